@@ -27,7 +27,9 @@ SPDX-License-Identifier: MIT
 #include "CrossingAnalysis.h"
 #include "debug/Dump.hpp"
 #include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/PostOrderIterator.h>
 #include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/STLExtras.h>
 #include <llvm/IR/Function.h>
 #include "common/LLVMWarningsPop.hpp"
 
@@ -85,6 +87,16 @@ LLVM_DUMP_METHOD void SuspendCrossingInfo::print(raw_ostream& OS) const {
         print(OS, "   Consumes", Block[I].Consumes);
         print(OS, "      Kills", Block[I].Kills);
     }
+    if (Sparse) {
+        // Only the kill sets queried so far are available.
+        for (auto& [DefIndex, Kills] : SparseKills) {
+            OS << Mapping.indexToBlock(DefIndex)->getName() << " kills:";
+            for (const KillRange& KR : Kills)
+                for (unsigned R = KR.First; R <= KR.Last; ++R)
+                    OS << " " << Mapping.indexToBlock(RPOBlocks[R])->getName();
+            OS << "\n";
+        }
+    }
     OS << "\n";
 }
 
@@ -111,6 +123,44 @@ SuspendCrossingInfo::SuspendCrossingInfo(
     Function& F, const std::vector<Instruction*>& SuspendPoints)
     : Mapping(F) {
     const size_t N = Mapping.size();
+
+    SuspendBlocks.resize(N);
+    for (auto *SP : SuspendPoints) {
+        SuspendBlocks.set(Mapping.blockToIndex(SP->getParent()));
+    }
+
+    const unsigned Threshold = IGC_GET_FLAG_VALUE(SuspendCrossingSparseThreshold);
+    Sparse = (Threshold == 0 || N > Threshold);
+
+    if (Sparse || IGC_IS_FLAG_ENABLED(VerifySuspendCrossingInfo))
+        computeRPONumbers(F);
+    if (!Sparse || IGC_IS_FLAG_ENABLED(VerifySuspendCrossingInfo))
+        computeDense();
+}
+
+void SuspendCrossingInfo::computeRPONumbers(Function& F) {
+    const size_t N = Mapping.size();
+    RPONumber.assign(N, ~0U);
+    RPOBlocks.reserve(N);
+
+    ReversePostOrderTraversal<Function*> RPOT(&F);
+    for (BasicBlock* BB : RPOT) {
+        unsigned I = (unsigned)Mapping.blockToIndex(BB);
+        RPONumber[I] = RPOBlocks.size();
+        RPOBlocks.push_back(I);
+    }
+
+    // Unreachable blocks go last.
+    for (unsigned I = 0; I < N; ++I) {
+        if (RPONumber[I] == ~0U) {
+            RPONumber[I] = RPOBlocks.size();
+            RPOBlocks.push_back(I);
+        }
+    }
+}
+
+void SuspendCrossingInfo::computeDense() {
+    const size_t N = Mapping.size();
     Block.resize(N);
 
     // Initialize every block so that it consumes itself
@@ -123,15 +173,10 @@ SuspendCrossingInfo::SuspendCrossingInfo(
 
     // Mark all suspend blocks and indicate that they kill everything they
     // consume.
-    auto markSuspendBlock = [&](Instruction* BarrierInst) {
-        BasicBlock* SuspendBlock = BarrierInst->getParent();
-        auto& B = getBlockData(SuspendBlock);
+    for (unsigned I : SuspendBlocks.set_bits()) {
+        auto& B = Block[I];
         B.Suspend = true;
         B.Kills |= B.Consumes;
-    };
-
-    for (auto *SP : SuspendPoints) {
-        markSuspendBlock(SP);
     }
 
     // Iterate propagating consumes and kills until they stop changing.
@@ -176,12 +221,91 @@ SuspendCrossingInfo::SuspendCrossingInfo(
     } while (Changed);
 }
 
+const SuspendCrossingInfo::KillList& SuspendCrossingInfo::getSparseKills(unsigned DefIndex) const {
+    auto It = SparseKills.find(DefIndex);
+    if (It != SparseKills.end())
+        return It->second;
+
+    const size_t N = Mapping.size();
+    const bool DefIsSuspend = SuspendBlocks.test(DefIndex);
+
+    BitVector Killed(N);
+    SmallVector<unsigned, 32> KillWorklist;
+
+    if (DefIsSuspend) {
+        // A suspend block kills everything it reaches, itself included.
+        Killed.set(DefIndex);
+        KillWorklist.push_back(DefIndex);
+    }
+    else {
+        // Collect the suspend blocks reachable from the def block.
+        BitVector Visited(N);
+        SmallVector<unsigned, 32> Worklist{ DefIndex };
+        Visited.set(DefIndex);
+        while (!Worklist.empty()) {
+            unsigned I = Worklist.pop_back_val();
+            for (BasicBlock* Succ : llvm::successors(Mapping.indexToBlock(I))) {
+                unsigned S = Mapping.blockToIndex(Succ);
+                if (Visited.test(S))
+                    continue;
+                Visited.set(S);
+                Worklist.push_back(S);
+                if (SuspendBlocks.test(S)) {
+                    Killed.set(S);
+                    KillWorklist.push_back(S);
+                }
+            }
+        }
+    }
+
+    // Everything reachable from those suspend blocks is killed, unless the
+    // path goes through the (non-suspend) def block again: that redefines
+    // the value.
+    while (!KillWorklist.empty()) {
+        unsigned I = KillWorklist.pop_back_val();
+        for (BasicBlock* Succ : llvm::successors(Mapping.indexToBlock(I))) {
+            unsigned S = Mapping.blockToIndex(Succ);
+            if (Killed.test(S) || (S == DefIndex && !DefIsSuspend))
+                continue;
+            Killed.set(S);
+            KillWorklist.push_back(S);
+        }
+    }
+
+    KillList& Kills = SparseKills[DefIndex];
+    for (unsigned R = 0; R < N; ++R) {
+        if (!Killed.test(RPOBlocks[R]))
+            continue;
+        if (!Kills.empty() && Kills.back().Last + 1 == R)
+            Kills.back().Last = R;
+        else
+            Kills.push_back({ R, R });
+    }
+    return Kills;
+}
+
+bool SuspendCrossingInfo::hasPathCrossingSuspendPointSparse(size_t DefIndex, size_t UseIndex) const {
+    const KillList& Kills = getSparseKills((unsigned)DefIndex);
+    const unsigned R = RPONumber[UseIndex];
+    // Find the last range starting at or before R.
+    auto It = llvm::upper_bound(Kills, R, [](unsigned R, const KillRange& KR) {
+        return R < KR.First;
+    });
+    return It != Kills.begin() && std::prev(It)->Last >= R;
+}
+
 bool SuspendCrossingInfo::hasPathCrossingSuspendPoint(BasicBlock* DefBB, BasicBlock* UseBB) const {
     size_t const DefIndex = Mapping.blockToIndex(DefBB);
     size_t const UseIndex = Mapping.blockToIndex(UseBB);
 
+    if (Sparse && Block.empty())
+        return hasPathCrossingSuspendPointSparse(DefIndex, UseIndex);
+
     IGC_ASSERT_MESSAGE(Block[UseIndex].Consumes[DefIndex], "use must consume def");
     bool const Result = Block[UseIndex].Kills[DefIndex];
+    IGC_ASSERT_MESSAGE(!IGC_IS_FLAG_ENABLED(VerifySuspendCrossingInfo) ||
+        Result == hasPathCrossingSuspendPointSparse(DefIndex, UseIndex),
+        "sparse and dense suspend crossing analysis disagree");
     return Result;
 }
 
@@ -21,6 +21,7 @@ SPDX-License-Identifier: MIT
 #include "common/LLVMWarningsPush.hpp"
 #include <llvm/IR/Function.h>
 #include <llvm/ADT/BitVector.h>
+#include <llvm/ADT/DenseMap.h>
 #include <llvm/IR/CFG.h>
 #include "common/LLVMWarningsPop.hpp"
 
@@ -56,13 +57,23 @@ public:
 // whether given two BasicBlocks A and B there is a path from A to B that
 // passes through a suspend point.
 //
-// For every basic block 'i' it maintains a BlockData that consists of:
+// For small functions, for every basic block 'i' it maintains a BlockData that
+// consists of:
 //   Consumes:  a bit vector which contains a set of indices of blocks that can
 //              reach block 'i'
 //   Kills: a bit vector which contains a set of indices of blocks that can
 //          reach block 'i', but one of the path will cross a suspend point
 //   Suspend: a boolean indicating whether block 'i' contains a suspend point.
 //
+// That is quadratic in the number of blocks, so functions larger than
+// SuspendCrossingSparseThreshold blocks use the sparse mode instead: the
+// kill set of a def block is computed on first query by walking forward to
+// the suspend blocks it reaches and from those to every block reachable
+// without redefining the value (i.e. without re-entering the def block).
+// Kill sets are cached as sorted ranges of reverse post-order numbers: the
+// blocks reached from a suspend point are mostly numbered consecutively, so
+// a kill set takes a few ranges and is queried with a binary search.
+//
 
 class SuspendCrossingInfo {
     BlockToIndexMapping Mapping;
@@ -74,10 +85,29 @@ class SuspendCrossingInfo {
     };
     llvm::SmallVector<BlockData, 32> Block;
 
+    // Sparse mode state.
+    bool Sparse = false;
+    llvm::BitVector SuspendBlocks;
+    // Block index -> reverse post-order number, and back.
+    llvm::SmallVector<unsigned, 32> RPONumber;
+    llvm::SmallVector<unsigned, 32> RPOBlocks;
+    // Inclusive range of reverse post-order numbers.
+    struct KillRange {
+        unsigned First;
+        unsigned Last;
+    };
+    using KillList = llvm::SmallVector<KillRange, 4>;
+    mutable llvm::DenseMap<unsigned, KillList> SparseKills;
+
     llvm::iterator_range<llvm::succ_iterator> successors(BlockData const& BD) const;
 
     BlockData& getBlockData(llvm::BasicBlock* BB);
 
+    void computeDense();
+    void computeRPONumbers(llvm::Function& F);
+    const KillList& getSparseKills(unsigned DefIndex) const;
+    bool hasPathCrossingSuspendPointSparse(size_t DefIndex, size_t UseIndex) const;
+
 public:
     void print(llvm::raw_ostream& OS) const;
     void print(llvm::raw_ostream& OS, llvm::StringRef Label, llvm::BitVector const& BV) const;
@@ -87,6 +117,8 @@ public:
 
     SuspendCrossingInfo(llvm::Function& F, const std::vector<llvm::Instruction*>& SuspendPoints);
 
+    bool isSparse() const { return Sparse; }
+
     bool hasPathCrossingSuspendPoint(llvm::BasicBlock* DefBB, llvm::BasicBlock* UseBB) const;
 
     bool isDefinitionAcrossSuspend(llvm::BasicBlock* DefBB, llvm::User* U) const;
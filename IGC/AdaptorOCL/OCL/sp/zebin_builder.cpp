@@ -876,19 +876,40 @@ void ZEBinaryBuilder::addElfSections(void* elfBin, size_t elfSize)
     }
 }
 
-void ZEBinaryBuilder::getBinaryObject(llvm::raw_pwrite_stream& os)
+void ZEBinaryBuilder::getBinaryObject(llvm::raw_ostream& os)
 {
     if (!mZEInfoBuilder.empty())
         mBuilder.addSectionZEInfo(mZEInfoBuilder.getZEInfoContainer());
     mBuilder.finalize(os);
 }
 
+namespace {
+/// BinaryStreamOStream - raw_ostream adaptor that forwards the written data
+/// to a Util::BinaryStream, so that the zebin object can be streamed into it
+/// without being buffered as a whole
+class BinaryStreamOStream : public llvm::raw_ostream {
+public:
+    explicit BinaryStreamOStream(Util::BinaryStream& stream)
+        : mStream(stream), mPos(0) {}
+    ~BinaryStreamOStream() override { flush(); }
+
+private:
+    void write_impl(const char* ptr, size_t size) override
+    {
+        mStream.Write(ptr, size);
+        mPos += size;
+    }
+    uint64_t current_pos() const override { return mPos; }
+
+    Util::BinaryStream& mStream;
+    uint64_t mPos;
+};
+} // anonymous namespace
+
 void ZEBinaryBuilder::getBinaryObject(Util::BinaryStream& outputStream)
 {
-    llvm::SmallVector<char, 64> buf;
-    llvm::raw_svector_ostream llvm_os(buf);
+    BinaryStreamOStream llvm_os(outputStream);
     getBinaryObject(llvm_os);
-    outputStream.Write(buf.data(), buf.size());
 }
 
 void ZEBinaryBuilder::printBinaryObject(const std::string& filename)
@@ -22,6 +22,11 @@ namespace IGC
     class OpenCLProgramContext;
 }
 
+namespace llvm
+{
+    class raw_ostream;
+}
+
 namespace vISA
 {
     struct ZESymEntry;
@@ -75,10 +80,10 @@ public:
     void addElfSections(void* elfBin, size_t elfSize);
 
     /// getBinaryObject - get the final ze object
-    void getBinaryObject(llvm::raw_pwrite_stream& os);
+    void getBinaryObject(llvm::raw_ostream& os);
 
-    // getBinaryObject - write the final object into given Util::BinaryStream
-    // Avoid using this function, which has extra buffer copy
+    // getBinaryObject - write the final object into given Util::BinaryStream,
+    // the object is streamed into it without an intermediate buffer
     void getBinaryObject(Util::BinaryStream& outputStream);
 
     void printBinaryObject(const std::string& filename);
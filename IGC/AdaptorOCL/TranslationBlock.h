@@ -182,6 +182,10 @@ struct STB_TranslateInputArgs
     uint32_t        NumVISAAsmsToLink;
     const char**    pDirectCallFunctions;
     uint32_t        NumDirectCallFunctions;
+    const char*     pSpecializedKernelName;   // kernel to specialize on argument values
+    const uint32_t* pSpecializedArgIndices;   // indices of the specialized kernel arguments
+    const uint64_t* pSpecializedArgValues;    // values the kernel is going to be launched with
+    uint32_t        NumSpecializedArgs;       // number of specialized kernel arguments
 
     STB_TranslateInputArgs()
     {
@@ -202,6 +206,10 @@ struct STB_TranslateInputArgs
         NumVISAAsmsToLink           = 0;
         pDirectCallFunctions        = NULL;
         NumDirectCallFunctions      = 0;
+        pSpecializedKernelName      = NULL;
+        pSpecializedArgIndices      = NULL;
+        pSpecializedArgValues       = NULL;
+        NumSpecializedArgs          = 0;
     }
 };
 
@@ -42,6 +42,7 @@ SPDX-License-Identifier: MIT
 #include "Compiler/CISACodeGen/ResolvePredefinedConstant.h"
 #include "Compiler/CISACodeGen/SimplifyConstant.h"
 #include "Compiler/CISACodeGen/FoldKnownWorkGroupSizes.h"
+#include "Compiler/CISACodeGen/SpecializeKernelArgs.h"
 #include "Compiler/CISACodeGen/OpenCLKernelCodeGen.hpp"
 
 #include "Compiler/HandleFRemInstructions.hpp"
@@ -469,6 +470,7 @@ static void CommonOCLBasedPasses(
     mpm.add(new BreakConstantExpr());
 
     mpm.add(CreateFoldKnownWorkGroupSizes());
+    mpm.add(createSpecializeKernelArgsPass());
 
     mpm.add(new ResolveSampledImageBuiltins());
 
@@ -110,6 +110,48 @@ protected:
                                                   void *gtPinInput);
 };
 
+CIF_DEFINE_INTERFACE_VER_WITH_COMPATIBILITY(IgcOclTranslationCtx, 4, 3) {
+  CIF_INHERIT_CONSTRUCTOR();
+
+  // Same as Translate, but kernel kernelName is additionally specialized on
+  // the values of its scalar arguments : argIndices holds argument indices
+  // (uint32_t) and argValues the matching raw values (uint64_t, zero-extended
+  // for types narrower than 64 bits). The caller is responsible for launching
+  // the resulting kernel with those same values only.
+  // Translations without tracing options and GTPin input are cached per device
+  // context, so repeated requests for the same variant are cheap.
+  template <typename OclTranslationOutputInterface = OclTranslationOutputTagOCL>
+  CIF::RAII::UPtr_t<OclTranslationOutputInterface> TranslateSpecialized(CIF::Builtins::BufferSimple *src,
+                                                                        CIF::Builtins::BufferSimple *specConstantsIds,
+                                                                        CIF::Builtins::BufferSimple *specConstantsValues,
+                                                                        CIF::Builtins::BufferSimple *options,
+                                                                        CIF::Builtins::BufferSimple *internalOptions,
+                                                                        CIF::Builtins::BufferSimple *kernelName,
+                                                                        CIF::Builtins::BufferSimple *argIndices,
+                                                                        CIF::Builtins::BufferSimple *argValues,
+                                                                        CIF::Builtins::BufferSimple *tracingOptions,
+                                                                        uint32_t tracingOptionsCount,
+                                                                        void *gtPinInput) {
+      auto p = TranslateSpecializedImpl(OclTranslationOutputInterface::GetVersion(), src, specConstantsIds, specConstantsValues, options, internalOptions,
+                                        kernelName, argIndices, argValues, tracingOptions, tracingOptionsCount, gtPinInput);
+      return CIF::RAII::Pack<OclTranslationOutputInterface>(p);
+  }
+
+protected:
+  virtual OclTranslationOutputBase *TranslateSpecializedImpl(CIF::Version_t outVersion,
+                                                             CIF::Builtins::BufferSimple *src,
+                                                             CIF::Builtins::BufferSimple *specConstantsIds,
+                                                             CIF::Builtins::BufferSimple *specConstantsValues,
+                                                             CIF::Builtins::BufferSimple *options,
+                                                             CIF::Builtins::BufferSimple *internalOptions,
+                                                             CIF::Builtins::BufferSimple *kernelName,
+                                                             CIF::Builtins::BufferSimple *argIndices,
+                                                             CIF::Builtins::BufferSimple *argValues,
+                                                             CIF::Builtins::BufferSimple *tracingOptions,
+                                                             uint32_t tracingOptionsCount,
+                                                             void *gtPinInput);
+};
+
 CIF_GENERATE_VERSIONS_LIST_AND_DECLARE_INTERFACE_DEPENDENCIES(IgcOclTranslationCtx, IGC::OclTranslationOutput, CIF::Builtins::Buffer);
 CIF_MARK_LATEST_VERSION(IgcOclTranslationCtxLatest, IgcOclTranslationCtx);
 using IgcOclTranslationCtxTagOCL = IgcOclTranslationCtxLatest; // Note : can tag with different version for
@@ -22,6 +22,7 @@ SPDX-License-Identifier: MIT
 #include "ocl_igc_interface/impl/igc_features_and_workarounds_impl.h"
 #include "ocl_igc_interface/impl/platform_impl.h"
 #include "ocl_igc_interface/impl/igc_builtins_impl.h"
+#include "ocl_igc_interface/impl/specialized_binary_cache.h"
 
 #include "Compiler/CISACodeGen/Platform.hpp"
 #include "common/SystemThread.h"
@@ -125,6 +126,8 @@ CIF_DECLARE_INTERFACE_PIMPL(IgcOclDeviceCtx) : CIF::PimplBase
         float ProfilingTimerResolution;
     } MiscOptions;
 
+    SpecializedBinaryCache SpecializedBinaries;
+
     const IGC::CPlatform & GetIgcCPlatform()
     {
         if(igcPlatform.get() != nullptr)
@@ -54,6 +54,23 @@ OclTranslationOutputBase *CIF_GET_INTERFACE_CLASS(IgcOclTranslationCtx, 3)::Tran
     return CIF_GET_PIMPL()->Translate(outVersion, src, specConstantsIds, specConstantsValues, options, internalOptions, tracingOptions, tracingOptionsCount, gtPinInput);
 }
 
+OclTranslationOutputBase *CIF_GET_INTERFACE_CLASS(IgcOclTranslationCtx, 4)::TranslateSpecializedImpl(
+                                                 CIF::Version_t outVersion,
+                                                 CIF::Builtins::BufferSimple *src,
+                                                 CIF::Builtins::BufferSimple *specConstantsIds,
+                                                 CIF::Builtins::BufferSimple *specConstantsValues,
+                                                 CIF::Builtins::BufferSimple *options,
+                                                 CIF::Builtins::BufferSimple *internalOptions,
+                                                 CIF::Builtins::BufferSimple *kernelName,
+                                                 CIF::Builtins::BufferSimple *argIndices,
+                                                 CIF::Builtins::BufferSimple *argValues,
+                                                 CIF::Builtins::BufferSimple *tracingOptions,
+                                                 uint32_t tracingOptionsCount,
+                                                 void *gtPinInput) {
+    return CIF_GET_PIMPL()->Translate(outVersion, src, specConstantsIds, specConstantsValues, options, internalOptions, tracingOptions, tracingOptionsCount, gtPinInput,
+                                      kernelName, argIndices, argValues);
+}
+
 }
 
 #include "cif/macros/disable.h"
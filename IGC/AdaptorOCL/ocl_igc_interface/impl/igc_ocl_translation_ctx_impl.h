@@ -209,7 +209,10 @@ CIF_DECLARE_INTERFACE_PIMPL(IgcOclTranslationCtx) : CIF::PimplBase
                                         CIF::Builtins::BufferSimple *internalOptions,
                                         CIF::Builtins::BufferSimple *tracingOptions,
                                         uint32_t tracingOptionsCount,
-                                        void *gtPinInput) const{
+                                        void *gtPinInput,
+                                        CIF::Builtins::BufferSimple *specializedKernelName = nullptr,
+                                        CIF::Builtins::BufferSimple *specializedArgIndices = nullptr,
+                                        CIF::Builtins::BufferSimple *specializedArgValues = nullptr) const{
         // Create interface for return data
         auto outputInterface = CIF::RAII::UPtr(CIF::InterfaceCreator<OclTranslationOutput>::CreateInterfaceVer(outVersion, this->outType));
         if(outputInterface == nullptr){
@@ -252,6 +255,21 @@ CIF_DECLARE_INTERFACE_PIMPL(IgcOclTranslationCtx) : CIF::PimplBase
             inputArgs.pSpecConstantsValues = specConstantsValues->GetMemory<uint64_t>();
         }
         inputArgs.GTPinInput = gtPinInput;
+        std::string kernelNameToSpecialize;
+        if(specializedKernelName != nullptr){
+            if((specializedArgIndices == nullptr) || (specializedArgValues == nullptr) ||
+               (specializedArgIndices->GetSizeRaw() / sizeof(uint32_t) != specializedArgValues->GetSizeRaw() / sizeof(uint64_t))){
+                outputInterface->GetImpl()->SetError(TranslationErrorType::UnhandledInput, "Mismatched kernel argument specialization data");
+                return outputInterface.release();
+            }
+            // Kernel name may or may not come with a terminating null
+            kernelNameToSpecialize.assign(specializedKernelName->GetMemory<char>(), specializedKernelName->GetSizeRaw());
+            kernelNameToSpecialize.erase(std::find(kernelNameToSpecialize.begin(), kernelNameToSpecialize.end(), '\0'), kernelNameToSpecialize.end());
+            inputArgs.pSpecializedKernelName = kernelNameToSpecialize.c_str();
+            inputArgs.pSpecializedArgIndices = specializedArgIndices->GetMemory<uint32_t>();
+            inputArgs.pSpecializedArgValues = specializedArgValues->GetMemory<uint64_t>();
+            inputArgs.NumSpecializedArgs = static_cast<uint32_t>(specializedArgIndices->GetSizeRaw() / sizeof(uint32_t));
+        }
 
         CIF::Sanity::NotNullOrAbort(this->globalState.GetPlatformImpl());
         auto platform = this->globalState.GetPlatformImpl()->p;
@@ -312,6 +330,26 @@ CIF_DECLARE_INTERFACE_PIMPL(IgcOclTranslationCtx) : CIF::PimplBase
             inputArgs.InternalOptionsSize = combinedInternalOptions.size();
         }
 
+        // Specialized programs are typically requested over and over with the
+        // same argument values, so reuse the previous build when there is one.
+        std::string specializationKey;
+        size_t specializationCacheSize = static_cast<size_t>(IGC_GET_FLAG_VALUE(SpecializedKernelCacheSizeKB)) * 1024;
+        if((inputArgs.NumSpecializedArgs != 0) && (specializationCacheSize != 0) &&
+           (tracingOptions == nullptr) && (gtPinInput == nullptr)){
+            specializationKey = GetSpecializationKey(inputArgs);
+            SpecializedBinaryCache::Entry cached;
+            if(this->globalState.SpecializedBinaries.lookup(specializationKey, cached)){
+                bool dataCopiedSuccessfuly = true;
+                dataCopiedSuccessfuly &= outputInterface->GetImpl()->AddWarning(cached.Warnings.data(), cached.Warnings.size());
+                dataCopiedSuccessfuly &= outputInterface->GetImpl()->CloneDebugData(cached.DebugData.data(), cached.DebugData.size());
+                dataCopiedSuccessfuly &= outputInterface->GetImpl()->SetSuccessfulAndCloneOutput(cached.Output.data(), cached.Output.size());
+                if(dataCopiedSuccessfuly == false){
+                    return nullptr; // OOM
+                }
+                return outputInterface.release();
+            }
+        }
+
         bool success = false;
         try
         {
@@ -388,9 +426,48 @@ CIF_DECLARE_INTERFACE_PIMPL(IgcOclTranslationCtx) : CIF::PimplBase
             return nullptr; // OOM
         }
 
+        if(success && !specializationKey.empty()){
+            SpecializedBinaryCache::Entry entry;
+            entry.Output.assign(output.pOutput, output.OutputSize);
+            if(output.pDebugData != nullptr){
+                entry.DebugData.assign(output.pDebugData, output.DebugDataSize);
+            }
+            if(output.pErrorString != nullptr){
+                entry.Warnings.assign(output.pErrorString, output.ErrorStringSize);
+            }
+            this->globalState.SpecializedBinaries.insert(specializationKey, std::move(entry), specializationCacheSize);
+        }
+
         return outputInterface.release();
     }
 
+    // Builds the key identifying a translation with specialized kernel
+    // arguments. All the inputs, including the source, are stored verbatim
+    // so that different translations never share an entry.
+    std::string GetSpecializationKey(const TC::STB_TranslateInputArgs &inputArgs) const
+    {
+        std::string key;
+        auto append = [&key](const void *data, size_t size){
+            uint64_t size64 = size;
+            key.append(reinterpret_cast<const char*>(&size64), sizeof(size64));
+            if(data != nullptr){
+                key.append(reinterpret_cast<const char*>(data), size);
+            }
+        };
+
+        append(&this->inType, sizeof(this->inType));
+        append(&this->outType, sizeof(this->outType));
+        append(inputArgs.pInput, inputArgs.InputSize);
+        append(inputArgs.pOptions, inputArgs.OptionsSize);
+        append(inputArgs.pInternalOptions, inputArgs.InternalOptionsSize);
+        append(inputArgs.pSpecConstantsIds, inputArgs.SpecConstantsSize * sizeof(uint32_t));
+        append(inputArgs.pSpecConstantsValues, inputArgs.SpecConstantsSize * sizeof(uint64_t));
+        append(inputArgs.pSpecializedKernelName, strlen(inputArgs.pSpecializedKernelName));
+        append(inputArgs.pSpecializedArgIndices, inputArgs.NumSpecializedArgs * sizeof(uint32_t));
+        append(inputArgs.pSpecializedArgValues, inputArgs.NumSpecializedArgs * sizeof(uint64_t));
+        return key;
+    }
+
 protected:
     CIF_PIMPL(IgcOclDeviceCtx) &globalState;
     CodeType::CodeType_t inType;
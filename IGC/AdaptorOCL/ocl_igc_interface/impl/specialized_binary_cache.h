@@ -0,0 +1,98 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace IGC
+{
+
+// Least recently used cache of programs built with specialized kernel
+// arguments. Entries are keyed by a digest of the translation inputs and the
+// argument values, and the total size of the cached data is kept under
+// a given limit.
+class SpecializedBinaryCache
+{
+public:
+    struct Entry
+    {
+        std::string Output;
+        std::string DebugData;
+        std::string Warnings;
+
+        size_t size() const {
+            return Output.size() + DebugData.size() + Warnings.size();
+        }
+    };
+
+    bool lookup(const std::string& key, Entry& entry)
+    {
+        std::lock_guard<std::mutex> lock{this->mutex};
+        auto it = index.find(key);
+        if (it == index.end())
+        {
+            return false;
+        }
+        // Move the entry to the front of the LRU list.
+        entries.splice(entries.begin(), entries, it->second);
+        entry = it->second->second;
+        return true;
+    }
+
+    void insert(const std::string& key, Entry entry, size_t maxSize)
+    {
+        size_t entrySize = key.size() + entry.size();
+        if (entrySize > maxSize)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock{this->mutex};
+        if (index.count(key) != 0)
+        {
+            return;
+        }
+        while (!entries.empty() && currentSize + entrySize > maxSize)
+        {
+            auto& last = entries.back();
+            currentSize -= last.first.size() + last.second.size();
+            index.erase(last.first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, std::move(entry));
+        index[key] = entries.begin();
+        currentSize += entrySize;
+    }
+
+    // Total size of the cached keys and data.
+    size_t getCurrentSize()
+    {
+        std::lock_guard<std::mutex> lock{this->mutex};
+        return currentSize;
+    }
+
+    size_t getNumEntries()
+    {
+        std::lock_guard<std::mutex> lock{this->mutex};
+        return entries.size();
+    }
+
+protected:
+    using EntryList = std::list<std::pair<std::string, Entry>>;
+
+    std::mutex                                               mutex;
+    EntryList                                                entries;
+    std::unordered_map<std::string, EntryList::iterator>     index;
+    size_t                                                   currentSize = 0;
+};
+
+} // namespace IGC
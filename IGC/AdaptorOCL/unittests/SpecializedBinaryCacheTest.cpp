@@ -0,0 +1,101 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "ocl_igc_interface/impl/specialized_binary_cache.h"
+
+#include "gtest/gtest.h"
+
+using namespace IGC;
+
+namespace {
+
+SpecializedBinaryCache::Entry makeEntry(size_t outputSize, size_t debugSize = 0,
+                                        size_t warningsSize = 0) {
+    SpecializedBinaryCache::Entry entry;
+    entry.Output.assign(outputSize, 'o');
+    entry.DebugData.assign(debugSize, 'd');
+    entry.Warnings.assign(warningsSize, 'w');
+    return entry;
+}
+
+TEST(SpecializedBinaryCache, LookupReturnsInsertedData) {
+    SpecializedBinaryCache cache;
+    SpecializedBinaryCache::Entry entry;
+    EXPECT_FALSE(cache.lookup("k", entry));
+
+    cache.insert("k", makeEntry(4, 2, 1), 100);
+    ASSERT_TRUE(cache.lookup("k", entry));
+    EXPECT_EQ(entry.Output, "oooo");
+    EXPECT_EQ(entry.DebugData, "dd");
+    EXPECT_EQ(entry.Warnings, "w");
+}
+
+TEST(SpecializedBinaryCache, SizeAccountsForKeysAndAllData) {
+    SpecializedBinaryCache cache;
+    cache.insert("key1", makeEntry(10, 5, 1), 100);
+    EXPECT_EQ(cache.getCurrentSize(), 4u + 10u + 5u + 1u);
+    cache.insert("key2", makeEntry(20), 100);
+    EXPECT_EQ(cache.getCurrentSize(), 20u + 24u);
+    EXPECT_EQ(cache.getNumEntries(), 2u);
+
+    // Inserting an existing key keeps the first entry.
+    cache.insert("key2", makeEntry(30), 100);
+    EXPECT_EQ(cache.getCurrentSize(), 20u + 24u);
+    EXPECT_EQ(cache.getNumEntries(), 2u);
+}
+
+TEST(SpecializedBinaryCache, EvictsLeastRecentlyUsed) {
+    SpecializedBinaryCache cache;
+    const size_t maxSize = 3 * 11; // three entries of 1 + 10 bytes
+    cache.insert("a", makeEntry(10), maxSize);
+    cache.insert("b", makeEntry(10), maxSize);
+    cache.insert("c", makeEntry(10), maxSize);
+    EXPECT_EQ(cache.getCurrentSize(), maxSize);
+
+    // Touch "a" so that "b" becomes the least recently used entry.
+    SpecializedBinaryCache::Entry entry;
+    ASSERT_TRUE(cache.lookup("a", entry));
+
+    cache.insert("d", makeEntry(10), maxSize);
+    EXPECT_EQ(cache.getNumEntries(), 3u);
+    EXPECT_EQ(cache.getCurrentSize(), maxSize);
+    EXPECT_FALSE(cache.lookup("b", entry));
+    EXPECT_TRUE(cache.lookup("a", entry));
+    EXPECT_TRUE(cache.lookup("c", entry));
+    EXPECT_TRUE(cache.lookup("d", entry));
+}
+
+TEST(SpecializedBinaryCache, EvictsAsManyEntriesAsNeeded) {
+    SpecializedBinaryCache cache;
+    const size_t maxSize = 40;
+    cache.insert("a", makeEntry(9), maxSize);
+    cache.insert("b", makeEntry(9), maxSize);
+    cache.insert("c", makeEntry(9), maxSize);
+
+    // Needs the space of both "a" and "b".
+    cache.insert("e", makeEntry(24), maxSize);
+    SpecializedBinaryCache::Entry entry;
+    EXPECT_FALSE(cache.lookup("a", entry));
+    EXPECT_FALSE(cache.lookup("b", entry));
+    EXPECT_TRUE(cache.lookup("c", entry));
+    EXPECT_TRUE(cache.lookup("e", entry));
+    EXPECT_EQ(cache.getCurrentSize(), 10u + 25u);
+}
+
+TEST(SpecializedBinaryCache, DropsEntriesLargerThanLimit) {
+    SpecializedBinaryCache cache;
+    cache.insert("a", makeEntry(10), 20);
+    cache.insert("big", makeEntry(100), 20);
+    SpecializedBinaryCache::Entry entry;
+    EXPECT_FALSE(cache.lookup("big", entry));
+    // The existing entry is not evicted for an entry that can never fit.
+    EXPECT_TRUE(cache.lookup("a", entry));
+    EXPECT_EQ(cache.getCurrentSize(), 11u);
+}
+
+} // namespace
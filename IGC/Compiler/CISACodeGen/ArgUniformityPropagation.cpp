@@ -0,0 +1,217 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "Compiler/CISACodeGen/ArgUniformityPropagation.h"
+#include "Compiler/CISACodeGen/GenCodeGenModule.h"
+#include "Compiler/CISACodeGen/WIAnalysis.hpp"
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/IGCPassSupport.h"
+#include "AdaptorCommon/ImplicitArgs.hpp"
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include "common/LLVMWarningsPop.hpp"
+#include <algorithm>
+
+using namespace llvm;
+using namespace IGC;
+using namespace IGC::IGCMD;
+
+namespace {
+// WIAnalysis runs on a single function and has to assume that the explicit
+// arguments of subroutines and stack-call functions are random. This pass
+// computes, for each such argument, the meet of the dependencies of the
+// values passed to it over all call sites, and records it on the argument
+// (see WIAnalysis::setArgDependency). WIAnalysis then seeds the callee with
+// it, and the argument and the computations depending on it are emitted as
+// uniform.
+//
+// Functions are visited callers first within each function group, so the
+// uniformity proven for a caller's arguments is used when its call sites are
+// analyzed. Groups with recursion and indirectly called functions, whose call
+// sites are not all known, are skipped.
+class ArgUniformityPropagation : public ModulePass
+{
+public:
+    static char ID;
+
+    ArgUniformityPropagation();
+    bool runOnModule(Module& M) override;
+
+    void getAnalysisUsage(AnalysisUsage& AU) const override {
+        AU.setPreservesCFG();
+        AU.addRequired<MetaDataUtilsWrapper>();
+        AU.addRequired<CodeGenContextWrapper>();
+        AU.addRequired<WIAnalysis>();
+    }
+
+    StringRef getPassName() const override {
+        return "ArgUniformityPropagation";
+    }
+
+private:
+    typedef DenseMap<const Argument*, WIAnalysis::WIDependancy> ArgDepMap;
+
+    bool processGroup(FunctionGroup* FG);
+    void visitCallees(Function* F, FunctionGroup* FG,
+        SmallPtrSetImpl<Function*>& Visited, SmallVectorImpl<Function*>& PostOrder);
+    bool allCallSitesKnown(Function* F, FunctionGroup* FG);
+    bool seedArgs(Function* F, FunctionGroup* FG, const ArgDepMap& Deps);
+    void meetCallSites(Function* F, FunctionGroup* FG, ArgDepMap& Deps);
+    static bool isSupportedArg(const Argument& Arg);
+
+    GenXFunctionGroupAnalysis* FGA = nullptr;
+    MetaDataUtils* MDU = nullptr;
+};
+} // End anonymous namespace
+
+char ArgUniformityPropagation::ID = 0;
+
+#define PASS_FLAG "igc-arg-uniformity-propagation"
+#define PASS_DESCRIPTION "Propagate argument uniformity from call sites to callees"
+#define PASS_CFG_ONLY false
+#define PASS_ANALYSIS false
+
+namespace IGC {
+IGC_INITIALIZE_PASS_BEGIN(ArgUniformityPropagation, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
+IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+IGC_INITIALIZE_PASS_DEPENDENCY(WIAnalysis)
+IGC_INITIALIZE_PASS_END(ArgUniformityPropagation, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+} // End IGC namespace
+
+ModulePass* IGC::createArgUniformityPropagationPass() {
+    return new ArgUniformityPropagation();
+}
+
+ArgUniformityPropagation::ArgUniformityPropagation() : ModulePass(ID) {
+    initializeArgUniformityPropagationPass(*PassRegistry::getPassRegistry());
+}
+
+bool ArgUniformityPropagation::runOnModule(Module& M) {
+    FGA = getAnalysisIfAvailable<GenXFunctionGroupAnalysis>();
+    if (!FGA)
+        return false;
+    MDU = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
+
+    bool Changed = false;
+    for (auto FG : *FGA) {
+        if (FG->isSingle() || FG->hasRecursion() || FG == FGA->getIndirectCallGroup())
+            continue;
+        Changed |= processGroup(FG);
+    }
+    return Changed;
+}
+
+bool ArgUniformityPropagation::processGroup(FunctionGroup* FG) {
+    SmallVector<Function*, 16> PostOrder;
+    SmallPtrSet<Function*, 16> Visited;
+    for (Function* F : *FG)
+        visitCallees(F, FG, Visited, PostOrder);
+
+    // Without recursion the reverse post order puts every caller before its
+    // callees, so the meet over the call sites of a function is complete by
+    // the time it is reached.
+    ArgDepMap Deps;
+    bool Changed = false;
+    for (Function* F : llvm::reverse(PostOrder)) {
+        if (F != FG->getHead())
+            Changed |= seedArgs(F, FG, Deps);
+        meetCallSites(F, FG, Deps);
+    }
+    return Changed;
+}
+
+void ArgUniformityPropagation::visitCallees(Function* F, FunctionGroup* FG,
+    SmallPtrSetImpl<Function*>& Visited, SmallVectorImpl<Function*>& PostOrder) {
+    if (!Visited.insert(F).second)
+        return;
+    for (auto& I : instructions(*F)) {
+        auto CI = dyn_cast<CallInst>(&I);
+        if (!CI)
+            continue;
+        Function* Callee = CI->getCalledFunction();
+        if (Callee && !Callee->isDeclaration() && FGA->getGroup(Callee) == FG)
+            visitCallees(Callee, FG, Visited, PostOrder);
+    }
+    PostOrder.push_back(F);
+}
+
+bool ArgUniformityPropagation::allCallSitesKnown(Function* F, FunctionGroup* FG) {
+    // Invoke SIMD targets are compiled by the vector compiler, which has its
+    // own calling convention for uniform arguments.
+    if (F->hasFnAttribute("referenced-indirectly") ||
+        F->hasFnAttribute("invoke_simd_target"))
+        return false;
+    for (auto U : F->users()) {
+        auto CI = dyn_cast<CallInst>(U);
+        if (!CI || CI->getCalledFunction() != F ||
+            FGA->getGroup(CI->getFunction()) != FG)
+            return false;
+    }
+    return true;
+}
+
+bool ArgUniformityPropagation::isSupportedArg(const Argument& Arg) {
+    // Only scalars, for which the uniform and the vectorized layouts agree
+    // on where the first lane is, are passed as uniform.
+    Type* Ty = Arg.getType();
+    if (Arg.hasByValAttr() || Arg.hasStructRetAttr())
+        return false;
+    return (Ty->isIntegerTy() && !Ty->isIntegerTy(1)) ||
+        Ty->isFloatingPointTy() || Ty->isPointerTy();
+}
+
+bool ArgUniformityPropagation::seedArgs(Function* F, FunctionGroup* FG, const ArgDepMap& Deps) {
+    bool Known = allCallSitesKnown(F, FG);
+    ImplicitArgs implicitArgs(*F, MDU);
+    unsigned NumExplicitArgs = F->arg_size() - implicitArgs.size();
+
+    bool Changed = false;
+    for (auto& Arg : F->args()) {
+        WIAnalysis::WIDependancy Dep = WIAnalysis::RANDOM;
+        auto It = Deps.find(&Arg);
+        if (Known && It != Deps.end() &&
+            Arg.getArgNo() < NumExplicitArgs && isSupportedArg(Arg))
+            Dep = It->second;
+        if (Dep != WIAnalysis::getArgDependency(&Arg)) {
+            WIAnalysis::setArgDependency(&Arg, Dep);
+            Changed = true;
+        }
+    }
+    return Changed;
+}
+
+void ArgUniformityPropagation::meetCallSites(Function* F, FunctionGroup* FG, ArgDepMap& Deps) {
+    WIAnalysis* WI = nullptr;
+    for (auto& I : instructions(*F)) {
+        auto CI = dyn_cast<CallInst>(&I);
+        if (!CI)
+            continue;
+        Function* Callee = CI->getCalledFunction();
+        if (!Callee || Callee->isDeclaration() || FGA->getGroup(Callee) != FG)
+            continue;
+
+        // Run WIAnalysis only on functions with calls to process.
+        if (!WI)
+            WI = &getAnalysis<WIAnalysis>(*F);
+        for (auto& Arg : Callee->args()) {
+            WIAnalysis::WIDependancy Dep = WI->whichDepend(CI->getArgOperand(Arg.getArgNo()));
+            // The uniform dependencies are ordered from the strongest to the
+            // weakest, so the meet is the largest one.
+            if (!WIAnalysis::isDepUniform(Dep))
+                Dep = WIAnalysis::RANDOM;
+            auto It = Deps.try_emplace(&Arg, Dep).first;
+            It->second = std::max(It->second, Dep);
+        }
+    }
+}
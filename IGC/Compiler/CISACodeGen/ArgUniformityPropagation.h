@@ -0,0 +1,19 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/Pass.h"
+#include "common/LLVMWarningsPop.hpp"
+
+namespace IGC
+{
+    llvm::ModulePass* createArgUniformityPropagationPass();
+    void initializeArgUniformityPropagationPass(llvm::PassRegistry&);
+}
@@ -139,11 +139,110 @@ Value *AtomicOptPass::getSubgroupLocalIdBI(Instruction *Pos) {
     return subgroupLocalInvocationId;
 }
 
+// Get the subgroup reduction which combines the sources of lanes accessing
+// the same address, and the atomic operation applying the combined value.
+static bool getAggregationOps(AtomicOp Op, WaveOps &Reduce, AtomicOp &NewOp) {
+    NewOp = Op;
+    switch (Op) {
+    case EATOMIC_IADD: Reduce = WaveOps::SUM; return true;
+    case EATOMIC_SUB:  Reduce = WaveOps::SUM; return true;
+    case EATOMIC_INC:  Reduce = WaveOps::SUM; NewOp = EATOMIC_IADD; return true;
+    case EATOMIC_DEC:  Reduce = WaveOps::SUM; NewOp = EATOMIC_SUB; return true;
+    case EATOMIC_AND:  Reduce = WaveOps::AND; return true;
+    case EATOMIC_OR:   Reduce = WaveOps::OR; return true;
+    case EATOMIC_XOR:  Reduce = WaveOps::XOR; return true;
+    case EATOMIC_IMIN: Reduce = WaveOps::IMIN; return true;
+    case EATOMIC_IMAX: Reduce = WaveOps::IMAX; return true;
+    case EATOMIC_UMIN: Reduce = WaveOps::UMIN; return true;
+    case EATOMIC_UMAX: Reduce = WaveOps::UMAX; return true;
+    default:
+        return false;
+    }
+}
+
+bool AtomicOptPass::isDivergentAtomicToAggregate(GenIntrinsicInst *Inst) const {
+    GenISAIntrinsic::ID ID = Inst->getIntrinsicID();
+    if (ID != GenISAIntrinsic::GenISA_intatomicraw &&
+        ID != GenISAIntrinsic::GenISA_intatomicrawA64)
+        return false;
+
+    // The returned value would need a prefix scan within each partition.
+    if (!Inst->use_empty() || !Inst->getType()->isIntegerTy(32))
+        return false;
+
+    ConstantInt *Op = dyn_cast<ConstantInt>(Inst->getOperand(3));
+    WaveOps Reduce;
+    AtomicOp NewOp;
+    if (!Op || !getAggregationOps((AtomicOp)Op->getZExtValue(), Reduce, NewOp))
+        return false;
+
+    // Stateful atomics are partitioned by offset within the same buffer.
+    if (ID == GenISAIntrinsic::GenISA_intatomicraw && !Wi->isUniform(Inst->getOperand(0)))
+        return false;
+
+    // Atomics on a uniform address are already reduced when emitted.
+    return !Wi->isUniform(Inst->getOperand(1));
+}
+
+void AtomicOptPass::aggregateDivergentAtomic(GenIntrinsicInst *Inst) {
+    LLVMContext &Ctx = Inst->getContext();
+    BasicBlock *Bb = Inst->getParent();
+    Function *F = Bb->getParent();
+
+    AtomicOp Op = (AtomicOp)cast<ConstantInt>(Inst->getOperand(3))->getZExtValue();
+    WaveOps Reduce;
+    AtomicOp NewOp;
+    getAggregationOps(Op, Reduce, NewOp);
+    // inc/dec are turned into add/sub of the number of lanes.
+    Value *Src = (NewOp != Op) ? ConstantInt::get(Inst->getType(), 1) : Inst->getOperand(2);
+
+    BasicBlock *ExitBb = Bb->splitBasicBlock(Inst->getNextNode(), "atomic.aggr.exit");
+    BasicBlock *LoopBb = Bb->splitBasicBlock(Inst, "atomic.aggr.loop");
+    BasicBlock *LeaderBb = LoopBb->splitBasicBlock(Inst, "atomic.aggr.leader");
+    BasicBlock *PartitionBb = BasicBlock::Create(Ctx, "atomic.aggr.partition", F, LeaderBb);
+    BasicBlock *LatchBb = BasicBlock::Create(Ctx, "atomic.aggr.latch", F, ExitBb);
+    LoopBb->getTerminator()->eraseFromParent();
+    cast<BranchInst>(LeaderBb->getTerminator())->setSuccessor(0, LatchBb);
+
+    // Pick the address of the first lane still in the loop.
+    IRBuilder<> Builder(LoopBb);
+    Function *BallotFn = GenISAIntrinsic::getDeclaration(M, GenISAIntrinsic::GenISA_WaveBallot);
+    Value *Mask = Builder.CreateCall(BallotFn, { Builder.getTrue(), Builder.getInt32(0) });
+    Function *FirstBitFn = GenISAIntrinsic::getDeclaration(M, GenISAIntrinsic::GenISA_firstbitLo);
+    Value *Leader = Builder.CreateCall(FirstBitFn, Mask);
+    Value *Addr = Inst->getOperand(1);
+    if (Addr->getType()->isPointerTy())
+        Addr = Builder.CreatePtrToInt(Addr, Builder.getInt64Ty());
+    Function *ShuffleFn = GenISAIntrinsic::getDeclaration(M,
+        GenISAIntrinsic::GenISA_WaveShuffleIndex, Addr->getType());
+    Value *LeadAddr = Builder.CreateCall(ShuffleFn, { Addr, Leader, Builder.getInt32(0) });
+    Value *Match = Builder.CreateICmpEQ(Addr, LeadAddr);
+    BranchInst *LoopBr = Builder.CreateCondBr(Match, PartitionBb, LatchBb);
+
+    // Combine the sources of the lanes sharing that address.
+    Value *LaneId = getSubgroupLocalIdBI(LoopBr);
+    Builder.SetInsertPoint(PartitionBb);
+    Function *WaveAllFn = GenISAIntrinsic::getDeclaration(M,
+        GenISAIntrinsic::GenISA_WaveAll, Src->getType());
+    Value *Combined = Builder.CreateCall(WaveAllFn,
+        { Src, Builder.getInt8((uint8_t)Reduce), Builder.getInt32(0) });
+    Value *IsLeader = Builder.CreateICmpEQ(LaneId, Leader);
+    Builder.CreateCondBr(IsLeader, LeaderBb, LatchBb);
+
+    Inst->setOperand(2, Combined);
+    Inst->setOperand(3, Builder.getInt32(NewOp));
+
+    // Lanes whose address has been handled leave the loop.
+    Builder.SetInsertPoint(LatchBb);
+    Builder.CreateCondBr(Match, ExitBb, LoopBb);
+}
+
 bool AtomicOptPass::runOnFunction(Function &F)
 {
     Changed = false;
     M = F.getParent();
     llvm::SmallVector<std::tuple<Instruction*, BasicBlock*, BasicBlock*, Instruction*, size_t>, 32> AtomicsEmulationToProcess;
+    llvm::SmallVector<GenIntrinsicInst*, 32> DivergentAtomicsToProcess;
     Wi = &getAnalysis<WIAnalysis>();
 
     for (auto &B : F) {
@@ -154,6 +253,12 @@ bool AtomicOptPass::runOnFunction(Function &F)
             if (I.getNumOperands() == 0)
                 continue;
 
+            if (IGC_IS_FLAG_ENABLED(EnableDivergentAtomicAggregation) &&
+                isDivergentAtomicToAggregate(cast<GenIntrinsicInst>(&I))) {
+                DivergentAtomicsToProcess.push_back(cast<GenIntrinsicInst>(&I));
+                continue;
+            }
+
             uint8_t DepType = Wi->whichDepend(I.getOperand(0));
             if (DepType != IGC::WIBaseClass::WIDependancy::UNIFORM_GLOBAL &&
                 DepType != IGC::WIBaseClass::WIDependancy::UNIFORM_WORKGROUP &&
@@ -247,5 +352,11 @@ bool AtomicOptPass::runOnFunction(Function &F)
         }
         Changed = true;
     }
+
+    for (auto *AtomicInstr : DivergentAtomicsToProcess)
+    {
+        aggregateDivergentAtomic(AtomicInstr);
+        Changed = true;
+    }
     return Changed;
-}
\ No newline at end of file
+}
@@ -13,6 +13,7 @@ SPDX-License-Identifier: MIT
 #include <llvm/IR/InstVisitor.h>
 #include "common/LLVMWarningsPop.hpp"
 #include "Compiler/CISACodeGen/WIAnalysis.hpp"
+#include "GenISAIntrinsics/GenIntrinsicInst.h"
 
 namespace IGC
 {
@@ -50,6 +51,29 @@ namespace IGC
     //      br i1 %cmp, label %exit, label %back
     //  exit:
     //      ret void
+    //
+    //  With EnableDivergentAtomicAggregation it also aggregates integer atomics
+    //  with a divergent address whose result is unused (histograms, scatter-add).
+    //  Lanes are partitioned by address with a loop; in each iteration the
+    //  first remaining lane picks its address, the lanes sharing it reduce
+    //  their sources with GenISA.WaveAll, and only the first lane issues the
+    //  atomic:
+    //
+    //  loop:
+    //      %mask = call i32 @llvm.genx.GenISA.WaveBallot(i1 true, i32 0)
+    //      %leader = call i32 @llvm.genx.GenISA.firstbitLo(i32 %mask)
+    //      %lead.addr = call i64 @llvm.genx.GenISA.WaveShuffleIndex.i64(i64 %addr, i32 %leader, i32 0)
+    //      %match = icmp eq i64 %addr, %lead.addr
+    //      br i1 %match, label %partition, label %latch
+    //  partition:
+    //      %sum = call i32 @llvm.genx.GenISA.WaveAll.i32(i32 %src, i8 0, i32 0)
+    //      %is.leader = icmp eq i32 %lane, %leader
+    //      br i1 %is.leader, label %leader, label %latch
+    //  leader:
+    //      atomic add %sum
+    //      br label %latch
+    //  latch:
+    //      br i1 %match, label %exit, label %loop
 
     class AtomicOptPass : public llvm::FunctionPass
     {
@@ -65,7 +89,6 @@ namespace IGC
 
         virtual void getAnalysisUsage(llvm::AnalysisUsage &AU) const override
         {
-            AU.setPreservesAll();
             AU.addRequired<WIAnalysis>();
         }
 
@@ -75,6 +98,8 @@ namespace IGC
         llvm::Instruction *createReduce(llvm::Instruction *Pos, llvm::Value *ValueForReduce);
         llvm::Value *getSubgroupLocalIdBI(llvm::Instruction *Pos);
         bool checkFloatAtomicEmulation(llvm::Instruction *Val, size_t &OperandPos);
+        bool isDivergentAtomicToAggregate(llvm::GenIntrinsicInst *Inst) const;
+        void aggregateDivergentAtomic(llvm::GenIntrinsicInst *Inst);
 
         bool Changed = false;
         WIAnalysis *Wi;
@@ -2698,6 +2698,11 @@ CVariable* CShader::getOrCreateArgumentSymbol(
             // Arg is for the current function and m_WI is available
             isUniform = m_WI->isUniform(&*Arg);
         }
+        else {
+            // Callee's WIAnalysis is not available, but the uniformity proven
+            // over all call sites is recorded on the argument.
+            isUniform = WIAnalysis::isDepUniform(WIAnalysis::getArgDependency(Arg));
+        }
 
         VISA_Type type = GetType(Arg->getType());
         uint16_t nElts = (uint16_t)GetNumElts(Arg->getType(), isUniform);
@@ -16,6 +16,7 @@ SPDX-License-Identifier: MIT
 #include "Compiler/CISACodeGen/DebugInfo.hpp"
 #include "Compiler/CISACodeGen/OpenCLKernelCodeGen.hpp"
 #include "llvm/IR/IntrinsicInst.h"
+#include "llvm/Support/Parallel.h"
 
 using namespace llvm;
 using namespace IGC;
@@ -78,6 +79,11 @@ bool DebugInfoPass::runOnModule(llvm::Module& M)
 
     DwarfDISubprogramCache DISPCache;
 
+    // Debug information of each unit is finalized by its own debug emitter,
+    // so the units are prepared first and then finalized, optionally
+    // concurrently.
+    std::vector<DebugInfoUnit> unitsToEmit;
+
     for (auto& currShader : units)
     {
         // Look for the right CShaderProgram instance
@@ -87,13 +93,16 @@ bool DebugInfoPass::runOnModule(llvm::Module& M)
         if (!isEntryFunc(pMdUtils, m_currShader->entry))
             continue;
 
-        bool finalize = false;
-        unsigned int size = m_currShader->GetDebugInfoData().m_VISAModules.size();
         m_pDebugEmitter = m_currShader->GetDebugInfoData().m_pDebugEmitter;
+        DebugInfoUnit& unit = unitsToEmit.emplace_back();
+        unit.Shader = m_currShader;
+        unit.Emitter = m_pDebugEmitter;
         std::vector<std::pair<unsigned int, std::pair<llvm::Function*, IGC::VISAModule*>>> sortedVISAModules;
 
         // Sort modules in order of their placement in binary
-        IGC::VISADebugInfo VisaDbgInfo(m_currShader->ProgramOutput()->m_debugDataGenISA);
+        unit.VisaDbgInfo = std::make_unique<IGC::VISADebugInfo>(
+            m_currShader->ProgramOutput()->m_debugDataGenISA);
+        const IGC::VISADebugInfo& VisaDbgInfo = *unit.VisaDbgInfo;
         const auto &decodedDbg = VisaDbgInfo.getRawDecodedData();
         auto getGenOff = [&decodedDbg](const std::vector<std::pair<unsigned int, unsigned int>>& data,
                                        unsigned int VISAIndex)
@@ -216,20 +225,47 @@ bool DebugInfoPass::runOnModule(llvm::Module& M)
             m_pDebugEmitter->registerVISA(m.second.second);
         }
 
-        std::vector<llvm::Function*> functions;
-        std::for_each(sortedVISAModules.begin(), sortedVISAModules.end(),
-            [&functions](auto& item) { functions.push_back(item.second.first); });
-
         for (auto& m : sortedVISAModules)
-        {
-            m_pDebugEmitter->setCurrentVISA(m.second.second);
+            unit.VISAModules.push_back(m.second.second);
+        // the last one is finalized only when there are all the VISA modules
+        // of the shader in the list
+        unit.Finalize = !unit.VISAModules.empty() &&
+            unit.VISAModules.size() == m_currShader->GetDebugInfoData().m_VISAModules.size();
+    }
 
-            if (--size == 0)
-                finalize = true;
+    // Units don't share their emitters, VISA modules and Gen ISA range
+    // indexes. What they share is only read while they are finalized:
+    // - DISPCache is guarded by its own lock,
+    // - LLVMContext is not modified, no metadata is created in DwarfDebug,
+    // - function metadata is loaded lazily, so it's loaded here before the
+    //   concurrent lookups in ScalarVisaModule::GetVariableLocation.
+    bool parallelEmission =
+        IGC_IS_FLAG_ENABLED(ParallelDebugInfoEmission) && unitsToEmit.size() > 1;
+    if (parallelEmission)
+    {
+        MetaDataUtils* pMdUtils = unitsToEmit.front().Shader->GetMetaDataUtils();
+        for (auto FI = pMdUtils->begin_FunctionsInfo(),
+                  FE = pMdUtils->end_FunctionsInfo(); FI != FE; ++FI)
+            (void)FI->second->size_ImplicitArgInfoList();
+    }
 
-            EmitDebugInfo(finalize, VisaDbgInfo);
+    auto emitUnit = [](DebugInfoUnit& unit)
+    {
+        for (unsigned i = 0, e = unit.VISAModules.size(); i != e; ++i)
+        {
+            unit.Emitter->setCurrentVISA(unit.VISAModules[i]);
+            EmitDebugInfo(unit.Shader, unit.Emitter,
+                unit.Finalize && i + 1 == e, *unit.VisaDbgInfo);
         }
+    };
+    if (parallelEmission)
+        llvm::parallelForEach(unitsToEmit.begin(), unitsToEmit.end(), emitUnit);
+    else
+        std::for_each(unitsToEmit.begin(), unitsToEmit.end(), emitUnit);
 
+    for (auto& unit : unitsToEmit)
+    {
+        CShader* currShader = unit.Shader;
         // set VISA dbg info to nullptr to indicate 1-step debug is enabled
         if (currShader->ProgramOutput()->m_debugDataGenISA)
         {
@@ -238,13 +274,13 @@ bool DebugInfoPass::runOnModule(llvm::Module& M)
         currShader->ProgramOutput()->m_debugDataGenISASize = 0;
         currShader->ProgramOutput()->m_debugDataGenISA = nullptr;
 
-        m_currShader->GetContext()->metrics.CollectDataFromDebugInfo(
-            m_currShader->entry,
-            &m_currShader->GetDebugInfoData(), &VisaDbgInfo);
+        currShader->GetContext()->metrics.CollectDataFromDebugInfo(
+            currShader->entry,
+            &currShader->GetDebugInfoData(), unit.VisaDbgInfo.get());
 
-        if (finalize)
+        if (unit.Finalize)
         {
-            IDebugEmitter::Release(m_pDebugEmitter);
+            IDebugEmitter::Release(unit.Emitter);
         }
     }
 
@@ -267,25 +303,27 @@ static void debugDump(const CShader* Shader, llvm::StringRef Ext,
     fclose(DumpFile);
 }
 
-void DebugInfoPass::EmitDebugInfo(bool finalize,
+void DebugInfoPass::EmitDebugInfo(CShader* pShader,
+                                  IDebugEmitter* pDebugEmitter,
+                                  bool finalize,
                                   const IGC::VISADebugInfo& VisaDbgInfo)
 {
-    IGC_ASSERT(m_pDebugEmitter);
+    IGC_ASSERT(pDebugEmitter);
 
-    std::vector<char> buffer = m_pDebugEmitter->Finalize(finalize, VisaDbgInfo);
+    std::vector<char> buffer = pDebugEmitter->Finalize(finalize, VisaDbgInfo);
 
     if (IGC_IS_FLAG_ENABLED(ShaderDumpEnable) || IGC_IS_FLAG_ENABLED(ElfDumpEnable))
-        debugDump(m_currShader, "elf", { buffer.data(), buffer.size() });
+        debugDump(pShader, "elf", { buffer.data(), buffer.size() });
 
-    const std::string& DbgErrors = m_pDebugEmitter->getErrors();
+    const std::string& DbgErrors = pDebugEmitter->getErrors();
     if (IGC_IS_FLAG_ENABLED(ShaderDumpEnable))
-        debugDump(m_currShader, "dbgerr", { DbgErrors.data(), DbgErrors.size() });
+        debugDump(pShader, "dbgerr", { DbgErrors.data(), DbgErrors.size() });
 
     void* dbgInfo = IGC::aligned_malloc(buffer.size(), sizeof(void*));
     if (dbgInfo)
         memcpy_s(dbgInfo, buffer.size(), buffer.data(), buffer.size());
 
-    SProgramOutput* pOutput = m_currShader->ProgramOutput();
+    SProgramOutput* pOutput = pShader->ProgramOutput();
     pOutput->m_debugData = dbgInfo;
     pOutput->m_debugDataSize = dbgInfo ? buffer.size() : 0;
 }
@@ -42,6 +42,18 @@ namespace IGC
         CShader* m_currShader = nullptr;
         IDebugEmitter* m_pDebugEmitter = nullptr;
 
+        // Debug information of a shader to be finalized by its emitter
+        struct DebugInfoUnit
+        {
+            CShader* Shader = nullptr;
+            IDebugEmitter* Emitter = nullptr;
+            std::unique_ptr<IGC::VISADebugInfo> VisaDbgInfo;
+            // VISA modules sorted by their placement in the binary
+            std::vector<IGC::VISAModule*> VISAModules;
+            // the emitter is finalized with the last VISA module
+            bool Finalize = false;
+        };
+
         virtual bool runOnModule(llvm::Module& M) override;
         virtual bool doInitialization(llvm::Module& M) override;
         virtual bool doFinalization(llvm::Module& M) override;
@@ -52,7 +64,8 @@ namespace IGC
             AU.setPreservesAll();
         }
 
-        void EmitDebugInfo(bool, const IGC::VISADebugInfo &VDI);
+        static void EmitDebugInfo(CShader* pShader, IDebugEmitter* pDebugEmitter,
+                                  bool finalize, const IGC::VISADebugInfo &VDI);
     };
 
     class CatchAllLineNumber : public llvm::FunctionPass
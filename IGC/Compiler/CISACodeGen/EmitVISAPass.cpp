@@ -488,6 +488,19 @@ bool EmitPass::isSymbolTableRequired(llvm::Function* F)
     return false;
 }
 
+// Reports where the private arrays of the entry function were placed.
+static void ReportPrivateArrayPlacement(CodeGenContext* ctx, CShaderProgram* pProgram, llvm::Function* pFunc)
+{
+    auto it = ctx->m_privateArrayPlacement.find(pFunc);
+    if (it == ctx->m_privateArrayPlacement.end())
+    {
+        return;
+    }
+    COMPILER_SHADER_STATS_SET(pProgram->m_shaderStats, STATS_PRIVATE_ARRAYS_IN_GRF, it->second.numInGRF);
+    COMPILER_SHADER_STATS_SET(pProgram->m_shaderStats, STATS_PRIVATE_ARRAYS_IN_SLM, it->second.numInSLM);
+    COMPILER_SHADER_STATS_SET(pProgram->m_shaderStats, STATS_PRIVATE_ARRAYS_IN_SCRATCH, it->second.numInScratch);
+}
+
 void EmitPass::CreateKernelShaderMap(CodeGenContext* ctx, MetaDataUtils* pMdUtils, llvm::Function& F)
 {
     /* Moving CShaderProgram instantiation to EmitPass from codegen*/
@@ -509,6 +522,7 @@ void EmitPass::CreateKernelShaderMap(CodeGenContext* ctx, MetaDataUtils* pMdUtil
                 {
                     m_shaders[pFunc] = new CShaderProgram(ctx, pFunc);
                     COMPILER_SHADER_STATS_INIT(m_shaders[pFunc]->m_shaderStats);
+                    ReportPrivateArrayPlacement(ctx, m_shaders[pFunc], pFunc);
                 }
             }
         }
@@ -525,6 +539,7 @@ void EmitPass::CreateKernelShaderMap(CodeGenContext* ctx, MetaDataUtils* pMdUtil
                 }
                 m_shaders[pFunc] = new CShaderProgram(ctx, pFunc);
                 COMPILER_SHADER_STATS_INIT(m_shaders[pFunc]->m_shaderStats);
+                ReportPrivateArrayPlacement(ctx, m_shaders[pFunc], pFunc);
             }
         }
     }
@@ -9830,7 +9845,7 @@ void EmitPass::emitStackCall(llvm::CallInst* inst)
     uint32_t offsetA = 0;  // visa argument offset
     uint32_t offsetS = 0;  // visa stack offset
     std::vector<CVariable*> argsOnStack;
-    SmallVector<std::tuple<CVariable*, Type*, uint32_t>, 8> argsOnRegister;
+    SmallVector<std::tuple<CVariable*, Type*, uint32_t, bool>, 8> argsOnRegister;
 
     for (uint32_t i = 0; i < IGCLLVM::getNumArgOperands(inst); i++)
     {
@@ -9838,12 +9853,18 @@ void EmitPass::emitStackCall(llvm::CallInst* inst)
         CVariable* Src = GetSymbol(operand);
         Type* argType = operand->getType();
 
+        // The callee reads an argument proven uniform over all its call sites
+        // from lane 0, which may be disabled here. Write it to all the lanes.
+        bool broadcast = false;
         if (!isInvokeSIMDTarget && !isIndirectFCall)
         {
             // Skip unused arguments if any for direct call
             auto argIter = F->arg_begin();
             std::advance(argIter, i);
             if (argIter->use_empty()) continue;
+
+            broadcast = WIAnalysis::isDepUniform(WIAnalysis::getArgDependency(&*argIter));
+            IGC_ASSERT_MESSAGE(!broadcast || Src->IsUniform(), "uniform callee argument passed a non-uniform value");
         }
 
         // adjust offset for alignment
@@ -9860,7 +9881,7 @@ void EmitPass::emitStackCall(llvm::CallInst* inst)
         bool overflow = ((offsetA + argSize) > ArgBlkVar->GetSize());
         if (!overflow)
         {
-            argsOnRegister.push_back(std::make_tuple(Src, argType, offsetA));
+            argsOnRegister.push_back(std::make_tuple(Src, argType, offsetA, broadcast));
             offsetA += argSize;
         }
         else
@@ -9870,6 +9891,10 @@ void EmitPass::emitStackCall(llvm::CallInst* inst)
             {
                 uint16_t nElts = (uint16_t)m_currShader->GetNumElts(argType, false);
                 CVariable* SrcVec = m_currShader->GetNewVariable(nElts, Src->GetType(), m_currShader->getGRFAlignment(), false, Src->getName());
+                if (broadcast)
+                {
+                    m_encoder->SetNoMask();
+                }
                 emitCopyAll(SrcVec, Src, argType);
                 Src = SrcVec;
             }
@@ -9917,9 +9942,15 @@ void EmitPass::emitStackCall(llvm::CallInst* inst)
             CVariable * Src = std::get<0>(I);
             Type* argType = std::get<1>(I);
             uint32_t offset = std::get<2>(I);
+            bool broadcast = std::get<3>(I);
 
             uint16_t nElts = (uint16_t)m_currShader->GetNumElts(argType, false);
             CVariable* Dst = m_currShader->GetNewAlias(ArgBlkVar, m_currShader->GetType(argType), offset, nElts, false);
+            if (broadcast)
+            {
+                // Only scalar arguments are marked uniform, so this is a single copy
+                m_encoder->SetNoMask();
+            }
             emitCopyAll(Dst, Src, argType);
         }
     };
@@ -10062,6 +10093,8 @@ void EmitPass::emitStackFuncEntry(Function* F)
     uint32_t offsetA = 0;  // visa argument offset
     uint32_t offsetS = 0;  // visa stack offset
     std::vector<CVariable*> argsOnStack;
+    // Uniform arguments read from stack, paired with their vectorized copies
+    std::vector<std::pair<CVariable*, CVariable*>> uniformArgsOnStack;
     for (auto& Arg : F->args())
     {
         if (!F->hasFnAttribute("referenced-indirectly"))
@@ -10075,6 +10108,12 @@ void EmitPass::emitStackFuncEntry(Function* F)
         uint align = getGRFSize();
         offsetA = int_cast<unsigned>(llvm::alignTo(offsetA, align));
         uint argSize = Dst->GetSize();
+        // Callers always pass a uniform argument vectorized and write it to all
+        // the lanes, see emitStackCall.
+        if (Dst->IsUniform())
+        {
+            argSize = Dst->GetSize() * numLanes(m_currShader->m_dispatchSize);
+        }
 
         // check if an argument can be written to ARGV based upon offset + arg-size
         bool overflow = ((offsetA + argSize) > ArgBlkVar->GetSize());
@@ -10111,6 +10150,14 @@ void EmitPass::emitStackFuncEntry(Function* F)
             }
             offsetA += argSize;
         }
+        else if (Dst->IsUniform())
+        {
+            // Read the vectorized argument, and take its first lane afterwards
+            uint16_t nElts = (uint16_t)m_currShader->GetNumElts(Arg.getType(), false);
+            CVariable* DstVec = m_currShader->GetNewVariable(nElts, Dst->GetType(), m_currShader->getGRFAlignment(), false, Dst->getName());
+            argsOnStack.push_back(DstVec);
+            uniformArgsOnStack.push_back(std::make_pair(Dst, DstVec));
+        }
         else
         {
             argsOnStack.push_back(Dst);
@@ -10136,6 +10183,13 @@ void EmitPass::emitStackFuncEntry(Function* F)
 
     // Read from caller stack back into registers
     ReadStackDataBlocks(argBlkData, offsetS);
+    for (auto& I : uniformArgsOnStack)
+    {
+        CVariable* Dst = I.first;
+        CVariable* Src = m_currShader->GetNewAlias(I.second, Dst->GetType(), 0, Dst->GetNumberElement(), true);
+        m_encoder->Copy(Dst, Src);
+        m_encoder->Push();
+    }
 
     unsigned totalAllocaSize = 0;
 
@@ -0,0 +1,367 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "Compiler/CISACodeGen/LSC2DBlockLoadSynthesis.h"
+#include "Compiler/CISACodeGen/WIAnalysis.hpp"
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/IGCPassSupport.h"
+#include "Compiler/MetaDataUtilsWrapper.h"
+#include "Compiler/MetaDataApi/IGCMetaDataHelper.h"
+#include "GenISAIntrinsics/GenIntrinsicInst.h"
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/Config/llvm-config.h"
+#include <llvm/Analysis/AliasAnalysis.h>
+#include <llvm/Analysis/ScalarEvolution.h>
+#if LLVM_VERSION_MAJOR < 11
+#include <llvm/Analysis/ScalarEvolutionExpander.h>
+#endif
+#include <llvm/Analysis/ScalarEvolutionExpressions.h>
+#if LLVM_VERSION_MAJOR >= 11
+#include <llvm/Transforms/Utils/ScalarEvolutionExpander.h>
+#endif
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvmWrapper/IR/DerivedTypes.h>
+#include <llvmWrapper/IR/IRBuilder.h>
+#include <llvmWrapper/Support/Alignment.h>
+#include "common/LLVMWarningsPop.hpp"
+#include "Probe/Assertion.h"
+
+using namespace llvm;
+using namespace IGC;
+using namespace IGC::IGCMD;
+
+namespace {
+// Turn per-lane loads reading a 2D tile across the subgroup into a single LSC
+// 2D block read. E.g. with a required subgroup size of 16,
+//
+//    %lane = call i16 @llvm.genx.GenISA.simdLaneId()
+//    %col  = zext i16 %lane to i64
+//    %p0   = gep float, float addrspace(1)* %a, i64 %col     ; row 0
+//    %v0   = load float, float addrspace(1)* %p0
+//    %p1   = gep float, float addrspace(1)* %p0, i64 %ld     ; row 1
+//    %v1   = load float, float addrspace(1)* %p1
+//    ...
+//
+// where the rows are a uniform pitch apart, becomes
+//
+//    %blk = call <H x i32> @llvm.genx.GenISA.LSC2DBlockRead(...)
+//    %e0  = extractelement <H x i32> %blk, i32 0
+//    %v0  = bitcast i32 %e0 to float
+//    ...
+//
+// A non-transposed block read with the tile width equal to the subgroup size
+// returns row r as the r-th SIMD-wide element of the result, so no shuffle is
+// needed.
+//
+// The surface is described such that the hardware restrictions hold
+// statically: the base is the row 0 address aligned down to 64 bytes with
+// the remainder as the X offset, and the pitch, which also serves as the
+// surface width, must be provably a multiple of 16 bytes and at least 128
+// bytes so the tile never crosses the surface width. As the block read
+// ignores the execution mask, it's only formed outside divergent control flow
+// in kernels whose work-group size is a multiple of the subgroup size.
+class LSC2DBlockLoadSynthesis : public FunctionPass
+{
+public:
+    static char ID;
+
+    LSC2DBlockLoadSynthesis();
+    bool runOnFunction(Function& F) override;
+
+    void getAnalysisUsage(AnalysisUsage& AU) const override {
+        AU.setPreservesCFG();
+        AU.addRequired<CodeGenContextWrapper>();
+        AU.addRequired<MetaDataUtilsWrapper>();
+        AU.addRequired<AAResultsWrapperPass>();
+        AU.addRequired<ScalarEvolutionWrapperPass>();
+        AU.addRequired<WIAnalysis>();
+    }
+
+    StringRef getPassName() const override {
+        return "LSC2DBlockLoadSynthesis";
+    }
+
+private:
+    struct RowLoad {
+        LoadInst* LD;
+        const SCEV* Row;    // Address of the lane 0 element.
+    };
+
+    bool processBlock(BasicBlock& BB, SmallVectorImpl<Instruction*>& ToErase);
+    const SCEV* getRowAddress(LoadInst* LD) const;
+    bool isValidPitch(const SCEV* P) const;
+    bool isSafeToReplace(ArrayRef<LoadInst*> Rows) const;
+    void emitBlockRead(ArrayRef<LoadInst*> Rows, const SCEV* Base,
+        const SCEV* Pitch, SmallVectorImpl<Instruction*>& ToErase);
+
+    const DataLayout* DL = nullptr;
+    AliasAnalysis* AA = nullptr;
+    ScalarEvolution* SE = nullptr;
+    WIAnalysis* WI = nullptr;
+    unsigned SimdSize = 0;
+    unsigned GRFSize = 0;
+
+    static const unsigned MaxBlockHeight = 32;
+    static const unsigned MaxBlockWidthInBytes = 64;
+};
+} // End anonymous namespace
+
+char LSC2DBlockLoadSynthesis::ID = 0;
+
+#define PASS_FLAG "igc-lsc-2d-block-load-synthesis"
+#define PASS_DESCRIPTION "IGC LSC 2D Block Load Synthesis"
+#define PASS_CFG_ONLY false
+#define PASS_ANALYSIS false
+
+namespace IGC {
+IGC_INITIALIZE_PASS_BEGIN(LSC2DBlockLoadSynthesis, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
+IGC_INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(WIAnalysis)
+IGC_INITIALIZE_PASS_END(LSC2DBlockLoadSynthesis, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+} // End IGC namespace
+
+FunctionPass* IGC::createLSC2DBlockLoadSynthesisPass() {
+    return new LSC2DBlockLoadSynthesis();
+}
+
+LSC2DBlockLoadSynthesis::LSC2DBlockLoadSynthesis() : FunctionPass(ID) {
+    initializeLSC2DBlockLoadSynthesisPass(*PassRegistry::getPassRegistry());
+}
+
+bool LSC2DBlockLoadSynthesis::runOnFunction(Function& F) {
+    CodeGenContext* Ctx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+    if (!Ctx->platform.isProductChildOf(IGFX_PVC))
+        return false;
+
+    MetaDataUtils* MDU = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
+    auto FII = MDU->findFunctionsInfoItem(&F);
+    if (FII == MDU->end_FunctionsInfo())
+        return false;
+
+    // The tile width is the subgroup size, so it has to be fixed, and all
+    // subgroups have to be full.
+    SimdSize = (unsigned)MDU->getFunctionsInfoItem(&F)->getSubGroupSize()->getSIMD_size();
+    uint32_t WGSize = IGCMetaDataHelper::getThreadGroupSize(*MDU, &F);
+    if (SimdSize == 0 || WGSize == 0 || WGSize % SimdSize != 0)
+        return false;
+
+    DL = &F.getParent()->getDataLayout();
+    AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
+    SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+    WI = &getAnalysis<WIAnalysis>();
+    GRFSize = Ctx->platform.getGRFSize();
+
+    bool Changed = false;
+    SmallVector<Instruction*, 32> ToErase;
+    for (auto& BB : F)
+        Changed |= processBlock(BB, ToErase);
+    for (auto* I : ToErase)
+        I->eraseFromParent();
+    return Changed;
+}
+
+static bool isSimdLaneId(const SCEV* S) {
+    if (auto Ext = dyn_cast<SCEVZeroExtendExpr>(S))
+        S = Ext->getOperand();
+    else if (auto Ext = dyn_cast<SCEVSignExtendExpr>(S))
+        S = Ext->getOperand();
+    auto U = dyn_cast<SCEVUnknown>(S);
+    if (!U)
+        return false;
+    auto GII = dyn_cast<GenIntrinsicInst>(U->getValue());
+    return GII && GII->isGenIntrinsic(GenISAIntrinsic::GenISA_simdLaneId);
+}
+
+/// getRowAddress() - returns the address accessed by lane 0 if LD reads
+/// consecutive elements across lanes from a uniform address, or null.
+const SCEV* LSC2DBlockLoadSynthesis::getRowAddress(LoadInst* LD) const {
+    if (!LD->isSimple() || LD->getPointerAddressSpace() != ADDRESS_SPACE_GLOBAL)
+        return nullptr;
+    Type* Ty = LD->getType();
+    if (!Ty->isIntegerTy() && !Ty->isFloatingPointTy())
+        return nullptr;
+    unsigned EltBytes = (unsigned)DL->getTypeStoreSize(Ty);
+    if ((EltBytes != 2 && EltBytes != 4) ||
+        DL->getTypeSizeInBits(Ty) != EltBytes * 8 ||
+        SimdSize * EltBytes > MaxBlockWidthInBytes ||
+        IGCLLVM::getAlignmentValue(LD) < EltBytes)
+        return nullptr;
+    if (WI->insideDivergentCF(LD))
+        return nullptr;
+
+    auto Add = dyn_cast<SCEVAddExpr>(SE->getSCEV(LD->getPointerOperand()));
+    if (!Add)
+        return nullptr;
+    const SCEV* LaneTerm = nullptr;
+    for (const SCEV* Op : Add->operands()) {
+        auto Mul = dyn_cast<SCEVMulExpr>(Op);
+        if (!Mul || Mul->getNumOperands() != 2 || !isSimdLaneId(Mul->getOperand(1)))
+            continue;
+        auto Scale = dyn_cast<SCEVConstant>(Mul->getOperand(0));
+        if (Scale && Scale->getValue()->equalsInt(EltBytes)) {
+            LaneTerm = Op;
+            break;
+        }
+    }
+    if (!LaneTerm)
+        return nullptr;
+
+    const SCEV* Row = SE->getMinusSCEV(Add, LaneTerm);
+    bool HasDivergentPart = SCEVExprContains(Row, [&](const SCEV* S) {
+        auto U = dyn_cast<SCEVUnknown>(S);
+        return U && !WI->isUniform(U->getValue());
+    });
+    return HasDivergentPart ? nullptr : Row;
+}
+
+bool LSC2DBlockLoadSynthesis::isValidPitch(const SCEV* P) const {
+    if (isa<SCEVCouldNotCompute>(P) || !P->getType()->isIntegerTy())
+        return false;
+    // Surface pitch: multiple of 16 bytes, below 2^24. At least 128 bytes so
+    // that using it as the surface width always covers X offset + tile width.
+    return SE->GetMinTrailingZeros(P) >= 4 &&
+        SE->getUnsignedRangeMin(P).uge(128) &&
+        SE->getUnsignedRangeMax(P).ult(1 << 24);
+}
+
+bool LSC2DBlockLoadSynthesis::isSafeToReplace(ArrayRef<LoadInst*> Rows) const {
+    // All rows are read at the position of row 0.
+    LoadInst* First = Rows.front();
+    SmallPtrSet<Instruction*, 32> Pending(Rows.begin() + 1, Rows.end());
+    for (auto I = std::next(First->getIterator()); !Pending.empty(); ++I) {
+        if (Pending.erase(&*I) || !I->mayWriteToMemory())
+            continue;
+        for (auto* LD : Rows) {
+            if (isModSet(AA->getModRefInfo(&*I, MemoryLocation::get(LD))))
+                return false;
+        }
+    }
+    return true;
+}
+
+void LSC2DBlockLoadSynthesis::emitBlockRead(ArrayRef<LoadInst*> Rows,
+    const SCEV* Base, const SCEV* Pitch, SmallVectorImpl<Instruction*>& ToErase) {
+    LoadInst* First = Rows.front();
+    Type* Ty = First->getType();
+    unsigned EltBits = (unsigned)DL->getTypeSizeInBits(Ty);
+    unsigned Height = Rows.size();
+
+    SCEVExpander Expander(*SE, *DL, "block2d");
+    Value* RowPtr = Expander.expandCodeFor(Base, Base->getType(), First);
+    Value* PitchV = Expander.expandCodeFor(Pitch, Pitch->getType(), First);
+
+    IGCLLVM::IRBuilder<> Builder(First);
+    Value* Addr = Builder.CreatePtrToInt(RowPtr, Builder.getInt64Ty());
+    Value* SurfBase = Builder.CreateAnd(Addr, Builder.getInt64(~63ULL));
+    Value* XOff = Builder.CreateLShr(Builder.CreateAnd(Addr, Builder.getInt64(63)),
+        Log2_32(EltBits / 8));
+    XOff = Builder.CreateTrunc(XOff, Builder.getInt32Ty());
+    Value* PitchM1 = Builder.CreateSub(
+        Builder.CreateZExtOrTrunc(PitchV, Builder.getInt32Ty()), Builder.getInt32(1));
+
+    Value* Args[] = {
+        SurfBase,
+        PitchM1,                            // surface width - 1
+        Builder.getInt32(Height - 1),       // surface height - 1
+        PitchM1,                            // surface pitch - 1
+        XOff,
+        Builder.getInt32(0),
+        Builder.getInt32(EltBits),
+        Builder.getInt32(SimdSize),
+        Builder.getInt32(Height),
+        Builder.getInt32(1),
+        Builder.getFalse(),
+        Builder.getFalse(),
+    };
+    Type* EltTy = Builder.getIntNTy(EltBits);
+    Type* VecTy = IGCLLVM::FixedVectorType::get(EltTy, Height);
+    Function* BlockReadFunc = GenISAIntrinsic::getDeclaration(
+        First->getModule(), GenISAIntrinsic::GenISA_LSC2DBlockRead, VecTy);
+    CallInst* BlockRead = Builder.CreateCall(BlockReadFunc, Args);
+    BlockRead->setDebugLoc(First->getDebugLoc());
+
+    for (unsigned i = 0; i != Height; ++i) {
+        LoadInst* LD = Rows[i];
+        Builder.SetInsertPoint(LD);
+        Value* V = Builder.CreateExtractElement(BlockRead, Builder.getInt32(i));
+        V = Builder.CreateBitCast(V, Ty);
+        if (auto I = dyn_cast<Instruction>(V))
+            I->setDebugLoc(LD->getDebugLoc());
+        V->takeName(LD);
+        LD->replaceAllUsesWith(V);
+        ToErase.push_back(LD);
+    }
+}
+
+bool LSC2DBlockLoadSynthesis::processBlock(BasicBlock& BB,
+    SmallVectorImpl<Instruction*>& ToErase) {
+    // Candidates in program order.
+    SmallVector<RowLoad, 16> Cands;
+    for (auto& I : BB) {
+        if (auto LD = dyn_cast<LoadInst>(&I)) {
+            if (const SCEV* Row = getRowAddress(LD))
+                Cands.push_back({ LD, Row });
+        }
+    }
+    if (Cands.size() < 2)
+        return false;
+
+    bool Changed = false;
+    SmallPtrSet<LoadInst*, 16> Used;
+    for (unsigned i = 0, e = Cands.size(); i != e; ++i) {
+        const RowLoad& Row0 = Cands[i];
+        if (Used.count(Row0.LD))
+            continue;
+        unsigned RowBytes = SimdSize * (unsigned)DL->getTypeStoreSize(Row0.LD->getType());
+
+        // Row 0 is the first load in program order, any later load may be
+        // row 1 and determine the pitch.
+        for (unsigned j = i + 1; j != e; ++j) {
+            const RowLoad& Row1 = Cands[j];
+            if (Used.count(Row1.LD) || Row1.LD->getType() != Row0.LD->getType())
+                continue;
+            const SCEV* Pitch = SE->getMinusSCEV(Row1.Row, Row0.Row);
+            if (!isValidPitch(Pitch))
+                continue;
+
+            SmallVector<LoadInst*, MaxBlockHeight> Rows{ Row0.LD, Row1.LD };
+            while (Rows.size() < MaxBlockHeight) {
+                const SCEV* Next = SE->getAddExpr(Row0.Row, SE->getMulExpr(
+                    SE->getConstant(Pitch->getType(), Rows.size()), Pitch));
+                auto It = std::find_if(Cands.begin() + i + 1, Cands.end(),
+                    [&](const RowLoad& C) {
+                        return C.Row == Next && C.LD->getType() == Row0.LD->getType() &&
+                            !Used.count(C.LD);
+                    });
+                if (It == Cands.end())
+                    break;
+                Rows.push_back(It->LD);
+            }
+
+            // The block is written in whole GRFs; don't let it overrun the
+            // result.
+            while (!Rows.empty() && (Rows.size() * RowBytes) % GRFSize != 0)
+                Rows.pop_back();
+            if (Rows.size() < 2 || !isSafeToReplace(Rows) ||
+                !isSafeToExpandAt(Row0.Row, Row0.LD, *SE) ||
+                !isSafeToExpandAt(Pitch, Row0.LD, *SE))
+                continue;
+
+            emitBlockRead(Rows, Row0.Row, Pitch, ToErase);
+            Used.insert(Rows.begin(), Rows.end());
+            Changed = true;
+            break;
+        }
+    }
+    return Changed;
+}
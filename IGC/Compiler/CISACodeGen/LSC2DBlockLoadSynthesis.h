@@ -0,0 +1,23 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#ifndef _CISA_LSC_2D_BLOCK_LOAD_SYNTHESIS_H_
+#define _CISA_LSC_2D_BLOCK_LOAD_SYNTHESIS_H_
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/Pass.h>
+#include "common/LLVMWarningsPop.hpp"
+
+namespace IGC {
+
+llvm::FunctionPass* createLSC2DBlockLoadSynthesisPass();
+void initializeLSC2DBlockLoadSynthesisPass(llvm::PassRegistry &);
+
+} // End namespace IGC
+
+#endif // _CISA_LSC_2D_BLOCK_LOAD_SYNTHESIS_H_
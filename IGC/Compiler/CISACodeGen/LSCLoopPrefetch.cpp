@@ -0,0 +1,216 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "Compiler/CISACodeGen/LSCLoopPrefetch.h"
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/IGCPassSupport.h"
+#include "GenISAIntrinsics/GenIntrinsics.h"
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/ScalarEvolution.h>
+#include <llvm/Analysis/ScalarEvolutionExpressions.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include <llvmWrapper/IR/IRBuilder.h>
+#include <llvmWrapper/Support/Alignment.h>
+#include <llvmWrapper/Transforms/Utils/LoopUtils.h>
+#include "common/LLVMWarningsPop.hpp"
+#include "visa_igc_common_header.h"
+#include "Probe/Assertion.h"
+
+using namespace llvm;
+using namespace IGC;
+
+namespace {
+// Insert LSC prefetches for loads in innermost loops whose address is an
+// affine function of the loop induction variable, e.g.
+//
+// loop:
+//    %i = phi [0, %entry], [%i.next, %loop]
+//    %p = gep float addrspace(1)* %src, %i
+//    %v = load float, float addrspace(1)* %p
+//
+// gets
+//
+//    %p8 = bitcast float addrspace(1)* %p to i8 addrspace(1)*
+//    %pf = gep i8, i8 addrspace(1)* %p8, D * 4
+//    call void @llvm.genx.GenISA.LSCPrefetch(%pf, 0, D32, V1, L1C_L3C)
+//    %v = load float, float addrspace(1)* %p
+//
+// The prefetch distance D (in iterations) is chosen so that D iterations of
+// the loop body roughly cover the memory latency, and is clamped by the
+// trip count when it's known. Only one prefetch is issued per cache line
+// touched by the loads of an iteration.
+//
+// Prefetches beyond the end of the buffer are dropped by the hardware, so no
+// bound check is needed.
+class LSCLoopPrefetch : public FunctionPass
+{
+public:
+    static char ID;
+
+    LSCLoopPrefetch();
+    bool runOnFunction(Function& F) override;
+
+    void getAnalysisUsage(AnalysisUsage& AU) const override {
+        AU.setPreservesCFG();
+        AU.addRequired<CodeGenContextWrapper>();
+        AU.addRequired<LoopInfoWrapperPass>();
+        AU.addRequired<ScalarEvolutionWrapperPass>();
+        AU.addPreserved<LoopInfoWrapperPass>();
+    }
+
+    StringRef getPassName() const override {
+        return "LSCLoopPrefetch";
+    }
+
+private:
+    bool processLoop(Loop* L);
+    unsigned getPrefetchDistance(Loop* L, unsigned NumInsts) const;
+    void insertPrefetch(LoadInst* LD, int64_t Offset);
+
+    const DataLayout* DL = nullptr;
+    LoopInfo* LI = nullptr;
+    ScalarEvolution* SE = nullptr;
+
+    // Assumed issue cost of an average instruction in cycles, used to turn
+    // the loop size into an iteration latency.
+    static const unsigned CyclesPerInst = 2;
+    static const int64_t CacheLineSize = 64;
+};
+} // End anonymous namespace
+
+char LSCLoopPrefetch::ID = 0;
+
+#define PASS_FLAG "igc-lsc-loop-prefetch"
+#define PASS_DESCRIPTION "IGC LSC Loop Prefetch"
+#define PASS_CFG_ONLY false
+#define PASS_ANALYSIS false
+
+namespace IGC {
+IGC_INITIALIZE_PASS_BEGIN(LSCLoopPrefetch, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+IGC_INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(ScalarEvolutionWrapperPass)
+IGC_INITIALIZE_PASS_END(LSCLoopPrefetch, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+} // End IGC namespace
+
+FunctionPass* IGC::createLSCLoopPrefetchPass() {
+    return new LSCLoopPrefetch();
+}
+
+LSCLoopPrefetch::LSCLoopPrefetch() : FunctionPass(ID) {
+    initializeLSCLoopPrefetchPass(*PassRegistry::getPassRegistry());
+}
+
+bool LSCLoopPrefetch::runOnFunction(Function& F) {
+    CodeGenContext* Ctx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+    if (!Ctx->platform.hasLSC())
+        return false;
+
+    DL = &F.getParent()->getDataLayout();
+    LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+    SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+
+    bool Changed = false;
+    for (auto& L : LI->getLoopsInPreorder()) {
+        if (IGCLLVM::isInnermost(L))
+            Changed |= processLoop(L);
+    }
+    return Changed;
+}
+
+unsigned LSCLoopPrefetch::getPrefetchDistance(Loop* L, unsigned NumInsts) const {
+    unsigned IterCycles = std::max(NumInsts * CyclesPerInst, 1U);
+    unsigned Latency = IGC_GET_FLAG_VALUE(LSCLoopPrefetchLatency);
+    unsigned Distance = (Latency + IterCycles - 1) / IterCycles;
+    Distance = std::min(Distance, (unsigned)IGC_GET_FLAG_VALUE(LSCLoopPrefetchMaxDistance));
+    return std::max(Distance, 1U);
+}
+
+bool LSCLoopPrefetch::processLoop(Loop* L) {
+    unsigned NumInsts = 0;
+    SmallVector<LoadInst*, 16> Loads;
+    for (auto* BB : L->blocks()) {
+        for (auto& I : *BB) {
+            if (isa<DbgInfoIntrinsic>(&I))
+                continue;
+            ++NumInsts;
+            auto LD = dyn_cast<LoadInst>(&I);
+            if (!LD || !LD->isSimple())
+                continue;
+            unsigned AS = LD->getPointerAddressSpace();
+            if (AS == ADDRESS_SPACE_GLOBAL || AS == ADDRESS_SPACE_CONSTANT)
+                Loads.push_back(LD);
+        }
+    }
+    if (Loads.empty())
+        return false;
+
+    unsigned Distance = getPrefetchDistance(L, NumInsts);
+    // Nothing to overlap if the loop is done before the first prefetch pays
+    // off.
+    unsigned TripCount = SE->getSmallConstantTripCount(L);
+    if (TripCount == 0)
+        TripCount = SE->getSmallConstantMaxTripCount(L);
+    if (TripCount != 0 && TripCount <= Distance)
+        return false;
+
+    bool Changed = false;
+    SmallVector<const SCEV*, 8> Prefetched;
+    for (auto* LD : Loads) {
+        const SCEV* Ptr = SE->getSCEV(LD->getPointerOperand());
+        auto AR = dyn_cast<SCEVAddRecExpr>(Ptr);
+        if (!AR || AR->getLoop() != L || !AR->isAffine())
+            continue;
+        auto Step = dyn_cast<SCEVConstant>(AR->getStepRecurrence(*SE));
+        if (!Step || Step->getValue()->isZero())
+            continue;
+
+        // Skip loads falling into a cache line already prefetched.
+        bool Covered = false;
+        for (auto* P : Prefetched) {
+            auto Diff = dyn_cast<SCEVConstant>(SE->getMinusSCEV(Ptr, P));
+            if (Diff && std::abs(Diff->getValue()->getSExtValue()) < CacheLineSize) {
+                Covered = true;
+                break;
+            }
+        }
+        if (Covered)
+            continue;
+
+        Prefetched.push_back(Ptr);
+        insertPrefetch(LD, Step->getValue()->getSExtValue() * Distance);
+        Changed = true;
+    }
+    return Changed;
+}
+
+void LSCLoopPrefetch::insertPrefetch(LoadInst* LD, int64_t Offset) {
+    IGCLLVM::IRBuilder<> Builder(LD);
+    Value* Ptr = LD->getPointerOperand();
+    unsigned AS = LD->getPointerAddressSpace();
+    Type* IdxTy = DL->getIndexType(Ptr->getType());
+    Value* BytePtr = Builder.CreateBitCast(Ptr, Builder.getInt8PtrTy(AS));
+    Value* PfPtr = Builder.CreateGEP(Builder.getInt8Ty(), BytePtr,
+        ConstantInt::get(IdxTy, Offset), "prefetch.addr");
+
+    // The prefetch address keeps the alignment of the load only when the
+    // offset does.
+    bool DwAligned = IGCLLVM::getAlignmentValue(LD) >= 4 && (Offset % 4) == 0;
+    Value* Args[] = {
+        PfPtr,
+        Builder.getInt32(0),
+        Builder.getInt32(DwAligned ? LSC_DATA_SIZE_32b : LSC_DATA_SIZE_8c32b),
+        Builder.getInt32(LSC_DATA_ELEMS_1),
+        Builder.getInt32(LSC_L1C_WT_L3C_WB),
+    };
+    Function* PfFunc = GenISAIntrinsic::getDeclaration(
+        LD->getModule(), GenISAIntrinsic::GenISA_LSCPrefetch, PfPtr->getType());
+    Builder.CreateCall(PfFunc, Args)->setDebugLoc(LD->getDebugLoc());
+}
@@ -0,0 +1,23 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#ifndef _CISA_LSC_LOOP_PREFETCH_H_
+#define _CISA_LSC_LOOP_PREFETCH_H_
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/Pass.h>
+#include "common/LLVMWarningsPop.hpp"
+
+namespace IGC {
+
+llvm::FunctionPass* createLSCLoopPrefetchPass();
+void initializeLSCLoopPrefetchPass(llvm::PassRegistry &);
+
+} // End namespace IGC
+
+#endif // _CISA_LSC_LOOP_PREFETCH_H_
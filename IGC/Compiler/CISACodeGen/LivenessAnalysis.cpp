@@ -170,6 +170,14 @@ bool LivenessAnalysis::isBefore(Instruction* A, Instruction* B)
     return nA < nB;
 }
 
+void LivenessAnalysis::recalculate(Function* F)
+{
+    clear();
+    m_F = F;
+    initValueIds();
+    calculate(F);
+}
+
 void LivenessAnalysis::calculate(Function* F)
 {
     // If m_LV is not nullptr, it means that the full liveness has been
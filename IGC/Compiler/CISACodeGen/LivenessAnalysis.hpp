@@ -68,6 +68,10 @@ namespace IGC
         // Entry to compute Liveness
         void calculate(llvm::Function* F);
 
+        // Recompute value ids and Liveness after the user of this analysis
+        // has moved or created instructions in F.
+        void recalculate(llvm::Function* F);
+
         llvm::StringRef getPassName() const override { return "LivenessAnalysis"; }
 
         void getAnalysisUsage(llvm::AnalysisUsage& AU) const override
@@ -14,13 +14,18 @@ SPDX-License-Identifier: MIT
 #include "Compiler/CodeGenPublic.h"
 #include "Compiler/IGCPassSupport.h"
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
+#include "Compiler/CISACodeGen/OpenCLKernelCodeGen.hpp"
+#include "Compiler/Optimizer/OpenCLPasses/PrivateMemory/PrivateMemoryToSLM.hpp"
+#include "AdaptorCommon/ImplicitArgs.hpp"
 #include "common/LLVMWarningsPush.hpp"
 #include "llvmWrapper/IR/DerivedTypes.h"
 #include "llvmWrapper/IR/IRBuilder.h"
+#include "llvmWrapper/Support/Alignment.h"
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Instructions.h>
 #include <llvm/ADT/SmallVector.h>
 #include <llvm/Transforms/Utils/Local.h>
+#include <llvm/Transforms/Utils/PromoteMemToReg.h>
 #include "common/LLVMWarningsPop.hpp"
 #include "Probe/Assertion.h"
 
@@ -73,6 +78,11 @@ namespace IGC {
         StatusPrivArr2Reg CheckIfAllocaPromotable(llvm::AllocaInst* pAlloca);
         bool IsNativeType(Type* type);
 
+        bool CollectSLMCandidate(llvm::AllocaInst* pAlloca, StatusPrivArr2Reg status);
+        bool IsSLMOccupancyAcceptable(unsigned int slmSize);
+        llvm::Value* GetLinearLocalId();
+        void MoveAllocasToSLM();
+
     public:
         static char ID;
 
@@ -97,6 +107,22 @@ namespace IGC {
         llvm::DenseMap<llvm::BasicBlock*, unsigned> m_pBBPressure;
 
         std::vector<PromotedLiverange> m_promotedLiveranges;
+
+        /// Arrays that do not fit in GRF and are moved to SLM instead of
+        /// scratch, with the weight of their accesses.
+        struct SLMCandidate
+        {
+            llvm::AllocaInst* pAlloca;
+            unsigned int accessWeight;
+            unsigned int size;
+        };
+        std::vector<SLMCandidate> m_allocasToSLM;
+
+        /// Work-group dimensions of the kernel, all zero when not known.
+        uint64_t m_wgDims[3] = {};
+        llvm::Value* m_linearLocalId = nullptr;
+
+        CodeGenContext::PrivateArrayPlacement m_placement;
     };
 
     FunctionPass* createPromotePrivateArrayToReg()
@@ -170,6 +196,32 @@ bool LowerGEPForPrivMem::runOnFunction(llvm::Function& F)
     m_pRegisterPressureEstimate->buildRPMapPerInstruction();
 
     m_allocasToPrivMem.clear();
+    m_allocasToSLM.clear();
+    m_linearLocalId = nullptr;
+    m_placement = CodeGenContext::PrivateArrayPlacement();
+
+    // Arrays that do not fit in GRF may be given a slice of SLM per work-item
+    // instead of going to scratch. This needs the work-group size and the
+    // local ids to be known in the kernel.
+    std::fill(std::begin(m_wgDims), std::end(m_wgDims), 0);
+    if (IGC_IS_FLAG_ENABLED(EnablePrivateMemoryToSLMFallback) &&
+        m_ctx->type == ShaderType::OPENCL_SHADER &&
+        isEntryFunc(pMdUtils, &F))
+    {
+        ImplicitArgs implicitArgs(F, pMdUtils);
+        ThreadGroupSizeMetaDataHandle threadGroupSize =
+            pMdUtils->getFunctionsInfoItem(&F)->getThreadGroupSize();
+        if (threadGroupSize->hasValue() &&
+            implicitArgs.isImplicitArgExist(ImplicitArg::LOCAL_ID_X) &&
+            implicitArgs.isImplicitArgExist(ImplicitArg::LOCAL_ID_Y) &&
+            implicitArgs.isImplicitArgExist(ImplicitArg::LOCAL_ID_Z))
+        {
+            m_wgDims[0] = threadGroupSize->getXDim();
+            m_wgDims[1] = threadGroupSize->getYDim();
+            m_wgDims[2] = threadGroupSize->getZDim();
+        }
+    }
+
     visit(F);
 
     std::vector<llvm::AllocaInst*>& allocaToHande = m_allocasToPrivMem;
@@ -186,11 +238,16 @@ bool LowerGEPForPrivMem::runOnFunction(llvm::Function& F)
             pInst->eraseFromParent();
         }
     }
+    m_placement.numInGRF = int_cast<unsigned int>(allocaToHande.size());
+
+    MoveAllocasToSLM();
+    m_ctx->m_privateArrayPlacement[&F] = m_placement;
 
-    if (!allocaToHande.empty())
+    bool changed = !allocaToHande.empty() || m_placement.numInSLM != 0;
+    if (changed)
         DumpLLVMIR(m_ctx, "AfterLowerGEP");
     // IR changed only if we had alloca instruction to optimize
-    return !allocaToHande.empty();
+    return changed;
 }
 
 void TransposeHelper::EraseDeadCode()
@@ -493,11 +550,259 @@ void LowerGEPForPrivMem::visitAllocaInst(AllocaInst& I)
     if (status != StatusPrivArr2Reg::OK)
     {
         // alloca size extends remain per-lane-reg space
+        if (!CollectSLMCandidate(&I, status) && !isAllocaPromotable(&I))
+        {
+            m_placement.numInScratch++;
+        }
         return;
     }
     m_allocasToPrivMem.push_back(&I);
 }
 
+// Checks that all the uses of a private pointer can be rewritten to access
+// SLM, and accumulates the weight of the memory accesses through it.
+static bool CheckUsesForSLM(Instruction* I, unsigned int& accessWeight)
+{
+    for (auto U : I->users())
+    {
+        if (GetElementPtrInst* pGEP = dyn_cast<GetElementPtrInst>(U))
+        {
+            unsigned int weight = 0;
+            if (!CheckUsesForSLM(pGEP, weight))
+                return false;
+            // Dynamically indexed accesses are the most expensive ones in
+            // scratch, as they are scattered across the per-lane slices.
+            accessWeight += pGEP->hasAllConstantIndices() ? weight : 2 * weight;
+        }
+        else if (BitCastInst* pBitCast = dyn_cast<BitCastInst>(U))
+        {
+            if (!CheckUsesForSLM(pBitCast, accessWeight))
+                return false;
+        }
+        else if (LoadInst* pLoad = dyn_cast<LoadInst>(U))
+        {
+            if (!pLoad->isSimple())
+                return false;
+            accessWeight++;
+        }
+        else if (StoreInst* pStore = dyn_cast<StoreInst>(U))
+        {
+            // The pointer itself escapes when it is the stored value.
+            if (!pStore->isSimple() || pStore->getValueOperand() == I)
+                return false;
+            accessWeight++;
+        }
+        else if (IntrinsicInst* pIntr = dyn_cast<IntrinsicInst>(U))
+        {
+            if (pIntr->getIntrinsicID() != Intrinsic::lifetime_start &&
+                pIntr->getIntrinsicID() != Intrinsic::lifetime_end)
+                return false;
+        }
+        else
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Rewrites the uses of a private pointer to go through the SLM pointer with
+// the same element type. The old instructions are appended to toBeRemoved
+// after their own users.
+static void RewriteUsesForSLM(Instruction* I, Value* pSLMPtr, std::vector<Instruction*>& toBeRemoved)
+{
+    SmallVector<User*, 8> users(I->users());
+    for (auto U : users)
+    {
+        Instruction* pInst = cast<Instruction>(U);
+        IGCLLVM::IRBuilder<> IRB(pInst);
+        if (GetElementPtrInst* pGEP = dyn_cast<GetElementPtrInst>(pInst))
+        {
+            SmallVector<Value*, 4> indices(pGEP->idx_begin(), pGEP->idx_end());
+            Value* pNewGEP = pGEP->isInBounds() ?
+                IRB.CreateInBoundsGEP(pGEP->getSourceElementType(), pSLMPtr, indices) :
+                IRB.CreateGEP(pGEP->getSourceElementType(), pSLMPtr, indices);
+            RewriteUsesForSLM(pGEP, pNewGEP, toBeRemoved);
+        }
+        else if (BitCastInst* pBitCast = dyn_cast<BitCastInst>(pInst))
+        {
+            Type* pNewType = PointerType::get(
+                IGCLLVM::getNonOpaquePtrEltTy(pBitCast->getType()), ADDRESS_SPACE_LOCAL);
+            RewriteUsesForSLM(pBitCast, IRB.CreateBitCast(pSLMPtr, pNewType), toBeRemoved);
+        }
+        else if (LoadInst* pLoad = dyn_cast<LoadInst>(pInst))
+        {
+            LoadInst* pNewLoad = IRB.CreateAlignedLoad(pSLMPtr, IGCLLVM::getAlign(*pLoad));
+            pNewLoad->takeName(pLoad);
+            pLoad->replaceAllUsesWith(pNewLoad);
+        }
+        else if (StoreInst* pStore = dyn_cast<StoreInst>(pInst))
+        {
+            IRB.CreateAlignedStore(pStore->getValueOperand(), pSLMPtr, IGCLLVM::getAlign(*pStore));
+        }
+        // Lifetime markers have no meaning for SLM and are dropped.
+        toBeRemoved.push_back(pInst);
+    }
+}
+
+bool LowerGEPForPrivMem::CollectSLMCandidate(AllocaInst* pAlloca, StatusPrivArr2Reg status)
+{
+    uint64_t threadsNum = m_wgDims[0] * m_wgDims[1] * m_wgDims[2];
+    if (threadsNum == 0)
+        return false;
+
+    if (status != StatusPrivArr2Reg::OutOfAllocSizeLimit &&
+        status != StatusPrivArr2Reg::OutOfMaxGRFPressure &&
+        status != StatusPrivArr2Reg::CannotUseSOALayout &&
+        status != StatusPrivArr2Reg::IsNotNativeType)
+        return false;
+
+    // Uniform arrays are shared by the lanes of a thread, a slice per
+    // work-item would waste the SLM. Scalars are left to mem2reg.
+    Type* pType = pAlloca->getAllocatedType();
+    if (pAlloca->getMetadata("uniform") != nullptr ||
+        pAlloca->isArrayAllocation() ||
+        !(pType->isArrayTy() || pType->isStructTy() || pType->isVectorTy()))
+        return false;
+
+    unsigned int accessWeight = 0;
+    if (!CheckUsesForSLM(pAlloca, accessWeight) || accessWeight == 0)
+        return false;
+
+    uint64_t size = m_pDL->getTypeAllocSize(pType) * threadsNum;
+    if (size == 0 || size > m_ctx->platform.getSlmSizePerSsOrDss())
+        return false;
+
+    m_allocasToSLM.push_back({ pAlloca, accessWeight, int_cast<unsigned int>(size) });
+    return true;
+}
+
+bool LowerGEPForPrivMem::IsSLMOccupancyAcceptable(unsigned int slmSize)
+{
+    OpenCLProgramContext* oclCtx = static_cast<OpenCLProgramContext*>(m_ctx);
+    unsigned int slmSizePerSubslice = oclCtx->GetSlmSizePerSubslice();
+    if (slmSize > slmSizePerSubslice)
+        return false;
+
+    unsigned int maxThreads = m_ctx->platform.getMaxNumberThreadPerSubslice();
+    if (maxThreads == 0)
+        return true;
+
+    // The dispatch SIMD size is not known yet, assume SIMD16 unless the
+    // kernel requires a sub-group size.
+    uint64_t simdSize = 16;
+    SubGroupSizeMetaDataHandle subGroupSize =
+        pMdUtils->getFunctionsInfoItem(m_pFunc)->getSubGroupSize();
+    if (subGroupSize->hasValue())
+        simdSize = (uint64_t)subGroupSize->getSIMD_size();
+
+    // Compare the number of work-groups resident on a subslice with the SLM
+    // usage against the one allowed by the hardware threads alone.
+    uint64_t threadsNum = m_wgDims[0] * m_wgDims[1] * m_wgDims[2];
+    uint64_t threadsPerWG = (threadsNum + simdSize - 1) / simdSize;
+    uint64_t wgByThreads = std::max<uint64_t>(1, maxThreads / threadsPerWG);
+    uint64_t wgBySLM = slmSize ? slmSizePerSubslice / slmSize : wgByThreads;
+    uint64_t residentWG = std::min(wgByThreads, wgBySLM);
+    return residentWG * 100 >= wgByThreads * IGC_GET_FLAG_VALUE(PrivateMemoryToSLMMinOccupancy);
+}
+
+Value* LowerGEPForPrivMem::GetLinearLocalId()
+{
+    if (m_linearLocalId)
+        return m_linearLocalId;
+
+    ImplicitArgs implicitArgs(*m_pFunc, pMdUtils);
+    IGCLLVM::IRBuilder<> IRB(&*m_pFunc->getEntryBlock().getFirstInsertionPt());
+    Type* pInt32Ty = IRB.getInt32Ty();
+
+    // linearLocalId = localIdX +
+    //                 localIdY * dimX +
+    //                 localIdZ * dimX * dimY
+    Value* localIdX = IRB.CreateZExt(
+        implicitArgs.getImplicitArgValue(*m_pFunc, ImplicitArg::LOCAL_ID_X, pMdUtils), pInt32Ty);
+    Value* localIdY = IRB.CreateZExt(
+        implicitArgs.getImplicitArgValue(*m_pFunc, ImplicitArg::LOCAL_ID_Y, pMdUtils), pInt32Ty);
+    Value* localIdZ = IRB.CreateZExt(
+        implicitArgs.getImplicitArgValue(*m_pFunc, ImplicitArg::LOCAL_ID_Z, pMdUtils), pInt32Ty);
+    Value* yOffset = IRB.CreateMul(localIdY, IRB.getInt32(int_cast<uint32_t>(m_wgDims[0])));
+    Value* zOffset = IRB.CreateMul(localIdZ, IRB.getInt32(int_cast<uint32_t>(m_wgDims[0] * m_wgDims[1])));
+    m_linearLocalId = IRB.CreateAdd(localIdX, IRB.CreateAdd(yOffset, zOffset), VALUE_NAME("linearLocalId"));
+    return m_linearLocalId;
+}
+
+void LowerGEPForPrivMem::MoveAllocasToSLM()
+{
+    if (m_allocasToSLM.empty())
+        return;
+
+    // The arrays with the densest accesses gain the most from leaving
+    // scratch, so they get the SLM first.
+    std::stable_sort(m_allocasToSLM.begin(), m_allocasToSLM.end(),
+        [](const SLMCandidate& a, const SLMCandidate& b)
+        {
+            return (uint64_t)a.accessWeight * b.size > (uint64_t)b.accessWeight * a.size;
+        });
+
+    Module* M = m_pFunc->getParent();
+    ModuleMetaData* modMD = getAnalysis<MetaDataUtilsWrapper>().getModuleMetaData();
+    FunctionMetaData& funcMD = modMD->FuncMD[m_pFunc];
+    uint64_t threadsNum = m_wgDims[0] * m_wgDims[1] * m_wgDims[2];
+
+    for (const SLMCandidate& candidate : m_allocasToSLM)
+    {
+        AllocaInst* pAlloca = candidate.pAlloca;
+        Type* pType = pAlloca->getAllocatedType();
+        unsigned int alignment = std::max<unsigned int>(
+            PrivateMemoryToSLM::SLM_LOCAL_VARIABLE_ALIGNMENT,
+            int_cast<unsigned int>(m_pDL->getPrefTypeAlignment(pType)));
+
+        unsigned int offset = iSTD::Align(funcMD.localSize, alignment);
+        unsigned int newSize = iSTD::Align(offset + candidate.size,
+            PrivateMemoryToSLM::SLM_LOCAL_SIZE_ALIGNMENT);
+        if (!IsSLMOccupancyAcceptable(newSize))
+        {
+            m_placement.numInScratch++;
+            continue;
+        }
+
+        Type* pNewType = ArrayType::get(pType, threadsNum);
+        auto pSLMVar = new GlobalVariable(
+            *M,
+            pNewType,
+            /* isConstant */ false,
+            GlobalValue::ExternalLinkage,
+            UndefValue::get(pNewType),
+            m_pFunc->getName() + "." + pAlloca->getName(),
+            /* InsertBefore */ nullptr,
+            GlobalVariable::ThreadLocalMode::NotThreadLocal,
+            ADDRESS_SPACE_LOCAL);
+        pSLMVar->setAlignment(IGCLLVM::getCorrectAlign(alignment));
+        pSLMVar->setDSOLocal(false);
+        pSLMVar->setSection("localSLM");
+
+        Value* linearLocalId = GetLinearLocalId();
+        IGCLLVM::IRBuilder<> IRB(pAlloca);
+        Value* pSlice = IRB.CreateInBoundsGEP(pNewType, pSLMVar,
+            { IRB.getInt32(0), linearLocalId }, VALUE_NAME(pAlloca->getName() + ".slm"));
+
+        std::vector<Instruction*> toBeRemoved;
+        RewriteUsesForSLM(pAlloca, pSlice, toBeRemoved);
+        for (auto pInst : toBeRemoved)
+        {
+            pInst->eraseFromParent();
+        }
+        pAlloca->eraseFromParent();
+
+        LocalOffsetMD localOffset;
+        localOffset.m_Var = pSLMVar;
+        localOffset.m_Offset = offset & 0xFFFF;
+        funcMD.localOffsets.push_back(localOffset);
+        funcMD.localSize = newSize;
+
+        m_placement.numInSLM++;
+    }
+}
+
 void TransposeHelper::HandleAllocaSources(Instruction* v, Value* idx)
 {
     SmallVector<Value*, 10> instructions;
@@ -13,10 +13,13 @@ SPDX-License-Identifier: MIT
 #include <llvmWrapper/Analysis/MemoryLocation.h>
 #include <llvmWrapper/Analysis/TargetLibraryInfo.h>
 #include <llvm/Analysis/AliasAnalysis.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/Analysis/PostDominators.h>
 #include <llvm/Analysis/ScalarEvolution.h>
 #include <llvm/Analysis/ScalarEvolutionExpressions.h>
 #include <llvm/Analysis/ValueTracking.h>
 #include <llvm/IR/DataLayout.h>
+#include <llvm/IR/Dominators.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/GetElementPtrTypeIterator.h>
 #include <llvm/IR/GlobalAlias.h>
@@ -68,6 +71,9 @@ namespace {
         AliasAnalysis* AA;
         ScalarEvolution* SE;
         WIAnalysis* WI;
+        DominatorTree* DT;
+        PostDominatorTree* PDT;
+        LoopInfo* LI;
 
         CodeGenContext* CGC;
         TargetLibraryInfo* TLI;
@@ -90,7 +96,7 @@ namespace {
 
         MemOpt(bool AllowNegativeSymPtrsForLoad = false, bool AllowVector8LoadStore = false) :
             FunctionPass(ID), DL(nullptr), AA(nullptr), SE(nullptr), WI(nullptr),
-            CGC(nullptr), AllowNegativeSymPtrsForLoad(AllowNegativeSymPtrsForLoad),
+            DT(nullptr), PDT(nullptr), LI(nullptr), CGC(nullptr), AllowNegativeSymPtrsForLoad(AllowNegativeSymPtrsForLoad),
             AllowVector8LoadStore(AllowVector8LoadStore)
         {
             initializeMemOptPass(*PassRegistry::getPassRegistry());
@@ -107,10 +113,31 @@ namespace {
             AU.addRequired<TargetLibraryInfoWrapperPass>();
             AU.addRequired<ScalarEvolutionWrapperPass>();
             AU.addRequired<WIAnalysis>();
+            // Only the cross-block mode needs control equivalence.
+            if (IGC_IS_FLAG_ENABLED(EnableMemOptCrossBlock)) {
+                AU.addRequired<DominatorTreeWrapperPass>();
+                AU.addRequired<PostDominatorTreeWrapperPass>();
+                AU.addRequired<LoopInfoWrapperPass>();
+            }
         }
 
         void buildProfitVectorLengths(Function& F);
 
+        /// Move loads/stores between control-equivalent blocks so that the
+        /// per-BB merging below sees them in the same window.
+        bool combineAcrossBlocks(Function& F);
+        bool hoistLoadsInto(BasicBlock* BB, BasicBlock* Succ,
+            const SmallVectorImpl<BasicBlock*>& Region);
+        bool sinkStoresInto(BasicBlock* BB, BasicBlock* Succ,
+            const SmallVectorImpl<BasicBlock*>& Region);
+        bool getControlEquivalentRegion(BasicBlock* BB, BasicBlock* Succ,
+            SmallVectorImpl<BasicBlock*>& Region, unsigned& NumInsts) const;
+        bool hasConstantDistance(Instruction* A, Instruction* B) const;
+        bool collectAddressToHoist(Value* V, Instruction* InsertPt,
+            SmallVectorImpl<Instruction*>& ToHoist, unsigned Depth) const;
+        bool isSafeToMove(const MemoryLocation& Loc, bool IsStore,
+            const SmallVectorImpl<Instruction*>& CheckList) const;
+
         bool mergeLoad(LoadInst* LeadingLoad, MemRefListTy::iterator MI,
             MemRefListTy& MemRefs, TrivialMemRefListTy& ToOpt);
         bool mergeStore(StoreInst* LeadingStore, MemRefListTy::iterator MI,
@@ -416,6 +443,9 @@ IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
 IGC_INITIALIZE_PASS_DEPENDENCY(AAResultsWrapperPass)
 IGC_INITIALIZE_PASS_DEPENDENCY(TargetLibraryInfoWrapperPass)
 IGC_INITIALIZE_PASS_DEPENDENCY(WIAnalysis)
+IGC_INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(PostDominatorTreeWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
 IGC_INITIALIZE_PASS_END(MemOpt, PASS_FLAG, PASS_DESC, PASS_CFG_ONLY, PASS_ANALYSIS)
 
 char MemOpt::ID = 0;
@@ -462,6 +492,9 @@ bool MemOpt::runOnFunction(Function& F) {
     AA = &getAnalysis<AAResultsWrapperPass>().getAAResults();
     SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
     WI = &getAnalysis<WIAnalysis>();
+    DT = nullptr;
+    PDT = nullptr;
+    LI = nullptr;
 
     CGC = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
     TLI = &getAnalysis<TargetLibraryInfoWrapperPass>().getTLI();
@@ -471,6 +504,13 @@ bool MemOpt::runOnFunction(Function& F) {
 
     bool Changed = false;
 
+    if (IGC_IS_FLAG_ENABLED(EnableMemOptCrossBlock)) {
+        DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+        PDT = &getAnalysis<PostDominatorTreeWrapperPass>().getPostDomTree();
+        LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+        Changed |= combineAcrossBlocks(F);
+    }
+
     IGC::IGCMD::FunctionInfoMetaDataHandle funcInfoMD = MDU->getFunctionsInfoItem(&F);
     unsigned SimdSize = funcInfoMD->getSubGroupSize()->getSIMD_size();
 
@@ -526,7 +566,218 @@ bool MemOpt::runOnFunction(Function& F) {
     DL = nullptr;
     AA = nullptr;
     SE = nullptr;
+    DT = nullptr;
+    PDT = nullptr;
+    LI = nullptr;
+
+    return Changed;
+}
+
+// Kernels frequently split a contiguous access into several blocks guarded
+// by the same condition, e.g. after unrolling
+//
+//   if (c) a0 = p[0];
+//   if (c) a1 = p[1];
+//
+// Each guarded block executes exactly when the others do, so the accesses
+// can be gathered into one block and merged as usual. For a block BB and each
+// block Succ up its post-dominator chain that BB dominates (i.e. BB and Succ
+// are control-equivalent), loads in Succ are hoisted to the end of BB and
+// stores in BB are sunk to the start of Succ when:
+// - there's an access with a constant distance on the other side to merge
+//   with,
+// - nothing in between may alias it, and
+// - the whole region is within MemOptWindowSize instructions.
+bool MemOpt::combineAcrossBlocks(Function& F) {
+    bool Changed = false;
+    for (auto& BB : F) {
+        DomTreeNode* Node = PDT->getNode(&BB);
+        if (!Node)
+            continue;
+        for (DomTreeNode* N = Node->getIDom(); N && N->getBlock(); N = N->getIDom()) {
+            BasicBlock* Succ = N->getBlock();
+            if (!DT->dominates(&BB, Succ) ||
+                LI->getLoopFor(&BB) != LI->getLoopFor(Succ))
+                break;
+
+            SmallVector<BasicBlock*, 8> Region;
+            unsigned NumInsts = 0;
+            if (!getControlEquivalentRegion(&BB, Succ, Region, NumInsts))
+                break;
+
+            Changed |= hoistLoadsInto(&BB, Succ, Region);
+            Changed |= sinkStoresInto(&BB, Succ, Region);
+        }
+    }
+    return Changed;
+}
+
+/// getControlEquivalentRegion() - collects blocks strictly between BB and
+/// Succ. Returns false if the region can't be handled or is too large.
+bool MemOpt::getControlEquivalentRegion(BasicBlock* BB, BasicBlock* Succ,
+    SmallVectorImpl<BasicBlock*>& Region, unsigned& NumInsts) const {
+    const unsigned Limit = IGC_GET_FLAG_VALUE(MemOptWindowSize);
+    SmallPtrSet<BasicBlock*, 8> Visited;
+    SmallVector<BasicBlock*, 8> Worklist(succ_begin(BB), succ_end(BB));
+    NumInsts = BB->size() + Succ->size();
+    while (!Worklist.empty()) {
+        BasicBlock* Cur = Worklist.pop_back_val();
+        if (Cur == Succ || !Visited.insert(Cur).second)
+            continue;
+        // Back to BB, or leaving the region BB dominates, through a path not
+        // passing Succ.
+        if (Cur == BB || !DT->dominates(BB, Cur))
+            return false;
+        NumInsts += Cur->size();
+        if (NumInsts > Limit)
+            return false;
+        Region.push_back(Cur);
+        Worklist.append(succ_begin(Cur), succ_end(Cur));
+    }
+    return NumInsts <= Limit;
+}
+
+/// hasConstantDistance() - checks whether two simple loads or stores access
+/// the same address space with same-sized elements at a constant distance.
+bool MemOpt::hasConstantDistance(Instruction* A, Instruction* B) const {
+    Value* PtrA = getLoadStorePointerOperand(A);
+    Value* PtrB = getLoadStorePointerOperand(B);
+    if (!PtrA || !PtrB)
+        return false;
+    if (PtrA->getType()->getPointerAddressSpace() !=
+        PtrB->getType()->getPointerAddressSpace())
+        return false;
+    auto getAccessType = [](Instruction* I) {
+        if (auto ST = dyn_cast<StoreInst>(I))
+            return ST->getValueOperand()->getType();
+        return I->getType();
+    };
+    Type* TyA = getAccessType(A)->getScalarType();
+    Type* TyB = getAccessType(B)->getScalarType();
+    if (!hasSameSize(TyA, TyB))
+        return false;
+    const SCEV* SA = SE->getSCEV(PtrA);
+    const SCEV* SB = SE->getSCEV(PtrB);
+    if (isa<SCEVCouldNotCompute>(SA) || isa<SCEVCouldNotCompute>(SB))
+        return false;
+    return isa<SCEVConstant>(SE->getMinusSCEV(SA, SB));
+}
+
+/// collectAddressToHoist() - collects the side-effect free instructions V
+/// depends on which don't dominate InsertPt, in def-before-use order.
+bool MemOpt::collectAddressToHoist(Value* V, Instruction* InsertPt,
+    SmallVectorImpl<Instruction*>& ToHoist, unsigned Depth) const {
+    Instruction* I = dyn_cast<Instruction>(V);
+    if (!I || DT->dominates(I, InsertPt) || is_contained(ToHoist, I))
+        return true;
+    if (Depth > SymbolicPointer::MaxLookupSearchDepth || isa<PHINode>(I) ||
+        I->mayReadOrWriteMemory() || !isSafeToSpeculativelyExecute(I))
+        return false;
+    for (Value* Op : I->operands())
+        if (!collectAddressToHoist(Op, InsertPt, ToHoist, Depth + 1))
+            return false;
+    ToHoist.push_back(I);
+    return true;
+}
+
+/// isSafeToMove() - checks whether the given location may be read (for
+/// stores) or written by any instruction in the check list.
+bool MemOpt::isSafeToMove(const MemoryLocation& Loc, bool IsStore,
+    const SmallVectorImpl<Instruction*>& CheckList) const {
+    for (auto* I : CheckList) {
+        if (IsStore ? !I->mayReadOrWriteMemory() : !I->mayWriteToMemory())
+            continue;
+        if (IsStore && I->getMetadata(LLVMContext::MD_invariant_load))
+            continue;
+
+        MemoryLocation B = getLocation(I);
+
+        if (!Loc.Ptr || !B.Ptr || AA->alias(Loc, B))
+            return false;
+    }
+    return true;
+}
+
+bool MemOpt::hoistLoadsInto(BasicBlock* BB, BasicBlock* Succ,
+    const SmallVectorImpl<BasicBlock*>& Region) {
+    SmallVector<Instruction*, 8> Anchors;
+    for (auto& I : *BB) {
+        auto LD = dyn_cast<LoadInst>(&I);
+        if (LD && LD->isSimple() && !shouldSkip(LD))
+            Anchors.push_back(LD);
+    }
+    if (Anchors.empty())
+        return false;
+
+    SmallVector<Instruction*, 32> CheckList;
+    for (auto* R : Region)
+        for (auto& I : *R)
+            CheckList.push_back(&I);
+
+    bool Changed = false;
+    Instruction* InsertPt = BB->getTerminator();
+    for (auto BI = Succ->begin(), BE = Succ->end(); BI != BE;) {
+        Instruction* I = &*BI++;
+        auto LD = dyn_cast<LoadInst>(I);
+        if (!LD || !LD->isSimple() || shouldSkip(LD) ||
+            none_of(Anchors, [&](Instruction* A) { return hasConstantDistance(A, LD); })) {
+            CheckList.push_back(I);
+            continue;
+        }
+
+        SmallVector<Instruction*, 4> ToHoist;
+        if (!collectAddressToHoist(LD->getPointerOperand(), InsertPt, ToHoist, 0) ||
+            !isSafeToMove(MemoryLocation::get(LD), false, CheckList)) {
+            CheckList.push_back(I);
+            continue;
+        }
+
+        for (auto* H : ToHoist)
+            H->moveBefore(InsertPt);
+        LD->moveBefore(InsertPt);
+        Anchors.push_back(LD);
+        Changed = true;
+    }
+    return Changed;
+}
 
+bool MemOpt::sinkStoresInto(BasicBlock* BB, BasicBlock* Succ,
+    const SmallVectorImpl<BasicBlock*>& Region) {
+    SmallVector<Instruction*, 8> Anchors;
+    for (auto& I : *Succ) {
+        auto ST = dyn_cast<StoreInst>(&I);
+        if (ST && ST->isSimple() && !shouldSkip(ST))
+            Anchors.push_back(ST);
+    }
+    if (Anchors.empty())
+        return false;
+
+    SmallVector<Instruction*, 32> Middle;
+    for (auto* R : Region)
+        for (auto& I : *R)
+            Middle.push_back(&I);
+
+    // Sunk stores are inserted in their original order before the first
+    // non-PHI instruction of Succ.
+    bool Changed = false;
+    Instruction* InsertPt = &*Succ->getFirstInsertionPt();
+    SmallVector<StoreInst*, 8> Candidates;
+    for (auto& I : *BB) {
+        auto ST = dyn_cast<StoreInst>(&I);
+        if (ST && ST->isSimple() && !shouldSkip(ST) &&
+            any_of(Anchors, [&](Instruction* A) { return hasConstantDistance(A, ST); }))
+            Candidates.push_back(ST);
+    }
+    for (auto* ST : Candidates) {
+        SmallVector<Instruction*, 32> CheckList;
+        for (auto I = std::next(ST->getIterator()), E = BB->end(); I != E; ++I)
+            CheckList.push_back(&*I);
+        CheckList.append(Middle.begin(), Middle.end());
+        if (!isSafeToMove(MemoryLocation::get(ST), true, CheckList))
+            continue;
+        ST->moveBefore(InsertPt);
+        Changed = true;
+    }
     return Changed;
 }
 
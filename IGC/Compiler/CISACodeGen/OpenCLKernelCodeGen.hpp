@@ -246,6 +246,10 @@ namespace IGC
         std::vector<const char*> m_VISAAsmToLink;
         // Functions that are forced to be direct calls.
         std::unordered_set<std::string> m_DirectCallFunctions;
+        // Kernel specialized on the values of some of its scalar arguments,
+        // see SpecializeKernelArgs.
+        std::string m_SpecializedKernelName;
+        std::map<uint32_t, uint64_t> m_SpecializedKernelArgs;
 
         OpenCLProgramContext(
             const COCLBTILayout& btiLayout,
@@ -272,6 +276,14 @@ namespace IGC
                 m_DirectCallFunctions.insert(pInputArgs->pDirectCallFunctions[i]);
               }
             }
+            if (pInputArgs && pInputArgs->pSpecializedKernelName &&
+                pInputArgs->pSpecializedArgIndices && pInputArgs->pSpecializedArgValues) {
+                m_SpecializedKernelName = pInputArgs->pSpecializedKernelName;
+                for (uint32_t i = 0; i < pInputArgs->NumSpecializedArgs; ++i) {
+                    m_SpecializedKernelArgs[pInputArgs->pSpecializedArgIndices[i]] =
+                        pInputArgs->pSpecializedArgValues[i];
+                }
+            }
 
 
             // Handle forcing ZEBin
@@ -17,6 +17,7 @@ SPDX-License-Identifier: MIT
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/Instruction.h>
 #include <llvm/IR/PatternMatch.h>
+#include <llvm/Support/CommandLine.h>
 #include <llvmWrapper/IR/Instructions.h>
 #include <llvm/IR/IntrinsicInst.h>
 #include "common/LLVMWarningsPop.hpp"
@@ -30,6 +31,10 @@ using namespace llvm;
 using namespace IGC;
 using namespace IGC::IGCMD;
 
+static cl::opt<bool> PrintPatternMatch(
+    "print-pattern-match", cl::init(false), cl::Hidden,
+    cl::desc("Print the instructions emitted after pattern matching"));
+
 char CodeGenPatternMatch::ID = 0;
 #define PASS_FLAG "CodeGenPatternMatch"
 #define PASS_DESCRIPTION "Does pattern matching"
@@ -121,9 +126,29 @@ namespace IGC
         m_LivenessInfo = &getAnalysis<LiveVarsAnalysis>().getLiveVars();
         CreateBasicBlocks(&F);
         CodeGenNode(DT->getRootNode());
+        if (PrintPatternMatch)
+        {
+            print(llvm::errs());
+        }
         return false;
     }
 
+    void CodeGenPatternMatch::print(llvm::raw_ostream& OS, const llvm::Module*) const
+    {
+        // Patterns are matched bottom up, print the roots in program order.
+        for (uint i = 0; i < m_numBlocks; i++)
+        {
+            const SBasicBlock& block = m_blocks[i];
+            OS << "PatternMatch: ";
+            block.bb->printAsOperand(OS, false);
+            OS << "\n";
+            for (auto I = block.m_dags.rbegin(), E = block.m_dags.rend(); I != E; ++I)
+            {
+                OS << "  root:" << *I->m_root << "\n";
+            }
+        }
+    }
+
     inline bool HasSideEffect(llvm::Instruction& inst)
     {
         if (inst.mayWriteToMemory() || inst.isTerminator())
@@ -376,6 +401,11 @@ namespace IGC
         Constant* C = dyn_cast_or_null<Constant>(Val);
         if (!C)
             return;
+        if (m_speculating)
+        {
+            m_speculativeConstants.push_back(std::make_pair(UseBlock, Val));
+            return;
+        }
 
         BasicBlock* LCA = UseBlock;
         // Determine where we put the constant initialization.
@@ -1098,6 +1128,11 @@ namespace IGC
 
     void CodeGenPatternMatch::visitBinaryOperator(llvm::BinaryOperator& I)
     {
+        if (IGC_IS_FLAG_ENABLED(EnableCostDrivenPatternMatch) &&
+            MatchArithmeticByCost(I))
+        {
+            return;
+        }
 
         bool match = false;
         switch (I.getOpcode())
@@ -1181,6 +1216,199 @@ namespace IGC
         IGC_ASSERT(match == true);
     }
 
+    // Weight of an emitted instruction relative to a unit of latency or of
+    // register pressure.
+    static const unsigned PatternInstCost = 4;
+
+    // Arithmetic roots have several overlapping patterns (mad, add3, lrp,
+    // source modifiers...) and the first one matching is not always the best:
+    // fusing an operand that has to be emitted anyway for another user saves
+    // nothing and extends the live ranges of its sources. Probe all the
+    // patterns in the greedy order, score them and only commit the cheapest
+    // one. Ties keep the greedy choice.
+    bool CodeGenPatternMatch::MatchArithmeticByCost(llvm::BinaryOperator& I)
+    {
+        using AP = ArithmeticPattern;
+        // Rough estimates of { instructions, latency } for each pattern.
+        switch (I.getOpcode())
+        {
+        case Instruction::FSub:
+        {
+            PatternCandidate candidates[] = {
+                { AP::Floor, 1, 1 },
+                { AP::Frc, 1, 1 },
+                { AP::Lrp, 1, 2 },
+                { AP::PredAdd, 2, 2 },
+                { AP::Mad, 1, 1 },
+                { AP::AbsNeg, 1, 1 },
+                { AP::Modifier, 1, 1 },
+            };
+            return MatchByCost(I, candidates);
+        }
+        case Instruction::FAdd:
+        {
+            PatternCandidate candidates[] = {
+                { AP::Lrp, 1, 2 },
+                { AP::PredAdd, 2, 2 },
+                { AP::Mad, 1, 1 },
+                { AP::SimpleAdd, 1, 1 },
+                { AP::Modifier, 1, 1 },
+            };
+            return MatchByCost(I, candidates);
+        }
+        case Instruction::Sub:
+        {
+            PatternCandidate candidates[] = {
+                { AP::Mad, 1, 1 },
+                { AP::Add3, 1, 1 },
+                { AP::AbsNeg, 1, 1 },
+                { AP::MulAdd16, 1, 1 },
+                { AP::Modifier, 1, 1 },
+            };
+            return MatchByCost(I, candidates);
+        }
+        case Instruction::Add:
+        {
+            PatternCandidate candidates[] = {
+                { AP::Mad, 1, 1 },
+                { AP::Add3, 1, 1 },
+                { AP::MulAdd16, 1, 1 },
+                { AP::Modifier, 1, 1 },
+            };
+            return MatchByCost(I, candidates);
+        }
+        default:
+            break;
+        }
+        return false;
+    }
+
+    bool CodeGenPatternMatch::MatchArithmeticPattern(llvm::BinaryOperator& I, ArithmeticPattern pattern)
+    {
+        switch (pattern)
+        {
+        case ArithmeticPattern::Floor:     return MatchFloor(I);
+        case ArithmeticPattern::Frc:       return MatchFrc(I);
+        case ArithmeticPattern::Lrp:       return MatchLrp(I);
+        case ArithmeticPattern::PredAdd:   return MatchPredAdd(I);
+        case ArithmeticPattern::Mad:       return MatchMad(I);
+        case ArithmeticPattern::SimpleAdd: return MatchSimpleAdd(I);
+        case ArithmeticPattern::AbsNeg:    return MatchAbsNeg(I);
+        case ArithmeticPattern::Add3:      return MatchAdd3(I);
+        case ArithmeticPattern::MulAdd16:  return MatchMulAdd16(I);
+        case ArithmeticPattern::Modifier:  return MatchModifier(I);
+        }
+        IGC_ASSERT_MESSAGE(0, "unknown arithmetic pattern");
+        return false;
+    }
+
+    // Each candidate is matched once while speculating. The pattern built by
+    // the cheapest one is kept, and only its sources and constants are
+    // committed afterwards.
+    bool CodeGenPatternMatch::MatchByCost(llvm::BinaryOperator& I, llvm::ArrayRef<PatternCandidate> candidates)
+    {
+        Pattern* bestPattern = nullptr;
+        unsigned bestCost = UINT_MAX;
+        SmallVector<Value*, 8> bestSources;
+        SmallVector<std::pair<BasicBlock*, Value*>, 4> bestConstants;
+        SmallPtrSet<Value*, 8> seen;
+        m_speculating = true;
+        for (const PatternCandidate& candidate : candidates)
+        {
+            m_speculativeSources.clear();
+            m_speculativeConstants.clear();
+            m_currentPattern = nullptr;
+            if (!MatchArithmeticPattern(I, candidate.pattern))
+            {
+                continue;
+            }
+
+            unsigned cost = candidate.numInsts * PatternInstCost + candidate.latency;
+            seen.clear();
+            for (Value* V : m_speculativeSources)
+            {
+                cost += GetSourceCost(V, seen);
+            }
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestPattern = m_currentPattern;
+                bestSources.swap(m_speculativeSources);
+                bestConstants.swap(m_speculativeConstants);
+            }
+        }
+        m_speculating = false;
+        m_speculativeSources.clear();
+        m_speculativeConstants.clear();
+        m_currentPattern = bestPattern;
+        if (!bestPattern)
+        {
+            return false;
+        }
+        for (Value* V : bestSources)
+        {
+            MarkAsSource(V);
+        }
+        for (auto& C : bestConstants)
+        {
+            AddToConstantPool(C.first, C.second);
+        }
+        return true;
+    }
+
+    // Number of live value units added by making v live up to the current root.
+    unsigned CodeGenPatternMatch::GetLiveRangeCost(llvm::Value* v, llvm::SmallPtrSetImpl<llvm::Value*>& seen)
+    {
+        Instruction* I = dyn_cast<Instruction>(v);
+        if (!I || IsConstOrSimdConstExpr(v) || NeedInstruction(*I) || !seen.insert(v).second)
+        {
+            // Constants and arguments are always available, and values already
+            // used by a later pattern are live here anyway.
+            return 0;
+        }
+        if (isUniform(v))
+        {
+            return 1;
+        }
+        return std::max(1U, (unsigned)(m_DL->getTypeSizeInBits(v->getType()) / 32));
+    }
+
+    // Whether a user of I other than the current root is emitted, in which
+    // case I is very likely emitted as its source as well.
+    bool CodeGenPatternMatch::HasEmittedUser(llvm::Instruction& I)
+    {
+        for (User* U : I.users())
+        {
+            Instruction* userInst = dyn_cast<Instruction>(U);
+            if (userInst && userInst != m_root && NeedInstruction(*userInst))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Cost of using v as a source of the current root.
+    unsigned CodeGenPatternMatch::GetSourceCost(llvm::Value* v, llvm::SmallPtrSetImpl<llvm::Value*>& seen)
+    {
+        Instruction* I = dyn_cast<Instruction>(v);
+        bool needsOwnPattern = I && !IsConstOrSimdConstExpr(v) && !NeedInstruction(*I) &&
+            !HasEmittedUser(*I);
+        unsigned cost = GetLiveRangeCost(v, seen);
+        if (needsOwnPattern)
+        {
+            // A source that is not folded into the pattern, at any depth, and
+            // that nothing else emits will need its own instruction, which
+            // keeps its own operands alive.
+            cost += PatternInstCost;
+            for (Value* op : I->operands())
+            {
+                cost += GetLiveRangeCost(op, seen);
+            }
+        }
+        return cost;
+    }
+
     void CodeGenPatternMatch::visitCmpInst(llvm::CmpInst& I)
     {
         bool match =
@@ -1957,6 +2185,11 @@ namespace IGC
 
     void CodeGenPatternMatch::MarkAsSource(llvm::Value* v)
     {
+        if (m_speculating)
+        {
+            m_speculativeSources.push_back(v);
+            return;
+        }
         // update liveness of the sources
         if (IsConstOrSimdConstExpr(v))
         {
@@ -16,6 +16,7 @@ SPDX-License-Identifier: MIT
 
 #include "common/LLVMWarningsPush.hpp"
 #include <llvm/IR/InstVisitor.h>
+#include <llvm/ADT/ArrayRef.h>
 #include <llvm/ADT/DenseSet.h>
 #include <llvm/ADT/MapVector.h>
 #include <llvm/Analysis/LoopInfo.h>
@@ -76,6 +77,31 @@ namespace IGC
         virtual bool supportsSaturate() { return true; }
     };
 
+    // Patterns competing for an arithmetic root in cost driven selection.
+    enum class ArithmeticPattern
+    {
+        Floor,
+        Frc,
+        Lrp,
+        PredAdd,
+        Mad,
+        SimpleAdd,
+        AbsNeg,
+        Add3,
+        MulAdd16,
+        Modifier,
+    };
+
+    // One way of covering a root instruction, used by cost driven pattern
+    // selection. numInsts and latency give a rough estimate of the code the
+    // pattern emits.
+    struct PatternCandidate
+    {
+        ArithmeticPattern pattern;
+        unsigned numInsts;
+        unsigned latency;
+    };
+
     struct SDAG
     {
         SDAG(Pattern* pattern, llvm::Instruction* root) : m_pattern(pattern), m_root(root)
@@ -147,6 +173,8 @@ namespace IGC
             return "CodeGenPatternMatchPass";
         }
 
+        void print(llvm::raw_ostream& OS, const llvm::Module* = nullptr) const override;
+
         void visitCastInst(llvm::CastInst& I);
         void visitBinaryOperator(llvm::BinaryOperator& I);
         void visitCmpInst(llvm::CmpInst& I);
@@ -249,6 +277,14 @@ namespace IGC
         bool MatchInsertToStruct(llvm::InsertValueInst*);
         bool MatchExtractFromStruct(llvm::ExtractValueInst*);
 
+        // Cost driven selection among alternative patterns.
+        bool MatchArithmeticByCost(llvm::BinaryOperator& I);
+        bool MatchByCost(llvm::BinaryOperator& I, llvm::ArrayRef<PatternCandidate> candidates);
+        bool MatchArithmeticPattern(llvm::BinaryOperator& I, ArithmeticPattern pattern);
+        bool HasEmittedUser(llvm::Instruction& I);
+        unsigned GetSourceCost(llvm::Value* v, llvm::SmallPtrSetImpl<llvm::Value*>& seen);
+        unsigned GetLiveRangeCost(llvm::Value* v, llvm::SmallPtrSetImpl<llvm::Value*>& seen);
+
         void AddPattern(Pattern* P)
         {
             m_currentPattern = P;
@@ -306,6 +342,13 @@ namespace IGC
         llvm::Instruction* m_root;
         Pattern* m_currentPattern;
 
+        // While set, Match* functions are only probed: sources and constants
+        // are recorded in m_speculativeSources and m_speculativeConstants
+        // instead of being marked as used.
+        bool m_speculating = false;
+        llvm::SmallVector<llvm::Value*, 8> m_speculativeSources;
+        llvm::SmallVector<std::pair<llvm::BasicBlock*, llvm::Value*>, 4> m_speculativeConstants;
+
         CPlatform             m_Platform;
         bool                  m_AllowContractions;
         bool                  m_NeedVMask;
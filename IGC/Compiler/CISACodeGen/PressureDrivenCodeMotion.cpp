@@ -0,0 +1,505 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "Compiler/CISACodeGen/PressureDrivenCodeMotion.h"
+#include "Compiler/CISACodeGen/RegisterEstimator.hpp"
+#include "Compiler/CISACodeGen/WIAnalysis.hpp"
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/IGCPassSupport.h"
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/Analysis/CFG.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Instructions.h>
+#include "common/LLVMWarningsPop.hpp"
+#include "Probe/Assertion.h"
+#include <algorithm>
+
+using namespace llvm;
+using namespace IGC;
+using namespace IGC::IGCMD;
+
+namespace {
+// Move cheap ALU instructions to lower the peak of the register pressure
+// estimated by RegisterEstimator, so that the function fits the GRF budget
+// of the SIMD size it is meant to be compiled in.
+//
+// For each peak, i.e. the instruction with the highest pressure of a block
+// over the budget, the values live across it are looked at:
+//
+//  - sink:  a value whose uses all come after the peak is moved down to
+//           the latest point dominating them;
+//  - remat: a value also used after the peak is recomputed there, when
+//           its operands are live across the peak anyway;
+//  - hoist: an instruction after the peak in the same block, killing
+//           operands larger than its result, is moved above the peak.
+//
+// The motions with the best gain are applied until the estimate at the peak
+// fits. Code is never moved between loops, so the latency it adds is
+// bounded by the few rematerialized copies. Liveness is recomputed between
+// rounds, and rounds are repeated until no peak exceeds the budget.
+class PressureDrivenCodeMotion : public FunctionPass
+{
+public:
+    static char ID;
+
+    PressureDrivenCodeMotion();
+    bool runOnFunction(Function& F) override;
+
+    void getAnalysisUsage(AnalysisUsage& AU) const override {
+        AU.setPreservesCFG();
+        AU.addRequired<CodeGenContextWrapper>();
+        AU.addRequired<MetaDataUtilsWrapper>();
+        AU.addRequired<WIAnalysis>();
+        AU.addRequired<RegisterEstimator>();
+        AU.addRequired<DominatorTreeWrapperPass>();
+        AU.addRequired<LoopInfoWrapperPass>();
+        AU.addPreserved<DominatorTreeWrapperPass>();
+        AU.addPreserved<LoopInfoWrapperPass>();
+    }
+
+    StringRef getPassName() const override {
+        return "PressureDrivenCodeMotion";
+    }
+
+private:
+    enum MotionKind { MK_Sink, MK_Remat, MK_Hoist };
+
+    struct Motion {
+        MotionKind Kind;
+        Instruction* I;
+        // Instruction to move I before, for sinking and hoisting.
+        Instruction* InsertPt;
+        // Bytes no longer live across the peak.
+        int Gain;
+    };
+
+    typedef SmallDenseMap<BasicBlock*, Instruction*, 4> RematPointMap;
+
+    uint16_t getTargetSimdSize(Function& F);
+    void findPeaks(Function& F, SmallVectorImpl<Instruction*>& Peaks);
+    void computeLiveAt(Instruction* P, SBitVector& Live);
+    bool relievePeak(Instruction* P);
+
+    void addSink(Instruction* I, Instruction* P, const SBitVector& Live, SmallVectorImpl<Motion>& Motions);
+    void addRemat(Instruction* I, Instruction* P, const SBitVector& Live, SmallVectorImpl<Motion>& Motions);
+    void addHoist(Instruction* I, Instruction* P, const SBitVector& Live, SmallVectorImpl<Motion>& Motions);
+    bool getRematPoints(Instruction* I, Instruction* P, RematPointMap& Points,
+        SmallVectorImpl<Use*>& LaterUses);
+    void apply(const Motion& M, Instruction* P);
+
+    bool isMovable(const Instruction* I) const;
+    bool isTouched(const Instruction* I) const;
+    void touch(Instruction* I);
+    bool isLive(Value* V, const SBitVector& Live) const;
+    int getRegBytes(Value* V) const;
+    Instruction* getUseInsertPt(const Use& U) const;
+
+    CodeGenContext* Ctx = nullptr;
+    WIAnalysis* WI = nullptr;
+    RegisterEstimator* RPE = nullptr;
+    LivenessAnalysis* LVA = nullptr;
+    DominatorTree* DT = nullptr;
+    LoopInfo* LI = nullptr;
+
+    uint16_t SimdSize = 16;
+    // GRF budget, in the 32-byte registers RegisterEstimator counts.
+    uint32_t Budget = 0;
+
+    // Values whose live ranges changed in the current round. The liveness
+    // of the round no longer describes them.
+    SmallPtrSet<Value*, 32> Touched;
+    SmallVector<Instruction*, 8> DeadInsts;
+
+    // Registers left for what RegisterEstimator doesn't see: payload,
+    // temporaries of emitted sequences, address registers spilled to GRF...
+    static const unsigned ReservedGRFPercent = 15;
+    static const unsigned MaxPeaksPerRound = 16;
+    static const unsigned MaxRematCopies = 2;
+};
+} // End anonymous namespace
+
+char PressureDrivenCodeMotion::ID = 0;
+
+#define PASS_FLAG "igc-pressure-code-motion"
+#define PASS_DESCRIPTION "Register pressure driven global code motion"
+#define PASS_CFG_ONLY false
+#define PASS_ANALYSIS false
+
+namespace IGC {
+IGC_INITIALIZE_PASS_BEGIN(PressureDrivenCodeMotion, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+IGC_INITIALIZE_PASS_DEPENDENCY(MetaDataUtilsWrapper)
+IGC_INITIALIZE_PASS_DEPENDENCY(WIAnalysis)
+IGC_INITIALIZE_PASS_DEPENDENCY(RegisterEstimator)
+IGC_INITIALIZE_PASS_DEPENDENCY(DominatorTreeWrapperPass)
+IGC_INITIALIZE_PASS_DEPENDENCY(LoopInfoWrapperPass)
+IGC_INITIALIZE_PASS_END(PressureDrivenCodeMotion, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+} // End IGC namespace
+
+FunctionPass* IGC::createPressureDrivenCodeMotionPass() {
+    return new PressureDrivenCodeMotion();
+}
+
+PressureDrivenCodeMotion::PressureDrivenCodeMotion() : FunctionPass(ID) {
+    initializePressureDrivenCodeMotionPass(*PassRegistry::getPassRegistry());
+}
+
+bool PressureDrivenCodeMotion::runOnFunction(Function& F) {
+    Ctx = getAnalysis<CodeGenContextWrapper>().getCodeGenContext();
+    WI = &getAnalysis<WIAnalysis>();
+    RPE = &getAnalysis<RegisterEstimator>();
+    DT = &getAnalysis<DominatorTreeWrapperPass>().getDomTree();
+    LI = &getAnalysis<LoopInfoWrapperPass>().getLoopInfo();
+
+    SimdSize = getTargetSimdSize(F);
+    uint32_t NumGRF = Ctx->getNumGRFPerThread() * Ctx->platform.getGRFSize() / GRF_SIZE_IN_BYTE;
+    Budget = NumGRF * (100 - ReservedGRFPercent) / 100;
+
+    bool Changed = false;
+    unsigned MaxRounds = IGC_GET_FLAG_VALUE(PressureCodeMotionMaxRounds);
+    for (unsigned Round = 0; Round < MaxRounds; ++Round) {
+        // The estimator may already have been computed by an earlier user,
+        // without the per instruction pressure. Always start from scratch.
+        RPE->recalculate(true);
+        LVA = RPE->getLivenessAnalysis();
+
+        SmallVector<Instruction*, MaxPeaksPerRound> Peaks;
+        findPeaks(F, Peaks);
+        if (Peaks.empty())
+            break;
+
+        Touched.clear();
+        bool RoundChanged = false;
+        for (auto P : Peaks)
+            RoundChanged |= relievePeak(P);
+
+        for (auto I : DeadInsts)
+            I->eraseFromParent();
+        DeadInsts.clear();
+
+        if (!RoundChanged)
+            break;
+        Changed = true;
+    }
+    return Changed;
+}
+
+uint16_t PressureDrivenCodeMotion::getTargetSimdSize(Function& F) {
+    // A required sub group size fixes the SIMD size; otherwise aim at the
+    // one set by the flag, the codegen picks a narrower one if needed.
+    if (Ctx->type == ShaderType::OPENCL_SHADER) {
+        MetaDataUtils* MDU = getAnalysis<MetaDataUtilsWrapper>().getMetaDataUtils();
+        auto FI = MDU->findFunctionsInfoItem(&F);
+        if (FI != MDU->end_FunctionsInfo()) {
+            int Size = FI->second->getSubGroupSize()->getSIMD_size();
+            if (Size != 0)
+                return (uint16_t)Size;
+        }
+    }
+    return (uint16_t)IGC_GET_FLAG_VALUE(PressureCodeMotionSimdSize);
+}
+
+void PressureDrivenCodeMotion::findPeaks(Function& F, SmallVectorImpl<Instruction*>& Peaks) {
+    SmallVector<std::pair<uint32_t, Instruction*>, 32> Candidates;
+    for (auto& BB : F) {
+        if (RPE->getMaxLiveGRFAtBB(&BB, SimdSize) <= Budget)
+            continue;
+        Instruction* Peak = nullptr;
+        uint32_t Max = 0;
+        for (auto& I : BB) {
+            if (isa<PHINode>(&I))
+                continue;
+            uint32_t N = RPE->getNumLiveGRFAtInst(&I, SimdSize);
+            if (N > Max) {
+                Max = N;
+                Peak = &I;
+            }
+        }
+        if (Peak && Max > Budget)
+            Candidates.push_back(std::make_pair(Max, Peak));
+    }
+
+    std::stable_sort(Candidates.begin(), Candidates.end(),
+        [](const std::pair<uint32_t, Instruction*>& A, const std::pair<uint32_t, Instruction*>& B) {
+            return A.first > B.first;
+        });
+    for (auto& C : Candidates) {
+        if (Peaks.size() == MaxPeaksPerRound)
+            break;
+        Peaks.push_back(C.second);
+    }
+}
+
+// Values live at the exit of P, which is where RegisterEstimator measures
+// the pressure of P.
+void PressureDrivenCodeMotion::computeLiveAt(Instruction* P, SBitVector& Live) {
+    BasicBlock* BB = P->getParent();
+    Live = LVA->BBLiveIns[BB];
+    for (auto& I : *BB) {
+        auto DI = LVA->ValueIds.find(&I);
+        if (DI != LVA->ValueIds.end())
+            Live.set(DI->second);
+        auto KI = LVA->KillInsts.find(&I);
+        if (KI != LVA->KillInsts.end()) {
+            for (auto V : KI->second) {
+                auto VI = LVA->ValueIds.find(V);
+                if (VI != LVA->ValueIds.end())
+                    Live.reset(VI->second);
+            }
+        }
+        if (&I == P)
+            break;
+    }
+}
+
+bool PressureDrivenCodeMotion::relievePeak(Instruction* P) {
+    // The pressure and the liveness are the ones at the start of the round.
+    uint32_t Pressure = RPE->getNumLiveGRFAtInst(P, SimdSize);
+    if (Pressure <= Budget || isa<PHINode>(P) || P->isTerminator())
+        return false;
+    int Excess = (int)(Pressure - Budget) * GRF_SIZE_IN_BYTE;
+
+    SBitVector Live;
+    computeLiveAt(P, Live);
+
+    SmallVector<Motion, 16> Motions;
+    for (auto Id : Live) {
+        auto I = dyn_cast<Instruction>(LVA->getValueFromBitId(Id));
+        if (!I || I == P || !isMovable(I) || isTouched(I))
+            continue;
+        size_t NumMotions = Motions.size();
+        addSink(I, P, Live, Motions);
+        if (Motions.size() == NumMotions)
+            addRemat(I, P, Live, Motions);
+    }
+    for (auto& I : make_range(std::next(P->getIterator()), P->getParent()->end())) {
+        if (isMovable(&I) && !isTouched(&I))
+            addHoist(&I, P, Live, Motions);
+    }
+
+    std::stable_sort(Motions.begin(), Motions.end(),
+        [](const Motion& A, const Motion& B) { return A.Gain > B.Gain; });
+
+    bool Changed = false;
+    for (auto& M : Motions) {
+        if (Excess <= 0 || M.Gain <= 0)
+            break;
+        // An earlier motion may have changed the liveness this one was
+        // estimated with.
+        if (isTouched(M.I))
+            continue;
+        apply(M, P);
+        Excess -= M.Gain;
+        Changed = true;
+    }
+    return Changed;
+}
+
+void PressureDrivenCodeMotion::addSink(Instruction* I, Instruction* P,
+    const SBitVector& Live, SmallVectorImpl<Motion>& Motions) {
+    // The latest point dominating all uses.
+    BasicBlock* TargetBB = nullptr;
+    for (auto& U : I->uses()) {
+        BasicBlock* UseBB = getUseInsertPt(U)->getParent();
+        TargetBB = TargetBB ? DT->findNearestCommonDominator(TargetBB, UseBB) : UseBB;
+    }
+    if (!TargetBB || LI->getLoopFor(TargetBB) != LI->getLoopFor(I->getParent()))
+        return;
+    Instruction* InsertPt = TargetBB->getTerminator();
+    for (auto& U : I->uses()) {
+        Instruction* UI = getUseInsertPt(U);
+        if (UI != InsertPt && UI->getParent() == TargetBB && DT->dominates(UI, InsertPt))
+            InsertPt = UI;
+    }
+
+    // I is no longer live across P only if P dominates its new position.
+    if (InsertPt == P || !DT->dominates(P, InsertPt))
+        return;
+
+    // Operands killed by I before P now live across P.
+    int Gain = getRegBytes(I);
+    SmallPtrSet<Value*, 4> Seen;
+    for (auto& Op : I->operands()) {
+        if (isa<Constant>(Op) || !LVA->isCandidateValue(Op) ||
+            isLive(Op, Live) || !Seen.insert(Op).second)
+            continue;
+        Gain -= getRegBytes(Op);
+    }
+    Motions.push_back({ MK_Sink, I, InsertPt, Gain });
+}
+
+bool PressureDrivenCodeMotion::getRematPoints(Instruction* I, Instruction* P,
+    RematPointMap& Points, SmallVectorImpl<Use*>& LaterUses) {
+    Instruction* Next = P->getNextNode();
+    for (auto& U : I->uses()) {
+        Instruction* UI = getUseInsertPt(U);
+        if (UI != P && DT->dominates(P, UI)) {
+            LaterUses.push_back(&U);
+            continue;
+        }
+        // Any other use reachable from P keeps I live across it.
+        if (isPotentiallyReachable(Next, UI, nullptr, DT, LI))
+            return false;
+    }
+    if (LaterUses.empty())
+        return false;
+
+    // One copy per block, before the first use in it.
+    for (auto U : LaterUses) {
+        Instruction* UI = getUseInsertPt(*U);
+        BasicBlock* BB = UI->getParent();
+        if (LI->getLoopFor(BB) != LI->getLoopFor(I->getParent()))
+            return false;
+        auto It = Points.find(BB);
+        if (It == Points.end())
+            Points[BB] = UI;
+        else if (UI != It->second && DT->dominates(UI, It->second))
+            It->second = UI;
+    }
+    return Points.size() <= MaxRematCopies;
+}
+
+void PressureDrivenCodeMotion::addRemat(Instruction* I, Instruction* P,
+    const SBitVector& Live, SmallVectorImpl<Motion>& Motions) {
+    // The copies must not extend any operand across P.
+    for (auto& Op : I->operands()) {
+        if (!isa<Constant>(Op) && !isLive(Op, Live))
+            return;
+    }
+    RematPointMap Points;
+    SmallVector<Use*, 8> LaterUses;
+    if (!getRematPoints(I, P, Points, LaterUses))
+        return;
+    Motions.push_back({ MK_Remat, I, nullptr, getRegBytes(I) });
+}
+
+void PressureDrivenCodeMotion::addHoist(Instruction* I, Instruction* P,
+    const SBitVector& Live, SmallVectorImpl<Motion>& Motions) {
+    // I now lives across P, while the operands it kills no longer do.
+    int Gain = -getRegBytes(I);
+    auto KI = LVA->KillInsts.find(I);
+    SmallPtrSet<Value*, 4> Seen;
+    for (auto& Op : I->operands()) {
+        if (isa<Constant>(Op) || !Seen.insert(Op).second)
+            continue;
+        // Operands must be available before P.
+        auto OpI = dyn_cast<Instruction>(Op);
+        if (OpI && OpI->getParent() == P->getParent() && !DT->dominates(OpI, P))
+            return;
+        if (KI == LVA->KillInsts.end() || !is_contained(KI->second, Op) || !isLive(Op, Live))
+            continue;
+        // Still live across P if used between P and I.
+        bool UsedBetween = any_of(Op->users(), [&](User* U) {
+            auto UI = dyn_cast<Instruction>(U);
+            return UI && UI != I && UI->getParent() == P->getParent() &&
+                DT->dominates(P, UI) && DT->dominates(UI, I);
+        });
+        if (!UsedBetween)
+            Gain += getRegBytes(Op);
+    }
+    if (Gain > 0)
+        Motions.push_back({ MK_Hoist, I, P, Gain });
+}
+
+void PressureDrivenCodeMotion::apply(const Motion& M, Instruction* P) {
+    Instruction* I = M.I;
+    touch(I);
+    switch (M.Kind) {
+    case MK_Sink:
+    case MK_Hoist:
+        I->moveBefore(M.InsertPt);
+        break;
+    case MK_Remat: {
+        RematPointMap Points;
+        SmallVector<Use*, 8> LaterUses;
+        bool Valid = getRematPoints(I, P, Points, LaterUses);
+        IGC_ASSERT(Valid);
+        (void)Valid;
+        SmallDenseMap<BasicBlock*, Instruction*, 4> Copies;
+        for (auto& Point : Points) {
+            Instruction* Copy = I->clone();
+            Copy->setName(I->getName() + ".remat");
+            Copy->insertBefore(Point.second);
+            WI->incUpdateDepend(Copy, WI->whichDepend(I));
+            Touched.insert(Copy);
+            Copies[Point.first] = Copy;
+        }
+        for (auto U : LaterUses)
+            U->set(Copies[getUseInsertPt(*U)->getParent()]);
+        if (I->use_empty())
+            DeadInsts.push_back(I);
+        break;
+    }
+    }
+}
+
+bool PressureDrivenCodeMotion::isMovable(const Instruction* I) const {
+    // Only GRF values; moving flags only trades GRF pressure for flag
+    // pressure.
+    Type* Ty = I->getType();
+    if (Ty->isVoidTy() || Ty->getScalarType()->isIntegerTy(1))
+        return false;
+    if (I->mayReadOrWriteMemory() || I->mayHaveSideEffects())
+        return false;
+    // Cheap instructions only, so that the latency of the copies made by
+    // rematerialization and the one exposed by sinking stays low.
+    if (auto BO = dyn_cast<BinaryOperator>(I)) {
+        switch (BO->getOpcode()) {
+        case Instruction::UDiv:
+        case Instruction::SDiv:
+        case Instruction::URem:
+        case Instruction::SRem:
+        case Instruction::FDiv:
+        case Instruction::FRem:
+            return false;
+        default:
+            return true;
+        }
+    }
+    return isa<CastInst>(I) || isa<GetElementPtrInst>(I) || isa<ExtractElementInst>(I);
+}
+
+bool PressureDrivenCodeMotion::isTouched(const Instruction* I) const {
+    if (Touched.count(I))
+        return true;
+    return any_of(I->operands(), [this](const Use& Op) {
+        return Touched.count(Op.get()) != 0;
+    });
+}
+
+void PressureDrivenCodeMotion::touch(Instruction* I) {
+    Touched.insert(I);
+    for (auto& Op : I->operands())
+        Touched.insert(Op.get());
+}
+
+bool PressureDrivenCodeMotion::isLive(Value* V, const SBitVector& Live) const {
+    auto VI = LVA->ValueIds.find(V);
+    return VI != LVA->ValueIds.end() && Live.test(VI->second);
+}
+
+// Size of V in bytes at SimdSize, as RegisterEstimator counts it.
+int PressureDrivenCodeMotion::getRegBytes(Value* V) const {
+    RegUse R = RPE->estimateNumOfRegs(V);
+    if (R.rClass != REGISTER_CLASS_GRF)
+        return 0;
+    return R.nregs_simd16 * GRF_SIZE_IN_BYTE * SimdSize / 16 + R.uniformInBytes;
+}
+
+// Where a value must be available for use U: the user itself, or the end
+// of the incoming block for a phi.
+Instruction* PressureDrivenCodeMotion::getUseInsertPt(const Use& U) const {
+    auto UI = cast<Instruction>(U.getUser());
+    if (auto PN = dyn_cast<PHINode>(UI))
+        return PN->getIncomingBlock(U)->getTerminator();
+    return UI;
+}
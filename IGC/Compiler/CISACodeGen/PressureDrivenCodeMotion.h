@@ -0,0 +1,23 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#ifndef _CISA_PRESSURE_DRIVEN_CODE_MOTION_H_
+#define _CISA_PRESSURE_DRIVEN_CODE_MOTION_H_
+
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/Pass.h>
+#include "common/LLVMWarningsPop.hpp"
+
+namespace IGC {
+
+llvm::FunctionPass* createPressureDrivenCodeMotionPass();
+void initializePressureDrivenCodeMotionPass(llvm::PassRegistry &);
+
+} // End namespace IGC
+
+#endif // _CISA_PRESSURE_DRIVEN_CODE_MOTION_H_
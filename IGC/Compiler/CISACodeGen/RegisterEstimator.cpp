@@ -116,6 +116,12 @@ void RegisterEstimator::addRegUsage(RegUsage& RUsage, SBitVector& BV)
 }
 
 RegUse RegisterEstimator::estimateNumOfRegs(Value* V) const
+{
+    return estimateNumOfRegs(V, *m_DL, m_LVA->isUniform(V));
+}
+
+RegUse RegisterEstimator::estimateNumOfRegs(
+    Value* V, const DataLayout& DL, bool isUniform)
 {
     // Assume no sharing GRF among Values.
     RegUse regs;
@@ -134,11 +140,11 @@ RegUse RegisterEstimator::estimateNumOfRegs(Value* V) const
         IGCLLVM::FixedVectorType* VTy = dyn_cast<IGCLLVM::FixedVectorType>(Ty);
         Type* eltTy = VTy ? VTy->getElementType() : Ty;
         uint32_t nelts = VTy ? int_cast<uint32_t>(VTy->getNumElements()) : 1;
-        uint32_t eltBits = (uint32_t)m_DL->getTypeSizeInBits(eltTy);
+        uint32_t eltBits = (uint32_t)DL.getTypeSizeInBits(eltTy);
         uint32_t nBytes = nelts * ((eltBits + 7) / 8);
 
         regs.rClass = (RegClass)REGISTER_CLASS_GRF;
-        if (m_LVA->isUniform(V))
+        if (isUniform)
         {
             // round up to DW
             uint16_t sz = (nBytes + DWORD_SIZE_IN_BYTE - 1) / DWORD_SIZE_IN_BYTE;
@@ -316,6 +322,29 @@ bool RegisterEstimator::runOnFunction(Function& F)
 
     m_WIA = getAnalysisIfAvailable<WIAnalysis>();
 
+    initValueRegUses();
+
+    // Note that runOnFunction does not do RPE calculation unless ForceRPE
+    // is enabled (for debugging).  The RPE is calcualted for users to call
+    // calculate() explicitly.
+    if (IGC_IS_FLAG_ENABLED(ForceRPE))
+    {
+        // Calculate register pressure for each BB
+        calculate();
+    }
+    return false;
+}
+
+void RegisterEstimator::recalculate(bool doRPEPerInst)
+{
+    clear();
+    m_LVA->recalculate(m_F);
+    initValueRegUses();
+    calculate(doRPEPerInst);
+}
+
+void RegisterEstimator::initValueRegUses()
+{
     uint32_t nVals = (uint32_t)m_LVA->IdValues.size();
     uint32_t Caps = (uint32_t)m_LVA->IdValues.capacity();
     m_ValueRegUses.reserve(Caps);
@@ -337,16 +366,6 @@ bool RegisterEstimator::runOnFunction(Function& F)
     }
 
     m_noGRFPressure = isGRFPressureLow(16, estNumRegs);
-
-    // Note that runOnFunction does not do RPE calculation unless ForceRPE
-    // is enabled (for debugging).  The RPE is calcualted for users to call
-    // calculate() explicitly.
-    if (IGC_IS_FLAG_ENABLED(ForceRPE))
-    {
-        // Calculate register pressure for each BB
-        calculate();
-    }
-    return false;
 }
 
 void RegisterEstimator::print(raw_ostream& OS, BasicBlock* BB, int dumpLevel)
@@ -171,11 +171,34 @@ namespace IGC
 
         RegUse estimateNumOfRegs(llvm::Value* V) const;
 
+        // Same as above for callers without LivenessAnalysis, which have to
+        // provide the uniformity of V themselves.
+        static RegUse estimateNumOfRegs(
+            llvm::Value* V, const llvm::DataLayout& DL, bool isUniform);
+
+        static uint32_t getNumRegs(const RegUse& RUse, uint16_t simdsize)
+        {
+            uint32_t uniformRegs =
+                (RUse.uniformInBytes + GRF_SIZE_IN_BYTE - 1) / GRF_SIZE_IN_BYTE;
+            switch (simdsize) {
+            case 16:
+                return RUse.nregs_simd16 + uniformRegs;
+            case 32:
+                return 2 * RUse.nregs_simd16 + uniformRegs;
+            default:
+                return (RUse.nregs_simd16 + 1) / 2 + uniformRegs;
+            }
+        }
+
         // This will compute Register pressure estimates. It also saves
         // register pressure estimate per instruction if "doRPPerInst"
         // is true.
         void calculate(bool doRPEPerInst = false);
 
+        // Recompute liveness and register pressure estimates after the
+        // user of this analysis has moved or created instructions.
+        void recalculate(bool doRPEPerInst = false);
+
         // Once MAX register estimate of a function is computed, check
         // if there is GRF pressure.  If the number of estimated registers
         // is larger than a given threshold (threshold is selected based on
@@ -246,6 +269,8 @@ namespace IGC
 
         void addRegUsage(RegUsage& RUsage, SBitVector& BV);
 
+        void initValueRegUses();
+
         uint32_t getNumGRF(RegUsage& rusage, uint16_t simdsize = 16) {
             RegUse& grfuse = rusage.allUses[REGISTER_CLASS_GRF];
             return getNumRegs(grfuse, simdsize);
@@ -287,20 +312,6 @@ namespace IGC
             return getRegUse(valId);
         }
 
-        uint32_t getNumRegs(const RegUse& RUse, uint16_t simdsize) const
-        {
-            uint32_t uniformRegs =
-                (RUse.uniformInBytes + GRF_SIZE_IN_BYTE - 1) / GRF_SIZE_IN_BYTE;
-            switch (simdsize) {
-            case 16:
-                return RUse.nregs_simd16 + uniformRegs;
-            case 32:
-                return 2 * RUse.nregs_simd16 + uniformRegs;
-            default:
-                return (RUse.nregs_simd16 + 1) / 2 + uniformRegs;
-            }
-        }
-
         void clear()
         {
             m_LiveVirtRegs.clear();
@@ -14,6 +14,7 @@ SPDX-License-Identifier: MIT
 #include "Compiler/CISACodeGen/AdvCodeMotion.h"
 #include "Compiler/CISACodeGen/RematAddressArithmetic.h"
 #include "Compiler/CISACodeGen/AdvMemOpt.h"
+#include "Compiler/CISACodeGen/ArgUniformityPropagation.h"
 #include "Compiler/CISACodeGen/Emu64OpsPass.h"
 #include "Compiler/CISACodeGen/PullConstantHeuristics.hpp"
 #include "Compiler/CISACodeGen/PushAnalysis.hpp"
@@ -36,6 +37,7 @@ SPDX-License-Identifier: MIT
 #include "Compiler/CISACodeGen/MemOpt2.h"
 #include "Compiler/CISACodeGen/PreRARematFlag.h"
 #include "Compiler/CISACodeGen/PreRAScheduler.hpp"
+#include "Compiler/CISACodeGen/PressureDrivenCodeMotion.h"
 #include "Compiler/CISACodeGen/PromoteConstantStructs.hpp"
 #include "Compiler/CISACodeGen/ResolveGAS.h"
 #include "Compiler/CISACodeGen/ResolvePredefinedConstant.h"
@@ -53,7 +55,9 @@ SPDX-License-Identifier: MIT
 #include "Compiler/CISACodeGen/OpenCLKernelCodeGen.hpp"
 #include "Compiler/CISACodeGen/RayTracingShaderLowering.hpp"
 #include "Compiler/CISACodeGen/RayTracingStatefulPass.h"
+#include "Compiler/CISACodeGen/LSC2DBlockLoadSynthesis.h"
 #include "Compiler/CISACodeGen/LSCCacheOptimizationPass.h"
+#include "Compiler/CISACodeGen/LSCLoopPrefetch.h"
 #include "Compiler/CISACodeGen/LSCControlsAnalysisPass.h"
 #include "Compiler/ConvertMSAAPayloadTo16Bit.hpp"
 #include "Compiler/MSAAInsertDiscard.hpp"
@@ -295,6 +299,11 @@ void AddAnalysisPasses(CodeGenContext& ctx, IGCPassManager& mpm)
     // clean up constexpressions after EarlyCSE
     mpm.add( new BreakConstantExpr() );
 
+    if (IGC_IS_FLAG_ENABLED(EnablePressureCodeMotion) && !isOptDisabled)
+    {
+        mpm.add(createPressureDrivenCodeMotionPass());
+    }
+
     // This is for dumping register pressure info
     if (IGC_IS_FLAG_ENABLED(ForceRPE)) {
         mpm.add(new RegisterEstimator());
@@ -305,6 +314,12 @@ void AddAnalysisPasses(CodeGenContext& ctx, IGCPassManager& mpm)
     // collect stats after all the optimization. This info can be dumped to the cos file
     mpm.add(new CheckInstrTypes(&(ctx.m_instrTypesAfterOpts), nullptr));
 
+    if (ctx.enableFunctionCall() && IGC_IS_FLAG_ENABLED(EnableArgUniformityPropagation))
+    {
+        // Only annotates function arguments, WIAnalysis in EmitPass picks it up.
+        mpm.add(createArgUniformityPropagationPass());
+    }
+
     //
     // Generally, passes that change IR should be prior to this place!
     //
@@ -425,6 +440,7 @@ void AddLegalizationPasses(CodeGenContext& ctx, IGCPassManager& mpm, PSSignature
 
         if (LoopUnrollThreshold > 0 && (ctx.m_tempCount < 64))
         {
+            mpm.add(new ResetUnrollFunctionInfo());
             mpm.add(IGCLLVM::createLoopUnrollPass(2, LoopUnrollThreshold, -1, 1));
         }
 
@@ -661,6 +677,24 @@ void AddLegalizationPasses(CodeGenContext& ctx, IGCPassManager& mpm, PSSignature
         }
     }
 
+    if (!isOptDisabled && ctx.type == ShaderType::OPENCL_SHADER &&
+        ctx.m_instrTypes.hasGlobalLoad &&
+        ctx.platform.isProductChildOf(IGFX_PVC) &&
+        IGC_IS_FLAG_ENABLED(EnableLSC2DBlockLoadSynthesis))
+    {
+        mpm.add(createLSC2DBlockLoadSynthesisPass());
+    }
+
+    if (!isOptDisabled && ctx.type == ShaderType::OPENCL_SHADER &&
+        ctx.m_instrTypes.numOfLoop && ctx.m_instrTypes.hasGlobalLoad &&
+        ctx.platform.hasLSC() &&
+        IGC_IS_FLAG_ENABLED(EnableLSCLoopPrefetch))
+    {
+        // Issue prefetches ahead of streaming loads in loops, after MemOpt
+        // has formed the final accesses.
+        mpm.add(createLSCLoopPrefetchPass());
+    }
+
     if (ctx.hasSyncRTCalls())
     {
         mpm.add(createRaytracingStatefulPass());
@@ -892,7 +926,8 @@ void AddLegalizationPasses(CodeGenContext& ctx, IGCPassManager& mpm, PSSignature
     // Therefore last 64bit emulation pass must be after the last Replace Unsupported Intrinsics Pass.
     mpm.add(createReplaceUnsupportedIntrinsicsPass());
 
-    if (!ctx.platform.hasFP32GlobalAtomicAdd()) {
+    if (!ctx.platform.hasFP32GlobalAtomicAdd() ||
+        (ctx.m_instrTypes.hasAtomics && IGC_IS_FLAG_ENABLED(EnableDivergentAtomicAggregation))) {
         mpm.add(new AtomicOptPass());
     }
 
@@ -1337,6 +1372,7 @@ void OptimizeIR(CodeGenContext* const pContext)
                      !disableLoopUnrollStage1)
                     || hasIndexTemp)
                 {
+                    mpm.add(new ResetUnrollFunctionInfo());
                     mpm.add(IGCLLVM::createLoopUnrollPass());
                 }
 
@@ -1352,6 +1388,7 @@ void OptimizeIR(CodeGenContext* const pContext)
                 // Second unrolling with the same threshold.
                 if (LoopUnrollThreshold > 0 && !IGC_IS_FLAG_ENABLED(DisableLoopUnroll))
                 {
+                    mpm.add(new ResetUnrollFunctionInfo());
                     mpm.add(IGCLLVM::createLoopUnrollPass());
                 }
 
@@ -1514,6 +1551,7 @@ void OptimizeIR(CodeGenContext* const pContext)
                          !disableLoopUnrollStage1)
                         || hasIndexTemp)
                     {
+                        mpm.add(new ResetUnrollFunctionInfo());
                         mpm.add(IGCLLVM::createLoopUnrollPass());
                     }
                 }
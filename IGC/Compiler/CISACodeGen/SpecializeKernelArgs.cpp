@@ -0,0 +1,151 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "Compiler/CISACodeGen/SpecializeKernelArgs.h"
+#include "Compiler/CISACodeGen/OpenCLKernelCodeGen.hpp"
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/IGCPassSupport.h"
+#include "common/LLVMWarningsPush.hpp"
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/Module.h>
+#include "common/LLVMWarningsPop.hpp"
+
+using namespace llvm;
+using namespace IGC;
+
+namespace {
+// Replace the uses of the scalar arguments of the kernel requested through
+// TranslateSpecialized with the values the runtime promised to launch it
+// with. The arguments themselves are kept so that the kernel interface is
+// unchanged; the regular optimization pipeline then folds the constants,
+// computes trip counts of the loops they bound and removes dead branches.
+class SpecializeKernelArgs : public ModulePass
+{
+public:
+    static char ID;
+
+    SpecializeKernelArgs();
+    SpecializeKernelArgs(const std::string& KernelName,
+        const std::map<uint32_t, uint64_t>& Args);
+    bool runOnModule(Module& M) override;
+
+    void getAnalysisUsage(AnalysisUsage& AU) const override {
+        AU.setPreservesCFG();
+        if (!m_Injected)
+            AU.addRequired<CodeGenContextWrapper>();
+    }
+
+    StringRef getPassName() const override {
+        return "SpecializeKernelArgs";
+    }
+
+private:
+    static Constant* getArgConstant(Type* Ty, uint64_t Bits);
+    void warn(const char* Msg) const;
+
+    // Set when the specialization is given at construction instead of being
+    // read from the OpenCL program context.
+    bool m_Injected = false;
+    std::string m_KernelName;
+    std::map<uint32_t, uint64_t> m_Args;
+    CodeGenContext* m_Ctx = nullptr;
+};
+} // End anonymous namespace
+
+char SpecializeKernelArgs::ID = 0;
+
+#define PASS_FLAG "igc-specialize-kernel-args"
+#define PASS_DESCRIPTION "Fold kernel arguments with specialized values"
+#define PASS_CFG_ONLY false
+#define PASS_ANALYSIS false
+
+namespace IGC {
+IGC_INITIALIZE_PASS_BEGIN(SpecializeKernelArgs, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+IGC_INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+IGC_INITIALIZE_PASS_END(SpecializeKernelArgs, PASS_FLAG, PASS_DESCRIPTION, PASS_CFG_ONLY, PASS_ANALYSIS)
+} // End IGC namespace
+
+ModulePass* IGC::createSpecializeKernelArgsPass() {
+    return new SpecializeKernelArgs();
+}
+
+ModulePass* IGC::createSpecializeKernelArgsPass(
+    const std::string& KernelName, const std::map<uint32_t, uint64_t>& Args) {
+    return new SpecializeKernelArgs(KernelName, Args);
+}
+
+SpecializeKernelArgs::SpecializeKernelArgs() : ModulePass(ID) {
+    initializeSpecializeKernelArgsPass(*PassRegistry::getPassRegistry());
+}
+
+SpecializeKernelArgs::SpecializeKernelArgs(const std::string& KernelName,
+    const std::map<uint32_t, uint64_t>& Args)
+    : ModulePass(ID), m_Injected(true), m_KernelName(KernelName), m_Args(Args) {
+    initializeSpecializeKernelArgsPass(*PassRegistry::getPassRegistry());
+}
+
+void SpecializeKernelArgs::warn(const char* Msg) const {
+    if (m_Ctx)
+        m_Ctx->EmitWarning(Msg);
+}
+
+Constant* SpecializeKernelArgs::getArgConstant(Type* Ty, uint64_t Bits) {
+    if (Ty->isIntegerTy())
+        return ConstantInt::get(Ty, Bits);
+    if (Ty->isHalfTy() || Ty->isFloatTy() || Ty->isDoubleTy()) {
+        Type* IntTy = Type::getIntNTy(Ty->getContext(), Ty->getPrimitiveSizeInBits());
+        return ConstantExpr::getBitCast(ConstantInt::get(IntTy, Bits), Ty);
+    }
+    // Pointers, vectors and aggregates passed by value are left alone.
+    return nullptr;
+}
+
+bool SpecializeKernelArgs::runOnModule(Module& M) {
+    if (auto* CGCW = getAnalysisIfAvailable<CodeGenContextWrapper>())
+        m_Ctx = CGCW->getCodeGenContext();
+
+    if (!m_Injected) {
+        if (m_Ctx->type != ShaderType::OPENCL_SHADER)
+            return false;
+        auto OCLCtx = static_cast<OpenCLProgramContext*>(m_Ctx);
+        m_KernelName = OCLCtx->m_SpecializedKernelName;
+        m_Args = OCLCtx->m_SpecializedKernelArgs;
+    }
+    const std::string& KernelName = m_KernelName;
+    const std::map<uint32_t, uint64_t>& Args = m_Args;
+    if (Args.empty())
+        return false;
+
+    Function* F = M.getFunction(KernelName);
+    if (!F || F->isDeclaration()) {
+        warn("Kernel requested for argument specialization not found");
+        return false;
+    }
+
+    bool Changed = false;
+    for (auto& KV : Args) {
+        if (KV.first >= F->arg_size()) {
+            warn("Specialized argument index out of range, ignored");
+            continue;
+        }
+        Argument* Arg = F->getArg(KV.first);
+        if (Arg->hasByValAttr())
+            continue;
+        Constant* C = getArgConstant(Arg->getType(), KV.second);
+        if (!C) {
+            warn("Only scalar kernel arguments can be specialized, ignored");
+            continue;
+        }
+        if (Arg->use_empty())
+            continue;
+        Arg->replaceAllUsesWith(C);
+        Changed = true;
+    }
+    return Changed;
+}
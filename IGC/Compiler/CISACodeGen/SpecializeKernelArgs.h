@@ -0,0 +1,26 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#pragma once
+
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/Pass.h"
+#include "common/LLVMWarningsPop.hpp"
+
+#include <map>
+#include <string>
+
+namespace IGC
+{
+    llvm::ModulePass* createSpecializeKernelArgsPass();
+    // Specializes the given kernel instead of the one recorded in the OpenCL
+    // program context. Used by the unit tests, which run without a context.
+    llvm::ModulePass* createSpecializeKernelArgsPass(
+        const std::string& KernelName, const std::map<uint32_t, uint64_t>& Args);
+    void initializeSpecializeKernelArgsPass(llvm::PassRegistry&);
+}
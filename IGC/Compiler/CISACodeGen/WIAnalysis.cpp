@@ -507,11 +507,12 @@ void WIAnalysisRunner::updateArgsDependency(llvm::Function* pF)
     ae = pF->arg_end();
 
     // 1. add all kernel function args as uniform, or
-    //    add all subroutine function args as random
+    //    add all subroutine function args as random, unless the uniformity
+    //    has been proven over all call sites.
     for (int i = 0; i < implicitArgStart; ++i, ++ai)
     {
         IGC_ASSERT(ai != ae);
-        incUpdateDepend(&(*ai), IsSubroutine ? WIAnalysis::RANDOM : WIAnalysis::UNIFORM_GLOBAL);
+        incUpdateDepend(&(*ai), IsSubroutine ? WIAnalysis::getArgDependency(&*ai) : WIAnalysis::UNIFORM_GLOBAL);
     }
 
     // 2. add implicit args
@@ -590,6 +591,32 @@ bool WIAnalysis::isWorkGroupOrGlobalUniform(const Value* val)
     return Runner.isWorkGroupOrGlobalUniform(val);
 }
 
+static const char* const ArgDependencyAttr = "igc-arg-wi-dep";
+
+WIAnalysis::WIDependancy WIAnalysis::getArgDependency(const Argument* Arg)
+{
+    llvm::Attribute A = Arg->getParent()->getAttributes().getParamAttr(Arg->getArgNo(), ArgDependencyAttr);
+    unsigned Dep = 0;
+    if (!A.isStringAttribute() ||
+        A.getValueAsString().getAsInteger(10, Dep) ||
+        !isDepUniform(static_cast<WIDependancy>(Dep)))
+    {
+        return WIAnalysis::RANDOM;
+    }
+    return static_cast<WIDependancy>(Dep);
+}
+
+void WIAnalysis::setArgDependency(Argument* Arg, WIDependancy Dep)
+{
+    Function* F = Arg->getParent();
+    F->removeParamAttr(Arg->getArgNo(), ArgDependencyAttr);
+    if (isDepUniform(Dep))
+    {
+        F->addParamAttr(Arg->getArgNo(),
+            llvm::Attribute::get(F->getContext(), ArgDependencyAttr, std::to_string((unsigned)Dep)));
+    }
+}
+
 bool WIAnalysis::insideDivergentCF(const Value* val) const
 {
     return Runner.insideDivergentCF(val);
@@ -382,6 +382,11 @@ namespace IGC
                 Dep == WIDependancy::UNIFORM_WORKGROUP ||
                 Dep == WIDependancy::UNIFORM_THREAD;
         }
+
+        /// Dependency of a subroutine argument proven over all of its call
+        /// sites by ArgUniformityPropagation. RANDOM if nothing is known.
+        static WIDependancy getArgDependency(const llvm::Argument* Arg);
+        static void setArgDependency(llvm::Argument* Arg, WIDependancy Dep);
     private:
         WIAnalysisRunner Runner;
         bool isComputeProgram;
@@ -817,6 +817,8 @@ namespace IGC
         unsigned int lscCacheCtrl;
     };
 
+    struct UnrollFunctionInfo;
+
     class CodeGenContext
     {
     private:
@@ -885,6 +887,10 @@ namespace IGC
         std::vector<unsigned> m_indexableTempSize;
         bool         m_highPsRegisterPressure = 0;
 
+        // What the loop unroll heuristics know about each function, see
+        // GenIntrinsicsTTIImpl::getUnrollFunctionInfo.
+        llvm::ValueMap<const llvm::Function*, std::shared_ptr<UnrollFunctionInfo>> m_unrollFunctionInfo;
+
         // Record previous simd for code patching
         CShader* m_prevShader = nullptr;
 
@@ -939,6 +945,16 @@ namespace IGC
 
         bool HasFuncExpensiveLoop(llvm::Function* pFunc);
 
+        // Where the private arrays of each function were placed by the
+        // private array promotion, reported through the shader stats.
+        struct PrivateArrayPlacement
+        {
+            unsigned int numInGRF = 0;
+            unsigned int numInSLM = 0;
+            unsigned int numInScratch = 0;
+        };
+        std::unordered_map<llvm::Function*, PrivateArrayPlacement> m_privateArrayPlacement;
+
         // Raytracing (any shader type)
         // If provided, the BVH has been constructed such that the root node
         // is at a constant offset from the start of the BVH. This allows
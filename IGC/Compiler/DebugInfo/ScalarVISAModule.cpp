@@ -403,14 +403,17 @@ ScalarVisaModule::GetVariableLocation(const llvm::Instruction* pInst) const
         CodeGenContext* pCtx = m_pShader->GetContext();
         ModuleMetaData* modMD = pCtx->getModuleMetaData();
 
+        // Module metadata is shared by the debug emitters finalized
+        // concurrently, so it's only looked up here, never inserted into.
+        auto funcMDItr = modMD->FuncMD.find(const_cast<Function*>(curFunc));
         if (itr != m_pShader->GetMetaDataUtils()->end_FunctionsInfo()
-            && modMD->FuncMD.find(const_cast<Function*>(curFunc)) != modMD->FuncMD.end())
+            && funcMDItr != modMD->FuncMD.end())
         {
             unsigned int explicitArgsNum = curFunc->arg_size() - itr->second->size_ImplicitArgInfoList();
         if (pArgument->getArgNo() < explicitArgsNum &&
-                modMD->FuncMD[const_cast<Function*>(curFunc)].m_OpenCLArgBaseTypes.size() > pArgument->getArgNo())
+                funcMDItr->second.m_OpenCLArgBaseTypes.size() > pArgument->getArgNo())
             {
-                const std::string typeStr = modMD->FuncMD[const_cast<Function*>(curFunc)].m_OpenCLArgBaseTypes[pArgument->getArgNo()];
+                const std::string typeStr = funcMDItr->second.m_OpenCLArgBaseTypes[pArgument->getArgNo()];
                 KernelArg::ArgType argType = KernelArg::calcArgType(pArgument, typeStr);
                 if (argType == KernelArg::ArgType::SAMPLER)
                 {
@@ -422,7 +425,7 @@ ScalarVisaModule::GetVariableLocation(const llvm::Instruction* pInst) const
                         argType = KernelArg::ArgType::End;
                     }
                 }
-                FunctionMetaData* funcMD = &modMD->FuncMD[const_cast<Function*>(curFunc)];
+                FunctionMetaData* funcMD = &funcMDItr->second;
                 ResourceAllocMD* resAllocMD = &funcMD->resAllocMD;
                 IGC_ASSERT_MESSAGE(resAllocMD->argAllocMDList.size() == curFunc->arg_size(), "Invalid ArgAllocMDList");
                 ArgAllocMD* argAlloc = &resAllocMD->argAllocMDList[pArgument->getArgNo()];
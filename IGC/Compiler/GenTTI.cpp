@@ -12,14 +12,21 @@ SPDX-License-Identifier: MIT
 #include "Compiler/CodeGenPublic.h"
 #include "Compiler/IGCPassSupport.h"
 #include "Compiler/CISACodeGen/ShaderCodeGen.hpp"
+#include "Compiler/CISACodeGen/RegisterEstimator.hpp"
+#include "Compiler/CISACodeGen/WIAnalysis.hpp"
 
 #include "common/LLVMWarningsPush.hpp"
 #include "llvm/Config/llvm-config.h"
 #include "WrapperLLVM/Utils.h"
 
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/Analysis/CodeMetrics.h"
 #include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/PostDominators.h"
 #include "llvm/Analysis/ScalarEvolution.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvmWrapper/Transforms/Utils/LoopUtils.h"
 #include "common/LLVMWarningsPop.hpp"
@@ -27,6 +34,47 @@ SPDX-License-Identifier: MIT
 using namespace llvm;
 using namespace IGC;
 
+namespace IGC {
+
+    // What the loop unroll heuristics know about a function. Loop unrolling
+    // asks about one loop at a time and only changes the function by
+    // transforming the loop it last asked about, so this stays valid as long
+    // as that loop was left alone.
+    struct UnrollFunctionInfo
+    {
+        unsigned instCount = 0;
+
+        // Header of the last loop asked about and its predecessors then.
+        // Every transformation of the unroller changes the latter: full
+        // unrolling drops the back edge, partial and runtime unrolling move
+        // it to the last copy of the body, and peeling puts the peeled
+        // iterations in front of the header.
+        WeakVH lastHeader;
+        SmallVector<WeakVH, 2> lastHeaderPreds;
+
+        // Uniformity of the function's values, computed on first use.
+        std::unique_ptr<DominatorTree> DT;
+        std::unique_ptr<PostDominatorTree> PDT;
+        std::unique_ptr<TranslationTable> TT;
+        std::unique_ptr<WIAnalysisRunner> WI;
+
+        bool isLastLoopUnchanged() const
+        {
+            auto* Header = cast_or_null<BasicBlock>((Value*)lastHeader);
+            if (!Header)
+                return false;
+            unsigned i = 0;
+            for (BasicBlock* Pred : predecessors(Header))
+            {
+                if (i == lastHeaderPreds.size() || (Value*)lastHeaderPreds[i] != Pred)
+                    return false;
+                ++i;
+            }
+            return i == lastHeaderPreds.size();
+        }
+    };
+
+} // namespace IGC
 
 namespace llvm {
 
@@ -36,6 +84,24 @@ namespace llvm {
         initializeDummyPassPass(*PassRegistry::getPassRegistry());
     }
 
+    char ResetUnrollFunctionInfo::ID = 0;
+    void initializeResetUnrollFunctionInfoPass(PassRegistry& Registry);
+    ResetUnrollFunctionInfo::ResetUnrollFunctionInfo() : FunctionPass(ID) {
+        initializeResetUnrollFunctionInfoPass(*PassRegistry::getPassRegistry());
+    }
+
+    void ResetUnrollFunctionInfo::getAnalysisUsage(AnalysisUsage& AU) const
+    {
+        AU.addRequired<CodeGenContextWrapper>();
+        AU.setPreservesAll();
+    }
+
+    bool ResetUnrollFunctionInfo::runOnFunction(Function& F)
+    {
+        getAnalysis<CodeGenContextWrapper>().getCodeGenContext()->m_unrollFunctionInfo.erase(&F);
+        return false;
+    }
+
     bool GenIntrinsicsTTIImpl::isLoweredToCall(const Function* F)
     {
         if (GenISAIntrinsic::isIntrinsic(F))
@@ -154,6 +220,152 @@ namespace llvm {
         return true;
     }
 
+    UnrollFunctionInfo& GenIntrinsicsTTIImpl::getUnrollFunctionInfo(Loop* L)
+    {
+        BasicBlock* Header = L->getHeader();
+        Function* F = Header->getParent();
+        std::shared_ptr<UnrollFunctionInfo>& FI = ctx->m_unrollFunctionInfo[F];
+        if (!FI || !FI->isLastLoopUnchanged())
+        {
+            FI = std::make_shared<UnrollFunctionInfo>();
+            FI->instCount = countTotalInstructions(F);
+        }
+        FI->lastHeader = Header;
+        FI->lastHeaderPreds.assign(pred_begin(Header), pred_end(Header));
+        return *FI;
+    }
+
+    unsigned GenIntrinsicsTTIImpl::getFunctionInstCount(Loop* L)
+    {
+        return getUnrollFunctionInfo(L).instCount;
+    }
+
+    // Estimate GRF pressure of the loop with RegisterEstimator's per-value
+    // sizes, but only for the loop body:
+    //  - values live through the loop (defined outside and used inside, plus
+    //    loop-carried PHIs) occupy registers for the whole loop;
+    //  - values defined in a block are live from their definition to their
+    //    last use in that block, or to its end if used elsewhere.
+    // The unrolled loop keeps the live-through part once and replicates the
+    // body part, which gives the largest spill-free unroll factor.
+    unsigned GenIntrinsicsTTIImpl::getMaxSpillFreeUnrollCount(Loop* L, bool& lowPressure)
+    {
+        lowPressure = false;
+        Function* F = L->getHeader()->getParent();
+        const DataLayout& DL = F->getParent()->getDataLayout();
+
+        unsigned simdSize = 16;
+        auto* pMdUtils = ctx->getMetaDataUtils();
+        auto FII = pMdUtils->findFunctionsInfoItem(F);
+        if (FII != pMdUtils->end_FunctionsInfo() &&
+            FII->second->getSubGroupSize()->getSIMD_size() != 0)
+        {
+            simdSize = FII->second->getSubGroupSize()->getSIMD_size();
+        }
+
+        UnrollFunctionInfo& FI = getUnrollFunctionInfo(L);
+        if (!FI.DT)
+        {
+            FI.DT = std::make_unique<DominatorTree>(*F);
+            FI.PDT = std::make_unique<PostDominatorTree>(*F);
+            // WIAnalysis only handles functions with IGC metadata, values of
+            // any other function are taken as non-uniform.
+            if (FII != pMdUtils->end_FunctionsInfo())
+            {
+                FI.TT = std::make_unique<TranslationTable>();
+                FI.TT->run(*F);
+                FI.WI = std::make_unique<WIAnalysisRunner>(F, FI.DT.get(), FI.PDT.get(),
+                    pMdUtils, ctx, ctx->getModuleMetaData(), FI.TT.get());
+                FI.WI->run();
+            }
+        }
+
+        // Flags are allocated separately and do not count against the GRFs.
+        auto regUse = [&](Value* V) -> RegUse {
+            Type* Ty = V->getType();
+            if (Ty->isVoidTy() || Ty->isLabelTy() || Ty->isMetadataTy() ||
+                RegisterEstimator::getValueRegClass(V) != REGISTER_CLASS_GRF)
+                return RegUse();
+            return RegisterEstimator::estimateNumOfRegs(V, DL, FI.WI && FI.WI->isUniform(V));
+        };
+
+        RegUse liveThroughUse;
+        SmallPtrSet<const Value*, 32> liveThrough;
+        for (PHINode& PN : L->getHeader()->phis())
+        {
+            liveThrough.insert(&PN);
+            liveThroughUse += regUse(&PN);
+        }
+
+        unsigned bodyPeakRegs = 0;
+        for (BasicBlock* BB : L->blocks())
+        {
+            // Last position in BB where an in-block definition is used.
+            DenseMap<const Instruction*, unsigned> lastUse;
+            unsigned pos = 0;
+            for (Instruction& I : *BB)
+            {
+                ++pos;
+                for (Value* Op : I.operands())
+                {
+                    if (auto* OpI = dyn_cast<Instruction>(Op))
+                    {
+                        if (OpI->getParent() == BB)
+                            lastUse[OpI] = pos;
+                        else if (!L->contains(OpI) && liveThrough.insert(OpI).second)
+                            liveThroughUse += regUse(OpI);
+                    }
+                    else if (isa<Argument>(Op) && liveThrough.insert(Op).second)
+                    {
+                        liveThroughUse += regUse(Op);
+                    }
+                }
+            }
+
+            // Scan the block once more tracking the registers live at each point.
+            SmallVector<RegUse, 64> freedAt(pos + 2);
+            RegUse liveUse;
+            pos = 0;
+            for (Instruction& I : *BB)
+            {
+                ++pos;
+                liveUse -= freedAt[pos];
+                if (liveThrough.count(&I))
+                    continue;
+                RegUse use = regUse(&I);
+                if (use.nregs_simd16 == 0 && use.uniformInBytes == 0)
+                    continue;
+                liveUse += use;
+                bodyPeakRegs = std::max(bodyPeakRegs,
+                    RegisterEstimator::getNumRegs(liveUse, (uint16_t)simdSize));
+
+                // Values used in other blocks or by PHIs stay live to the end.
+                bool usedOutside = llvm::any_of(I.users(), [BB](const User* U) {
+                    return isa<PHINode>(U) || cast<Instruction>(U)->getParent() != BB;
+                });
+                if (!usedOutside)
+                {
+                    auto It = lastUse.find(&I);
+                    unsigned endPos = (It != lastUse.end()) ? It->second : pos;
+                    freedAt[endPos + 1] += use;
+                }
+            }
+        }
+
+        // RegisterEstimator counts 32-byte registers.
+        const unsigned grfScale = std::max(1u, ctx->platform.getGRFSize() / 32);
+        const unsigned liveThroughGRFs =
+            RegisterEstimator::getNumRegs(liveThroughUse, (uint16_t)simdSize) / grfScale;
+        const unsigned bodyGRFs = std::max(1u, bodyPeakRegs / grfScale);
+        // Keep some headroom for payloads, address and temporary registers.
+        const unsigned budget = ctx->getNumGRFPerThread() * 7 / 8;
+
+        lowPressure = 2 * (liveThroughGRFs + bodyGRFs) <= budget;
+        if (liveThroughGRFs + bodyGRFs >= budget)
+            return 1;
+        return (budget - liveThroughGRFs) / bodyGRFs;
+    }
+
     void GenIntrinsicsTTIImpl::getUnrollingPreferences(Loop* L,
 #if LLVM_VERSION_MAJOR >= 7
         ScalarEvolution& SE,
@@ -182,9 +394,37 @@ namespace llvm {
                 LoopUnrollThreshold = ctx->getModuleMetaData()->compOpt.SetLoopUnrollThreshold;
             }
         }
-        unsigned totalInstCountInShader = countTotalInstructions(L->getBlocks()[0]->getParent());
+        unsigned totalInstCountInShader = getFunctionInstCount(L);
         uint32_t registerPressureEst = (uint32_t)(IGC_GET_FLAG_VALUE(SetRegisterPressureThresholdForLoopUnroll) * (ctx->getNumGRFPerThread() / 128.0));
         bool lowPressure = (this->ctx->m_tempCount < registerPressureEst) && (totalInstCountInShader < LoopUnrollThreshold);
+
+        unsigned maxSpillFreeCount = UINT_MAX;
+        if (IGC_IS_FLAG_ENABLED(EnableRegPressureAwareUnroll))
+        {
+            // m_tempCount describes the whole shader; a small loop in a big
+            // shader may still be cheap to unroll.
+            bool loopLowPressure = false;
+            maxSpillFreeCount = getMaxSpillFreeUnrollCount(L, loopLowPressure);
+            lowPressure |= loopLowPressure && (totalInstCountInShader < LoopUnrollThreshold);
+        }
+
+        // Whatever the heuristics below pick, do not unroll past the factor
+        // predicted to spill.
+        auto capUnrollByPressure = llvm::make_scope_exit([&]() {
+            if (maxSpillFreeCount == UINT_MAX)
+                return;
+            UP.Count = std::min(UP.Count, maxSpillFreeCount);
+            UP.MaxCount = std::min(UP.MaxCount, maxSpillFreeCount);
+            // Fully unrolling loops over private arrays lets them live in
+            // registers, which is worth it even under pressure.
+            if (!UP.Force)
+                UP.FullUnrollMaxCount = std::min(UP.FullUnrollMaxCount, maxSpillFreeCount);
+            if (maxSpillFreeCount <= 1)
+            {
+                UP.Partial = false;
+                UP.Runtime = false;
+            }
+        });
         // For OCL shaders, do a two-step loop unrolling. The first
         // unrolling is simple and full, and the second runs after
         // LICM, which allows partial unrolling. Same for other APIs?
@@ -601,3 +841,8 @@ namespace llvm {
 // Register the basic pass.
 INITIALIZE_PASS(DummyPass, "gen-tti-dummy-pass",
     "Dummy Pass for GenTTIImpl", false, true)
+INITIALIZE_PASS_BEGIN(ResetUnrollFunctionInfo, "gen-tti-reset-unroll-info",
+    "Reset GenTTIImpl loop unroll info", false, true)
+INITIALIZE_PASS_DEPENDENCY(CodeGenContextWrapper)
+INITIALIZE_PASS_END(ResetUnrollFunctionInfo, "gen-tti-reset-unroll-info",
+    "Reset GenTTIImpl loop unroll info", false, true)
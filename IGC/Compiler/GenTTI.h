@@ -24,6 +24,25 @@ namespace llvm
         DummyPass();
     };
 
+    // Drops what GenIntrinsicsTTIImpl caches about a function for the loop
+    // unroll heuristics. Add it right before each loop unroll pass, since the
+    // passes in between may have changed the function.
+    class ResetUnrollFunctionInfo : public FunctionPass
+    {
+    public:
+        static char ID;
+        ResetUnrollFunctionInfo();
+
+        bool runOnFunction(Function& F) override;
+
+        void getAnalysisUsage(AnalysisUsage& AU) const override;
+
+        StringRef getPassName() const override
+        {
+            return "ResetUnrollFunctionInfo";
+        }
+    };
+
     // This implementation allows us to define our own costs for the GenIntrinsics
     // Did not use BasicTTIImplBase because the overloaded constructors have TragetMachine as an argument,
     // so I inherited from its parent which has only DL as its arguments
@@ -34,12 +53,23 @@ namespace llvm
         friend BaseT;
         IGC::CodeGenContext* ctx;
         DummyPass* dummyPass;
+
+        IGC::UnrollFunctionInfo& getUnrollFunctionInfo(Loop* L);
     public:
         GenIntrinsicsTTIImpl(IGC::CodeGenContext* pCtx, DummyPass* pDummyPass) :
             BaseT(pCtx->getModule()->getDataLayout()), ctx(pCtx) {
             dummyPass = pDummyPass;
         }
 
+        // Instruction count of the function containing L, computed once per
+        // function and reused for its other loops until L gets unrolled.
+        unsigned getFunctionInstCount(Loop* L);
+
+        // Largest unroll factor of L whose predicted GRF footprint still
+        // fits in the register file; 1 if even the rolled loop does not.
+        // lowPressure is set if the rolled loop uses at most half of it.
+        unsigned getMaxSpillFreeUnrollCount(Loop* L, bool& lowPressure);
+
         bool shouldBuildLookupTables();
 
         bool isLoweredToCall(const Function* F);
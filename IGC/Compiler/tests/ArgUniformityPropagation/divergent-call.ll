@@ -0,0 +1,55 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2022 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+
+; RUN: igc_opt -GenXCodeGenModule -igc-arg-uniformity-propagation -S < %s | FileCheck %s
+
+; The stack call is reached under a condition on the lane id, so lane 0 may
+; be disabled at the call site. %n is still uniform at every call site and is
+; marked as such: the callee reads it from lane 0, and the caller writes it to
+; all the lanes with NoMask (see EmitPass::emitStackCall). %v depends on the
+; lane and keeps the conservative dependency.
+
+; CHECK: define spir_func i32 @foo(i32 "igc-arg-wi-dep"="{{[0-9]+}}" %n, i32 %v)
+
+define spir_kernel void @test(i32 addrspace(1)* %out, i32 %n) {
+entry:
+  %lane = call i16 @llvm.genx.GenISA.simdLaneId()
+  %lane32 = zext i16 %lane to i32
+  %cond = icmp ugt i32 %lane32, 3
+  br i1 %cond, label %call, label %exit
+
+call:
+  %r = call spir_func i32 @foo(i32 %n, i32 %lane32)
+  %idx = zext i32 %lane32 to i64
+  %p = getelementptr i32, i32 addrspace(1)* %out, i64 %idx
+  store i32 %r, i32 addrspace(1)* %p
+  br label %exit
+
+exit:
+  ret void
+}
+
+define spir_func i32 @foo(i32 %n, i32 %v) #0 {
+entry:
+  %a = mul i32 %n, %n
+  %b = add i32 %a, %v
+  ret i32 %b
+}
+
+declare i16 @llvm.genx.GenISA.simdLaneId()
+
+attributes #0 = { noinline "visaStackCall" }
+
+!igc.functions = !{!0, !3}
+
+!0 = !{void (i32 addrspace(1)*, i32)* @test, !1}
+!1 = !{!2}
+!2 = !{!"function_type", i32 0}
+!3 = !{i32 (i32, i32)* @foo, !4}
+!4 = !{!5}
+!5 = !{!"function_type", i32 2}
@@ -0,0 +1,57 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2022 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+
+; RUN: igc_opt -regkey EnableDivergentAtomicAggregation=1 -opt-atomics-pass -S < %s | FileCheck %s
+
+; An integer atomic add with a per-lane address and an unused result is
+; issued once per distinct address: each loop iteration takes the address of
+; the first remaining lane, reduces the sources of the lanes sharing it, and
+; only the leader lane executes the atomic.
+
+define spir_kernel void @histogram(i32 addrspace(1)* %bins, i32 %v) {
+entry:
+  %lane = call i16 @llvm.genx.GenISA.simdLaneId()
+  %idx = zext i16 %lane to i64
+  %bin = and i64 %idx, 3
+  %p = getelementptr inbounds i32, i32 addrspace(1)* %bins, i64 %bin
+  %old = call i32 @llvm.genx.GenISA.intatomicrawA64.i32.p1i32.p1i32(i32 addrspace(1)* %p, i32 addrspace(1)* %p, i32 %v, i32 0)
+  ret void
+}
+
+; CHECK-LABEL: define spir_kernel void @histogram
+; CHECK:       br label %atomic.aggr.loop
+; CHECK:     atomic.aggr.loop:
+; CHECK:       [[MASK:%.*]] = call i32 @llvm.genx.GenISA.WaveBallot(i1 true, i32 0)
+; CHECK:       [[LEADER:%.*]] = call i32 @llvm.genx.GenISA.firstbitLo(i32 [[MASK]])
+; CHECK:       [[ADDR:%.*]] = ptrtoint i32 addrspace(1)* %p to i64
+; CHECK:       [[LEADADDR:%.*]] = call i64 @llvm.genx.GenISA.WaveShuffleIndex.i64(i64 [[ADDR]], i32 [[LEADER]], i32 0)
+; CHECK:       [[MATCH:%.*]] = icmp eq i64 [[ADDR]], [[LEADADDR]]
+; CHECK:       [[LANE:%.*]] = zext i16 {{%.*}} to i32
+; CHECK:       br i1 [[MATCH]], label %atomic.aggr.partition, label %atomic.aggr.latch
+; CHECK:     atomic.aggr.partition:
+; CHECK-NEXT:  [[SUM:%.*]] = call i32 @llvm.genx.GenISA.WaveAll.i32(i32 %v, i8 0, i32 0)
+; CHECK-NEXT:  [[ISLEADER:%.*]] = icmp eq i32 [[LANE]], [[LEADER]]
+; CHECK-NEXT:  br i1 [[ISLEADER]], label %atomic.aggr.leader, label %atomic.aggr.latch
+; CHECK:     atomic.aggr.leader:
+; CHECK-NEXT:  %old = call i32 @llvm.genx.GenISA.intatomicrawA64.i32.p1i32.p1i32(i32 addrspace(1)* %p, i32 addrspace(1)* %p, i32 [[SUM]], i32 0)
+; CHECK-NEXT:  br label %atomic.aggr.latch
+; CHECK:     atomic.aggr.latch:
+; CHECK-NEXT:  br i1 [[MATCH]], label %atomic.aggr.exit, label %atomic.aggr.loop
+; CHECK:     atomic.aggr.exit:
+; CHECK-NOT:   intatomicrawA64
+; CHECK:       ret void
+
+declare i16 @llvm.genx.GenISA.simdLaneId()
+declare i32 @llvm.genx.GenISA.intatomicrawA64.i32.p1i32.p1i32(i32 addrspace(1)*, i32 addrspace(1)*, i32, i32)
+
+!igc.functions = !{!0}
+
+!0 = !{void (i32 addrspace(1)*, i32)* @histogram, !1}
+!1 = !{!2, !3}
+!2 = !{!"function_type", i32 0}
+!3 = !{!"sub_group_size", i32 16}
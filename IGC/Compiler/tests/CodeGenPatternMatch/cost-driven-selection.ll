@@ -0,0 +1,50 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2022 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+
+; RUN: igc_opt --platformskl -CodeGenPatternMatch -print-pattern-match -S < %s 2>&1 | FileCheck %s --check-prefix=GREEDY
+; RUN: igc_opt --platformskl -regkey EnableCostDrivenPatternMatch=1 -CodeGenPatternMatch -print-pattern-match -S < %s 2>&1 | FileCheck %s --check-prefix=COST
+
+; %r = %x * %s1 + %y * (1 - %x) is the first lrp pattern to match. %m0 is
+; stored as well, so the lrp leaves it to its own instruction. A mad reading
+; %m0 would leave the (1 - %x) subtraction unfolded and need one more
+; instruction than the lrp, so the cost driven selection keeps the lrp and
+; emits no more instructions than the greedy one.
+
+; GREEDY-LABEL: PatternMatch: %entry
+; GREEDY-NEXT:    root: %s1 = fadd float %a, %b
+; GREEDY-NEXT:    root: %m0 = fmul float %x, %s1
+; GREEDY-NEXT:    root: %r = fadd float %m0, %m1
+; GREEDY-NEXT:    root: store float %r, float addrspace(1)* %out
+; GREEDY-NEXT:    root: store float %m0, float addrspace(1)* %out2
+; GREEDY-NEXT:    root: ret void
+
+; COST-LABEL: PatternMatch: %entry
+; COST-NEXT:    root: %s1 = fadd float %a, %b
+; COST-NEXT:    root: %m0 = fmul float %x, %s1
+; COST-NEXT:    root: %r = fadd float %m0, %m1
+; COST-NEXT:    root: store float %r, float addrspace(1)* %out
+; COST-NEXT:    root: store float %m0, float addrspace(1)* %out2
+; COST-NEXT:    root: ret void
+
+define spir_kernel void @test_lrp(float addrspace(1)* %out, float addrspace(1)* %out2, float %x, float %y, float %a, float %b) {
+entry:
+  %s1 = fadd float %a, %b
+  %m0 = fmul float %x, %s1
+  %sub = fsub float 1.000000e+00, %x
+  %m1 = fmul float %y, %sub
+  %r = fadd float %m0, %m1
+  store float %r, float addrspace(1)* %out
+  store float %m0, float addrspace(1)* %out2
+  ret void
+}
+
+!igc.functions = !{!0}
+
+!0 = !{void (float addrspace(1)*, float addrspace(1)*, float, float, float, float)* @test_lrp, !1}
+!1 = !{!2}
+!2 = !{!"function_type", i32 0}
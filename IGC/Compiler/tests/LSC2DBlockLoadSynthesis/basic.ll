@@ -0,0 +1,52 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2022 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+
+; RUN: igc_opt --platformpvc -igc-lsc-2d-block-load-synthesis -S < %s | FileCheck %s
+
+; Four rows of 16 floats, 256 bytes apart, read one element per lane.
+
+define spir_kernel void @tile(float addrspace(1)* %a, float addrspace(1)* %dst) {
+entry:
+  %lane = call i16 @llvm.genx.GenISA.simdLaneId()
+  %col = zext i16 %lane to i64
+  %p0 = getelementptr inbounds float, float addrspace(1)* %a, i64 %col
+  %v0 = load float, float addrspace(1)* %p0, align 4
+  %p1 = getelementptr inbounds float, float addrspace(1)* %p0, i64 64
+  %v1 = load float, float addrspace(1)* %p1, align 4
+  %p2 = getelementptr inbounds float, float addrspace(1)* %p0, i64 128
+  %v2 = load float, float addrspace(1)* %p2, align 4
+  %p3 = getelementptr inbounds float, float addrspace(1)* %p0, i64 192
+  %v3 = load float, float addrspace(1)* %p3, align 4
+  %s0 = fadd float %v0, %v1
+  %s1 = fadd float %v2, %v3
+  %s = fadd float %s0, %s1
+  %q = getelementptr inbounds float, float addrspace(1)* %dst, i64 %col
+  store float %s, float addrspace(1)* %q, align 4
+  ret void
+}
+
+; CHECK-LABEL: define spir_kernel void @tile
+; CHECK: [[ADDR:%.*]] = ptrtoint float addrspace(1)* {{%.*}} to i64
+; CHECK: [[BASE:%.*]] = and i64 [[ADDR]], -64
+; CHECK: [[BLK:%.*]] = call <4 x i32> @llvm.genx.GenISA.LSC2DBlockRead.v4i32(i64 [[BASE]], i32 255, i32 3, i32 255, i32 {{%.*}}, i32 0, i32 32, i32 16, i32 4, i32 1, i1 false, i1 false)
+; CHECK: extractelement <4 x i32> [[BLK]], i32 0
+; CHECK: extractelement <4 x i32> [[BLK]], i32 1
+; CHECK: extractelement <4 x i32> [[BLK]], i32 2
+; CHECK: extractelement <4 x i32> [[BLK]], i32 3
+; CHECK-NOT: load float
+; CHECK: ret void
+
+declare i16 @llvm.genx.GenISA.simdLaneId()
+
+!igc.functions = !{!0}
+
+!0 = !{void (float addrspace(1)*, float addrspace(1)*)* @tile, !1}
+!1 = !{!2, !3, !4}
+!2 = !{!"function_type", i32 0}
+!3 = !{!"sub_group_size", i32 16}
+!4 = !{!"thread_group_size", i32 16, i32 1, i32 1}
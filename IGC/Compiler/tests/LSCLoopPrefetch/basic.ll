@@ -0,0 +1,48 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2022 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+
+; RUN: igc_opt --platformdg2 -regkey LSCLoopPrefetchLatency=88 -regkey LSCLoopPrefetchMaxDistance=4 -igc-lsc-loop-prefetch -S < %s | FileCheck %s
+
+; The loop body is 11 instructions, so 88 cycles of latency need 4
+; iterations of look-ahead: 4 * 4 bytes for %src. The second load is on the
+; same cache line and doesn't get its own prefetch.
+
+define spir_kernel void @stream(float addrspace(1)* %src, float addrspace(1)* %dst, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %p = getelementptr inbounds float, float addrspace(1)* %src, i32 %i
+  %v = load float, float addrspace(1)* %p, align 4
+  %p1 = getelementptr inbounds float, float addrspace(1)* %p, i32 1
+  %v1 = load float, float addrspace(1)* %p1, align 4
+  %s = fadd float %v, %v1
+  %q = getelementptr inbounds float, float addrspace(1)* %dst, i32 %i
+  store float %s, float addrspace(1)* %q, align 4
+  %i.next = add nuw nsw i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+; CHECK-LABEL: define spir_kernel void @stream
+; CHECK: [[P8:%.*]] = bitcast float addrspace(1)* %p to i8 addrspace(1)*
+; CHECK: [[PF:%.*]] = getelementptr i8, i8 addrspace(1)* [[P8]], i{{[0-9]+}} 16
+; CHECK: call void @llvm.genx.GenISA.LSCPrefetch.p1i8(i8 addrspace(1)* [[PF]], i32 0, i32 3, i32 1, i32 4)
+; CHECK-NEXT: %v = load float
+; CHECK-NOT: LSCPrefetch
+; CHECK: ret void
+
+!igc.functions = !{!0}
+
+!0 = !{void (float addrspace(1)*, float addrspace(1)*, i32)* @stream, !1}
+!1 = !{!2}
+!2 = !{!"function_type", i32 0}
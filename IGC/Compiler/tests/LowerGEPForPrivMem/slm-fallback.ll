@@ -0,0 +1,53 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2022 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+;
+; RUN: igc_opt -regkey EnablePrivateMemoryToSLMFallback=1 -igc-priv-mem-to-reg -S < %s | FileCheck %s
+; ------------------------------------------------
+; LowerGEPForPrivMem: arrays too large for GRF are given a slice of SLM per
+; work-item instead of going to scratch.
+; ------------------------------------------------
+
+; CHECK: @test_fallback.arr = {{.*}}addrspace(3) global [2 x [256 x i32]] undef, section "localSLM"
+
+define spir_kernel void @test_fallback(i32 addrspace(1)* %dst, <8 x i32> %r0, <8 x i32> %payloadHeader, i16 %localIdX, i16 %localIdY, i16 %localIdZ, i8* %privateBase, i32 %bufferOffset) {
+; CHECK-LABEL: @test_fallback(
+; CHECK-NOT:    alloca
+; CHECK:        [[SLICE:%.*]] = getelementptr inbounds [2 x [256 x i32]], [2 x [256 x i32]] addrspace(3)* @test_fallback.arr, i32 0, i32 {{%.*}}
+; CHECK:        [[P:%.*]] = getelementptr inbounds [256 x i32], [256 x i32] addrspace(3)* [[SLICE]], i32 0, i32 [[IDX:%.*]]
+; CHECK:        store i32 1, i32 addrspace(3)* [[P]], align 4
+; CHECK:        [[Q:%.*]] = getelementptr inbounds [256 x i32], [256 x i32] addrspace(3)* [[SLICE]], i32 0, i32 3
+; CHECK:        [[V:%.*]] = load i32, i32 addrspace(3)* [[Q]], align 4
+; CHECK:        store i32 [[V]], i32 addrspace(1)* %dst, align 4
+; CHECK:        ret void
+;
+entry:
+  %arr = alloca [256 x i32], align 4
+  %idx = zext i16 %localIdX to i32
+  %p = getelementptr inbounds [256 x i32], [256 x i32]* %arr, i32 0, i32 %idx
+  store i32 1, i32* %p, align 4
+  %q = getelementptr inbounds [256 x i32], [256 x i32]* %arr, i32 0, i32 3
+  %v = load i32, i32* %q, align 4
+  store i32 %v, i32 addrspace(1)* %dst, align 4
+  ret void
+}
+
+!igc.functions = !{!0}
+
+!0 = !{void (i32 addrspace(1)*, <8 x i32>, <8 x i32>, i16, i16, i16, i8*, i32)* @test_fallback, !1}
+!1 = !{!2, !3, !12}
+!2 = !{!"function_type", i32 0}
+!3 = !{!"implicit_arg_desc", !4, !5, !6, !7, !8, !9, !10}
+!4 = !{i32 0}
+!5 = !{i32 1}
+!6 = !{i32 7}
+!7 = !{i32 8}
+!8 = !{i32 9}
+!9 = !{i32 12}
+!10 = !{i32 14, !11}
+!11 = !{!"explicit_arg_num", i32 0}
+!12 = !{!"thread_group_size", i32 2, i32 1, i32 1}
@@ -0,0 +1,67 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2022 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+
+; RUN: igc_opt %s -S -o - %enable-basic-aa% -regkey EnableMemOptCrossBlock=1 -igc-memopt -instcombine | FileCheck %s
+
+target datalayout = "e-p:32:32:32-i1:8:8-i8:8:8-i16:16:16-i32:32:32-i64:64:64-f16:16:16-f32:32:32-f64:64:64-f80:128:128-v16:16:16-v24:32:32-v32:32:32-v48:64:64-v64:64:64-v96:128:128-v128:128:128-v192:256:256-v256:256:256-v512:512:512-v1024:1024:1024-a:64:64-f80:128:128-n8:16:32:64"
+
+; Loads split across control-equivalent blocks are gathered and merged.
+define void @f0(i32* noalias %dst, i32* noalias %src, i1 %c) {
+entry:
+  %0 = load i32, i32* %src, align 4
+  br i1 %c, label %then, label %join
+
+then:
+  store i32 0, i32* %dst, align 4
+  br label %join
+
+join:
+  %arrayidx1 = getelementptr inbounds i32, i32* %src, i64 1
+  %1 = load i32, i32* %arrayidx1, align 4
+  %add = add i32 %0, %1
+  %arrayidx2 = getelementptr inbounds i32, i32* %dst, i64 4
+  store i32 %add, i32* %arrayidx2, align 4
+  ret void
+}
+
+; CHECK-LABEL: define void @f0
+; CHECK: entry:
+; CHECK: load <2 x i32>
+; CHECK: br i1 %c
+
+; The store in %then may alias, so the load must stay where it is.
+define void @f1(i32* %dst, i32* %src, i1 %c) {
+entry:
+  %0 = load i32, i32* %src, align 4
+  br i1 %c, label %then, label %join
+
+then:
+  store i32 0, i32* %dst, align 4
+  br label %join
+
+join:
+  %arrayidx1 = getelementptr inbounds i32, i32* %src, i64 1
+  %1 = load i32, i32* %arrayidx1, align 4
+  %add = add i32 %0, %1
+  store i32 %add, i32* %dst, align 4
+  ret void
+}
+
+; CHECK-LABEL: define void @f1
+; CHECK: entry:
+; CHECK-NOT: load <2 x i32>
+; CHECK: join:
+; CHECK: load i32
+
+!igc.functions = !{!0, !3}
+
+!0 = !{void (i32*, i32*, i1)* @f0, !1}
+!3 = !{void (i32*, i32*, i1)* @f1, !1}
+
+!1 = !{!2}
+!2 = !{!"function_type", i32 0}
@@ -0,0 +1,89 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2022 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+
+; RUN: igc_opt --platformdg2 -regkey PressureCodeMotionSimdSize=32 -igc-pressure-code-motion -S < %s | FileCheck %s
+
+; %s is only used at the end of the kernel. In @high, the four <8 x float>
+; values loaded in between take the pressure over the GRF budget at SIMD32,
+; and %s is sunk next to its use. In @low, the same code with <2 x float>
+; values fits the budget and nothing is moved.
+
+; CHECK-LABEL: define spir_kernel void @high
+; CHECK:       %v3 = load <8 x float>
+; CHECK:       store <8 x float> %v3
+; CHECK-NEXT:  %s = fmul float %x, 2.000000e+00
+; CHECK-NEXT:  %r = fadd float %s, %x
+
+define spir_kernel void @high(float addrspace(1)* %in, <8 x float> addrspace(1)* %vin, <8 x float> addrspace(1)* %out0, <8 x float> addrspace(1)* %out1, <8 x float> addrspace(1)* %out2, <8 x float> addrspace(1)* %out3, float addrspace(1)* %out) {
+entry:
+  %lane = call i16 @llvm.genx.GenISA.simdLaneId()
+  %idx = zext i16 %lane to i64
+  %px = getelementptr float, float addrspace(1)* %in, i64 %idx
+  %x = load float, float addrspace(1)* %px
+  %s = fmul float %x, 2.000000e+00
+  %p0 = getelementptr <8 x float>, <8 x float> addrspace(1)* %vin, i64 %idx
+  %v0 = load <8 x float>, <8 x float> addrspace(1)* %p0
+  %i1 = add i64 %idx, 32
+  %p1 = getelementptr <8 x float>, <8 x float> addrspace(1)* %vin, i64 %i1
+  %v1 = load <8 x float>, <8 x float> addrspace(1)* %p1
+  %i2 = add i64 %idx, 64
+  %p2 = getelementptr <8 x float>, <8 x float> addrspace(1)* %vin, i64 %i2
+  %v2 = load <8 x float>, <8 x float> addrspace(1)* %p2
+  %i3 = add i64 %idx, 96
+  %p3 = getelementptr <8 x float>, <8 x float> addrspace(1)* %vin, i64 %i3
+  %v3 = load <8 x float>, <8 x float> addrspace(1)* %p3
+  store <8 x float> %v0, <8 x float> addrspace(1)* %out0
+  store <8 x float> %v1, <8 x float> addrspace(1)* %out1
+  store <8 x float> %v2, <8 x float> addrspace(1)* %out2
+  store <8 x float> %v3, <8 x float> addrspace(1)* %out3
+  %r = fadd float %s, %x
+  store float %r, float addrspace(1)* %out
+  ret void
+}
+
+; CHECK-LABEL: define spir_kernel void @low
+; CHECK:       %x = load float
+; CHECK-NEXT:  %s = fmul float %x, 2.000000e+00
+; CHECK:       store <2 x float> %v3
+; CHECK-NEXT:  %r = fadd float %s, %x
+
+define spir_kernel void @low(float addrspace(1)* %in, <2 x float> addrspace(1)* %vin, <2 x float> addrspace(1)* %out0, <2 x float> addrspace(1)* %out1, <2 x float> addrspace(1)* %out2, <2 x float> addrspace(1)* %out3, float addrspace(1)* %out) {
+entry:
+  %lane = call i16 @llvm.genx.GenISA.simdLaneId()
+  %idx = zext i16 %lane to i64
+  %px = getelementptr float, float addrspace(1)* %in, i64 %idx
+  %x = load float, float addrspace(1)* %px
+  %s = fmul float %x, 2.000000e+00
+  %p0 = getelementptr <2 x float>, <2 x float> addrspace(1)* %vin, i64 %idx
+  %v0 = load <2 x float>, <2 x float> addrspace(1)* %p0
+  %i1 = add i64 %idx, 32
+  %p1 = getelementptr <2 x float>, <2 x float> addrspace(1)* %vin, i64 %i1
+  %v1 = load <2 x float>, <2 x float> addrspace(1)* %p1
+  %i2 = add i64 %idx, 64
+  %p2 = getelementptr <2 x float>, <2 x float> addrspace(1)* %vin, i64 %i2
+  %v2 = load <2 x float>, <2 x float> addrspace(1)* %p2
+  %i3 = add i64 %idx, 96
+  %p3 = getelementptr <2 x float>, <2 x float> addrspace(1)* %vin, i64 %i3
+  %v3 = load <2 x float>, <2 x float> addrspace(1)* %p3
+  store <2 x float> %v0, <2 x float> addrspace(1)* %out0
+  store <2 x float> %v1, <2 x float> addrspace(1)* %out1
+  store <2 x float> %v2, <2 x float> addrspace(1)* %out2
+  store <2 x float> %v3, <2 x float> addrspace(1)* %out3
+  %r = fadd float %s, %x
+  store float %r, float addrspace(1)* %out
+  ret void
+}
+
+declare i16 @llvm.genx.GenISA.simdLaneId()
+
+!igc.functions = !{!0, !3}
+
+!0 = !{void (float addrspace(1)*, <8 x float> addrspace(1)*, <8 x float> addrspace(1)*, <8 x float> addrspace(1)*, <8 x float> addrspace(1)*, <8 x float> addrspace(1)*, float addrspace(1)*)* @high, !1}
+!1 = !{!2}
+!2 = !{!"function_type", i32 0}
+!3 = !{void (float addrspace(1)*, <2 x float> addrspace(1)*, <2 x float> addrspace(1)*, <2 x float> addrspace(1)*, <2 x float> addrspace(1)*, <2 x float> addrspace(1)*, float addrspace(1)*)* @low, !1}
@@ -0,0 +1,66 @@
+;=========================== begin_copyright_notice ============================
+;
+; Copyright (C) 2022 Intel Corporation
+;
+; SPDX-License-Identifier: MIT
+;
+;============================ end_copyright_notice =============================
+; REQUIRES: regkeys
+;
+; RUN: igc_opt -tracerayinline-latency-scheduler-pass -S < %s 2>&1 | FileCheck %s
+; RUN: igc_opt -regkey SuspendCrossingSparseThreshold=0 -regkey VerifySuspendCrossingInfo=1 -tracerayinline-latency-scheduler-pass -S < %s 2>&1 | FileCheck %s
+; ------------------------------------------------
+; TraceRayInlineLatencySchedulerPass
+; ------------------------------------------------
+
+; SyncStackToShadowMemory is sunk as far as no suspend point is crossed.
+; The dense and the sparse suspend crossing analysis have to agree on that,
+; which VerifySuspendCrossingInfo checks for every query.
+
+define void @sinks(i32 addrspace(1)* %out) {
+; CHECK-LABEL: @sinks(
+; CHECK:       bb1:
+; CHECK-NEXT:    store i32 1, i32 addrspace(1)* %out
+; CHECK-NEXT:    call i1 @llvm.genx.GenISA.SyncStackToShadowMemory(i32 0, i32 %p)
+; CHECK-NEXT:    br label
+; CHECK:         call void @opaque()
+entry:
+  %p = call i32 @llvm.genx.GenISA.TraceRaySyncProceed(i32 0)
+  %s = call i1 @llvm.genx.GenISA.SyncStackToShadowMemory(i32 0, i32 %p)
+  br label %bb1
+
+bb1:
+  store i32 1, i32 addrspace(1)* %out
+  br label %bb2
+
+bb2:
+  call void @opaque()
+  ret void
+}
+
+; The join block post-dominates the sync, but one path to it goes through
+; a suspend point, so the sync stays where it is.
+define void @crossing(i32 addrspace(1)* %out, i1 %c) {
+; CHECK-LABEL: @crossing(
+; CHECK:         call i1 @llvm.genx.GenISA.SyncStackToShadowMemory(i32 0, i32 %p)
+; CHECK-NEXT:    br i1 %c
+; CHECK:       join:
+; CHECK-NEXT:    store i32 1, i32 addrspace(1)* %out
+; CHECK-NEXT:    ret void
+entry:
+  %p = call i32 @llvm.genx.GenISA.TraceRaySyncProceed(i32 0)
+  %s = call i1 @llvm.genx.GenISA.SyncStackToShadowMemory(i32 0, i32 %p)
+  br i1 %c, label %then, label %join
+
+then:
+  call void @opaque()
+  br label %join
+
+join:
+  store i32 1, i32 addrspace(1)* %out
+  ret void
+}
+
+declare void @opaque()
+declare i32 @llvm.genx.GenISA.TraceRaySyncProceed(i32)
+declare i1 @llvm.genx.GenISA.SyncStackToShadowMemory(i32, i32)
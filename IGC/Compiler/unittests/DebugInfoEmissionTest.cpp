@@ -0,0 +1,427 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "DebugInfo/DwarfDebug.hpp"
+#include "DebugInfo/VISADebugDecoder.hpp"
+#include "DebugInfo/EmitterOpts.hpp"
+#include "DebugInfo/VISADebugInfo.hpp"
+#include "DebugInfo/VISAIDebugEmitter.hpp"
+#include "DebugInfo/VISAModule.hpp"
+
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/IntrinsicInst.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/Support/Parallel.h"
+#include "llvm/Support/SourceMgr.h"
+#include "common/LLVMWarningsPop.hpp"
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+using namespace IGC;
+
+namespace {
+
+constexpr unsigned NumKernels = 8;
+// every instruction is emitted as a single 16-byte Gen instruction
+constexpr unsigned GenInstSize = 16;
+
+// Kernels with line info only, all of them share the compile unit and the
+// LLVMContext like the kernels of a single compilation do.
+std::string getTestIR() {
+    std::string IR =
+        "target datalayout = \"e-p:64:64-i64:64-n8:16:32:64\"\n"
+        "target triple = \"spir64-unknown-unknown\"\n";
+    for (unsigned K = 0; K != NumKernels; ++K) {
+        std::string N = std::to_string(K);
+        std::string SP = std::to_string(K + 10);
+        IR += "define spir_kernel void @k" + N + "(i32 %x) !dbg !" + SP + " {\n"
+              "entry:\n"
+              "  %a = add i32 %x, " + N + ", !dbg !DILocation(line: " +
+              std::to_string(K * 10 + 2) + ", column: 3, scope: !" + SP + ")\n"
+              "  %b = mul i32 %a, %x, !dbg !DILocation(line: " +
+              std::to_string(K * 10 + 3) + ", column: 5, scope: !" + SP + ")\n"
+              "  ret void, !dbg !DILocation(line: " +
+              std::to_string(K * 10 + 4) + ", column: 1, scope: !" + SP + ")\n"
+              "}\n";
+    }
+    IR += "!llvm.dbg.cu = !{!0}\n"
+          "!llvm.module.flags = !{!3, !4}\n"
+          "!0 = distinct !DICompileUnit(language: DW_LANG_OpenCL, file: !1, "
+          "producer: \"test\", isOptimized: false, emissionKind: FullDebug)\n"
+          "!1 = !DIFile(filename: \"test.cl\", directory: \"/tmp\")\n"
+          "!2 = !DISubroutineType(types: !{null})\n"
+          "!3 = !{i32 2, !\"Dwarf Version\", i32 4}\n"
+          "!4 = !{i32 2, !\"Debug Info Version\", i32 3}\n";
+    for (unsigned K = 0; K != NumKernels; ++K)
+        IR += "!" + std::to_string(K + 10) + " = distinct !DISubprogram(name: \"k" +
+              std::to_string(K) + "\", scope: !1, file: !1, line: " +
+              std::to_string(K * 10 + 1) + ", type: !2, scopeLine: " +
+              std::to_string(K * 10 + 1) +
+              ", spFlags: DISPFlagDefinition, unit: !0)\n";
+    return IR;
+}
+
+// Kernel where each of the variables a0..aN takes the constant 1 and then
+// the constant 2, so all of them get identical location lists.
+std::string getLocListIR(unsigned DwarfVersion, unsigned NumVars) {
+    std::string IR =
+        "target datalayout = \"e-p:64:64-i64:64-n8:16:32:64\"\n"
+        "target triple = \"spir64-unknown-unknown\"\n"
+        "define spir_kernel void @k(i32 %x) !dbg !10 {\n"
+        "entry:\n";
+    auto dbgValues = [NumVars](unsigned Value, unsigned Line) {
+        std::string Res;
+        for (unsigned V = 0; V != NumVars; ++V)
+            Res += "  call void @llvm.dbg.value(metadata i32 " +
+                   std::to_string(Value) + ", metadata !" +
+                   std::to_string(V + 20) + ", metadata !DIExpression())"
+                   ", !dbg !DILocation(line: " + std::to_string(Line) +
+                   ", scope: !10)\n";
+        return Res;
+    };
+    IR += dbgValues(1, 2);
+    IR += "  %a = add i32 %x, 1, !dbg !DILocation(line: 2, scope: !10)\n"
+          "  %b = add i32 %a, %x, !dbg !DILocation(line: 2, scope: !10)\n";
+    IR += dbgValues(2, 3);
+    IR += "  %c = mul i32 %b, %x, !dbg !DILocation(line: 3, scope: !10)\n"
+          "  %d = mul i32 %c, %x, !dbg !DILocation(line: 3, scope: !10)\n"
+          "  ret void, !dbg !DILocation(line: 4, scope: !10)\n"
+          "}\n"
+          "declare void @llvm.dbg.value(metadata, metadata, metadata)\n"
+          "!llvm.dbg.cu = !{!0}\n"
+          "!llvm.module.flags = !{!3, !4}\n"
+          "!0 = distinct !DICompileUnit(language: DW_LANG_OpenCL, file: !1, "
+          "producer: \"test\", isOptimized: true, emissionKind: FullDebug)\n"
+          "!1 = !DIFile(filename: \"test.cl\", directory: \"/tmp\")\n"
+          "!2 = !DISubroutineType(types: !{null})\n"
+          "!3 = !{i32 2, !\"Dwarf Version\", i32 " +
+          std::to_string(DwarfVersion) + "}\n"
+          "!4 = !{i32 2, !\"Debug Info Version\", i32 3}\n"
+          "!5 = !DIBasicType(name: \"int\", size: 32, encoding: DW_ATE_signed)\n"
+          "!10 = distinct !DISubprogram(name: \"k\", scope: !1, file: !1, "
+          "line: 1, type: !2, scopeLine: 1, spFlags: DISPFlagDefinition, "
+          "unit: !0)\n";
+    for (unsigned V = 0; V != NumVars; ++V)
+        IR += "!" + std::to_string(V + 20) +
+              " = !DILocalVariable(name: \"a" + std::to_string(V) +
+              "\", scope: !10, file: !1, line: 2, type: !5)\n";
+    return IR;
+}
+
+// VISA object of a kernel where each instruction except the debug
+// intrinsics is lowered to one vISA instruction and one Gen instruction.
+class TestVISAModule : public VISAModule {
+public:
+    TestVISAModule(Function* F, unsigned NumInsts)
+        : VISAModule(F, true), GenBinary(NumInsts * GenInstSize, 0) {
+        SetType(ObjectType::KERNEL);
+    }
+
+    // Simulates vISA code emission of a single instruction.
+    void emitVISAInst() { ++VISAInstCount; }
+
+    VISAVariableLocation
+    GetVariableLocation(const Instruction* pInst) const override {
+        if (auto* DbgValue = dyn_cast<DbgValueInst>(pInst))
+            if (auto* C = dyn_cast_or_null<Constant>(DbgValue->getValue()))
+                return VISAVariableLocation(C, this);
+        return VISAVariableLocation(this);
+    }
+    void UpdateVisaId() override { SetVISAId(VISAInstCount); }
+    void ValidateVisaId() override {
+        ASSERT_EQ(GetCurrentVISAId(), VISAInstCount);
+    }
+    uint16_t GetSIMDSize() const override { return 16; }
+    unsigned getUnpaddedProgramSize() const override { return GenBinary.size(); }
+    bool isLineTableOnly() const override { return false; }
+    unsigned getPrivateBaseReg() const override { return 0; }
+    unsigned getGRFSizeInBytes() const override { return 32; }
+    unsigned getNumGRFs() const override { return 128; }
+    unsigned getPointerSize() const override { return 8; }
+    uint64_t getTypeSizeInBits(Type* Ty) const override {
+        return GetModule()->getDataLayout().getTypeSizeInBits(Ty);
+    }
+    void* getPrivateBase() const override { return nullptr; }
+    void setPrivateBase(void*) override {}
+    bool hasPTO() const override { return false; }
+    int getPTOReg() const override { return -1; }
+    int getFPReg() const override { return -1; }
+    uint64_t getFPOffset() const override { return 0; }
+    bool usesSlot1ScratchSpill() const override { return false; }
+    ArrayRef<char> getGenDebug() const override { return {}; }
+    ArrayRef<char> getGenBinary() const override { return GenBinary; }
+    StringRef GetVISAFuncName() const override {
+        return GetEntryFunction()->getName();
+    }
+
+private:
+    std::vector<char> GenBinary;
+    unsigned VISAInstCount = 0;
+};
+
+unsigned getNumGenInsts(const Function& F) {
+    return std::count_if(inst_begin(F), inst_end(F), [](const Instruction& I) {
+        return !isa<DbgInfoIntrinsic>(I);
+    });
+}
+
+// An interval of a variable or of the frame pointer, allocated to a GRF.
+struct RawInterval {
+    uint32_t Start;
+    uint32_t End;
+    uint16_t Reg;
+};
+
+// vISA debug info of a kernel. vISA instruction I + 1 is the Gen instruction
+// at GenOffsets[I].
+struct RawObject {
+    std::string Name;
+    std::vector<uint32_t> GenOffsets;
+    // vISA index intervals of the variable V1
+    std::vector<RawInterval> VarLRs;
+    // Gen offset intervals of the frame pointer
+    std::vector<RawInterval> BEFP;
+};
+
+// Raw vISA debug info of a kernel as decoded by DbgDecoder.
+std::vector<char> getRawVISADebugInfo(const RawObject& Obj) {
+    std::vector<char> Raw;
+    auto write = [&Raw](auto Value) {
+        const char* P = reinterpret_cast<const char*>(&Value);
+        Raw.insert(Raw.end(), P, P + sizeof(Value));
+    };
+    auto writeGRF = [&write](uint16_t Reg) {
+        write(uint8_t(DbgDecoder::VarAlloc::VirTypeGRF));
+        write(uint8_t(DbgDecoder::VarAlloc::PhyTypeGRF));
+        write(Reg);
+        write(uint16_t(0));
+    };
+    write(uint32_t(0xdeadd010)); // magic
+    write(uint16_t(1));          // compiled objects
+    write(uint16_t(Obj.Name.size()));
+    Raw.insert(Raw.end(), Obj.Name.begin(), Obj.Name.end());
+    write(uint32_t(0)); // reloc offset
+    write(uint32_t(0)); // vISA offsets
+    write(uint32_t(Obj.GenOffsets.size()));
+    for (unsigned I = 0; I != Obj.GenOffsets.size(); ++I) {
+        write(uint32_t(I + 1));
+        write(Obj.GenOffsets[I]);
+    }
+    write(uint32_t(Obj.VarLRs.empty() ? 0 : 1)); // variables
+    if (!Obj.VarLRs.empty()) {
+        write(uint16_t(2));
+        Raw.push_back('V');
+        Raw.push_back('1');
+        write(uint16_t(Obj.VarLRs.size()));
+        for (auto& LR : Obj.VarLRs) {
+            write(uint16_t(LR.Start));
+            write(uint16_t(LR.End));
+            writeGRF(LR.Reg);
+        }
+    }
+    write(uint16_t(0)); // subroutines
+    write(uint16_t(0)); // frame size
+    write(uint8_t(!Obj.BEFP.empty()));
+    if (!Obj.BEFP.empty()) {
+        write(uint16_t(Obj.BEFP.size()));
+        for (auto& LR : Obj.BEFP) {
+            write(LR.Start);
+            write(LR.End);
+            writeGRF(LR.Reg);
+        }
+    }
+    write(uint8_t(0));  // caller befp
+    write(uint8_t(0));  // return address
+    write(uint16_t(0)); // callee save entries
+    write(uint16_t(0)); // caller save entries
+    return Raw;
+}
+
+std::vector<char> getRawVISADebugInfo(const Function& F) {
+    RawObject Obj;
+    Obj.Name = F.getName().str();
+    for (unsigned I = 0, E = getNumGenInsts(F); I != E; ++I)
+        Obj.GenOffsets.push_back(I * GenInstSize);
+    return getRawVISADebugInfo(Obj);
+}
+
+// Emits the debug info of a kernel with its own emitter, as DebugInfoPass
+// does for a compiled shader.
+std::vector<char> emitDebugInfo(Function& F, DwarfDISubprogramCache& DISPCache,
+                                const std::vector<char>& RawDebugInfo) {
+    auto VM = std::make_unique<TestVISAModule>(&F, getNumGenInsts(F));
+    TestVISAModule* pVM = VM.get();
+
+    IDebugEmitter* Emitter = IDebugEmitter::Create();
+    DebugEmitterOpts Opts;
+    Opts.DebugEnabled = true;
+    Opts.EmitDebugLoc = true;
+    Emitter->Initialize(std::move(VM), Opts);
+    Emitter->SetDISPCache(&DISPCache);
+    Emitter->EndEncodingMark();
+    for (auto& I : instructions(F)) {
+        Emitter->BeginInstruction(&I);
+        Emitter->BeginEncodingMark();
+        if (!isa<DbgInfoIntrinsic>(I))
+            pVM->emitVISAInst();
+        Emitter->EndEncodingMark();
+        Emitter->EndInstruction(&I);
+    }
+
+    VISADebugInfo VDI(RawDebugInfo.data());
+    std::vector<char> Result = Emitter->Finalize(true, VDI);
+    IDebugEmitter::Release(Emitter);
+    return Result;
+}
+
+class DebugInfoEmissionTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        SMDiagnostic Err;
+        M = parseAssemblyString(getTestIR(), Err, C);
+        ASSERT_TRUE(M) << Err.getMessage().str();
+        for (auto& F : *M)
+            RawDebugInfo.push_back(getRawVISADebugInfo(F));
+    }
+
+    std::vector<std::vector<char>> emitAll(bool Parallel) {
+        std::vector<Function*> Kernels;
+        for (auto& F : *M)
+            Kernels.push_back(&F);
+
+        DwarfDISubprogramCache DISPCache;
+        std::vector<std::vector<char>> Result(Kernels.size());
+        auto emit = [&](Function* F) {
+            unsigned Idx = std::distance(
+                Kernels.begin(), llvm::find(Kernels, F));
+            Result[Idx] = emitDebugInfo(*F, DISPCache, RawDebugInfo[Idx]);
+        };
+
+        if (Parallel)
+            llvm::parallelForEach(Kernels.begin(), Kernels.end(), emit);
+        else
+            std::for_each(Kernels.begin(), Kernels.end(), emit);
+        return Result;
+    }
+
+    LLVMContext C;
+    std::unique_ptr<Module> M;
+    std::vector<std::vector<char>> RawDebugInfo;
+};
+
+// Returns the contents of the section Name of the ELF emitted for a kernel.
+std::string getSection(const std::vector<char>& ELF, StringRef Name) {
+    MemoryBufferRef Buffer(StringRef(ELF.data(), ELF.size()), "");
+    auto ObjOrErr = object::ObjectFile::createELFObjectFile(Buffer);
+    if (!ObjOrErr) {
+        consumeError(ObjOrErr.takeError());
+        return {};
+    }
+    for (const auto& Section : (*ObjOrErr)->sections()) {
+        auto SectionName = Section.getName();
+        if (!SectionName || *SectionName != Name)
+            continue;
+        auto Contents = Section.getContents();
+        return Contents ? Contents->str() : std::string();
+    }
+    return {};
+}
+
+// Emits the debug info of the kernel of getLocListIR and returns its
+// location list section.
+std::string emitLocLists(unsigned DwarfVersion, unsigned NumVars) {
+    LLVMContext C;
+    SMDiagnostic Err;
+    auto M = parseAssemblyString(getLocListIR(DwarfVersion, NumVars), Err, C);
+    if (!M)
+        return {};
+    Function& F = *M->getFunction("k");
+    DwarfDISubprogramCache DISPCache;
+    auto ELF = emitDebugInfo(F, DISPCache, getRawVISADebugInfo(F));
+    return getSection(ELF, DwarfVersion >= 5 ? ".debug_loclists" : ".debug_loc");
+}
+
+} // namespace
+
+TEST_F(DebugInfoEmissionTest, ParallelEmissionMatchesSerial) {
+    auto Serial = emitAll(false);
+    auto Parallel = emitAll(true);
+
+    ASSERT_EQ(Serial.size(), NumKernels);
+    ASSERT_EQ(Parallel.size(), NumKernels);
+    for (unsigned K = 0; K != NumKernels; ++K) {
+        EXPECT_FALSE(Serial[K].empty()) << "kernel k" << K;
+        EXPECT_EQ(Serial[K], Parallel[K]) << "kernel k" << K;
+    }
+}
+
+// Gen ISA intervals end at the offset of their last instruction, adjacent
+// intervals are merged only when nothing lies in between, whatever the size
+// of the instructions is.
+TEST(DbgDecoderTest, CoalescesAdjacentIntervals) {
+    RawObject Obj;
+    Obj.Name = "k";
+    Obj.GenOffsets = { 0, 16, 24, 32, 48 };
+    Obj.VarLRs = { { 1, 3, 10 }, { 4, 6, 10 }, { 8, 9, 10 }, { 10, 12, 11 } };
+    Obj.BEFP = { { 0, 16, 1 }, { 24, 24, 1 }, { 48, 48, 1 } };
+    auto Raw = getRawVISADebugInfo(Obj);
+
+    DbgDecoder Decoder(Raw.data());
+    ASSERT_EQ(Decoder.compiledObjs.size(), 1u);
+    const auto& Decoded = Decoder.compiledObjs.front();
+
+    ASSERT_EQ(Decoded.Vars.size(), 1u);
+    const auto& LRs = Decoded.Vars.front().lrs;
+    ASSERT_EQ(LRs.size(), 3u);
+    EXPECT_EQ(LRs[0].start, 1);
+    EXPECT_EQ(LRs[0].end, 6);
+    EXPECT_EQ(LRs[1].start, 8);
+    EXPECT_EQ(LRs[1].end, 9);
+    EXPECT_EQ(LRs[2].start, 10);
+    EXPECT_EQ(LRs[2].end, 12);
+    EXPECT_EQ(LRs[2].getGRF().regNum, 11);
+
+    const auto& BEFP = Decoded.cfi.befp;
+    ASSERT_EQ(BEFP.size(), 2u);
+    EXPECT_EQ(BEFP[0].start, 0u);
+    EXPECT_EQ(BEFP[0].end, 24u);
+    EXPECT_EQ(BEFP[1].start, 48u);
+    EXPECT_EQ(BEFP[1].end, 48u);
+}
+
+// Variables with the same locations share a single location list.
+TEST(DebugLocListTest, IdenticalListsAreShared) {
+    auto One = emitLocLists(4, 1);
+    auto Two = emitLocLists(4, 2);
+    EXPECT_FALSE(One.empty());
+    EXPECT_EQ(One, Two);
+}
+
+TEST(DebugLocListTest, IdenticalListsAreSharedDwarf5) {
+    auto One = emitLocLists(5, 1);
+    auto Two = emitLocLists(5, 2);
+    ASSERT_GT(One.size(), 12u);
+    EXPECT_EQ(One, Two);
+
+    uint32_t UnitLength = 0;
+    uint16_t Version = 0;
+    std::memcpy(&UnitLength, One.data(), sizeof(UnitLength));
+    std::memcpy(&Version, One.data() + 4, sizeof(Version));
+    EXPECT_EQ(UnitLength, One.size() - 4);
+    EXPECT_EQ(Version, 5);
+    EXPECT_EQ(One.back(), char(dwarf::DW_LLE_end_of_list));
+}
@@ -0,0 +1,163 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "Compiler/GenTTI.h"
+#include "Compiler/CodeGenPublic.h"
+#include "Compiler/CodeGenContextWrapper.hpp"
+#include "Compiler/MetaDataApi/IGCMetaDataHelper.h"
+
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "common/LLVMWarningsPop.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// The same loop in a kernel, where the arguments and everything computed
+// from them are uniform, and in a subroutine, where they are not.
+const char* TestIR = R"IR(
+define spir_kernel void @kernel(<32 x float> %a, <32 x float> %b, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi <32 x float> [ %a, %entry ], [ %acc.next, %loop ]
+  %t0 = fmul <32 x float> %acc, %b
+  %t1 = fadd <32 x float> %t0, %a
+  %acc.next = fadd <32 x float> %t1, %t0
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+
+define spir_func void @func(<32 x float> %a, <32 x float> %b, i32 %n) {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi <32 x float> [ %a, %entry ], [ %acc.next, %loop ]
+  %t0 = fmul <32 x float> %acc, %b
+  %t1 = fadd <32 x float> %t0, %a
+  %acc.next = fadd <32 x float> %t1, %t0
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  ret void
+}
+)IR";
+
+class GenTTITest : public ::testing::Test {
+protected:
+    GenTTITest()
+        : Layout(nullptr),
+          Ctx(ShaderType::OPENCL_SHADER, Layout, Platform, DriverInfo) {}
+
+    void SetUp() override {
+        SMDiagnostic Err;
+        std::unique_ptr<Module> M =
+            parseAssemblyString(TestIR, Err, *Ctx.getLLVMContext());
+        ASSERT_TRUE(M);
+        Ctx.setModule(M.release());
+        auto* MdUtils = Ctx.getMetaDataUtils();
+        IGC::IGCMD::IGCMetaDataHelper::addFunction(
+            *MdUtils, getFunction("kernel"), IGC::FunctionTypeMD::KernelFunction);
+        IGC::IGCMD::IGCMetaDataHelper::addFunction(
+            *MdUtils, getFunction("func"), IGC::FunctionTypeMD::UserFunction);
+    }
+
+    Function* getFunction(StringRef Name) {
+        return Ctx.getModule()->getFunction(Name);
+    }
+
+    // The loop unroller builds a new TTI for each loop, so do the same.
+    GenIntrinsicsTTIImpl makeTTI() { return GenIntrinsicsTTIImpl(&Ctx, nullptr); }
+
+    void resetUnrollInfo() {
+        legacy::PassManager PM;
+        PM.add(new IGC::CodeGenContextWrapper(&Ctx));
+        PM.add(new ResetUnrollFunctionInfo());
+        PM.run(*Ctx.getModule());
+    }
+
+    IGC::CBTILayout Layout;
+    IGC::CPlatform Platform;
+    IGC::CDriverInfo DriverInfo;
+    IGC::CodeGenContext Ctx;
+};
+
+// Adds an instruction in front of the terminator of BB.
+void addInst(BasicBlock* BB) {
+    IRBuilder<> Builder(BB->getTerminator());
+    Builder.CreateFence(AtomicOrdering::SequentiallyConsistent);
+}
+
+// The instruction count is taken once per function, and only taken again
+// once the loop it was asked for got transformed or the reset pass ran.
+TEST_F(GenTTITest, CachesFunctionInstCount) {
+    Function* F = getFunction("kernel");
+    DominatorTree DT(*F);
+    LoopInfo LI(DT);
+    ASSERT_EQ(LI.end() - LI.begin(), 1);
+    Loop* L = *LI.begin();
+    BasicBlock* Exit = L->getExitBlock();
+    ASSERT_TRUE(Exit);
+
+    const unsigned Count = F->getInstructionCount();
+    EXPECT_EQ(makeTTI().getFunctionInstCount(L), Count);
+
+    // Changes outside of the loop do not invalidate the count.
+    addInst(Exit);
+    EXPECT_EQ(makeTTI().getFunctionInstCount(L), Count);
+
+    // Peeling or unrolling the loop replaces a predecessor of its header,
+    // which a new preheader does as well.
+    SplitEdge(L->getLoopPreheader(), L->getHeader());
+    EXPECT_EQ(makeTTI().getFunctionInstCount(L), F->getInstructionCount());
+
+    addInst(Exit);
+    EXPECT_NE(makeTTI().getFunctionInstCount(L), F->getInstructionCount());
+    resetUnrollInfo();
+    EXPECT_EQ(makeTTI().getFunctionInstCount(L), F->getInstructionCount());
+}
+
+// Uniform values only take a scalar each, so the loop in the kernel can be
+// unrolled while the same loop in a subroutine already fills the GRFs.
+TEST_F(GenTTITest, SpillFreeUnrollCountUsesUniformity) {
+    auto getCount = [&](StringRef Name, bool& LowPressure) {
+        Function* F = getFunction(Name);
+        DominatorTree DT(*F);
+        LoopInfo LI(DT);
+        return makeTTI().getMaxSpillFreeUnrollCount(*LI.begin(), LowPressure);
+    };
+
+    bool LowPressure = false;
+    EXPECT_GT(getCount("kernel", LowPressure), 1u);
+    EXPECT_TRUE(LowPressure);
+
+    EXPECT_EQ(getCount("func", LowPressure), 1u);
+    EXPECT_FALSE(LowPressure);
+}
+
+} // namespace
@@ -0,0 +1,121 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2022 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "Compiler/CISACodeGen/SpecializeKernelArgs.h"
+
+#include "common/LLVMWarningsPush.hpp"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+#include "common/LLVMWarningsPop.hpp"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+const char* TestIR = R"IR(
+define spir_kernel void @test_spec(i32 addrspace(1)* %out, i32 %n, float %f, i64 %unused) {
+entry:
+  %cmp = icmp slt i32 0, %n
+  br i1 %cmp, label %body, label %exit
+
+body:
+  %ptr = bitcast i32 addrspace(1)* %out to float addrspace(1)*
+  %x = load float, float addrspace(1)* %ptr
+  %mul = fmul float %x, %f
+  store float %mul, float addrspace(1)* %ptr
+  br label %exit
+
+exit:
+  ret void
+}
+
+define spir_kernel void @other(i32 %n, i32 addrspace(1)* %out) {
+entry:
+  store i32 %n, i32 addrspace(1)* %out
+  ret void
+}
+)IR";
+
+std::unique_ptr<Module> specialize(LLVMContext& Ctx, const std::string& Name,
+                                   const std::map<uint32_t, uint64_t>& Args,
+                                   bool& Changed) {
+    SMDiagnostic Err;
+    std::unique_ptr<Module> M = parseAssemblyString(TestIR, Err, Ctx);
+    if (!M)
+        return nullptr;
+    legacy::PassManager PM;
+    PM.add(IGC::createSpecializeKernelArgsPass(Name, Args));
+    Changed = PM.run(*M);
+    return M;
+}
+
+Instruction* findInst(Function& F, unsigned Opcode) {
+    for (auto& I : instructions(F))
+        if (I.getOpcode() == Opcode)
+            return &I;
+    return nullptr;
+}
+
+// The uses of the specialized scalar arguments are replaced with constants
+// while the kernel signature is kept.
+TEST(SpecializeKernelArgs, FoldsScalarArguments) {
+    LLVMContext Ctx;
+    bool Changed = false;
+    auto M = specialize(Ctx, "test_spec",
+                        {{0, 5}, {1, 16}, {2, 0x3f800000}, {3, 7}}, Changed);
+    ASSERT_TRUE(M);
+    EXPECT_TRUE(Changed);
+
+    Function* F = M->getFunction("test_spec");
+    ASSERT_EQ(F->arg_size(), 4u);
+    EXPECT_TRUE(F->getArg(1)->use_empty());
+    EXPECT_TRUE(F->getArg(2)->use_empty());
+    // Pointer arguments are left alone.
+    EXPECT_FALSE(F->getArg(0)->use_empty());
+
+    auto* Cmp = cast<ICmpInst>(findInst(*F, Instruction::ICmp));
+    auto* N = dyn_cast<ConstantInt>(Cmp->getOperand(1));
+    ASSERT_TRUE(N);
+    EXPECT_EQ(N->getZExtValue(), 16u);
+
+    auto* Mul = findInst(*F, Instruction::FMul);
+    auto* FC = dyn_cast<ConstantFP>(Mul->getOperand(1));
+    ASSERT_TRUE(FC);
+    EXPECT_TRUE(FC->isExactlyValue(1.0));
+}
+
+TEST(SpecializeKernelArgs, LeavesOtherKernelsAlone) {
+    LLVMContext Ctx;
+    bool Changed = false;
+    auto M = specialize(Ctx, "test_spec", {{1, 16}}, Changed);
+    ASSERT_TRUE(M);
+    EXPECT_FALSE(M->getFunction("other")->getArg(0)->use_empty());
+}
+
+// Without a context to report to, invalid requests are silently ignored.
+TEST(SpecializeKernelArgs, IgnoresInvalidRequests) {
+    LLVMContext Ctx;
+    bool Changed = true;
+    auto M = specialize(Ctx, "missing", {{1, 16}}, Changed);
+    ASSERT_TRUE(M);
+    EXPECT_FALSE(Changed);
+
+    M = specialize(Ctx, "test_spec", {{9, 16}}, Changed);
+    ASSERT_TRUE(M);
+    EXPECT_FALSE(Changed);
+}
+
+} // namespace
@@ -384,6 +384,7 @@ DwarfDISubprogramCache::findNodes(const std::vector<Function *> &Functions) {
   DISubprogramNodes Result;
   // to ensure that Result does not contain duplicates
   std::unordered_set<const llvm::DISubprogram *> UniqueDISP;
+  std::lock_guard<std::mutex> Guard(CacheLock);
 
   for (const auto *F : Functions) {
     // If we don't have a list of DISP nodes for the processed function -
@@ -1962,90 +1963,107 @@ void DwarfDebug::collectVariableInfo(
   }
 }
 
-llvm::MCSymbol *DwarfDebug::CopyDebugLoc(unsigned int o) {
-  // TempDotLocEntries has all entries discovered in collectVariableInfo.
-  // But some of those entries may not get emitted. This function
-  // is invoked when writing out DIE. At this time, it can be decided
-  // whether debug_range for a variable will be emitted to debug_ranges.
-  // If yes, it is copied over to DotDebugLocEntries and new offset is
-  // returned.
-  unsigned int offset = 0, index = 0;
-  bool found = false, done = false;
+// Raw entries in TempDotDebugLocEntries are laid out as in .debug_loc: one
+// or more records of start and end address (pointer size each), 2-byte
+// expression length and the expression itself.
+namespace {
+struct RawLocRecord {
+  uint64_t Start = 0;
+  uint64_t End = 0;
+  uint16_t ExprSize = 0;
+  const unsigned char *Expr = nullptr;
+};
+} // namespace
+
+static llvm::SmallVector<RawLocRecord, 2>
+decodeRawLocEntry(const DotDebugLocEntry &Entry, unsigned int PointerSize) {
+  llvm::SmallVector<RawLocRecord, 2> Records;
+  const unsigned char *P = Entry.loc.data();
+  const unsigned char *E = P + Entry.loc.size();
+  while (P != E) {
+    RawLocRecord Raw;
+    IGC_ASSERT(E - P >= (ptrdiff_t)(PointerSize * 2 + sizeof(uint16_t)));
+    std::copy(P, P + PointerSize, (unsigned char *)&Raw.Start);
+    P += PointerSize;
+    std::copy(P, P + PointerSize, (unsigned char *)&Raw.End);
+    P += PointerSize;
+    std::copy(P, P + sizeof(uint16_t), (unsigned char *)&Raw.ExprSize);
+    P += sizeof(uint16_t);
+    IGC_ASSERT(E - P >= (ptrdiff_t)Raw.ExprSize);
+    Raw.Expr = P;
+    P += Raw.ExprSize;
+    Records.push_back(Raw);
+  }
+  return Records;
+}
+
+unsigned int
+DwarfDebug::getDebugLocEntrySize(const DotDebugLocEntry &Entry) const {
   unsigned int pointerSize = m_pModule->getPointerSize();
+  if (getDwarfVersion() < 5)
+    return Entry.isEmpty() ? pointerSize * 2 : Entry.loc.size();
 
-  // Compute offset in DotDebugLocEntries
-  for (auto &item : DotDebugLocEntries) {
-    if (item.isEmpty())
-      offset += pointerSize * 2;
-    else
-      offset += item.loc.size();
-  }
+  if (Entry.isEmpty())
+    return 1; // DW_LLE_end_of_list
 
-  auto Label = Asm->GetTempSymbol("debug_loc", offset);
-  auto RetLabel = Label;
+  unsigned int Size = 0;
+  for (const auto &Raw : decodeRawLocEntry(Entry, pointerSize))
+    Size += 1 + getULEB128Size(Raw.Start) + getULEB128Size(Raw.End) +
+            getULEB128Size(Raw.ExprSize) + Raw.ExprSize;
+  return Size;
+}
 
-  while (!done) {
-    if (!found && TempDotDebugLocEntries[index].getOffset() == o) {
-      found = true;
-    } else if (!found) {
-      index++;
-      continue;
-    }
+unsigned int DwarfDebug::getDebugLocHeaderSize() const {
+  // unit_length, version, address_size, segment_selector_size,
+  // offset_entry_count
+  return getDwarfVersion() >= 5 ? 4 + 2 + 1 + 1 + 4 : 0;
+}
 
-    if (found) {
-      // Append data to DotLocEntries
-      auto &Entry = TempDotDebugLocEntries[index];
-      Entry.setSymbol(Label);
-      Label = nullptr;
-      DotDebugLocEntries.push_back(Entry);
-      if (TempDotDebugLocEntries[index].isEmpty()) {
-        done = true;
-      }
-    }
-    index++;
-  }
+std::pair<unsigned int, llvm::MCSymbol *>
+DwarfDebug::copyDebugLocList(unsigned int o, bool UseLabel) {
+  auto First = std::find_if(
+      TempDotDebugLocEntries.begin(), TempDotDebugLocEntries.end(),
+      [o](const DotDebugLocEntry &Entry) { return Entry.getOffset() == o; });
+  auto Last = std::find_if(
+      First, TempDotDebugLocEntries.end(),
+      [](const DotDebugLocEntry &Entry) { return Entry.isEmpty(); });
+  IGC_ASSERT_MESSAGE(Last != TempDotDebugLocEntries.end(),
+                     "unterminated location list");
+
+  std::string Key;
+  for (auto It = First; It != Last; ++It)
+    Key.append(It->loc.begin(), It->loc.end());
 
-  return RetLabel;
+  auto Res = DotDebugLocLists.try_emplace(Key);
+  if (!Res.second)
+    return Res.first->second;
+
+  unsigned int Offset = DotDebugLocSize;
+  llvm::MCSymbol *Label =
+      UseLabel ? Asm->GetTempSymbol("debug_loc", Offset) : nullptr;
+  Res.first->second = std::make_pair(Offset, Label);
+
+  for (auto It = First; It != std::next(Last); ++It) {
+    DotDebugLocEntries.push_back(*It);
+    DotDebugLocEntries.back().setSymbol(It == First ? Label : nullptr);
+    DotDebugLocSize += getDebugLocEntrySize(*It);
+  }
+  return Res.first->second;
 }
 
-unsigned int DwarfDebug::CopyDebugLocNoReloc(unsigned int o) {
+llvm::MCSymbol *DwarfDebug::CopyDebugLoc(unsigned int o) {
   // TempDotLocEntries has all entries discovered in collectVariableInfo.
   // But some of those entries may not get emitted. This function
   // is invoked when writing out DIE. At this time, it can be decided
   // whether debug_range for a variable will be emitted to debug_ranges.
   // If yes, it is copied over to DotDebugLocEntries and new offset is
-  // returned.
-  unsigned int offset = 0, index = 0;
-  bool found = false, done = false;
-  unsigned int pointerSize = m_pModule->getPointerSize();
-
-  // Compute offset in DotDebugLocEntries
-  for (auto &item : DotDebugLocEntries) {
-    if (item.isEmpty())
-      offset += pointerSize * 2;
-    else
-      offset += item.loc.size();
-  }
-
-  while (!done) {
-    if (!found && TempDotDebugLocEntries[index].getOffset() == o) {
-      found = true;
-    } else if (!found) {
-      index++;
-      continue;
-    }
-
-    if (found) {
-      // Append data to DotLocEntries
-      DotDebugLocEntries.push_back(TempDotDebugLocEntries[index]);
-      if (TempDotDebugLocEntries[index].isEmpty()) {
-        done = true;
-      }
-    }
-    index++;
-  }
+  // returned. Identical lists are emitted once and shared.
+  return copyDebugLocList(o, true).second;
+}
 
-  return offset;
+unsigned int DwarfDebug::CopyDebugLocNoReloc(unsigned int o) {
+  // Same as CopyDebugLoc, but returns section offset of the list.
+  return getDebugLocHeaderSize() + copyDebugLocList(o, false).first;
 }
 
 // Process beginning of an instruction.
@@ -2167,9 +2185,11 @@ void DwarfDebug::identifyScopeMarkers() {
   }
 }
 
-// Walk up the scope chain of given debug loc and find line number info
-// for the function.
-static DebugLoc getFnDebugLoc(DebugLoc DL, const LLVMContext &Ctx) {
+// Walk up the scope chain of given debug loc and find the subprogram and the
+// line number info for the function. No DILocation is created for it, as
+// uniquing one would modify the LLVMContext, which is shared by the debug
+// emitters finalized concurrently.
+static DISubprogram *getFnSubprogram(DebugLoc DL, unsigned &Line) {
   // Get MDNode for DebugLoc's scope.
   while (DILocation *InlinedAt = DL.getInlinedAt()) {
     DL = DebugLoc(InlinedAt);
@@ -2179,13 +2199,9 @@ static DebugLoc getFnDebugLoc(DebugLoc DL, const LLVMContext &Ctx) {
   DISubprogram *SP = getDISubprogram(Scope);
   if (SP) {
     // Check for number of operands since the compatibility is cheap here.
-    if (SP->getNumOperands() > 19) {
-      return DILocation::get(SP->getContext(), SP->getScopeLine(), 0, SP);
-    }
-    return DILocation::get(SP->getContext(), SP->getLine(), 0, SP);
+    Line = SP->getNumOperands() > 19 ? SP->getScopeLine() : SP->getLine();
   }
-
-  return DebugLoc();
+  return SP;
 }
 
 // Gather pre-function debug information.  Assumes being called immediately
@@ -2297,12 +2313,11 @@ void DwarfDebug::beginFunction(const Function *MF, IGC::VISAModule *v) {
 
   // Record beginning of function.
   if (PrologEndLoc) {
-    DebugLoc FnStartDL = getFnDebugLoc(PrologEndLoc, MF->getContext());
-    const MDNode *Scope = FnStartDL.getScope();
+    unsigned FnStartLine = 0;
+    const MDNode *Scope = getFnSubprogram(PrologEndLoc, FnStartLine);
     // We'd like to list the prologue as "not statements" but GDB behaves
     // poorly if we do that. Revisit this with caution/GDB (7.5+) testing.
-    recordSourceLine(FnStartDL.getLine(), FnStartDL.getCol(), Scope,
-                     DWARF2_FLAG_IS_STMT);
+    recordSourceLine(FnStartLine, 0, Scope, DWARF2_FLAG_IS_STMT);
   }
 }
 
@@ -2568,6 +2583,8 @@ void DwarfDebug::emitSectionLabels() {
   DwarfLineSectionSym =
       emitSectionSym(Asm, Asm->GetDwarfLineSection(), "section_line");
   emitSectionSym(Asm, Asm->GetDwarfLocSection());
+  if (getDwarfVersion() >= 5)
+    emitSectionSym(Asm, Asm->GetDwarfLoclistsSection());
 
   DwarfStrSectionSym =
       emitSectionSym(Asm, Asm->GetDwarfStrSection(), "info_string");
@@ -2763,25 +2780,57 @@ void DwarfDebug::emitDebugLoc() {
 
 // TODO: remove deprecated code
 #if 1
-  Asm->SwitchSection(Asm->GetDwarfLocSection());
   unsigned int size = Asm->GetPointerSize();
 
-  for (const DotDebugLocEntry &Entry : DotDebugLocEntries) {
-    if (Entry.isEmpty()) {
-      Asm->EmitIntValue(0, size);
-      Asm->EmitIntValue(0, size);
-    } else {
-      auto *Symbol = Entry.getSymbol();
-      if (Symbol)
+  if (getDwarfVersion() >= 5) {
+    // DWARF5 .debug_loclists: entries are encoded relative to the CU base
+    // address (same as .debug_loc), but with ULEB128 offsets and lengths.
+    Asm->SwitchSection(Asm->GetDwarfLoclistsSection());
+    Asm->EmitInt32(getDebugLocHeaderSize() - 4 + DotDebugLocSize);
+    Asm->EmitInt16(getDwarfVersion());
+    Asm->EmitInt8(size);
+    Asm->EmitInt8(0); // segment_selector_size
+    Asm->EmitInt32(0); // offset_entry_count
+
+    for (const DotDebugLocEntry &Entry : DotDebugLocEntries) {
+      if (Entry.isEmpty()) {
+        Asm->EmitInt8(dwarf::DW_LLE_end_of_list);
+        continue;
+      }
+      if (auto *Symbol = Entry.getSymbol())
         Asm->EmitLabel(Symbol);
 
-      for (unsigned int byte = 0; byte != Entry.loc.size(); byte++) {
-        Asm->EmitIntValue(Entry.loc[byte], 1);
+      for (const auto &Raw :
+           decodeRawLocEntry(Entry, m_pModule->getPointerSize())) {
+        Asm->EmitInt8(dwarf::DW_LLE_offset_pair);
+        Asm->EmitULEB128(Raw.Start);
+        Asm->EmitULEB128(Raw.End);
+        Asm->EmitULEB128(Raw.ExprSize);
+        Asm->EmitBytes(StringRef((const char *)Raw.Expr, Raw.ExprSize));
+      }
+    }
+  } else {
+    Asm->SwitchSection(Asm->GetDwarfLocSection());
+
+    for (const DotDebugLocEntry &Entry : DotDebugLocEntries) {
+      if (Entry.isEmpty()) {
+        Asm->EmitIntValue(0, size);
+        Asm->EmitIntValue(0, size);
+      } else {
+        auto *Symbol = Entry.getSymbol();
+        if (Symbol)
+          Asm->EmitLabel(Symbol);
+
+        for (unsigned int byte = 0; byte != Entry.loc.size(); byte++) {
+          Asm->EmitIntValue(Entry.loc[byte], 1);
+        }
       }
     }
   }
 
   DotDebugLocEntries.clear();
+  DotDebugLocLists.clear();
+  DotDebugLocSize = 0;
 
 #else
   for (SmallVectorImpl<DotDebugLocEntry>::iterator
@@ -42,6 +42,7 @@ See LICENSE.TXT for details.
 #include "EmitterOpts.hpp"
 
 #include "Probe/Assertion.h"
+#include <mutex>
 #include <set>
 
 namespace llvm {
@@ -254,9 +255,12 @@ struct SymbolCU {
 //    subprograms ever referenced in this kernel (+ it's recursive
 //    callees). We skip emitting declaration DIEs for which no code is
 //    emitted in current kernel.
+// The cache is shared by the debug emitters of all compiled units, which may
+// be finalized concurrently.
 class DwarfDISubprogramCache {
   using DISubprogramNodes = std::vector<llvm::DISubprogram *>;
   std::unordered_map<const llvm::Function *, DISubprogramNodes> DISubprograms;
+  std::mutex CacheLock;
 
   void updateDISPCache(const llvm::Function *F);
 
@@ -340,6 +344,13 @@ class DwarfDebug {
   DotDebugLocEntryVect DotDebugLocEntries;
   DotDebugLocEntryVect TempDotDebugLocEntries;
 
+  // Size of the location lists copied to DotDebugLocEntries so far.
+  unsigned int DotDebugLocSize = 0;
+
+  // Location lists already copied to DotDebugLocEntries, keyed by their raw
+  // contents. Variables with identical lists share a single copy.
+  llvm::StringMap<std::pair<unsigned int, llvm::MCSymbol *>> DotDebugLocLists;
+
   // Collection of subprogram DIEs that are marked (at the end of the module)
   // as DW_AT_inline.
   llvm::SmallPtrSet<DIE *, 4> InlinedSubprogramDIEs;
@@ -497,6 +508,18 @@ private:
   /// \brief Emit visible names into a debug loc section.
   void emitDebugLoc();
 
+  /// \brief Return size of a location entry in the emitted section. DWARF5
+  /// entries are re-encoded as DW_LLE_offset_pair/DW_LLE_end_of_list.
+  unsigned int getDebugLocEntrySize(const DotDebugLocEntry &Entry) const;
+
+  /// \brief Return size of the .debug_loclists header (0 for .debug_loc).
+  unsigned int getDebugLocHeaderSize() const;
+
+  /// \brief Copy location list starting at offset o of TempDotDebugLocEntries
+  /// to DotDebugLocEntries unless an identical list was copied before.
+  std::pair<unsigned int, llvm::MCSymbol *> copyDebugLocList(unsigned int o,
+                                                             bool UseLabel);
+
   /// \brief Emit visible names into a debug ranges section.
   void emitDebugRanges();
 
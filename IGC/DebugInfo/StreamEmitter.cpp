@@ -472,6 +472,10 @@ const MCSection *StreamEmitter::GetDwarfLocSection() const {
   return GetObjFileLowering().getDwarfLocSection();
 }
 
+const MCSection *StreamEmitter::GetDwarfLoclistsSection() const {
+  return GetObjFileLowering().getDwarfLoclistsSection();
+}
+
 const MCSection *StreamEmitter::GetDwarfMacroInfoSection() const {
   // return GetObjFileLowering().getDwarfMacroInfoSection();
   return nullptr;
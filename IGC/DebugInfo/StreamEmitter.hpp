@@ -75,6 +75,7 @@ public:
   const llvm::MCSection *GetDwarfInfoSection() const;
   const llvm::MCSection *GetDwarfLineSection() const;
   const llvm::MCSection *GetDwarfLocSection() const;
+  const llvm::MCSection *GetDwarfLoclistsSection() const;
   const llvm::MCSection *GetDwarfMacroInfoSection() const;
   const llvm::MCSection *GetDwarfRangesSection() const;
   const llvm::MCSection *GetDwarfStrSection() const;
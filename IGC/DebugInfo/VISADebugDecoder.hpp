@@ -46,7 +46,7 @@ public:
       uint16_t regNum;
       uint16_t subRegNum; // for GRF, in byte offset
 
-      bool operator==(const Register &rhs) {
+      bool operator==(const Register &rhs) const {
         return (regNum == rhs.regNum && subRegNum == rhs.subRegNum);
       }
 
@@ -59,7 +59,7 @@ public:
                                   // off BE_FP (0) or absolute (1)
       int32_t memoryOffset : 31;  // memory offset
 
-      bool operator==(const Memory &rhs) {
+      bool operator==(const Memory &rhs) const {
         return (isBaseOffBEFP == rhs.isBaseOffBEFP &&
                 memoryOffset == rhs.memoryOffset);
       }
@@ -85,6 +85,14 @@ public:
     PhysicalVarType physicalType;
     Mapping mapping;
 
+    bool operator==(const VarAlloc &rhs) const {
+      if (virtualType != rhs.virtualType || physicalType != rhs.physicalType)
+        return false;
+      if (physicalType == PhyTypeMemory)
+        return mapping.m == rhs.mapping.m;
+      return mapping.r == rhs.mapping.r;
+    }
+
     void print(llvm::raw_ostream &OS) const;
     void dump() const;
   };
@@ -281,6 +289,47 @@ private:
     return data;
   }
 
+  // vISA emits one interval per live range segment, so a variable that stays
+  // in the same location across several segments shows up as a chain of
+  // adjacent intervals. Merge adjacent/overlapping intervals sharing the same
+  // allocation to keep location lists short. Interval ends are inclusive, so
+  // an interval is adjacent to the previous one when it starts at
+  // NextPos(previous end): the next vISA index for vISA intervals and the
+  // offset of the next Gen instruction for Gen ISA intervals.
+  template <typename IntervalT, typename NextPosT>
+  static void coalesceIntervals(std::vector<IntervalT> &LRs,
+                                NextPosT NextPos) {
+    if (LRs.size() < 2)
+      return;
+    auto Last = LRs.begin();
+    for (auto It = std::next(LRs.begin()), E = LRs.end(); It != E; ++It) {
+      if (It->var == Last->var && It->start >= Last->start &&
+          (uint64_t)It->start <=
+              std::max<uint64_t>(Last->end, NextPos(Last->end))) {
+        Last->end = std::max(Last->end, It->end);
+        continue;
+      }
+      *++Last = *It;
+    }
+    LRs.erase(std::next(Last), LRs.end());
+  }
+
+  static void coalesceIntervals(std::vector<LiveIntervalsVISA> &LRs) {
+    coalesceIntervals(LRs, [](uint64_t End) { return End + 1; });
+  }
+
+  // Gen instruction sizes vary with compaction, so the offset following an
+  // instruction is looked up in the sorted offsets of the Gen instructions of
+  // the object. Past the last known instruction only overlapping intervals
+  // are merged.
+  static void coalesceIntervals(std::vector<LiveIntervalGenISA> &LRs,
+                                const std::vector<uint32_t> &GenOffsets) {
+    coalesceIntervals(LRs, [&GenOffsets](uint64_t End) -> uint64_t {
+      auto Next = std::upper_bound(GenOffsets.begin(), GenOffsets.end(), End);
+      return Next == GenOffsets.end() ? End : *Next;
+    });
+  }
+
   const void *dbg;
   uint16_t numCompiledObj = 0;
   uint32_t magic = 0;
@@ -306,13 +355,19 @@ private:
       }
 
       // cisa index map
+      // Gen offsets in the object, which Gen ISA intervals are relative to
+      std::vector<uint32_t> genOffsets;
       count = read<uint32_t>(dbg);
       for (unsigned int j = 0; j != count; j++) {
         uint32_t cisaIndex = read<uint32_t>(dbg);
         uint32_t genOffset = read<uint32_t>(dbg);
         f.CISAIndexMap.push_back(
             std::make_pair(cisaIndex, f.relocOffset + genOffset));
+        genOffsets.push_back(genOffset);
       }
+      std::sort(genOffsets.begin(), genOffsets.end());
+      genOffsets.erase(std::unique(genOffsets.begin(), genOffsets.end()),
+                       genOffsets.end());
 
       // var info
       count = read<uint32_t>(dbg);
@@ -328,6 +383,7 @@ private:
           LiveIntervalsVISA lv = readLiveIntervalsVISA();
           v.lrs.push_back(lv);
         }
+        coalesceIntervals(v.lrs);
 
         f.Vars.push_back(v);
       }
@@ -347,6 +403,7 @@ private:
           LiveIntervalsVISA lv = readLiveIntervalsVISA();
           sub.retval.push_back(lv);
         }
+        coalesceIntervals(sub.retval);
         f.subs.push_back(sub);
       }
 
@@ -357,9 +414,9 @@ private:
         count = read<uint16_t>(dbg);
         for (unsigned int j = 0; j != count; j++) {
           LiveIntervalGenISA lv = readLiveIntervalGenISA();
-          ;
           f.cfi.befp.push_back(lv);
         }
+        coalesceIntervals(f.cfi.befp, genOffsets);
       }
       f.cfi.callerbefpValid = (bool)read<uint8_t>(dbg);
       if (f.cfi.callerbefpValid) {
@@ -368,6 +425,7 @@ private:
           LiveIntervalGenISA lv = readLiveIntervalGenISA();
           f.cfi.callerbefp.push_back(lv);
         }
+        coalesceIntervals(f.cfi.callerbefp, genOffsets);
       }
       f.cfi.retAddrValid = (bool)read<uint8_t>(dbg);
       if (f.cfi.retAddrValid) {
@@ -376,6 +434,7 @@ private:
           LiveIntervalGenISA lv = readLiveIntervalGenISA();
           f.cfi.retAddr.push_back(lv);
         }
+        coalesceIntervals(f.cfi.retAddr, genOffsets);
       }
       f.cfi.numCalleeSaveEntries = read<uint16_t>(dbg);
       for (unsigned int j = 0; j != f.cfi.numCalleeSaveEntries; j++) {
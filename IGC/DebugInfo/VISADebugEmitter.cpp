@@ -284,6 +284,9 @@ std::vector<char> DebugEmitter::Finalize(bool Finalize,
   LLVM_DEBUG(dbgs() << "[DwarfDebug] endFunction start ---\n");
   m_pDwarfDebug->endFunction(pFunc);
   LLVM_DEBUG(dbgs() << "[DwarfDebug] endFunction done ***\n");
+  // Gen ISA ranges are not queried past the function, VisaDbgInfo may be
+  // released after this call.
+  m_pVISAModule->releaseGenISARangeIndexes();
 
   LLVM_DEBUG(dbgs() << "Processed VISA Object:\n");
   LLVM_DEBUG(m_pVISAModule->dump());
@@ -18,6 +18,7 @@ See LICENSE.TXT for details.
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/IR/DebugInfo.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Instruction.h"
 #include "llvm/IR/IntrinsicInst.h"
 #include "llvm/IR/Module.h"
@@ -212,6 +213,8 @@ bool VISAModule::IsExecutableInst(const llvm::Instruction &inst) {
 
 void VISAModule::rebuildVISAIndexes() {
 
+  releaseGenISARangeIndexes();
+
   VisaIndexToInst.clear();
   VisaIndexToVisaSizeIndex.clear();
   for (VISAModule::const_iterator II = begin(), IE = end(); II != IE; ++II) {
@@ -394,85 +397,113 @@ const llvm::Instruction *getNextInst(const llvm::Instruction *start) {
   return (const llvm::Instruction *)nullptr;
 }
 
-std::vector<std::pair<unsigned int, unsigned int>>
-VISAModule::getGenISARange(const VISAObjectDebugInfo &VDI,
-                           const InsnRange &Range) const {
-  // Given a range, return vector of start-end range for corresponding Gen ISA
-  // instructions
-  auto start = Range.first;
-  auto end = Range.second;
+void VISAModule::releaseGenISARangeIndexes() {
+  GenRangeIndexes.clear();
+  GenRangeIndexesVDI = nullptr;
+}
 
-  // Range consists of a sequence of LLVM IR instructions. This function needs
-  // to return a range of corresponding Gen ISA instructions. Instruction
-  // scheduling in Gen ISA means several independent sub-ranges will be present.
-  std::vector<std::pair<unsigned int, unsigned int>> GenISARange;
-  bool endNextInst = false;
+const VISAModule::GenISARangeIndex &
+VISAModule::getGenISARangeIndex(const VISAObjectDebugInfo &VDI,
+                                const llvm::Function &F) const {
+  IGC_ASSERT_MESSAGE(!GenRangeIndexesVDI || GenRangeIndexesVDI == &VDI,
+                     "Gen ISA range indexes of another VISA object are alive");
+  GenRangeIndexesVDI = &VDI;
+  auto &Slot = GenRangeIndexes[&F];
+  if (Slot)
+    return *Slot;
+
+  Slot = std::make_unique<GenISARangeIndex>();
+  auto &Index = *Slot;
 
   const auto &VisaToGenMapping = VDI.getVisaToGenLUT();
   const auto &GenToSizeInBytes = VDI.getGenToSizeInBytesLUT();
 
-  while (1) {
-    if (!start || !end || endNextInst)
-      break;
-
-    if (start == end)
-      endNextInst = true;
+  // Gen ISA ranges of a single instruction, consecutive gen instructions are
+  // merged the same way as for the whole InsnRange
+  for (const auto &I : llvm::instructions(F)) {
+    Index.InstNum[&I] = Index.RangeBegin.size();
+    Index.RangeBegin.push_back(Index.Ranges.size());
 
-    // Get VISA index/size for "start" LLVM IR inst
-    InstInfoMap::const_iterator itr = m_instInfoMap.find(start);
-    if (itr == m_instInfoMap.end()) {
-      start = getNextInst(start);
+    InstInfoMap::const_iterator itr = m_instInfoMap.find(&I);
+    if (itr == m_instInfoMap.end())
       continue;
-    }
 
     auto startVISAOffset = itr->second.m_offset;
     // VISASize indicated # of VISA insts emitted for this
     // LLVM IR inst
-    auto VISASize = GetVisaSize(start);
-
+    auto VISASize = GetVisaSize(&I);
+    unsigned FirstRange = Index.Ranges.size();
     for (unsigned int i = 0; i != VISASize; i++) {
-      auto VISAIndex = startVISAOffset + i;
-      auto it = VisaToGenMapping.find(VISAIndex);
+      auto it = VisaToGenMapping.find(startVISAOffset + i);
       if (it == VisaToGenMapping.end())
         continue;
-      int lastEnd = -1;
       for (const auto &genInst : it->second) {
         unsigned int sizeGenInst = GenToSizeInBytes.lookup(genInst);
-
-        if (GenISARange.size() > 0)
-          lastEnd = GenISARange.back().second;
-
-        if (lastEnd == genInst) {
-          GenISARange.back().second += sizeGenInst;
-        } else {
-          GenISARange.push_back(std::make_pair(genInst, genInst + sizeGenInst));
-        }
-        lastEnd = GenISARange.back().second;
+        if (Index.Ranges.size() > FirstRange &&
+            Index.Ranges.back().second == genInst)
+          Index.Ranges.back().second += sizeGenInst;
+        else
+          Index.Ranges.push_back(std::make_pair(genInst, genInst + sizeGenInst));
       }
     }
-
-    start = getNextInst(start);
   }
+  Index.RangeBegin.push_back(Index.Ranges.size());
 
-  if (GenISARange.size() == 0)
-    return GenISARange;
-
-  llvm::DenseMap<unsigned, unsigned> unassignedGenOffset;
   if (m_catchAllVisaId != 0) {
     auto it = VisaToGenMapping.find(m_catchAllVisaId);
     if (it != VisaToGenMapping.end()) {
-      for (const auto &genInst : it->second) {
-        unsigned int sizeGenInst = GenToSizeInBytes.lookup(genInst);
-        unassignedGenOffset[genInst] = sizeGenInst;
-      }
+      for (const auto &genInst : it->second)
+        Index.CatchAllGenInsts[genInst] = GenToSizeInBytes.lookup(genInst);
     }
+  }
+  return Index;
+}
 
+std::vector<std::pair<unsigned int, unsigned int>>
+VISAModule::getGenISARange(const VISAObjectDebugInfo &VDI,
+                           const InsnRange &Range) const {
+  // Given a range, return vector of start-end range for corresponding Gen ISA
+  // instructions
+  auto start = Range.first;
+  auto end = Range.second;
+
+  // Range consists of a sequence of LLVM IR instructions. This function needs
+  // to return a range of corresponding Gen ISA instructions. Instruction
+  // scheduling in Gen ISA means several independent sub-ranges will be present.
+  std::vector<std::pair<unsigned int, unsigned int>> GenISARange;
+  if (!start || !end)
+    return GenISARange;
+
+  const auto &Index = getGenISARangeIndex(VDI, *start->getFunction());
+  auto StartIt = Index.InstNum.find(start);
+  IGC_ASSERT(StartIt != Index.InstNum.end());
+  unsigned StartNum = StartIt->second;
+  // If the end of the range doesn't follow its start, the range extends to
+  // the end of the function
+  unsigned EndNum = Index.RangeBegin.size() - 2;
+  auto EndIt = Index.InstNum.find(end);
+  if (EndIt != Index.InstNum.end() && EndIt->second >= StartNum)
+    EndNum = EndIt->second;
+
+  for (unsigned i = Index.RangeBegin[StartNum], e = Index.RangeBegin[EndNum + 1];
+       i != e; ++i) {
+    const auto &R = Index.Ranges[i];
+    if (!GenISARange.empty() && GenISARange.back().second == R.first)
+      GenISARange.back().second = R.second;
+    else
+      GenISARange.push_back(R);
+  }
+
+  if (GenISARange.size() == 0)
+    return GenISARange;
+
+  if (m_catchAllVisaId != 0) {
     // Check whether holes can be filled up using catch all attributed Gen
     // instructions
     for (unsigned int i = 0; i != GenISARange.size(); i++) {
       auto rangeEnd = GenISARange[i].second;
-      auto it = unassignedGenOffset.find(rangeEnd);
-      if (it != unassignedGenOffset.end()) {
+      auto it = Index.CatchAllGenInsts.find(rangeEnd);
+      if (it != Index.CatchAllGenInsts.end()) {
         GenISARange[i].second += (*it).second;
       }
     }
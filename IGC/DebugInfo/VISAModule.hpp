@@ -401,6 +401,31 @@ private:
 
   std::unique_ptr<VarInfoCache> VICache = std::make_unique<VarInfoCache>();
 
+  using GenISARangeList = std::vector<std::pair<unsigned int, unsigned int>>;
+  // Gen ISA ranges of all llvm instructions of a function, computed in one
+  // pass over the function. Instructions are numbered in the layout order of
+  // the function, and the ranges of the instruction numbered I are
+  // Ranges[RangeBegin[I]] .. Ranges[RangeBegin[I + 1]]. An InsnRange
+  // query then becomes a walk over a contiguous slice of Ranges.
+  struct GenISARangeIndex {
+    llvm::DenseMap<const llvm::Instruction *, unsigned> InstNum;
+    std::vector<unsigned> RangeBegin;
+    GenISARangeList Ranges;
+    // Gen instructions attributed to the catch all vISA instruction,
+    // gen offset -> size in bytes
+    llvm::DenseMap<unsigned, unsigned> CatchAllGenInsts;
+  };
+  // Indexes are built for the VISA object being finalized and dropped when
+  // its finalization is done, so they never outlive VISAObjectDebugInfo or
+  // the functions they were built for.
+  mutable llvm::DenseMap<const llvm::Function *,
+                         std::unique_ptr<GenISARangeIndex>>
+      GenRangeIndexes;
+  mutable const VISAObjectDebugInfo *GenRangeIndexesVDI = nullptr;
+
+  const GenISARangeIndex &getGenISARangeIndex(const VISAObjectDebugInfo &VD,
+                                              const llvm::Function &F) const;
+
 public:
   /// @brief Constructor.
   /// @param AssociatedFunc holds llvm IR function associated with
@@ -518,6 +543,7 @@ public:
   getSubroutines(const VISAObjectDebugInfo &VD) const;
 
   void rebuildVISAIndexes();
+  void releaseGenISARangeIndexes();
 
   std::vector<std::pair<unsigned int, unsigned int>>
   getGenISARange(const VISAObjectDebugInfo &VD, const InsnRange &Range) const;
@@ -20,6 +20,7 @@ SPDX-License-Identifier: MIT
 #include "vc/Utils/GenX/GlobalVariable.h"
 
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/CFG.h"
 #include "llvm/Analysis/ValueTracking.h"
 #include "llvm/GenXIntrinsics/GenXIntrinsics.h"
@@ -55,6 +56,9 @@ using namespace llvm;
 using namespace genx;
 using namespace GenXIntrinsic::GenXRegion;
 
+STATISTIC(NumBaleCacheHits, "Number of bales reused from the bale cache");
+STATISTIC(NumBaleCacheMisses, "Number of bales built for the bale cache");
+
 // set of debug options to switch off different baling types
 static cl::opt<bool> BaleBinary("bale-binary", cl::init(true), cl::Hidden,
                                 cl::desc("Bale binary operators"));
@@ -1775,9 +1779,24 @@ void GenXBaling::setBaleInfo(const Instruction *Inst, genx::BaleInfo BI)
   IGC_ASSERT(BI.Bits < 1 << Inst->getNumOperands());
   LLVM_DEBUG(llvm::dbgs() << "Adding InstMap entry for " << *Inst
                           << "; BI type: " << BI.getTypeString() << "\n");
+  invalidateCachedBales(Inst);
   InstMap[Inst] = BI;
 }
 
+/***********************************************************************
+ * invalidateCachedBales : drop the cached bales containing an instruction
+ *
+ * Those are the bales headed by the instruction and by each instruction it
+ * is (transitively) baled into.
+ */
+void GenXBaling::invalidateCachedBales(const Instruction *Inst)
+{
+  if (BaleCache.empty())
+    return;
+  for (; Inst; Inst = getBaleParent(Inst))
+    BaleCache.erase(Inst);
+}
+
 /***********************************************************************
  * setOperandBaled : set flag to say that an operand is baled in
  *
@@ -2074,7 +2093,24 @@ Instruction *GenXBaling::getBaleHead(Instruction *Inst) const {
 void GenXBaling::buildBale(Instruction *Inst, Bale *B, bool IncludeAddr) const
 {
   IGC_ASSERT(!B->size());
+  // Bales pretending to include the address calculation are not cached.
+  if (IncludeAddr) {
+    buildBaleSub(Inst, B, IncludeAddr);
+    return;
+  }
+  auto Cached = BaleCache.find(Inst);
+  if (Cached != BaleCache.end()) {
+    ++NumBaleCacheHits;
+    *B = Cached->second->B;
+    return;
+  }
+  ++NumBaleCacheMisses;
   buildBaleSub(Inst, B, IncludeAddr);
+  auto CB = std::make_unique<CachedBale>();
+  CB->B = *B;
+  for (auto &BI : *B)
+    CB->Handles.emplace_back(BI.Inst, this, Inst);
+  BaleCache[Inst] = std::move(CB);
 }
 
 void GenXBaling::buildBaleSub(Instruction *Inst, Bale *B, bool IncludeAddr) const
@@ -2149,6 +2185,7 @@ int GenXBaling::getAddrOperandNum(unsigned IID) const
 void GenXBaling::store(BaleInst BI)
 {
   IGC_ASSERT(BI.Info.Bits < 1<< BI.Inst->getNumOperands());
+  invalidateCachedBales(BI.Inst);
   InstMap[BI.Inst] = BI.Info;
 }
 
@@ -221,9 +221,12 @@ SPDX-License-Identifier: MIT
 
 #include "IgnoreRAUWValueMap.h"
 #include "Probe/Assertion.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/IR/Dominators.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/Pass.h"
+#include <memory>
 #include <string>
 
 namespace llvm {
@@ -386,6 +389,30 @@ class GenXBaling {
   typedef SmallVector<NeedClone, 8> NeedCloneStack_t;
   NeedCloneStack_t NeedCloneStack;
   SmallVector<CallInst *, 4> TwoAddrSends;
+  // Bales already built by buildBale, keyed by head instruction. A cached
+  // bale is used as is, so it is dropped at every change that could make it
+  // stale:
+  // - setBaleInfo/store/unbale of one of its instructions,
+  // - erasing or RAUW of one of its instructions, through the value handles
+  //   the cache keeps on them.
+  // A pass replacing a baled in operand must update the BaleInfo of the user,
+  // as it does for the baling to stay valid anyway.
+  class BaleCacheVH final : public CallbackVH {
+    const GenXBaling *Baling;
+    const Instruction *Head;
+    void deleted() override { Baling->dropCachedBale(Head); }
+    void allUsesReplacedWith(Value *) override { Baling->dropCachedBale(Head); }
+
+  public:
+    BaleCacheVH(Instruction *Inst, const GenXBaling *Baling,
+                const Instruction *Head)
+        : CallbackVH(Inst), Baling(Baling), Head(Head) {}
+  };
+  struct CachedBale {
+    genx::Bale B;
+    SmallVector<BaleCacheVH, 4> Handles;
+  };
+  mutable DenseMap<const Instruction *, std::unique_ptr<CachedBale>> BaleCache;
 protected:
   BalingKind Kind;
   const DominatorTree *DT;
@@ -396,7 +423,10 @@ public:
   explicit GenXBaling(BalingKind BKind, const GenXSubtarget *Subtarget)
       : Kind(BKind), ST(Subtarget), Liveness(nullptr), DT(nullptr) {}
   // clear : clear out the analysis
-  void clear() { InstMap.clear(); }
+  void clear() {
+    InstMap.clear();
+    BaleCache.clear();
+  }
   // processFunction : process one Function
   bool processFunction(Function *F);
   // processInst : recalculate the baling info for an instruction
@@ -467,6 +497,8 @@ private:
   bool processSelectToPredicate(SelectInst *SI);
   // Helper func for buildBale
   void buildBaleSub(Instruction *Inst, genx::Bale *B, bool IncludeAddr) const;
+  void invalidateCachedBales(const Instruction *Inst);
+  void dropCachedBale(const Instruction *Head) const { BaleCache.erase(Head); }
   void processBranch(BranchInst *Branch);
   void processTwoAddrSend(CallInst *CI);
   void setOperandBaled(Instruction *Inst, unsigned OperandNum, genx::BaleInfo *BI);
@@ -109,6 +109,18 @@ static cl::opt<bool>
     OptDisableVisaLOC("vc-cg-disable-visa-loc", cl::init(false), cl::Hidden,
                       cl::desc("do not emit LOC and FILE instructions"));
 
+static cl::opt<unsigned> FinalizerThreads(
+    "vc-finalizer-threads", cl::init(0), cl::Hidden,
+    cl::desc("Number of threads the finalizer compiles the kernels and "
+             "functions of a module with (0 means serial compilation)"));
+
+static cl::opt<bool> OptVISATextRoundTrip(
+    "vc-visa-text-round-trip", cl::init(false), cl::Hidden,
+    cl::desc("Resolve inline assembly and vISA LTO modules by printing the "
+             "whole module as vISA text and parsing it back instead of "
+             "parsing inline assembly directly into the kernels being "
+             "built"));
+
 static cl::opt<bool> OptStrictI64Check(
         "genx-cisa-builder-noi64-check", cl::init(false), cl::Hidden,
         cl::desc("strict check to ensure we produce no 64-bit operations"));
@@ -629,6 +641,7 @@ private:
   void buildStackCall(CallInst *CI, const DstOpndDesc &DstDesc);
   void buildStackCallLight(CallInst *CI, const DstOpndDesc &DstDesc);
   void buildInlineAsm(CallInst *CI);
+  void emitInlineAsm(const std::string &AsmStr);
   void buildPrintIndex(CallInst *CI, unsigned IntrinID, unsigned Mod,
                        const DstOpndDesc &DstDesc);
   void buildSelectInst(SelectInst *SI, genx::BaleInfo BI, unsigned Mod,
@@ -871,7 +884,7 @@ bool GenXCisaBuilder::runOnFunctionGroup(FunctionGroup &FG) {
   KernelBuilder->run();
 
   GenXModule *GM = KernelBuilder->GM;
-  if (GM->HasInlineAsm() || !BC.getVISALTOStrings().empty()) {
+  if (GM->UseVISATextRoundTrip()) {
     auto VISAAsmTextReader = GM->GetVISAAsmReader();
     auto ParseVISA = [&](const std::string& text) {
       const int R = VISAAsmTextReader->ParseVISAText(text, "");
@@ -5420,11 +5433,10 @@ void GenXKernelBuilder::buildInlineAsm(CallInst *CI) {
   IGC_ASSERT_MESSAGE(CI->isInlineAsm(), "Inline asm expected");
   InlineAsm *IA = dyn_cast<InlineAsm>(IGCLLVM::getCalledValue(CI));
   std::string AsmStr(IA->getAsmString());
-  std::stringstream &AsmTextStream = CisaBuilder->GetAsmTextStream();
 
   // Nothing to substitute if no constraints provided
   if (IA->getConstraintString().empty()) {
-    AsmTextStream << AsmStr << std::endl;
+    emitInlineAsm(AsmStr);
     return;
   }
 
@@ -5510,9 +5522,24 @@ void GenXKernelBuilder::buildInlineAsm(CallInst *CI) {
     } while (R.match(AsmStr));
   }
 
-  AsmTextStream << "\n// INLASM BEGIN\n"
-                << AsmStr << "\n// INLASM END\n"
-                << std::endl;
+  emitInlineAsm(AsmStr);
+}
+
+void GenXKernelBuilder::emitInlineAsm(const std::string &AsmStr) {
+  if (GM->UseVISATextRoundTrip()) {
+    CisaBuilder->GetAsmTextStream() << "\n// INLASM BEGIN\n"
+                                    << AsmStr << "\n// INLASM END\n"
+                                    << std::endl;
+    return;
+  }
+
+  if (StringRef(AsmStr).trim().empty())
+    return;
+  // Parse the snippet straight into the kernel being built: its operands
+  // name variables that have already been declared in it.
+  if (CisaBuilder->ParseVISAInlineAsm(Kernel, AsmStr) != 0)
+    handleInlineAsmParseError(*BackendConfig, CisaBuilder->GetCriticalMsg(),
+                              AsmStr, getContext());
 }
 
 void GenXKernelBuilder::buildCall(CallInst *CI, const DstOpndDesc &DstDesc) {
@@ -6674,9 +6701,7 @@ public:
     auto &FGA = getAnalysis<FunctionGroupAnalysis>();
     auto &GM = getAnalysis<GenXModule>();
     std::stringstream ss;
-    VISABuilder *CisaBuilder = GM.GetCisaBuilder();
-    if (GM.HasInlineAsm() || !BC->getVISALTOStrings().empty())
-      CisaBuilder = GM.GetVISAAsmReader();
+    VISABuilder *CisaBuilder = GM.GetFinalVISABuilder();
     CISA_CALL(CisaBuilder->Compile("genxir", &ss, BC->emitVisaOnly()));
 
     if (!BC->isDisableFinalizerMsg())
@@ -6766,6 +6791,10 @@ collectFinalizerArgs(StringSaver &Saver, const GenXSubtarget &ST,
   }
   if (WATable && WATable->Wa_14012437816)
     addArgument("-LSCFenceWA");
+  if (FinalizerThreads > 1) {
+    addArgument("-compileThreads");
+    addArgument(std::to_string(FinalizerThreads.getValue()));
+  }
   return Argv;
 }
 
@@ -6832,14 +6861,24 @@ static VISABuilder *createVISABuilder(const GenXSubtarget &ST,
   return VB;
 }
 
+bool GenXModule::NeedsVISAParser() const {
+  return HasInlineAsm() || !BC->getVISALTOStrings().empty();
+}
+
+bool GenXModule::UseVISATextRoundTrip() const {
+  return NeedsVISAParser() && OptVISATextRoundTrip;
+}
+
 void GenXModule::InitCISABuilder() {
   IGC_ASSERT(ST);
   const vISABuilderMode Mode =
-    (HasInlineAsm() || !BC->getVISALTOStrings().empty())
-      ? vISA_ASM_WRITER
-      : vISA_DEFAULT;
+      UseVISATextRoundTrip() ? vISA_ASM_WRITER : vISA_DEFAULT;
   CisaBuilder = createVISABuilder(*ST, *BC, getInfoForFinalizer(), Mode,
                                   getContext(), ArgStorage);
+  // Inline assembly is parsed directly into the kernels being built and
+  // refers to their variables by name.
+  if (NeedsVISAParser() && !UseVISATextRoundTrip())
+    CisaBuilder->SetOption(vISA_KeepVarNames, true);
 }
 
 VISABuilder *GenXModule::GetCisaBuilder() {
@@ -6868,6 +6907,24 @@ VISABuilder *GenXModule::GetVISAAsmReader() {
   return VISAAsmTextReader;
 }
 
+VISABuilder *GenXModule::GetFinalVISABuilder() {
+  if (UseVISATextRoundTrip())
+    return GetVISAAsmReader();
+
+  VISABuilder *VB = GetCisaBuilder();
+  // vISA LTO modules are linked into the builder once all the kernels are
+  // built, as they would follow the module text in the round trip.
+  if (!VISALTOStringsLinked) {
+    VISALTOStringsLinked = true;
+    for (auto VisaAsm : BC->getVISALTOStrings()) {
+      if (VB->ParseVISAText(VisaAsm, "") != 0)
+        handleInlineAsmParseError(*BC, VB->GetCriticalMsg(), VisaAsm,
+                                  getContext());
+    }
+  }
+  return VB;
+}
+
 void GenXModule::DestroyVISAAsmReader() {
   if (VISAAsmTextReader) {
     CISA_CALL(DestroyVISABuilder(VISAAsmTextReader));
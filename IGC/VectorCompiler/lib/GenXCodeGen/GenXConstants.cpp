@@ -71,6 +71,20 @@ SPDX-License-Identifier: MIT
 /// insert in the block above that, in the hope that the split critical edge
 /// block can be removed later.
 ///
+/// poolLargeConstants
+/// ^^^^^^^^^^^^^^^^^^
+///
+/// This is called from GenXGlobalValueLowering, before memory operations are
+/// lowered, when -vc-constant-pool-threshold is set. It moves irregular vector
+/// constants (not splat, not packed, not predicate) of at least that many
+/// bytes out of the instruction stream into read-only constant globals. Each
+/// function loads such a constant once at its entry and all its uses in the
+/// function take the loaded value. The globals are shared by all functions
+/// in the module, so a table used by several kernels is laid out only once in
+/// the constant data section, and the load is lowered to a block read like
+/// any other load. Smaller or regular constants are left to the immediate
+/// based loading done by loadNonSimpleConstants.
+///
 /// ConstantLoader
 /// ^^^^^^^^^^^^^^
 ///
@@ -92,17 +106,24 @@ SPDX-License-Identifier: MIT
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Dominators.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/InstIterator.h"
 #include "llvmWrapper/IR/Instructions.h"
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/Module.h"
 #include "llvm/IR/ValueMap.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 
+#include "vc/Utils/General/Types.h"
+
 #include "Probe/Assertion.h"
 
 #include "llvmWrapper/IR/Constants.h"
 #include "llvmWrapper/IR/DerivedTypes.h"
+#include "llvmWrapper/Support/Alignment.h"
 #include "llvmWrapper/Support/MathExtras.h"
 #include "llvmWrapper/Support/TypeSize.h"
 
@@ -111,6 +132,11 @@ SPDX-License-Identifier: MIT
 using namespace llvm;
 using namespace genx;
 
+static cl::opt<unsigned> ConstantPoolThreshold(
+    "vc-constant-pool-threshold", cl::init(0), cl::Hidden,
+    cl::desc("Move irregular vector constants of at least this many bytes "
+             "into a module-wide read-only constant pool (0 disables)"));
+
 /***********************************************************************
  * loadConstantStruct : insert instructions to load a constant struct
  */
@@ -998,6 +1024,100 @@ bool genx::isReplicatedConstantVector(
                       [Orig](Constant *Slice) { return Slice == Orig; });
 }
 
+/***********************************************************************
+ * isPoolableConstantUse : check whether a constant operand may be replaced
+ *      with a load from the constant pool
+ *
+ * Only operands that loadNonSimpleConstants would otherwise load with
+ * instructions are considered, so no operand that has to stay an immediate
+ * is touched.
+ */
+static bool isPoolableConstantUse(Instruction *Inst, unsigned OpNum) {
+  if (isa<PHINode>(Inst))
+    return false; // phi constants are loaded by loadPhiConstants
+  if (opMustBeConstant(Inst, OpNum))
+    return false;
+  if (auto *CI = dyn_cast<CallInst>(Inst)) {
+    if (CI->isInlineAsm())
+      return false;
+    if (OpNum >= IGCLLVM::getNumArgOperands(CI))
+      return false; // call target
+    unsigned IID = vc::getAnyIntrinsicID(CI);
+    if (GenXIntrinsic::isAnyNonTrivialIntrinsic(IID) &&
+        !GenXIntrinsic::isGenXIntrinsic(IID))
+      return false; // llvm intrinsics may have immediate-only vector operands
+    switch (IID) {
+    case GenXIntrinsic::genx_alloca:
+    case GenXIntrinsic::genx_constanti:
+    case GenXIntrinsic::genx_constantf:
+    case GenXIntrinsic::genx_constantpred:
+      return false;
+    default:
+      break;
+    }
+  }
+  return true;
+}
+
+/***********************************************************************
+ * poolLargeConstants : move large irregular vector constants into read-only
+ *      globals shared across the module
+ *
+ * Return:  whether code was modified
+ */
+bool genx::poolLargeConstants(Module &M, const GenXSubtarget &Subtarget) {
+  if (!ConstantPoolThreshold)
+    return false;
+  const DataLayout &DL = M.getDataLayout();
+  // Constants are uniqued by the context, so pointer equality is enough to
+  // share a pool entry between all users in all functions.
+  DenseMap<Constant *, GlobalVariable *> Pool;
+  bool Modified = false;
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+    // Each pooled constant is loaded once per function, at its entry, and
+    // the load is shared by all uses in the function.
+    DenseMap<Constant *, Value *> Loads;
+    IRBuilder<> Builder(&*F.getEntryBlock().getFirstInsertionPt());
+    for (Instruction &Inst : instructions(F)) {
+      for (unsigned i = 0, e = Inst.getNumOperands(); i != e; ++i) {
+        auto *C = dyn_cast<ConstantDataVector>(Inst.getOperand(i));
+        if (!C)
+          continue;
+        if (DL.getTypeStoreSize(C->getType()) < ConstantPoolThreshold)
+          continue;
+        if (!isPoolableConstantUse(&Inst, i))
+          continue;
+        ConstantLoader CL(C, Subtarget, DL, &Inst);
+        if (!CL.isIrregular())
+          continue;
+        GlobalVariable *&GV = Pool[C];
+        if (!GV) {
+          GV = new GlobalVariable(M, C->getType(), /*isConstant=*/true,
+                                  GlobalValue::InternalLinkage, C,
+                                  "constpool", nullptr,
+                                  GlobalValue::NotThreadLocal,
+                                  vc::AddrSpace::Constant);
+          GV->setUnnamedAddr(GlobalValue::UnnamedAddr::Global);
+          GV->setAlignment(
+              IGCLLVM::getCorrectAlign(Subtarget.getGRFByteSize()));
+        }
+        Value *&Load = Loads[C];
+        if (!Load)
+          Load = Builder.CreateAlignedLoad(
+              C->getType(), GV,
+              IGCLLVM::getCorrectAlign(Subtarget.getGRFByteSize()),
+              "constpool.load");
+        Inst.setOperand(i, Load);
+        Modified = true;
+      }
+    }
+  }
+  LLVM_DEBUG(dbgs() << "pooled " << Pool.size() << " constants\n");
+  return Modified;
+}
+
 void ConstantLoader::fixSimple(int OperandIdx) {
   IGC_ASSERT_MESSAGE(User, "user must be provided");
   IGC_ASSERT_MESSAGE(NewC, "no need to fix simple case");
@@ -1571,6 +1691,18 @@ bool ConstantLoader::isBigSimple() const {
   return false;
 }
 
+/***********************************************************************
+ * ConstantLoader::isIrregular : detect if a constant can only be built
+ *    element by element, i.e. it is not big simple and not a packed vector
+ */
+bool ConstantLoader::isIrregular() const {
+  if (needFixingSimple())
+    return false; // consolidates into a splat
+  if (isBigSimple())
+    return false;
+  return !isPackedIntVector() && !isPackedFloatVector();
+}
+
 /***********************************************************************
  * ConstantLoader::isSimple : detect if a constant is "simple"
  *
@@ -74,6 +74,7 @@ public:
   bool isBigSimple() const;
   bool isSimple() const;
   bool isLegalSize() const;
+  bool isIrregular() const;
 
 private:
   bool allowI64Ops() const;
@@ -140,6 +141,10 @@ bool loadConstantsForInlineAsm(
 bool loadConstants(Instruction *Inst, const GenXSubtarget &Subtarget,
                    const DataLayout &DL);
 
+// Move large irregular vector constants used in a module into read-only
+// constant globals shared by all its functions, loading them at each use.
+bool poolLargeConstants(Module &M, const GenXSubtarget &Subtarget);
+
 // Load constants used in phi nodes in a function.
 bool loadPhiConstants(Function &F, DominatorTree *DT,
                       const GenXSubtarget &Subtarget, const DataLayout &DL,
@@ -1569,9 +1569,7 @@ bool GenXDebugInfo::runOnModule(Module &M) {
   const auto &BC = getAnalysis<GenXBackendConfig>();
   const FunctionGroupAnalysis &FGA = getAnalysis<FunctionGroupAnalysis>();
 
-  VISABuilder *VB = GM.GetCisaBuilder();
-  if (GM.HasInlineAsm() || !BC.getVISALTOStrings().empty())
-    VB = GM.GetVISAAsmReader();
+  VISABuilder *VB = GM.GetFinalVISABuilder();
   IGC_ASSERT(VB);
 
   const auto &CG = getAnalysis<CallGraphWrapperPass>().getCallGraph();
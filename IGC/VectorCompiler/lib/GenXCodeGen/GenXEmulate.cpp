@@ -37,6 +37,7 @@ SPDX-License-Identifier: MIT
 #include <llvm/CodeGen/TargetPassConfig.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/InstIterator.h>
 #include <llvm/IR/InstVisitor.h>
 #include <llvm/IR/Module.h>
 #include <llvm/Linker/Linker.h>
@@ -49,6 +50,7 @@ SPDX-License-Identifier: MIT
 #include "Probe/Assertion.h"
 
 #include <array>
+#include <set>
 #include <string>
 
 using namespace llvm;
@@ -154,6 +156,10 @@ static cl::opt<bool> OptProcessPtrs("vc-i64emu-ptrs-enable", cl::init(true),
 static cl::opt<bool> OptConvertPartialPredicates(
     "vc-i64emu-icmp-ppred-lowering", cl::init(true), cl::Hidden,
     cl::desc("if \"partial predicates\" shall be converted to icmp"));
+static cl::opt<bool> OptImportAllEmulationRoutines(
+    "vc-emu-import-all", cl::init(false), cl::Hidden,
+    cl::desc("link the whole emulation library instead of the routines the "
+             "module may need"));
 
 using IRBuilder = IRBuilder<TargetFolder>;
 struct OpType {
@@ -2241,7 +2247,8 @@ private:
 };
 
 // The purpose of GenXEmulationImport is just to load platform-specific
-// emulation library and link it into the currently processed module
+// emulation library and link the routines the currently processed module
+// may need into it
 class GenXEmulationImport : public ModulePass {
 public:
   static char ID;
@@ -2258,13 +2265,119 @@ public:
     if (!ModEmuFun)
       return false;
 
-    if (Linker::linkModules(M, std::move(ModEmuFun)))
+    if (OptImportAllEmulationRoutines) {
+      if (ModEmuFun->materializeAll())
+        report_fatal_error("Error loading emulation routines");
+      if (Linker::linkModules(M, std::move(ModEmuFun)))
+        report_fatal_error("Error linking emulation routines");
+      return true;
+    }
+
+    // The library is loaded lazily: only the function headers are read at
+    // this point. Declare the routines GenXEmulate may call in M, the linker
+    // then materializes their bodies and everything they depend on.
+    EmulationDemand Demand = collectEmulationDemand(M);
+    unsigned NumRequired = 0;
+    for (Function &F : *ModEmuFun) {
+      if (F.isDeclaration() || !vc::isEmulationFunction(F) ||
+          !isRoutineRequired(F, Demand))
+        continue;
+      M.getOrInsertFunction(F.getName(), F.getFunctionType());
+      ++NumRequired;
+    }
+    LLVM_DEBUG(dbgs() << "Emulation routines to import: " << NumRequired
+                      << "\n");
+    if (!NumRequired)
+      return false;
+
+    if (Linker::linkModules(M, std::move(ModEmuFun),
+                            Linker::Flags::LinkOnlyNeeded))
       report_fatal_error("Error linking emulation routines");
 
     return true;
   }
 
 private:
+  // Operations of the module that GenXEmulate may lower to a library call.
+  // Div/rem and fp<->int conversions are looked up by opcode and types the
+  // same way GenXEmulate::getEmulationFunction does, fdiv and fsqrt routines
+  // are selected by fast-math flags there, so only the type is tracked.
+  struct EmulationDemand {
+    std::set<OpType, decltype(OpTypeComparator)> OpTypes{OpTypeComparator};
+    SmallPtrSet<Type *, 4> FDivTypes;
+    SmallPtrSet<Type *, 4> FSqrtTypes;
+  };
+
+  static EmulationDemand collectEmulationDemand(const Module &M) {
+    EmulationDemand Demand;
+    auto IsEmulatedOpcode = [](unsigned Opcode) {
+      auto HasOpcode = [Opcode](const PrefixOpcode &PrOp) {
+        return PrOp.Opcode == Opcode;
+      };
+      return llvm::any_of(DivRemPrefixes, HasOpcode) ||
+             llvm::any_of(EmulationFPConvertsPrefixes, HasOpcode);
+    };
+    for (const Function &F : M) {
+      for (const Instruction &Inst : instructions(F)) {
+        Type *Ty = Inst.getType();
+        Type *Ty2 =
+            Inst.getNumOperands() > 0 ? Inst.getOperand(0)->getType() : nullptr;
+        unsigned Opcode = Inst.getOpcode();
+        if (Opcode == Instruction::FDiv) {
+          Demand.FDivTypes.insert(Ty);
+          continue;
+        }
+        if (!isa<CallInst>(Inst)) {
+          if (IsEmulatedOpcode(Opcode))
+            Demand.OpTypes.insert({Opcode, Ty, Ty2});
+          continue;
+        }
+        switch (vc::getAnyIntrinsicID(&Inst)) {
+        default:
+          break;
+        case GenXIntrinsic::genx_fptosi_sat:
+        case GenXIntrinsic::genx_fptoui_sat:
+          Demand.OpTypes.insert({Instruction::FPToSI, Ty, Ty2});
+          break;
+        case GenXIntrinsic::genx_ieee_div:
+          Demand.FDivTypes.insert(Ty);
+          break;
+        case Intrinsic::sqrt:
+        case GenXIntrinsic::genx_sqrt:
+        case GenXIntrinsic::genx_ieee_sqrt:
+          Demand.FSqrtTypes.insert(Ty);
+          break;
+        }
+      }
+    }
+    return Demand;
+  }
+
+  // Checks whether library routine \p F may be referenced once GenXEmulate
+  // lowers the operations recorded in \p Demand. Helpers that are not entry
+  // points are pulled in by the linker through the routines calling them.
+  static bool isRoutineRequired(const Function &F,
+                                const EmulationDemand &Demand) {
+    StringRef Name = F.getName();
+    Type *Ty = F.getReturnType();
+    Type *Ty2 = F.arg_size() > 0 ? F.getFunctionType()->getParamType(0)
+                                 : nullptr;
+    auto MatchesDemand = [&](const PrefixOpcode &PrOp) {
+      return Name.startswith(PrOp.Prefix) &&
+             Demand.OpTypes.count({PrOp.Opcode, Ty, Ty2});
+    };
+    if (llvm::any_of(DivRemPrefixes, MatchesDemand) ||
+        llvm::any_of(EmulationFPConvertsPrefixes, MatchesDemand))
+      return true;
+    if (Name.startswith(EmuLibFDivIEEEPrefix) ||
+        Name.startswith(EmuLibFDivFastPrefix))
+      return Demand.FDivTypes.count(Ty);
+    if (Name.startswith(EmuLibFSqrtIEEEPrefix) ||
+        Name.startswith(EmuLibFSqrtFastPrefix))
+      return Demand.FSqrtTypes.count(Ty);
+    return false;
+  }
+
   std::unique_ptr<Module> LoadEmuFunLib(LLVMContext &Ctx, const DataLayout &DL,
                                         const std::string &Triple) {
 
@@ -2275,7 +2388,8 @@ private:
     if (!EmulationBiFBuffer.getBufferSize())
       return nullptr;
 
-    auto BiFModule = vc::getBiFModuleOrReportError(EmulationBiFBuffer, Ctx);
+    auto BiFModule =
+        vc::getLazyBiFModuleOrReportError(EmulationBiFBuffer, Ctx);
 
     BiFModule->setDataLayout(DL);
     BiFModule->setTargetTriple(Triple);
@@ -31,11 +31,18 @@ SPDX-License-Identifier: MIT
 ///                      [8 x i32]* %array_b.lowered, i64 1
 /// store <2 x [8 x i32]*> %vec, <2 x [8 x i32]*>* %ptr
 ///
+/// Before that, large irregular vector constants may be moved into the
+/// module constant pool (see poolLargeConstants in GenXConstants), so the
+/// globals created for them are lowered here together with the others.
+///
 //===----------------------------------------------------------------------===//
 
 #include "GenX.h"
-#include "GenXUtil.h"
+#include "GenXConstants.h"
 #include "GenXRegionUtils.h"
+#include "GenXSubtarget.h"
+#include "GenXTargetMachine.h"
+#include "GenXUtil.h"
 
 #include "vc/Support/BackendConfig.h"
 #include "vc/Utils/GenX/GlobalVariable.h"
@@ -45,6 +52,7 @@ SPDX-License-Identifier: MIT
 #include <llvm/GenXIntrinsics/GenXIntrinsics.h>
 
 #include <llvm/ADT/STLExtras.h>
+#include <llvm/CodeGen/TargetPassConfig.h>
 #include <llvm/IR/BasicBlock.h>
 #include <llvm/IR/Function.h>
 #include <llvm/IR/GlobalVariable.h>
@@ -135,6 +143,7 @@ void initializeGenXGlobalValueLoweringPass(PassRegistry &);
 INITIALIZE_PASS_BEGIN(GenXGlobalValueLowering, "GenXGlobalValueLowering",
                       "GenXGlobalValueLowering", false, false)
 INITIALIZE_PASS_DEPENDENCY(GenXBackendConfig)
+INITIALIZE_PASS_DEPENDENCY(TargetPassConfig)
 INITIALIZE_PASS_END(GenXGlobalValueLowering, "GenXGlobalValueLowering",
                     "GenXGlobalValueLowering", false, false)
 
@@ -146,11 +155,16 @@ ModulePass *llvm::createGenXGlobalValueLoweringPass() {
 void GenXGlobalValueLowering::getAnalysisUsage(AnalysisUsage &AU) const {
   AU.setPreservesCFG();
   AU.addRequired<GenXBackendConfig>();
+  AU.addRequired<TargetPassConfig>();
 }
 
 bool GenXGlobalValueLowering::runOnModule(Module &M) {
   DL = &M.getDataLayout();
   auto &&BECfg = getAnalysis<GenXBackendConfig>();
+  const auto &ST = getAnalysis<TargetPassConfig>()
+                       .getTM<GenXTargetMachine>()
+                       .getGenXSubtarget();
+  bool Modified = genx::poolLargeConstants(M, ST);
   for (auto &GV : M.globals())
     if (vc::isRealGlobalVariable(GV))
       fillWorkListForGV(GV);
@@ -159,7 +173,7 @@ bool GenXGlobalValueLowering::runOnModule(Module &M) {
       fillWorkListForGV(F);
 
   if (WorkList.empty())
-    return false;
+    return Modified;
 
   for (auto &FuncInfo : WorkList) {
     buildAllConstantReplacementsInFunction(*FuncInfo.first);
@@ -33,6 +33,7 @@ SPDX-License-Identifier: MIT
 #include "llvmWrapper/IR/InstrTypes.h"
 #include "llvmWrapper/IR/Instructions.h"
 
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallSet.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/IR/BasicBlock.h"
@@ -52,6 +53,12 @@ SPDX-License-Identifier: MIT
 using namespace llvm;
 using namespace genx;
 
+std::atomic<uint64_t> LiveRange::LastStamp{0};
+
+// Bound on the number of cached interference results, as entries for stale
+// stamps are never removed individually.
+static constexpr unsigned InterferenceCacheLimit = 1 << 16;
+
 void GenXLiveness::getAnalysisUsage(AnalysisUsage &AU) {
   AU.addRequired<TargetPassConfig>();
   AU.setPreservesAll();
@@ -76,14 +83,13 @@ bool GenXLiveness::runOnFunctionGroup(FunctionGroup &ArgFG)
  */
 void GenXLiveness::releaseMemory() {
   LLVM_DEBUG(dbgs() << "releaseMemory for GenXLivness\n");
-  while (!LiveRangeMap.empty()) {
-    LiveRange *LR = begin()->second;
-    for (auto i = LR->value_begin(), e = LR->value_end(); i != e; ++i) {
-      SimpleValue V = *i;
-      LiveRangeMap.erase(V);
-    }
+  SmallPtrSet<LiveRange *, 32> LRs;
+  for (auto &Entry : LiveRangeMap)
+    LRs.insert(Entry.second);
+  LiveRangeMap.clear();
+  for (LiveRange *LR : LRs)
     delete LR;
-  }
+  InterferenceCache.clear();
   FG = 0;
   CG.reset();
   for (auto i = UnifiedRets.begin(), e = UnifiedRets.end(); i != e; ++i)
@@ -291,6 +297,7 @@ void GenXLiveness::rebuildLiveRange(LiveRange *LR)
   LLVM_DEBUG(dbgs() << "Rebuilding LiveRange: " << *LR << "\n");
   LR->getOrDefaultCategory();
   LR->Segments.clear();
+  LR->touch();
   for (auto vi = LR->value_begin(), ve = LR->value_end(); vi != ve; ++vi)
     rebuildLiveRangeForValue(LR, *vi);
   LR->sortAndMerge();
@@ -574,6 +581,7 @@ LiveRange *GenXLiveness::removeValueNoDelete(SimpleValue V)
   if (&LR->Values[j] != &LR->Values.back())
     LR->Values[j] = LR->Values.back();
   LR->Values.pop_back();
+  LR->touch();
   return LR;
 }
 
@@ -616,6 +624,7 @@ void GenXLiveness::replaceValue(SimpleValue OldVal, SimpleValue NewVal)
   for (j = 0; LR->Values[j].get() != OldVal; ++j)
     IGC_ASSERT(j != LR->Values.size());
   LR->Values[j] = NewVal;
+  LR->touch();
 }
 
 /***********************************************************************
@@ -623,14 +632,14 @@ void GenXLiveness::replaceValue(SimpleValue OldVal, SimpleValue NewVal)
  */
 LiveRange *GenXLiveness::getOrCreateLiveRange(SimpleValue V)
 {
-  auto [i, isInserted] = LiveRangeMap.emplace(V, nullptr);
+  auto [i, isInserted] = LiveRangeMap.try_emplace(V, nullptr);
   LLVM_DEBUG(dbgs() << "getOrCreateLiveRange for SimpleValue: " << V << " "
                     << (isInserted ? "Inserted" : "Not inserted") << "\n");
   LiveRange *LR = i->second;
   if (!LR) {
     // Newly created map entry. Create the LiveRange for it.
     LR = new LiveRange;
-    LR->Values.push_back(V);
+    LR->addValue(V);
     i->second = LR;
     LR->setAlignmentFromValue(
         *DL, V, Subtarget ? Subtarget->getGRFByteSize() : defaultGRFByteSize);
@@ -899,11 +908,41 @@ vc::RegCategory LiveRange::getOrDefaultCategory() {
  * Two live ranges interfere if there is a segment from each that overlap
  * and they are considered to cause interference by
  * checkIfOverlappingSegmentsInterfere below.
+ *
+ * Coalescing asks about the same pairs repeatedly, so the result is cached
+ * for the current stamps of the two live ranges.
  */
 bool GenXLiveness::interfere(LiveRange *LR1, LiveRange *LR2) {
   if (CoalescingDisabled)
     return true;
-  return getSingleInterferenceSites(LR1, LR2, nullptr);
+  auto Key = getInterferenceKey(LR1, LR2);
+  auto Cached = InterferenceCache.find(Key);
+  if (Cached != InterferenceCache.end())
+    return Cached->second;
+  bool Result = getSingleInterferenceSites(LR1, LR2, nullptr);
+  cacheInterference(Key, Result);
+  return Result;
+}
+
+/***********************************************************************
+ * getInterferenceKey : get the interference cache key of two live ranges
+ *
+ * Interference is symmetric, so the key does not depend on the order of
+ * the live ranges.
+ */
+std::pair<uint64_t, uint64_t>
+GenXLiveness::getInterferenceKey(const LiveRange *LR1, const LiveRange *LR2) {
+  uint64_t Stamp1 = LR1->getStamp(), Stamp2 = LR2->getStamp();
+  if (Stamp1 > Stamp2)
+    std::swap(Stamp1, Stamp2);
+  return std::make_pair(Stamp1, Stamp2);
+}
+
+void GenXLiveness::cacheInterference(std::pair<uint64_t, uint64_t> Key,
+                                     bool Interferes) {
+  if (InterferenceCache.size() >= InterferenceCacheLimit)
+    InterferenceCache.clear();
+  InterferenceCache[Key] = Interferes;
 }
 
 /***********************************************************************
@@ -957,11 +996,20 @@ bool GenXLiveness::interfere(LiveRange *LR1, LiveRange *LR2) {
 bool GenXLiveness::twoAddrInterfere(LiveRange *LR1, LiveRange *LR2) {
   if (CoalescingDisabled)
     return true;
+  auto Key = getInterferenceKey(LR1, LR2);
+  auto Cached = InterferenceCache.find(Key);
+  if (Cached != InterferenceCache.end() && !Cached->second)
+    return false; // known not to interfere at all
   SmallVector<unsigned, 4> Sites;
-  if (getSingleInterferenceSites(LR1, LR2, &Sites))
+  if (getSingleInterferenceSites(LR1, LR2, &Sites)) {
+    cacheInterference(Key, true);
     return true; // interferes, not just single number sites
-  if (Sites.empty())
+  }
+  if (Sites.empty()) {
+    cacheInterference(Key, false);
     return false; // does not interfere at all
+  }
+  cacheInterference(Key, true);
   // Put the single number sites in a set.
   SmallSet<unsigned, 4> SitesSet;
   LLVM_DEBUG(dbgs() << "got single number interference sites:");
@@ -994,6 +1042,24 @@ bool GenXLiveness::twoAddrInterfere(LiveRange *LR1, LiveRange *LR2) {
   return !SitesSet.empty();
 }
 
+/***********************************************************************
+ * skipSegmentsEndingBy : skip the segments that end at or before Pos
+ *
+ * Return:  the first segment from I that ends after Pos, or E
+ *
+ * The segments of a live range are sorted and disjoint, so their ends are
+ * increasing too. The next segment is checked first, as it is the usual
+ * answer, then the rest are binary searched.
+ */
+static LiveRange::iterator skipSegmentsEndingBy(LiveRange::iterator I,
+                                                LiveRange::iterator E,
+                                                unsigned Pos) {
+  if (I == E || I->getEnd() > Pos)
+    return I;
+  return std::partition_point(
+      I + 1, E, [Pos](const Segment &S) { return S.getEnd() <= Pos; });
+}
+
 /***********************************************************************
  * getSingleInterferenceSites : check whether two live ranges interfere,
  *      returning single number interference sites
@@ -1021,6 +1087,12 @@ bool GenXLiveness::getSingleInterferenceSites(LiveRange *LR1, LiveRange *LR2,
   // Swap if necessary to make LR1 the one with more segments.
   if (LR1->size() < LR2->size())
     std::swap(LR1, LR2);
+  if (!LR2->size())
+    return false;
+  // The live ranges cannot interfere if one ends before the other starts.
+  if (LR1->Segments.back().getEnd() <= LR2->Segments.front().getStart() ||
+      LR2->Segments.back().getEnd() <= LR1->Segments.front().getStart())
+    return false;
   auto Idx2 = LR2->begin(), End2 = LR2->end();
   // Find segment in LR1 that contains or is the next after the start
   // of the first segment in LR2, including the case that the start of
@@ -1049,12 +1121,15 @@ bool GenXLiveness::getSingleInterferenceSites(LiveRange *LR1, LiveRange *LR2,
           Sites->push_back(Idx1->getStart());
         }
     }
-    // Advance whichever one has the lowest End.
+    // Advance whichever one has the lowest End, past the segments that
+    // end before the other one starts as they cannot overlap anything.
     if (Idx1->getEnd() < Idx2->getEnd()) {
-      if (++Idx1 == End1)
+      Idx1 = skipSegmentsEndingBy(Idx1 + 1, End1, Idx2->getStart());
+      if (Idx1 == End1)
         return false;
     } else {
-      if (++Idx2 == End2)
+      Idx2 = skipSegmentsEndingBy(Idx2 + 1, End2, Idx1->getStart());
+      if (Idx2 == End2)
         return false;
     }
   }
@@ -1649,6 +1724,7 @@ bool LiveRange::testLiveRanges() const
  */
 void LiveRange::addSegment(Segment Seg)
 {
+  touch();
   iterator i = find(Seg.getStart()), e = end();
   if (i == e) {
     // New segment off end.
@@ -1686,6 +1762,7 @@ void LiveRange::addSegment(Segment Seg)
  */
 void LiveRange::setSegmentsFrom(LiveRange *Other)
 {
+  touch();
   Segments.clear();
   Segments.append(Other->Segments.begin(), Other->Segments.end());
 }
@@ -1695,6 +1772,7 @@ void LiveRange::setSegmentsFrom(LiveRange *Other)
  */
 void LiveRange::addSegments(LiveRange *LR2)
 {
+  touch();
   Segments.append(LR2->Segments.begin(), LR2->Segments.end());
 }
 
@@ -1703,6 +1781,7 @@ void LiveRange::addSegments(LiveRange *LR2)
  *      and merge overlapping/adjacent ones
  */
 void LiveRange::sortAndMerge() {
+  touch();
   std::sort(Segments.begin(), Segments.end());
 
   // Ensure that there are no duplicate segments:
@@ -165,11 +165,13 @@ SPDX-License-Identifier: MIT
 #include "Probe/Assertion.h"
 #include "vc/Utils/General/IndexFlattener.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/Value.h"
 #include "llvm/IR/ValueHandle.h"
+#include <atomic>
 #include <map>
 #include <set>
 #include <string>
@@ -330,12 +332,18 @@ public:
 // Also contains a list of each SimpleValue that points to this LiveRange.
 // Also a bitmap of register classes (general, surface, etc) that
 // its def and uses need.
+// Also a stamp that is unique to the current segments and values, so that
+// interference results can be cached (see GenXLiveness::interfere).
 class LiveRange {
   friend class llvm::GenXLiveness;
   typedef SmallVector<Segment, 2> Segments_t;
   Segments_t Segments;
   typedef SmallVector<AssertingSV, 2> Values_t;
   Values_t Values;
+  uint64_t Stamp;
+  // Shared by all the compilations in the process, which may run in
+  // parallel.
+  static std::atomic<uint64_t> LastStamp;
 
 public:
   vc::RegCategory Category;
@@ -343,8 +351,8 @@ public:
   bool DisallowCASC: 1; // disallow call arg special coalescing
   unsigned Offset :12; // kernel arg offset, else 0
   LiveRange()
-      : Category(vc::RegCategory::None), LogAlignment(0), DisallowCASC(false),
-        Offset(0) {}
+      : Stamp(++LastStamp), Category(vc::RegCategory::None), LogAlignment(0),
+        DisallowCASC(false), Offset(0) {}
   // Iterator forwarders for Segments
   typedef Segments_t::iterator iterator;
   typedef Segments_t::const_iterator const_iterator;
@@ -353,7 +361,7 @@ public:
   const_iterator begin() const { return Segments.begin(); }
   const_iterator end() const { return Segments.end(); }
   unsigned size() const { return Segments.size(); }
-  void resize(unsigned len) { Segments.resize(len); }
+  void resize(unsigned len) { Segments.resize(len); touch(); }
   // Iterator forwarders for Values.
   using value_iterator = Values_t::iterator;
   using const_value_iterator = Values_t::const_iterator;
@@ -369,10 +377,16 @@ public:
   // of being equal to the segment's End), or, if in a hole, the
   // iterator of the next segment, or, if at end, end().
   iterator find(unsigned Num);
-  void clear() { Segments.clear(); Values.clear(); }
-  void push_back(Segment Seg) { Segments.push_back(Seg); }
-  void push_back(unsigned S, unsigned E) { Segments.push_back(Segment(S, E)); }
-  SimpleValue addValue(SimpleValue V) { Values.push_back(V); return V; }
+  void clear() { Segments.clear(); Values.clear(); touch(); }
+  void push_back(Segment Seg) { Segments.push_back(Seg); touch(); }
+  void push_back(unsigned S, unsigned E) { push_back(Segment(S, E)); }
+  SimpleValue addValue(SimpleValue V) {
+    Values.push_back(V);
+    touch();
+    return V;
+  }
+  // getStamp : get the stamp of the current segments and values
+  uint64_t getStamp() const { return Stamp; }
   // contains : test whether live range contains instruction number
   bool contains(unsigned Num) {
     iterator i = find(Num);
@@ -408,7 +422,8 @@ public:
   void print(raw_ostream &OS, bool Detailed = false) const;
   void printSegments(raw_ostream &OS) const;
 private:
-  void value_clear() { Values.clear(); }
+  void value_clear() { Values.clear(); touch(); }
+  void touch() { Stamp = ++LastStamp; }
   bool testLiveRanges() const;
 };
 
@@ -456,10 +471,32 @@ public:
 
 } // end namespace genx
 
+// Specialize DenseMapInfo for SimpleValue.
+template <> struct DenseMapInfo<genx::SimpleValue> {
+  static inline genx::SimpleValue getEmptyKey() {
+    return genx::SimpleValue(DenseMapInfo<Value *>::getEmptyKey());
+  }
+  static inline genx::SimpleValue getTombstoneKey() {
+    return genx::SimpleValue(DenseMapInfo<Value *>::getTombstoneKey());
+  }
+  static unsigned getHashValue(const genx::SimpleValue &SV) {
+    return DenseMapInfo<Value *>::getHashValue(SV.getValue()) ^
+           DenseMapInfo<unsigned>::getHashValue(SV.getIndex());
+  }
+  static bool isEqual(const genx::SimpleValue &LHS,
+                      const genx::SimpleValue &RHS) {
+    return LHS == RHS;
+  }
+};
+
 class GenXLiveness : public FGPassImplInterface, public IDMixin<GenXLiveness> {
   FunctionGroup *FG = nullptr;
-  using LiveRangeMap_t = std::map<genx::SimpleValue, genx::LiveRange *>;
+  using LiveRangeMap_t = DenseMap<genx::SimpleValue, genx::LiveRange *>;
   LiveRangeMap_t LiveRangeMap;
+  // Results of interfere() keyed by the stamps of the two live ranges. A
+  // live range gets a new stamp whenever its segments or values change
+  // (merge, rebuildLiveRange, ...), which invalidates its entries.
+  DenseMap<std::pair<uint64_t, uint64_t>, bool> InterferenceCache;
   std::unique_ptr<genx::CallGraph> CG;
   GenXBaling *Baling = nullptr;
   GenXNumbering *Numbering = nullptr;
@@ -482,6 +519,9 @@ public:
   bool runOnFunctionGroup(FunctionGroup &FG) override;
   // setBaling : tell GenXLiveness where GenXBaling is
   void setBaling(GenXBaling *B) { Baling = B; }
+  // setDataLayout : tell GenXLiveness the data layout when live ranges are
+  // built without running the analysis
+  void setDataLayout(const DataLayout *D) { DL = D; }
   // experimental option to extend all LR till the end of a function
   void setNoCoalescingMode(bool NoCoalescingMode) {
     CoalescingDisabled = NoCoalescingMode;
@@ -601,30 +641,15 @@ private:
   void rebuildLiveRangeForValue(genx::LiveRange *LR, genx::SimpleValue SV);
   genx::LiveRange *visitPropagateSLRs(Function *F);
   void merge(genx::LiveRange *LR1, genx::LiveRange *LR2);
+  static std::pair<uint64_t, uint64_t>
+  getInterferenceKey(const genx::LiveRange *LR1, const genx::LiveRange *LR2);
+  void cacheInterference(std::pair<uint64_t, uint64_t> Key, bool Interferes);
   void printValueLiveness(genx::SimpleValue SV, raw_ostream &OS) const;
 };
 using GenXLivenessWrapper = FunctionGroupWrapperPass<GenXLiveness>;
 
 void initializeGenXLivenessWrapperPass(PassRegistry &);
 
-// Specialize DenseMapInfo for SimpleValue.
-template <> struct DenseMapInfo<genx::SimpleValue> {
-  static inline genx::SimpleValue getEmptyKey() {
-    return genx::SimpleValue(DenseMapInfo<Value *>::getEmptyKey());
-  }
-  static inline genx::SimpleValue getTombstoneKey() {
-    return genx::SimpleValue(DenseMapInfo<Value *>::getTombstoneKey());
-  }
-  static unsigned getHashValue(const genx::SimpleValue &SV) {
-    return DenseMapInfo<Value *>::getHashValue(SV.getValue()) ^
-           DenseMapInfo<unsigned>::getHashValue(SV.getIndex());
-  }
-  static bool isEqual(const genx::SimpleValue &LHS,
-                      const genx::SimpleValue &RHS) {
-    return LHS == RHS;
-  }
-};
-
 } // end namespace llvm
 namespace std {
 template <> struct hash<llvm::genx::Segment> {
@@ -84,6 +84,8 @@ namespace llvm {
 
     bool InlineAsm = false;
     bool CheckForInlineAsm(Module &M) const;
+    bool NeedsVISAParser() const;
+    bool VISALTOStringsLinked = false;
 
     bool DisableFinalizerOpts = false;
     bool EmitDebugInformation = false;
@@ -99,6 +101,7 @@ namespace llvm {
       VisaCounter.clear();
       DestroyCISABuilder();
       DestroyVISAAsmReader();
+      VISALTOStringsLinked = false;
       ArgStorage.Reset();
     }
 
@@ -124,6 +127,11 @@ namespace llvm {
     bool HasInlineAsm() const { return InlineAsm; }
     VISABuilder *GetCisaBuilder();
     VISABuilder *GetVISAAsmReader();
+    // Whether inline assembly and vISA LTO modules are resolved by printing
+    // the whole module as vISA text and parsing it back.
+    bool UseVISATextRoundTrip() const;
+    // Returns the builder holding the vISA of the whole module.
+    VISABuilder *GetFinalVISABuilder();
     void DestroyCISABuilder();
     void DestroyVISAAsmReader();
     LLVMContext &getContext();
@@ -868,8 +868,7 @@ bool GenXOCLRuntimeInfo::runOnModule(Module &M) {
                        .getGenXSubtarget();
   const auto &DBG = getAnalysis<GenXDebugInfo>();
 
-  VISABuilder &VB =
-      *((GM.HasInlineAsm() || !BC.getVISALTOStrings().empty()) ? GM.GetVISAAsmReader() : GM.GetCisaBuilder());
+  VISABuilder &VB = *GM.GetFinalVISABuilder();
 
   CompiledModule = RuntimeInfoCollector{FGA, BC, VB, ST, M, DBG}.run();
   return false;
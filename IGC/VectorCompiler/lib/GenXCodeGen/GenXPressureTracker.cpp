@@ -102,6 +102,20 @@ void PressureTracker::decreasePressure(LiveRange *LR) {
   calculateRedSegments();
 }
 
+void PressureTracker::decreasePressure(LiveRange *LR, unsigned From) {
+  if (!LR || LR->getCategory() == vc::RegCategory::None)
+    return;
+  unsigned Bytes = getSizeInBytes(LR, /*AllowWidening*/ false);
+  for (auto SI = LR->begin(), SE = LR->end(); SI != SE; ++SI) {
+    for (unsigned i = std::max(SI->getStart(), From); i < SI->getEnd(); ++i) {
+      IGC_ASSERT(i < Pressure.size());
+      IGC_ASSERT(Pressure[i] >= Bytes);
+      Pressure[i] -= Bytes;
+    }
+  }
+  calculateRedSegments();
+}
+
 void PressureTracker::calculate() {
   std::vector<LiveRange *> LRs;
   getLiveRanges(LRs);
@@ -132,7 +146,7 @@ void PressureTracker::calculateRedSegments() {
   unsigned B = UNDEF;
   unsigned E = UNDEF;
   for (unsigned i = 0; i < Pressure.size(); ++i) {
-    if (Pressure[i] >= THRESHOLD) {
+    if (Pressure[i] >= Threshold) {
       if (B == UNDEF)
         B = i;
       else
@@ -145,6 +159,9 @@ void PressureTracker::calculateRedSegments() {
       B = E = UNDEF;
     }
   }
+  // The last instructions may still be under high pressure.
+  if (B != UNDEF)
+    HighPressureSegments.emplace_back(B, E != UNDEF ? E : B);
 }
 
 // Check if segment [B, E] intersects with a high pressure region or not.
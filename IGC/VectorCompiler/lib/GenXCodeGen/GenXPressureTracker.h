@@ -33,6 +33,9 @@ class PressureTracker {
   std::vector<unsigned> Pressure;
 
   static const unsigned THRESHOLD = sizeof(float) * 8 * 120;
+  // Pressure in bytes starting from which an instruction is in a high
+  // pressure region.
+  unsigned Threshold;
   struct Segment {
     unsigned Begin;
     unsigned End;
@@ -42,8 +45,10 @@ class PressureTracker {
 
 public:
   PressureTracker(const DataLayout& DL, FunctionGroup &FG, GenXLiveness *L,
-                  bool WithByteWidening = false)
-      : DL(DL), FG(FG), Liveness(L), WithByteWidening(WithByteWidening) {
+                  bool WithByteWidening = false,
+                  unsigned Threshold = THRESHOLD)
+      : DL(DL), FG(FG), Liveness(L), WithByteWidening(WithByteWidening),
+        Threshold(Threshold) {
     calculate();
     calculateRedSegments();
   }
@@ -64,6 +69,22 @@ public:
   // Decrease pressure assuming no widening on variable for LR.
   void decreasePressure(LiveRange *LR);
 
+  // Decrease pressure by the size of LR on the parts of its segments from
+  // instruction number From on, e.g. after its uses past From have been
+  // rematerialized. The holes in LR are left alone.
+  void decreasePressure(LiveRange *LR, unsigned From);
+
+  // Return the pressure in bytes at instruction number Num.
+  unsigned getPressure(unsigned Num) const {
+    return Num < Pressure.size() ? Pressure[Num] : 0;
+  }
+
+  // Return the threshold in bytes for a register file of NumGRFs registers,
+  // leaving some registers to the finalizer.
+  static unsigned getGRFBudget(unsigned NumGRFs, unsigned GRFByteSize) {
+    return (NumGRFs - NumGRFs / 16) * GRFByteSize;
+  }
+
 private:
   void getLiveRanges(std::vector<LiveRange *> &LRs);
   void getLiveRangesForValue(Value *V, std::vector<LiveRange *> &LRs) const;
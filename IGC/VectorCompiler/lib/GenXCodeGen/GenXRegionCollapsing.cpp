@@ -31,6 +31,12 @@ SPDX-License-Identifier: MIT
 /// multiple bitcasts (from CM format()) or up to one SExt/ZExt (from a cast) in
 /// between.
 ///
+/// Deeply nested accesses are visited many times while the pass walks chains
+/// from each of their members, so the Region of a rdregion/wrregion is cached
+/// per instruction and reused for as long as the instruction's operands stay
+/// the same, and a wrregion found not to collapse is not walked again until
+/// the code changes.
+///
 //===----------------------------------------------------------------------===//
 #include "GenX.h"
 #include "GenXBaling.h"
@@ -38,7 +44,10 @@ SPDX-License-Identifier: MIT
 
 #include "vc/Utils/GenX/GlobalVariable.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/PostOrderIterator.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/CFG.h"
 #include "llvm/Analysis/InstructionSimplify.h"
 #include "llvm/IR/BasicBlock.h"
@@ -48,6 +57,7 @@ SPDX-License-Identifier: MIT
 #include "llvm/IR/Function.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/Intrinsics.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/InitializePasses.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Transforms/Utils/Local.h"
@@ -60,6 +70,11 @@ SPDX-License-Identifier: MIT
 using namespace llvm;
 using namespace genx;
 
+STATISTIC(NumRdRegionsCollapsed, "Number of collapsed rdregions");
+STATISTIC(NumWrRegionsCollapsed, "Number of collapsed wrregions");
+STATISTIC(NumRegionCacheHits, "Number of region descriptors reused");
+STATISTIC(NumRegionCacheMisses, "Number of region descriptors built");
+
 namespace {
 
 // GenX region collapsing pass
@@ -67,6 +82,12 @@ class GenXRegionCollapsing : public FunctionPass {
   const DataLayout *DL = nullptr;
   const DominatorTree *DT = nullptr;
   bool Modified = false;
+
+  genx::RegionWithOffsetCache RegionCache;
+  // wrregions that processWrRegion/processWrRegionSplat have found not to
+  // collapse since the code was last modified.
+  SmallPtrSet<const Instruction *, 16> UncollapsedWrRegions;
+  SmallPtrSet<const Instruction *, 16> UncollapsedSplatWrRegions;
 public:
   static char ID;
   explicit GenXRegionCollapsing() : FunctionPass(ID) { }
@@ -76,6 +97,11 @@ public:
     AU.setPreservesCFG();
   }
   bool runOnFunction(Function &F) override;
+  void releaseMemory() override {
+    RegionCache.clear();
+    UncollapsedWrRegions.clear();
+    UncollapsedSplatWrRegions.clear();
+  }
 
 private:
   void runOnBasicBlock(BasicBlock *BB);
@@ -86,7 +112,15 @@ private:
   Instruction *processWrRegionBitCast(Instruction *WrRegion);
   void processWrRegionBitCast2(Instruction *WrRegion);
   Instruction *processWrRegion(Instruction *OuterWr);
+  Instruction *collapseWrRegion(Instruction *OuterWr);
   Instruction *processWrRegionSplat(Instruction *OuterWr);
+  Instruction *collapseWrRegionSplat(Instruction *OuterWr);
+  Region getRegionWithOffset(const Instruction *Inst,
+                             bool WantParentWidth = false);
+  void forgetUncollapsedWrRegions() {
+    UncollapsedWrRegions.clear();
+    UncollapsedSplatWrRegions.clear();
+  }
   bool normalizeElementType(Region *R1, Region *R2, bool PreferFirst = false);
   bool combineRegions(const Region *OuterR, const Region *InnerR,
                       Region *CombinedR);
@@ -147,6 +181,7 @@ bool GenXRegionCollapsing::runOnFunction(Function &F)
     } while (Modified);
   }
 
+  releaseMemory();
   return Changed;
 }
 
@@ -264,7 +299,14 @@ void GenXRegionCollapsing::runOnBasicBlock(BasicBlock *BB) {
   // This loop processes instructions in reverse, tolerating an instruction
   // being removed during its processing, and not re-processing any new
   // instructions added during the processing of an instruction.
+  forgetUncollapsedWrRegions();
+  bool ModifiedBefore = Modified;
   for (Instruction *Prev = BB->getTerminator(); Prev;) {
+    // Whatever was found not to collapse may collapse once the code changed.
+    if (Modified)
+      forgetUncollapsedWrRegions();
+    ModifiedBefore |= Modified;
+    Modified = false;
     Instruction *Inst = Prev;
     Prev = nullptr;
     if (Inst != &BB->front())
@@ -311,6 +353,7 @@ void GenXRegionCollapsing::runOnBasicBlock(BasicBlock *BB) {
       break;
     }
   }
+  Modified |= ModifiedBefore;
 }
 
 /***********************************************************************
@@ -495,7 +538,7 @@ void GenXRegionCollapsing::processRdRegion(Instruction *InnerRd)
   // (in Region::Indirect and Region::Offset).
   // Then our index calculations can ensure that the constant add remains th
   // last thing that happens in the calculation.
-  Region InnerR = genx::makeRegionWithOffset(InnerRd,
+  Region InnerR = getRegionWithOffset(InnerRd,
                                              /*WantParentWidth=*/true);
 
   // Prevent region collapsing for specific src replication pattern,
@@ -558,7 +601,7 @@ void GenXRegionCollapsing::processRdRegion(Instruction *InnerRd)
     }
     if (!OuterRd)
       break; // no outer rdregion that we can combine with
-    Region OuterR = genx::makeRegionWithOffset(OuterRd);
+    Region OuterR = getRegionWithOffset(OuterRd);
     // There was a sext/zext. Because we are going to put that after the
     // collapsed region, we want to modify the inner region to the
     // extend's input element type without changing the region parameters
@@ -588,9 +631,13 @@ void GenXRegionCollapsing::processRdRegion(Instruction *InnerRd)
     // then check if there exist some other extracts
     if (OuterR.Indirect && (OuterR.NumElements != 1) &&
         isSingleElementRdRExtract(InnerRd)) {
-      auto NumExtracts = llvm::count_if(OuterRd->uses(), [this](Use &U) {
-        return isSingleElementRdRExtract(cast<Instruction>(U.getUser()));
-      });
+      // Stop counting at the second extract: OuterRd may have lots of uses.
+      unsigned NumExtracts = 0;
+      for (Use &U : OuterRd->uses()) {
+        if (isSingleElementRdRExtract(cast<Instruction>(U.getUser())) &&
+            ++NumExtracts > 1)
+          break;
+      }
       // If there are some more extracts except this one (InnerRd)
       // then not combine these regions to prevent generation
       // of extra address conversions for a combined region
@@ -658,11 +705,12 @@ void GenXRegionCollapsing::processRdRegion(Instruction *InnerRd)
     InnerRd->replaceAllUsesWith(NewVal);
     InnerRd->eraseFromParent();
     Modified = true;
+    ++NumRdRegionsCollapsed;
     // Check whether we just created a bitcast that can be combined with its
     // user. If so, combine them.
     combineBitCastWithUser(NewVal);
     InnerRd = CombinedRd;
-    InnerR = genx::makeRegionWithOffset(InnerRd, /*WantParentWidth=*/true);
+    InnerR = getRegionWithOffset(InnerRd, /*WantParentWidth=*/true);
     // Because the loop in runOnFunction does not re-process the new rdregion,
     // loop back here to re-process it.
   }
@@ -759,6 +807,7 @@ void GenXRegionCollapsing::processWrRegionElim(Instruction *OuterWr)
   OuterWr->replaceAllUsesWith(CombinedWr);
   // Do not erase OuterWr here -- it gets erased by the caller.
   Modified = true;
+  ++NumWrRegionsCollapsed;
 }
 
 /***********************************************************************
@@ -907,7 +956,16 @@ static bool isBitwiseIdentical(Value *V1, Value *V2, const DominatorTree *DT) {
  * here, we use recursion to scan back to find the innermost one and then work
  * forwards to where we started.
  */
-Instruction *GenXRegionCollapsing::processWrRegion(Instruction *OuterWr)
+Instruction *GenXRegionCollapsing::processWrRegion(Instruction *OuterWr) {
+  if (UncollapsedWrRegions.count(OuterWr))
+    return OuterWr;
+  Instruction *Res = collapseWrRegion(OuterWr);
+  if (Res == OuterWr)
+    UncollapsedWrRegions.insert(OuterWr);
+  return Res;
+}
+
+Instruction *GenXRegionCollapsing::collapseWrRegion(Instruction *OuterWr)
 {
   IGC_ASSERT(OuterWr);
   // Find the inner wrregion, skipping bitcasts.
@@ -933,9 +991,9 @@ Instruction *GenXRegionCollapsing::processWrRegion(Instruction *OuterWr)
     return OuterWr;
   if (GenXIntrinsic::isReadPredefReg(OuterRd->getOperand(0)))
     return OuterWr;
-  Region InnerR = genx::makeRegionWithOffset(InnerWr, /*WantParentWidth=*/true);
-  Region OuterR = genx::makeRegionWithOffset(OuterWr);
-  if (OuterR != genx::makeRegionWithOffset(OuterRd))
+  Region InnerR = getRegionWithOffset(InnerWr, /*WantParentWidth=*/true);
+  Region OuterR = getRegionWithOffset(OuterWr);
+  if (OuterR != getRegionWithOffset(OuterRd))
     return OuterWr;
   // See if the regions can be combined.
   LLVM_DEBUG(debugPrintInnerOuter("GenXRegionCollapsing::processWrRegion\n",
@@ -981,6 +1039,7 @@ Instruction *GenXRegionCollapsing::processWrRegion(Instruction *OuterWr)
   // eventually get visited and then erased as it has no uses.  For an outer
   // call of processWrRegion, OuterWr is erased by the caller.
   Modified = true;
+  ++NumWrRegionsCollapsed;
   return CombinedWr;
 }
 
@@ -1007,7 +1066,16 @@ Instruction *GenXRegionCollapsing::processWrRegion(Instruction *OuterWr)
  * here, we use recursion to scan back to find the innermost one and then work
  * forwards to where we started.
  */
-Instruction *GenXRegionCollapsing::processWrRegionSplat(Instruction *OuterWr)
+Instruction *GenXRegionCollapsing::processWrRegionSplat(Instruction *OuterWr) {
+  if (UncollapsedSplatWrRegions.count(OuterWr))
+    return OuterWr;
+  Instruction *Res = collapseWrRegionSplat(OuterWr);
+  if (Res == OuterWr)
+    UncollapsedSplatWrRegions.insert(OuterWr);
+  return Res;
+}
+
+Instruction *GenXRegionCollapsing::collapseWrRegionSplat(Instruction *OuterWr)
 {
   IGC_ASSERT(OuterWr);
   // Find the inner wrregion, skipping bitcasts.
@@ -1041,8 +1109,8 @@ Instruction *GenXRegionCollapsing::processWrRegionSplat(Instruction *OuterWr)
       return OuterWr;
   }
 
-  Region InnerR = genx::makeRegionWithOffset(InnerWr, /*WantParentWidth=*/true);
-  Region OuterR = genx::makeRegionWithOffset(OuterWr);
+  Region InnerR = getRegionWithOffset(InnerWr, /*WantParentWidth=*/true);
+  Region OuterR = getRegionWithOffset(OuterWr);
   Region CombinedR;
   if (!combineRegions(&OuterR, &InnerR, &CombinedR))
     return OuterWr; // cannot combine
@@ -1079,6 +1147,7 @@ Instruction *GenXRegionCollapsing::processWrRegionSplat(Instruction *OuterWr)
   // eventually get visited and then erased as it has no uses.  For an outer
   // call of processWrRegionSplat, OuterWr is erased by the caller.
   Modified = true;
+  ++NumWrRegionsCollapsed;
   return CombinedWr;
 }
 
@@ -1422,9 +1491,24 @@ Value *GenXRegionCollapsing::insertOp(Instruction::BinaryOps Opcode, Value *Lhs,
   return Inst;
 }
 
+/***********************************************************************
+ * getRegionWithOffset : genx::makeRegionWithOffset, reusing the Region
+ *    built for the same instruction while it is up to date
+ */
+Region GenXRegionCollapsing::getRegionWithOffset(const Instruction *Inst,
+                                                 bool WantParentWidth) {
+  bool IsHit = false;
+  Region R = RegionCache.get(Inst, WantParentWidth, &IsHit);
+  if (IsHit)
+    ++NumRegionCacheHits;
+  else
+    ++NumRegionCacheMisses;
+  return R;
+}
+
 bool GenXRegionCollapsing::isSingleElementRdRExtract(Instruction *I) {
   if (!GenXIntrinsic::isRdRegion(I))
     return false;
-  Region R = genx::makeRegionWithOffset(I, /*WantParentWidth=*/true);
+  Region R = getRegionWithOffset(I, /*WantParentWidth=*/true);
   return R.NumElements == 1 && !R.Indirect;
 }
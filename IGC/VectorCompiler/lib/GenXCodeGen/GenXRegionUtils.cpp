@@ -136,6 +136,53 @@ Region genx::makeRegionWithOffset(const Instruction *Inst,
   return makeRegionFromBaleInfo(Inst, BI, WantParentWidth);
 }
 
+/***********************************************************************
+ * RegionWithOffsetCache::get : makeRegionWithOffset, reusing the Region
+ *    built for the same instruction while its operands, and those of its
+ *    balable index add, are unchanged
+ */
+Region RegionWithOffsetCache::get(const Instruction *Inst,
+                                  bool WantParentWidth, bool *IsHit) {
+  unsigned IndexOperandNum = GenXIntrinsic::isRdRegion(Inst)
+                                 ? GenXIntrinsic::GenXRegion::RdIndexOperandNum
+                                 : GenXIntrinsic::GenXRegion::WrIndexOperandNum;
+  Value *Index = Inst->getOperand(IndexOperandNum);
+  const Instruction *IndexAdd = nullptr;
+  if (GenXBaling::isBalableIndexAdd(Index))
+    IndexAdd = cast<Instruction>(Index);
+  auto IsUpToDate = [Inst, IndexAdd](const Entry &E) {
+    if (E.Inst != Inst || E.Operands.size() != Inst->getNumOperands())
+      return false;
+    for (unsigned i = 0, e = Inst->getNumOperands(); i != e; ++i)
+      if (E.Operands[i] != Inst->getOperand(i))
+        return false;
+    if (!IndexAdd)
+      return E.IndexOperands.empty();
+    if (E.IndexOperands.size() != IndexAdd->getNumOperands())
+      return false;
+    for (unsigned i = 0, e = IndexAdd->getNumOperands(); i != e; ++i)
+      if (E.IndexOperands[i] != IndexAdd->getOperand(i))
+        return false;
+    return true;
+  };
+  Entry &E = Cache[{Inst, unsigned(WantParentWidth)}];
+  bool Hit = IsUpToDate(E);
+  if (IsHit)
+    *IsHit = Hit;
+  if (Hit)
+    return E.R;
+  E.R = makeRegionWithOffset(Inst, WantParentWidth);
+  E.Inst = const_cast<Instruction *>(Inst);
+  E.Operands.clear();
+  for (Value *Op : Inst->operands())
+    E.Operands.push_back(Op);
+  E.IndexOperands.clear();
+  if (IndexAdd)
+    for (Value *Op : IndexAdd->operands())
+      E.IndexOperands.push_back(Op);
+  return E.R;
+}
+
 /***********************************************************************
  * Region constructor from a rd/wr region and its BaleInfo
  * This also works with rdpredregion and wrpredregion, with Offset in
@@ -53,7 +53,10 @@ SPDX-License-Identifier: MIT
 #include "vc/Utils/GenX/Region.h"
 
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallBitVector.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/ValueHandle.h"
 
 namespace llvm {
     class Constant;
@@ -82,6 +85,28 @@ Region makeRegionWithOffset(const Instruction *Inst,
 Region makeRegionFromBaleInfo(const Instruction *Inst, const BaleInfo &BI,
                               bool WantParentWidth = false);
 
+// RegionWithOffsetCache : makeRegionWithOffset, reusing the Region built for
+// an instruction while it is up to date. An entry is stale once the
+// instruction is erased or any of its operands is replaced. The index add
+// that may be baled in (an add, sub or genx.add.addr with a constant offset)
+// gives Region::Indirect and part of Region::Offset, so its operands are
+// checked as well.
+class RegionWithOffsetCache {
+  struct Entry {
+    WeakVH Inst;
+    SmallVector<WeakVH, 8> Operands;
+    SmallVector<WeakVH, 2> IndexOperands;
+    Region R;
+  };
+  DenseMap<std::pair<const Instruction *, unsigned>, Entry> Cache;
+
+public:
+  // Get the region, setting IsHit (if not null) to whether it was reused.
+  Region get(const Instruction *Inst, bool WantParentWidth = false,
+             bool *IsHit = nullptr);
+  void clear() { Cache.clear(); }
+};
+
 // getLegalSize : get the max legal size of a region
 unsigned getLegalRegionSizeForTarget(const GenXSubtarget &ST, const Region &R,
                                      unsigned Idx, bool Allow2D,
@@ -12,6 +12,24 @@ SPDX-License-Identifier: MIT
 ///
 /// This pass performs rematerialization to reduce register pressure.
 ///
+/// The pressure is tracked per instruction number in bytes on the baled IR,
+/// and the high pressure threshold follows the register file of the
+/// subtarget. A value is rematerialized right before those of its uses that
+/// are only reached through a high pressure region, when the value is:
+///
+/// * a vector upward int-to-fp cast with at least 3 uses;
+///
+/// * a region read with a constant offset whose source is live at the use
+///   anyway, so cloning it does not extend any other live range.
+///
+/// The candidates are visited in program order and the pressure is updated
+/// after each of them, so the pass stops touching the code once the pressure
+/// gets under the threshold.
+///
+/// Rematerialization is the only way this pass reduces the pressure. Sinking
+/// is done later by GenXDepressurizer on the codegen baled IR with its own
+/// flag-aware model, and wide vectors are not split to fit the register file.
+///
 //===----------------------------------------------------------------------===//
 #include "GenX.h"
 #include "GenXBaling.h"
@@ -19,13 +37,34 @@ SPDX-License-Identifier: MIT
 #include "GenXModule.h"
 #include "GenXNumbering.h"
 #include "GenXPressureTracker.h"
+#include "GenXRematerialization.h"
+#include "GenXSubtarget.h"
+#include "GenXTargetMachine.h"
 #include "GenXUtil.h"
+
+#include "vc/Support/BackendConfig.h"
+
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/TargetPassConfig.h"
+#include "llvm/GenXIntrinsics/GenXIntrinsics.h"
+#include "llvm/InitializePasses.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
 #include "Probe/Assertion.h"
 
+#define DEBUG_TYPE "GENX_REMAT"
+
 using namespace llvm;
 using namespace genx;
 
+STATISTIC(NumRematCasts, "Number of rematerialized casts");
+STATISTIC(NumRematRegionReads, "Number of rematerialized region reads");
+
+static cl::opt<bool>
+    RematRegionReads("vc-remat-region-reads", cl::init(true), cl::Hidden,
+                     cl::desc("Rematerialize region reads under high "
+                              "register pressure"));
+
 namespace {
 
 class GenXRematerialization : public FGPassImplInterface,
@@ -33,6 +72,7 @@ class GenXRematerialization : public FGPassImplInterface,
   GenXBaling *Baling = nullptr;
   GenXLiveness *Liveness = nullptr;
   GenXNumbering *Numbering = nullptr;
+  const GenXSubtarget *ST = nullptr;
   bool Modified = false;
 
 public:
@@ -58,6 +98,8 @@ INITIALIZE_PASS_BEGIN(GenXRematerializationWrapper,
 INITIALIZE_PASS_DEPENDENCY(GenXGroupBalingWrapper)
 INITIALIZE_PASS_DEPENDENCY(GenXLivenessWrapper)
 INITIALIZE_PASS_DEPENDENCY(GenXNumberingWrapper)
+INITIALIZE_PASS_DEPENDENCY(GenXBackendConfig)
+INITIALIZE_PASS_DEPENDENCY(TargetPassConfig)
 INITIALIZE_PASS_END(GenXRematerializationWrapper,
                     "GenXRematerializationWrapper",
                     "GenXRematerializationWrapper", false, false)
@@ -71,6 +113,8 @@ void GenXRematerialization::getAnalysisUsage(AnalysisUsage &AU) {
   AU.addRequired<GenXGroupBaling>();
   AU.addRequired<GenXLiveness>();
   AU.addRequired<GenXNumbering>();
+  AU.addRequired<GenXBackendConfig>();
+  AU.addRequired<TargetPassConfig>();
   AU.addPreserved<GenXModule>();
   AU.addPreserved<FunctionGroupAnalysis>();
   AU.setPreservesCFG();
@@ -84,52 +128,118 @@ bool GenXRematerialization::runOnFunctionGroup(FunctionGroup &FG) {
   Baling = &getAnalysis<GenXGroupBaling>();
   Liveness = &getAnalysis<GenXLiveness>();
   Numbering = &getAnalysis<GenXNumbering>();
+  ST = &getAnalysis<TargetPassConfig>()
+            .getTM<GenXTargetMachine>()
+            .getGenXSubtarget();
+  unsigned NumGRFs =
+      getAnalysis<GenXBackendConfig>().isLargeGRFMode() ? 256 : 128;
   const auto &DL = FG.getModule()->getDataLayout();
-  PressureTracker RP(DL, FG, Liveness);
+  PressureTracker RP(
+      DL, FG, Liveness, /*WithByteWidening*/ false,
+      PressureTracker::getGRFBudget(NumGRFs, ST->getGRFByteSize()));
   for (auto fgi = FG.begin(), fge = FG.end(); fgi != fge; ++fgi)
     remat(*fgi, RP);
   return Modified;
 }
 
 void GenXRematerialization::remat(Function *F, PressureTracker &RP) {
+  Rematerializer Remat(*Liveness, *Numbering, RP, RematRegionReads);
   // Collect rematerialization candidates.
-  std::vector<Use *> Candidates;
-  for (auto &BB : F->getBasicBlockList()) {
-    for (auto &Inst : BB.getInstList()) {
-      // (1) upward cast
-      if (auto CI = dyn_cast<CastInst>(&Inst)) {
-        if (CI->getOpcode() != Instruction::UIToFP &&
-            CI->getOpcode() != Instruction::SIToFP)
-          continue;
-        if (!CI->getType()->isVectorTy())
-          continue;
-        if (CI->getSrcTy()->getScalarSizeInBits() >=
-            CI->getDestTy()->getScalarSizeInBits())
-          continue;
-        if (Inst.isUsedOutsideOfBlock(&BB) || !Inst.hasNUsesOrMore(3))
-          continue;
-        LiveRange *LR = Liveness->getLiveRangeOrNull(CI);
-        if (!LR || LR->value_size() != 1)
-          continue;
-        IGC_ASSERT(LR->value_begin()->getValue() == CI);
-        unsigned B = Numbering->getNumber(CI);
-        for (auto &U : CI->uses()) {
-          auto UI = U.getUser();
-          unsigned E = Numbering->getNumber(UI);
-          if (E > B && RP.intersectWithRedRegion(B, E))
-            Candidates.push_back(&U);
-        }
-      }
-    }
+  std::vector<Instruction *> Candidates;
+  for (auto &BB : F->getBasicBlockList())
+    for (auto &Inst : BB.getInstList())
+      if (Remat.isCandidate(Inst))
+        Candidates.push_back(&Inst);
+
+  // Do rematerialization, the pressure is updated after each candidate so
+  // that later ones only see the high pressure regions that are left.
+  for (auto *Inst : Candidates) {
+    unsigned NumClones = Remat.remat(*Inst);
+    if (!NumClones)
+      continue;
+    if (GenXIntrinsic::isRdRegion(Inst))
+      NumRematRegionReads += NumClones;
+    else
+      NumRematCasts += NumClones;
+    Modified = true;
+  }
+}
+
+// An upward int-to-fp vector cast is cheaper to redo than to keep live.
+bool Rematerializer::isUpwardCastCandidate(const Instruction &Inst) const {
+  auto CI = dyn_cast<CastInst>(&Inst);
+  if (!CI)
+    return false;
+  if (CI->getOpcode() != Instruction::UIToFP &&
+      CI->getOpcode() != Instruction::SIToFP)
+    return false;
+  if (!CI->getType()->isVectorTy())
+    return false;
+  if (CI->getSrcTy()->getScalarSizeInBits() >=
+      CI->getDestTy()->getScalarSizeInBits())
+    return false;
+  return Inst.hasNUsesOrMore(3);
+}
+
+// A region read with a constant offset from a value that stays live at the
+// rematerialization point costs nothing but the read itself, which is
+// usually baled into the user later.
+bool Rematerializer::isRegionReadCandidate(const Instruction &Inst) const {
+  if (!WithRegionReads || !GenXIntrinsic::isRdRegion(&Inst))
+    return false;
+  if (!isa<Constant>(
+          Inst.getOperand(GenXIntrinsic::GenXRegion::RdIndexOperandNum)))
+    return false;
+  LiveRange *SrcLR = Liveness.getLiveRangeOrNull(
+      Inst.getOperand(GenXIntrinsic::GenXRegion::OldValueOperandNum));
+  return SrcLR && SrcLR->getCategory() == vc::RegCategory::General;
+}
+
+bool Rematerializer::isCandidate(const Instruction &Inst) const {
+  if (Inst.isUsedOutsideOfBlock(Inst.getParent()))
+    return false;
+  if (!isUpwardCastCandidate(Inst) && !isRegionReadCandidate(Inst))
+    return false;
+  LiveRange *LR = Liveness.getLiveRangeOrNull(const_cast<Instruction *>(&Inst));
+  if (!LR || LR->value_size() != 1 ||
+      LR->getCategory() != vc::RegCategory::General)
+    return false;
+  IGC_ASSERT(LR->value_begin()->getValue() == &Inst);
+  return true;
+}
+
+unsigned Rematerializer::remat(Instruction &Inst) {
+  LiveRange *LR = Liveness.getLiveRangeOrNull(&Inst);
+  IGC_ASSERT(LR);
+  LiveRange *SrcLR =
+      GenXIntrinsic::isRdRegion(&Inst)
+          ? Liveness.getLiveRangeOrNull(Inst.getOperand(
+                GenXIntrinsic::GenXRegion::OldValueOperandNum))
+          : nullptr;
+  unsigned B = Numbering.getNumber(&Inst);
+  std::vector<Use *> Uses;
+  unsigned LastKeptUse = B;
+  for (auto &U : Inst.uses()) {
+    unsigned E = Numbering.getNumber(U.getUser());
+    bool Remat = E > B && RP.intersectWithRedRegion(B, E);
+    // A region read must not extend the live range of its source.
+    if (Remat && SrcLR)
+      Remat = SrcLR->contains(E);
+    if (Remat)
+      Uses.push_back(&U);
+    else
+      LastKeptUse = std::max(LastKeptUse, E);
   }
+  if (Uses.empty())
+    return 0;
 
-  // Do rematerialization.
-  for (auto U : Candidates) {
-    Instruction *Inst = cast<Instruction>(U->get());
+  for (auto U : Uses) {
     Instruction *UI = cast<Instruction>(U->getUser());
-    Instruction *Clone = Inst->clone();
+    Instruction *Clone = Inst.clone();
     Clone->insertBefore(UI);
     U->set(Clone);
-    Modified = true;
   }
+  // The value is now dead past its last kept use.
+  RP.decreasePressure(LR, LastKeptUse);
+  return Uses.size();
 }
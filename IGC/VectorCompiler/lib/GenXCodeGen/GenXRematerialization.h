@@ -0,0 +1,51 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2024 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#ifndef TARGET_GENX_REMATERIALIZATION_H
+#define TARGET_GENX_REMATERIALIZATION_H
+
+namespace llvm {
+
+class Instruction;
+class GenXLiveness;
+class GenXNumbering;
+
+namespace genx {
+
+class PressureTracker;
+
+// Rematerializer : clone a cheap value right before those of its uses that
+// are only reached through a high pressure region, and update the pressure
+// model for the shortened live range.
+class Rematerializer {
+  GenXLiveness &Liveness;
+  GenXNumbering &Numbering;
+  PressureTracker &RP;
+  // Whether region reads are candidates besides upward casts.
+  bool WithRegionReads;
+
+public:
+  Rematerializer(GenXLiveness &Liveness, GenXNumbering &Numbering,
+                 PressureTracker &RP, bool WithRegionReads = true)
+      : Liveness(Liveness), Numbering(Numbering), RP(RP),
+        WithRegionReads(WithRegionReads) {}
+
+  // Check whether Inst may be rematerialized at all.
+  bool isCandidate(const Instruction &Inst) const;
+  bool isUpwardCastCandidate(const Instruction &Inst) const;
+  bool isRegionReadCandidate(const Instruction &Inst) const;
+
+  // Rematerialize the candidate Inst at its uses across a high pressure
+  // region. Return the number of clones made.
+  unsigned remat(Instruction &Inst);
+};
+
+} // namespace genx
+} // namespace llvm
+
+#endif // TARGET_GENX_REMATERIALIZATION_H
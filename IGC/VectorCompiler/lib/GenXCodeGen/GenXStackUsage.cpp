@@ -10,6 +10,17 @@ SPDX-License-Identifier: MIT
 /// GenXStackUsage is a module pass whose purpose is to analyse allocas
 /// and spot possible places in code where memory may be exhausted
 ///
+/// The stack is laid out by GenXPrologEpilogInsertion: every function bumps SP
+/// by its own frame on entry and restores it on return, so the frames of
+/// callees that are never live at the same time share the same offsets. The
+/// stack amount of a kernel is therefore its own frame plus the largest
+/// amount required by any of its callees. Frame sizes are computed the way
+/// GenXPrologEpilogInsertion lays them out, so the reported amount is not
+/// inflated by padding that is never allocated.
+///
+/// Stack calls are not sized: the finalizer places its own save and spill
+/// areas in their frames, which are not known at this point.
+///
 //===----------------------------------------------------------------------===//
 
 #include "GenX.h"
@@ -90,6 +101,7 @@ class StackAnalysis : public InstVisitor<StackAnalysis> {
   uint64_t const m_MaxStackSize{};
 
   // FunctionState contains information about function:
+  // m_FrameSz => how much stack memory its own allocas take
   // m_UsedSz => how much stack memory it takes within with called from it the
   //  most heavy function
   // m_pHeavyFunction => pointer to function that occupies
@@ -102,6 +114,7 @@ class StackAnalysis : public InstVisitor<StackAnalysis> {
       Finished,  // function has completely finished being processed
       NotStarted // function has not started processing but will start
     };
+    uint64_t m_FrameSz{0};
     uint64_t m_UsedSz{0};
     alignment_t m_RequiredAlign{0};
     bool m_HasIndirect{false};
@@ -147,8 +160,9 @@ void StackAnalysis::visitAllocaInst(AllocaInst &AI) {
                                      genx::ByteBits);
   auto AllocaAlign = std::max(IGCLLVM::getAlignmentValue(&AI), visa::BytesPerSVMPtr);
 
-  CurFuncState.m_UsedSz = llvm::alignTo(CurFuncState.m_UsedSz, AllocaAlign);
-  CurFuncState.m_UsedSz += AllocaSize;
+  // GenXPrologEpilogInsertion places allocas in decreasing alignment order,
+  // so each of them is padded to no more than its own alignment.
+  CurFuncState.m_FrameSz += llvm::alignTo(AllocaSize, AllocaAlign);
   CurFuncState.m_RequiredAlign = std::max(CurFuncState.m_RequiredAlign,
                                           AllocaAlign);
 }
@@ -224,12 +238,16 @@ StackAnalysis::checkFunction(Function &F) {
   }
 
   StateOfF.m_ProcessingFlag = FunctionState::ProcessingState::Finished;
-  StateOfF.m_UsedSz += MostUsedStackSize;
-  // Add the max alignment of the function to the total size used because of
-  // run-time alignment that may vary from 0 to m_RequiredAlign - 1.
-  StateOfF.m_UsedSz += StateOfF.m_RequiredAlign;
+  // SP is kept oword aligned between frames, so run-time alignment of the
+  // frame start is only needed, and may waste up to m_RequiredAlign -
+  // OWordBytes bytes, when an alloca requires a bigger alignment.
+  uint64_t FrameSz = llvm::alignTo(StateOfF.m_FrameSz, genx::OWordBytes);
+  if (StateOfF.m_RequiredAlign > genx::OWordBytes)
+    FrameSz += StateOfF.m_RequiredAlign - genx::OWordBytes;
+  StateOfF.m_UsedSz = FrameSz + MostUsedStackSize;
 
   LLVM_DEBUG(dbgs() << F.getName() << " size: " << StateOfF.m_UsedSz
+                    << " frame: " << FrameSz
                     << " alignment: " << StateOfF.m_RequiredAlign << "\n");
 
   return std::make_pair(StateOfF.m_UsedSz, StateOfF.m_RequiredAlign);
@@ -35,6 +35,7 @@ SPDX-License-Identifier: MIT
 #include "llvm/Pass.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/Cloning.h"
 #include "llvm/Transforms/Utils/Local.h"
 
@@ -64,29 +65,37 @@ namespace llvm {
 ///    arguments for SIMT-functions are uniform if it is only defined by
 ///       callers' uniform argument.
 ///
-/// d) Run reg2mem pass to remove phi-nodes
+/// d) lower switches in the functions to be vectorized into chains of
+///    two-way branches, which can be turned into simd-control-flow
+///
+/// e) Run reg2mem pass to remove phi-nodes
 ///    This is because we need to generate simd-control-flow
 ///    after packetization. simd-control-flow lowering cannot handle phi-node.
 ///
-/// e) for uniform arguments
+/// f) for uniform arguments
 ///    Mark the allocas for those arguments as uniform
 ///    Mark the load/store for those allocas as uniform
 ///
-/// f) vectorize generic functions to its SIMT width, callee first
+/// g) vectorize generic functions to its SIMT width, callee first
 ///    - create the vector prototype
 ///    - clone the function-body into the vector prototype
 ///    - vectorize the function-body
 ///    - note: original function is kept because it may be used outside SIMT
 ///
-/// g) vectorize SIMT-entry functions
+/// h) vectorize SIMT-entry functions
 ///    - no change of function arguments
 ///    - no cloning, direct-vectorization on the function-body
+///    - a call to a function that is not vectorized by this pass uses
+///      the vector variant listed in its vector-function-abi-variant
+///      attribute, or is made once per lane when the callee has no
+///      side-effects and is safe to speculate
 ///
-/// h) SIMD-control-flow lowering
+/// i) SIMD-control-flow lowering, loops with divergent exits keep the
+///    lanes that left the loop disabled until the join in the exit block
 ///
-/// i) run mem2reg pass to create SSA
+/// j) run mem2reg pass to create SSA
 ///
-/// j) CMABI pass to remove global Execution-Mask
+/// k) CMABI pass to remove global Execution-Mask
 ///
 class GenXPacketize : public ModulePass {
 public:
@@ -118,6 +127,9 @@ private:
   Value *packetizeLLVMIntrinsic(Instruction *pInst);
   Value *packetizeLLVMInstruction(Instruction *pInst);
   Value *packetizeInstruction(Instruction *pInst);
+  Value *packetizeCall(CallInst *CI);
+  Function *findVectorVariant(CallInst &CI,
+                              SmallVectorImpl<bool> &UniformParams);
 
   void replaceAllUsesNoTypeCheck(Value *pInst, Value *pNewInst);
   void removeDeadInstructions(Function &F);
@@ -127,6 +139,7 @@ private:
   bool vectorizeSIMTEntry(Function &F);
 
   bool isUniformIntrinsic(unsigned id);
+  bool isUniformValue(const Value *V) const;
   void findUniformArgs(Function &F);
   void findUniformInsts(Function &F);
 
@@ -154,6 +167,106 @@ private:
   const DataLayout *DL = nullptr;
 };
 
+// Parse an entry of the vector-function-abi-variant attribute, mangled as
+// in the Vector Function ABI:
+//   _ZGV<isa><mask><vlen><parameters>_<scalar name>(<vector name>)
+// Only unmasked variants of the given width with vector ('v') and uniform
+// ('u') parameters are supported. Returns the name of the variant, or an
+// empty string for an unsupported entry.
+static StringRef parseVFABIVariant(StringRef Mangled, unsigned Width,
+                                   SmallVectorImpl<bool> &UniformParams) {
+  if (!Mangled.consume_front("_ZGV"))
+    return {};
+  // the ISA is a single letter, or _LLVM_ for the mappings made by LLVM
+  if (!Mangled.consume_front("_LLVM_")) {
+    if (Mangled.empty())
+      return {};
+    Mangled = Mangled.drop_front();
+  }
+  unsigned VLen = 0;
+  if (!Mangled.consume_front("N") || Mangled.consumeInteger(10, VLen) ||
+      VLen != Width)
+    return {};
+  UniformParams.clear();
+  for (; !Mangled.empty() && Mangled.front() != '_';
+       Mangled = Mangled.drop_front()) {
+    char Kind = Mangled.front();
+    if (Kind != 'v' && Kind != 'u')
+      return {};
+    UniformParams.push_back(Kind == 'u');
+  }
+  if (!Mangled.consume_front("_") || !Mangled.consume_back(")"))
+    return {};
+  size_t Open = Mangled.find('(');
+  if (Open == StringRef::npos)
+    return {};
+  return Mangled.drop_front(Open + 1);
+}
+
+// Replace a switch with a chain of compares and two-way branches.
+// Only a conditional branch can be packetized into simd-control-flow,
+// so a switch on a per-lane value has to be lowered beforehand.
+static void GenXLowerSwitch(SwitchInst *SI) {
+  BasicBlock *BB = SI->getParent();
+  Function *F = BB->getParent();
+  Value *Cond = SI->getCondition();
+  BasicBlock *Default = SI->getDefaultDest();
+
+  // Edges (successor, new predecessor) replacing the edges of the switch.
+  SmallVector<std::pair<BasicBlock *, BasicBlock *>, 8> Edges;
+  SmallVector<BranchInst *, 8> NewBranches;
+  IRBuilder<> IRB(SI);
+  unsigned NumCases = SI->getNumCases();
+  unsigned CaseNo = 0;
+  for (auto &Case : SI->cases()) {
+    bool IsLast = ++CaseNo == NumCases;
+    BasicBlock *CmpBB = IRB.GetInsertBlock();
+    BasicBlock *Next =
+        IsLast ? Default
+               : BasicBlock::Create(F->getContext(), BB->getName() + ".case",
+                                    F, CmpBB->getNextNode());
+    Value *IsCase =
+        IRB.CreateICmpEQ(Cond, Case.getCaseValue(), BB->getName() + ".cmp");
+    NewBranches.push_back(
+        IRB.CreateCondBr(IsCase, Case.getCaseSuccessor(), Next));
+    Edges.emplace_back(Case.getCaseSuccessor(), CmpBB);
+    if (IsLast)
+      Edges.emplace_back(Default, CmpBB);
+    else
+      IRB.SetInsertPoint(Next);
+  }
+  if (!NumCases)
+    IRB.CreateBr(Default);
+
+  // Each phi has an incoming entry from BB per edge of the switch, redirect
+  // one of them for every edge that now comes from another block.
+  for (auto &Edge : Edges) {
+    if (Edge.second == BB)
+      continue;
+    for (PHINode &Phi : Edge.first->phis()) {
+      int Idx = Phi.getBasicBlockIndex(BB);
+      IGC_ASSERT(Idx >= 0);
+      Phi.setIncomingBlock(Idx, Edge.second);
+    }
+  }
+  SI->eraseFromParent();
+
+  // keep the function free of critical edges as required by simd-cf lowering
+  for (auto *Br : NewBranches)
+    for (unsigned i = 0, e = Br->getNumSuccessors(); i != e; ++i)
+      SplitCriticalEdge(Br, i);
+}
+
+static bool GenXLowerSwitches(Function &F) {
+  SmallVector<SwitchInst *, 4> Switches;
+  for (auto &BB : F)
+    if (auto *SI = dyn_cast<SwitchInst>(BB.getTerminator()))
+      Switches.push_back(SI);
+  for (auto *SI : Switches)
+    GenXLowerSwitch(SI);
+  return !Switches.empty();
+}
+
 // Adapted from llvm::UnifyFunctionExitNodes.cpp
 // Loop over all of the blocks in a function, tracking all of the blocks
 // that return.
@@ -225,6 +338,12 @@ bool GenXPacketize::runOnModule(Module &Module) {
   findFunctionVectorizationOrder(M);
 
   unsigned NumFunc = FuncOrder.size();
+  // lower switches in the code that will be vectorized
+  for (auto &FV : FuncVectors)
+    GenXLowerSwitches(*FV.first);
+  for (auto F : ForkFuncs)
+    GenXLowerSwitches(*F);
+
   // find uniform arguments
   UniformArgs.clear();
   for (unsigned i = 0; i < NumFunc; ++i) {
@@ -739,6 +858,18 @@ Value *GenXPacketize::getPacketizeValue(Value *OrigValue) {
   return nullptr;
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Whether \p V is the same for all the lanes
+bool GenXPacketize::isUniformValue(const Value *V) const {
+  if (isa<Constant>(V))
+    return true;
+  if (auto *A = dyn_cast<Argument>(V))
+    return UniformArgs.count(A);
+  if (auto *I = dyn_cast<Instruction>(V))
+    return UniformInsts.count(I);
+  return false;
+}
+
 // this is used on operands that are expected to be uniform
 Value *GenXPacketize::getUniformValue(Value *OrigValue) {
   if (auto G = dyn_cast<GlobalValue>(OrigValue))
@@ -849,24 +980,8 @@ Value *GenXPacketize::packetizeLLVMInstruction(Instruction *pInst) {
   Value *pReplacedInst = nullptr;
   B->IRB()->SetInsertPoint(pInst);
   // packetize a call
-  if (auto CI = dyn_cast<CallInst>(pInst)) {
-    auto F = CI->getCalledFunction();
-    auto FMI = FuncMap.find(std::pair<Function *, unsigned>(F, B->mVWidth));
-    if (FMI != FuncMap.end()) {
-      std::vector<Value *> ArgOps;
-      auto VF = FMI->second;
-      for (Argument &Arg : VF->args()) {
-        auto i = Arg.getArgNo();
-        if (UniformArgs.count(&Arg))
-          ArgOps.push_back(getUniformValue(CI->getArgOperand(i)));
-        else
-          ArgOps.push_back(getPacketizeValue(CI->getArgOperand(i)));
-      }
-      pReplacedInst = CallInst::Create(VF, ArgOps, CI->getName(), CI);
-      return pReplacedInst;
-    } else
-      IGC_ASSERT(0);
-  }
+  if (auto CI = dyn_cast<CallInst>(pInst))
+    return packetizeCall(CI);
   uint32_t opcode = pInst->getOpcode();
 
   switch (opcode) {
@@ -1194,6 +1309,120 @@ Value *GenXPacketize::packetizeLLVMInstruction(Instruction *pInst) {
   return pReplacedInst;
 }
 
+//////////////////////////////////////////////////////////////////////////
+/// @brief Packetize a call to a non-intrinsic function
+///   - a callee vectorized by this pass is called with its vector version
+///   - otherwise the vector variant listed for the call is called
+///   - otherwise a callee with no side-effects is called once per lane
+Value *GenXPacketize::packetizeCall(CallInst *CI) {
+  Function *F = CI->getCalledFunction();
+  IGC_ASSERT(F);
+  Function *VF = nullptr;
+  bool IsVectorizedHere = false;
+  SmallVector<bool, 8> UniformParams;
+  auto FMI = FuncMap.find(std::pair<Function *, unsigned>(F, B->mVWidth));
+  if (FMI != FuncMap.end()) {
+    VF = FMI->second;
+    IsVectorizedHere = true;
+  } else
+    VF = findVectorVariant(*CI, UniformParams);
+
+  if (VF) {
+    std::vector<Value *> ArgOps;
+    for (Argument &Arg : VF->args()) {
+      auto i = Arg.getArgNo();
+      Value *OrigArg = CI->getArgOperand(i);
+      bool IsUniform = IsVectorizedHere ? UniformArgs.count(&Arg) > 0
+                                        : UniformParams[i];
+      if (IsUniform)
+        ArgOps.push_back(getUniformValue(OrigArg));
+      else
+        ArgOps.push_back(getPacketizeValue(OrigArg));
+    }
+    return CallInst::Create(VF, ArgOps, CI->getName(), CI);
+  }
+
+  // no vector version: serialize the call over the lanes. The call is made
+  // for the disabled lanes as well, so the callee must neither have
+  // side-effects nor trap on their values.
+  auto IsScalarTy = [](Type *Ty) {
+    return Ty->isIntegerTy() || Ty->isFloatingPointTy();
+  };
+  Type *RetTy = F->getReturnType();
+  if (!F->doesNotAccessMemory() || !F->isSpeculatable() ||
+      !(RetTy->isVoidTy() || IsScalarTy(RetTy)) ||
+      !llvm::all_of(F->args(),
+                    [&](Argument &Arg) { return IsScalarTy(Arg.getType()); }))
+    report_fatal_error("GenXPacketize: no vector variant for call to " +
+                       F->getName() + " in SIMT code");
+
+  std::vector<Value *> VecArgs;
+  for (Value *Arg : IGCLLVM::args(*CI))
+    VecArgs.push_back(getPacketizeValue(Arg));
+  Value *Result = RetTy->isVoidTy()
+                      ? nullptr
+                      : UndefValue::get(B->GetVectorType(RetTy));
+  Value *LaneCall = nullptr;
+  for (uint32_t Lane = 0; Lane < B->mVWidth; ++Lane) {
+    std::vector<Value *> LaneArgs;
+    for (Value *VecArg : VecArgs)
+      LaneArgs.push_back(B->VEXTRACT(VecArg, (uint64_t)Lane));
+    LaneCall = B->IRB()->CreateCall(F, LaneArgs);
+    if (Result)
+      Result = B->VINSERT(Result, LaneCall, (uint64_t)Lane);
+  }
+  return Result ? Result : LaneCall;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/// @brief Find a vector variant of the callee for the current width in the
+///        vector-function-abi-variant attribute of the call, or of the
+///        callee. \p UniformParams tells which arguments of the variant
+///        keep the scalar value, a variant is skipped when such an argument
+///        is not uniform at the call.
+Function *
+GenXPacketize::findVectorVariant(CallInst &CI,
+                                 SmallVectorImpl<bool> &UniformParams) {
+  static constexpr const char *VariantAttr = "vector-function-abi-variant";
+  Function *F = CI.getCalledFunction();
+#if LLVM_VERSION_MAJOR >= 14
+  Attribute Attr = CI.getFnAttr(VariantAttr);
+#else
+  Attribute Attr = CI.getAttribute(AttributeList::FunctionIndex, VariantAttr);
+#endif
+  if (!Attr.isStringAttribute())
+    Attr = F->getFnAttribute(VariantAttr);
+  StringRef Variants = Attr.getValueAsString();
+
+  SmallVector<StringRef, 4> Entries;
+  Variants.split(Entries, ',', -1, false);
+  for (StringRef Entry : Entries) {
+    StringRef Name =
+        parseVFABIVariant(Entry.trim(), B->mVWidth, UniformParams);
+    Function *VF = Name.empty() ? nullptr : M->getFunction(Name);
+    if (!VF || VF->isVarArg() || VF->arg_size() != F->arg_size() ||
+        UniformParams.size() != F->arg_size() ||
+        VF->getReturnType() != B->GetVectorType(F->getReturnType()))
+      continue;
+    bool Matches = true;
+    for (auto ArgPair : llvm::zip(F->args(), VF->args())) {
+      Argument &Arg = std::get<0>(ArgPair);
+      unsigned ArgNo = Arg.getArgNo();
+      Type *Ty = Arg.getType();
+      if (!UniformParams[ArgNo])
+        Ty = B->GetVectorType(Ty);
+      // a uniform parameter gets a single value for all the lanes, so the
+      // variant cannot be used for a per-lane argument
+      else if (!isUniformValue(CI.getArgOperand(ArgNo)))
+        Matches = false;
+      Matches &= std::get<1>(ArgPair).getType() == Ty;
+    }
+    if (Matches)
+      return VF;
+  }
+  return nullptr;
+}
+
 Value *GenXPacketize::packetizeGenXIntrinsic(Instruction *inst) {
   B->IRB()->SetInsertPoint(inst);
 
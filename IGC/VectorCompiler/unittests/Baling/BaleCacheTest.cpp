@@ -0,0 +1,126 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2024 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "GenX.h"
+#include "GenXBaling.h"
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <set>
+
+using namespace llvm;
+using namespace genx;
+
+namespace {
+
+constexpr const char *BaleIR = R"IR(
+declare <4 x float> @llvm.genx.rdregionf.v4f32.v16f32.i16(<16 x float>, i32, i32, i32, i16, i32)
+
+define void @f(<16 x float> %src, <4 x float> %y) {
+  %rd = call <4 x float> @llvm.genx.rdregionf.v4f32.v16f32.i16(<16 x float> %src, i32 0, i32 4, i32 1, i16 0, i32 undef)
+  %rd2 = call <4 x float> @llvm.genx.rdregionf.v4f32.v16f32.i16(<16 x float> %src, i32 0, i32 4, i32 1, i16 16, i32 undef)
+  %add = fadd <4 x float> %rd, %y
+  %mul = fmul <4 x float> %add, %y
+  ret void
+}
+)IR";
+
+class BaleCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    SMDiagnostic Err;
+    M = parseAssemblyString(BaleIR, Err, Ctx);
+    ASSERT_TRUE(M);
+    F = M->getFunction("f");
+    ASSERT_TRUE(F);
+    for (auto &Inst : instructions(*F))
+      Insts[std::string(Inst.getName())] = &Inst;
+
+    // %rd is baled into %add.
+    Baling.setBaleInfo(Insts["rd"], BaleInfo(BaleInfo::RDREGION));
+    Baling.setBaleInfo(Insts["rd2"], BaleInfo(BaleInfo::RDREGION));
+    BaleInfo AddBI(BaleInfo::MAININST);
+    AddBI.setOperandBaled(0);
+    Baling.setBaleInfo(Insts["add"], AddBI);
+  }
+
+  std::set<Instruction *> getBale(Instruction *Head) {
+    Bale B;
+    Baling.buildBale(Head, &B);
+    std::set<Instruction *> Res;
+    for (auto &BI : B)
+      Res.insert(BI.Inst);
+    return Res;
+  }
+
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M;
+  Function *F = nullptr;
+  std::map<std::string, Instruction *> Insts;
+  GenXBaling Baling{BalingKind::BK_Analysis, nullptr};
+};
+
+TEST_F(BaleCacheTest, CachedBaleIsReused) {
+  std::set<Instruction *> Expected = {Insts["rd"], Insts["add"]};
+  EXPECT_EQ(getBale(Insts["add"]), Expected);
+  EXPECT_EQ(getBale(Insts["add"]), Expected);
+  EXPECT_EQ(getBale(Insts["mul"]), std::set<Instruction *>{Insts["mul"]});
+}
+
+// Changing the baling of an instruction drops the cached bales it is in.
+TEST_F(BaleCacheTest, BaleInfoChangeInvalidates) {
+  EXPECT_EQ(getBale(Insts["add"]).size(), 2u);
+  Baling.unbale(Insts["rd"]);
+  EXPECT_EQ(getBale(Insts["add"]), std::set<Instruction *>{Insts["add"]});
+
+  // %add baled into %mul makes a new bale headed by %mul, the bale of %add
+  // alone is kept.
+  BaleInfo AddBI(BaleInfo::MAININST);
+  AddBI.setOperandBaled(0);
+  Baling.setBaleInfo(Insts["add"], AddBI);
+  EXPECT_EQ(getBale(Insts["mul"]).size(), 1u);
+  BaleInfo MulBI(BaleInfo::MAININST);
+  MulBI.setOperandBaled(0);
+  Baling.setBaleInfo(Insts["mul"], MulBI);
+  std::set<Instruction *> Expected = {Insts["rd"], Insts["add"], Insts["mul"]};
+  EXPECT_EQ(getBale(Insts["mul"]), Expected);
+
+  // Unbaling %rd drops both the bale of %add and of %mul containing it.
+  Baling.unbale(Insts["rd"]);
+  EXPECT_EQ(getBale(Insts["add"]), std::set<Instruction *>{Insts["add"]});
+  Expected = {Insts["add"], Insts["mul"]};
+  EXPECT_EQ(getBale(Insts["mul"]), Expected);
+}
+
+// RAUW of a baled in instruction drops the cached bale through its handles.
+TEST_F(BaleCacheTest, ReplaceAllUsesInvalidates) {
+  EXPECT_EQ(getBale(Insts["add"]).count(Insts["rd"]), 1u);
+  Insts["rd"]->replaceAllUsesWith(Insts["rd2"]);
+  std::set<Instruction *> Expected = {Insts["rd2"], Insts["add"]};
+  EXPECT_EQ(getBale(Insts["add"]), Expected);
+}
+
+// Erasing an instruction of a cached bale drops the bale through its handles.
+TEST_F(BaleCacheTest, EraseInvalidates) {
+  EXPECT_EQ(getBale(Insts["add"]).size(), 2u);
+  auto *Rd = Insts["rd"];
+  Insts["add"]->setOperand(0, Insts["rd2"]);
+  Rd->eraseFromParent();
+  std::set<Instruction *> Expected = {Insts["rd2"], Insts["add"]};
+  EXPECT_EQ(getBale(Insts["add"]), Expected);
+}
+
+} // namespace
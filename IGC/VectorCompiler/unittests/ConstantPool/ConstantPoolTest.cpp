@@ -0,0 +1,175 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2024 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "GenX.h"
+
+#include "vc/GenXCodeGen/GenXTarget.h"
+#include "vc/GenXCodeGen/TargetMachine.h"
+#include "vc/Support/BackendConfig.h"
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/CodeGen/TargetPassConfig.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include "gtest/gtest.h"
+
+#include <map>
+#include <set>
+#include <string>
+
+using namespace llvm;
+
+namespace {
+
+constexpr unsigned PoolThreshold = 16;
+
+// An irregular 64-byte constant, used twice by @k1 and once by @k2, next to
+// a splat, a packed and a predicate constant of at least PoolThreshold bytes.
+std::string getTestIR() {
+  const std::string Irregular =
+      "<16 x i32> <i32 1000, i32 2000, i32 37, i32 -5, i32 123456, i32 7, "
+      "i32 99, i32 8, i32 17, i32 65536, i32 3, i32 4, i32 5, i32 6, "
+      "i32 700, i32 81>";
+  std::string Pred = "<128 x i1> <";
+  for (unsigned I = 0; I != 128; ++I)
+    Pred += std::string(I ? ", " : "") + "i1 " + ((I * 7) % 3 ? "1" : "0");
+  Pred += ">";
+
+  return "target datalayout = \"e-p:64:64-i64:64-n8:16:32:64\"\n"
+         "target triple = \"genx64-unknown-unknown\"\n"
+         "define dllexport void @k1(<16 x i32> %x, <8 x i16> %y, "
+         "<128 x i8> %p, <128 x i8> %q) {\n"
+         "  %a = add <16 x i32> %x, " + Irregular + "\n"
+         "  %b = mul <16 x i32> %a, " + Irregular + "\n"
+         "  %c = add <16 x i32> %b, <i32 12345, i32 12345, i32 12345, "
+         "i32 12345, i32 12345, i32 12345, i32 12345, i32 12345, "
+         "i32 12345, i32 12345, i32 12345, i32 12345, i32 12345, "
+         "i32 12345, i32 12345, i32 12345>\n"
+         "  %d = add <8 x i16> %y, <i16 0, i16 1, i16 2, i16 3, i16 4, "
+         "i16 5, i16 6, i16 7>\n"
+         "  %e = select " + Pred + ", <128 x i8> %p, <128 x i8> %q\n"
+         "  ret void\n"
+         "}\n"
+         "define dllexport void @k2(<16 x i32> %x) {\n"
+         "  %a = add <16 x i32> %x, " + Irregular + "\n"
+         "  ret void\n"
+         "}\n";
+}
+
+class ConstantPoolTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    initializeGenX();
+    auto &Opts = cl::getRegisteredOptions();
+    Threshold = static_cast<cl::opt<unsigned> *>(
+        Opts["vc-constant-pool-threshold"]);
+    ASSERT_TRUE(Threshold);
+    Threshold->setValue(PoolThreshold);
+
+    SMDiagnostic Err;
+    M = parseAssemblyString(getTestIR(), Err, Ctx);
+    ASSERT_TRUE(M) << Err.getMessage().str();
+
+    Triple TT(M->getTargetTriple());
+    std::string Error;
+    const Target *T = TargetRegistry::lookupTarget("genx64", TT, Error);
+    ASSERT_TRUE(T) << Error;
+    TM = vc::createGenXTargetMachine(
+        *T, TT, "XeHPG", "", TargetOptions(), /*RelocModel=*/None,
+        /*CodeModel=*/None, CodeGenOpt::Default,
+        std::make_unique<GenXBackendConfig>());
+    ASSERT_TRUE(TM);
+  }
+
+  void TearDown() override {
+    if (Threshold)
+      Threshold->setValue(0);
+  }
+
+  void runGlobalValueLowering() {
+    legacy::PassManager PM;
+    PM.add(new GenXBackendConfig());
+    PM.add(static_cast<LLVMTargetMachine &>(*TM).createPassConfig(PM));
+    PM.add(createGenXGlobalValueLoweringPass());
+    PM.run(*M);
+  }
+
+  Instruction *getInst(StringRef Func, StringRef Name) {
+    for (auto &Inst : instructions(*M->getFunction(Func)))
+      if (Inst.getName() == Name)
+        return &Inst;
+    return nullptr;
+  }
+
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M;
+  std::unique_ptr<TargetMachine> TM;
+  cl::opt<unsigned> *Threshold = nullptr;
+};
+
+std::vector<LoadInst *> getPoolLoads(Function &F) {
+  std::vector<LoadInst *> Loads;
+  for (auto &Inst : instructions(F))
+    if (auto *LI = dyn_cast<LoadInst>(&Inst))
+      if (LI->getName().startswith("constpool.load"))
+        Loads.push_back(LI);
+  return Loads;
+}
+
+TEST_F(ConstantPoolTest, IrregularConstantIsSharedByKernels) {
+  Constant *Irregular = cast<Constant>(getInst("k2", "a")->getOperand(1));
+  runGlobalValueLowering();
+
+  std::vector<GlobalVariable *> Pool;
+  for (auto &GV : M->globals())
+    if (GV.getName().startswith("constpool"))
+      Pool.push_back(&GV);
+  ASSERT_EQ(Pool.size(), 1u);
+  EXPECT_TRUE(Pool.front()->isConstant());
+  EXPECT_EQ(Pool.front()->getInitializer(), Irregular);
+
+  // The global is lowered in both kernels.
+  std::set<Function *> Users;
+  for (User *U : Pool.front()->users())
+    if (auto *Inst = dyn_cast<Instruction>(U))
+      Users.insert(Inst->getFunction());
+  std::set<Function *> Kernels = {M->getFunction("k1"), M->getFunction("k2")};
+  EXPECT_EQ(Users, Kernels);
+
+  // Each kernel loads the constant once, all its uses share the load.
+  auto K1Loads = getPoolLoads(*M->getFunction("k1"));
+  auto K2Loads = getPoolLoads(*M->getFunction("k2"));
+  ASSERT_EQ(K1Loads.size(), 1u);
+  ASSERT_EQ(K2Loads.size(), 1u);
+  EXPECT_EQ(getInst("k1", "a")->getOperand(1), K1Loads.front());
+  EXPECT_EQ(getInst("k1", "b")->getOperand(1), K1Loads.front());
+  EXPECT_EQ(getInst("k2", "a")->getOperand(1), K2Loads.front());
+}
+
+TEST_F(ConstantPoolTest, RegularConstantsAreNotPooled) {
+  runGlobalValueLowering();
+  EXPECT_TRUE(isa<Constant>(getInst("k1", "c")->getOperand(1))); // splat
+  EXPECT_TRUE(isa<Constant>(getInst("k1", "d")->getOperand(1))); // packed
+  EXPECT_TRUE(isa<Constant>(getInst("k1", "e")->getOperand(0))); // predicate
+}
+
+TEST_F(ConstantPoolTest, DisabledByDefault) {
+  Threshold->setValue(0);
+  runGlobalValueLowering();
+  EXPECT_TRUE(getPoolLoads(*M->getFunction("k1")).empty());
+  EXPECT_TRUE(isa<Constant>(getInst("k1", "a")->getOperand(1)));
+}
+
+} // namespace
@@ -0,0 +1,170 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2024 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "GenX.h"
+
+#include "vc/GenXCodeGen/GenXTarget.h"
+#include "vc/GenXCodeGen/TargetMachine.h"
+#include "vc/Support/BackendConfig.h"
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/CodeGen/TargetPassConfig.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+constexpr const char *DataLayoutAndTriple = R"IR(
+target datalayout = "e-p:64:64-i64:64-n8:16:32:64"
+target triple = "genx64-unknown-unknown"
+)IR";
+
+// A stand-in for the emulation library: sdiv and srem share no helper, and
+// there are routines for other opcodes and for another vector width.
+constexpr const char *LibraryIR = R"IR(
+define internal <4 x i64> @div_helper(<4 x i64> %a, <4 x i64> %b) {
+  %r = xor <4 x i64> %a, %b
+  ret <4 x i64> %r
+}
+
+define internal <4 x i64> @rem_helper(<4 x i64> %a, <4 x i64> %b) {
+  %r = and <4 x i64> %a, %b
+  ret <4 x i64> %r
+}
+
+define <4 x i64> @__cm_intrinsic_impl_sdiv_v4i64(<4 x i64> %a, <4 x i64> %b) #0 {
+  %r = call <4 x i64> @div_helper(<4 x i64> %a, <4 x i64> %b)
+  ret <4 x i64> %r
+}
+
+define <4 x i64> @__cm_intrinsic_impl_udiv_v4i64(<4 x i64> %a, <4 x i64> %b) #0 {
+  %r = call <4 x i64> @div_helper(<4 x i64> %a, <4 x i64> %b)
+  ret <4 x i64> %r
+}
+
+define <8 x i64> @__cm_intrinsic_impl_sdiv_v8i64(<8 x i64> %a, <8 x i64> %b) #0 {
+  ret <8 x i64> %a
+}
+
+define <4 x i64> @__cm_intrinsic_impl_srem_v4i64(<4 x i64> %a, <4 x i64> %b) #0 {
+  %r = call <4 x i64> @rem_helper(<4 x i64> %a, <4 x i64> %b)
+  ret <4 x i64> %r
+}
+
+define <4 x float> @__cm_intrinsic_impl_si2fp_v4f32(<4 x i64> %a) #0 {
+  %r = sitofp <4 x i64> %a to <4 x float>
+  ret <4 x float> %r
+}
+
+attributes #0 = { "VC.Emulation.Routine" }
+)IR";
+
+constexpr const char *KernelIR = R"IR(
+define dllexport void @k(<4 x i64> %a, <4 x i64> %b) {
+  %d = sdiv <4 x i64> %a, %b
+  ret void
+}
+)IR";
+
+class EmulationImportTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    initializeGenX();
+    auto &Opts = cl::getRegisteredOptions();
+    ImportAll = static_cast<cl::opt<bool> *>(Opts["vc-emu-import-all"]);
+    ASSERT_TRUE(ImportAll);
+
+    LLVMContext LibCtx;
+    SMDiagnostic Err;
+    auto Lib = parseAssemblyString(std::string(DataLayoutAndTriple) + LibraryIR,
+                                   Err, LibCtx);
+    ASSERT_TRUE(Lib) << Err.getMessage().str();
+    raw_svector_ostream OS(LibBitcode);
+    WriteBitcodeToFile(*Lib, OS);
+
+    M = parseAssemblyString(std::string(DataLayoutAndTriple) + KernelIR, Err,
+                            Ctx);
+    ASSERT_TRUE(M) << Err.getMessage().str();
+
+    Triple TT(M->getTargetTriple());
+    std::string Error;
+    const Target *T = TargetRegistry::lookupTarget("genx64", TT, Error);
+    ASSERT_TRUE(T) << Error;
+    TM = vc::createGenXTargetMachine(
+        *T, TT, "XeHPG", "", TargetOptions(), /*RelocModel=*/None,
+        /*CodeModel=*/None, CodeGenOpt::Default,
+        std::make_unique<GenXBackendConfig>());
+    ASSERT_TRUE(TM);
+  }
+
+  void TearDown() override {
+    if (ImportAll)
+      ImportAll->setValue(false);
+  }
+
+  void runEmulationImport() {
+    GenXBackendData Data;
+    Data.BiFModule[BiFKind::VCEmulation] =
+        MemoryBufferRef(StringRef(LibBitcode.data(), LibBitcode.size()),
+                        "emulation");
+    legacy::PassManager PM;
+    PM.add(new GenXBackendConfig(GenXBackendOptions(), std::move(Data)));
+    PM.add(static_cast<LLVMTargetMachine &>(*TM).createPassConfig(PM));
+    PM.add(createGenXEmulationImportPass());
+    PM.run(*M);
+  }
+
+  bool isLinked(StringRef Name) const {
+    const Function *F = M->getFunction(Name);
+    return F && !F->isDeclaration();
+  }
+
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M;
+  std::unique_ptr<TargetMachine> TM;
+  SmallVector<char, 0> LibBitcode;
+  cl::opt<bool> *ImportAll = nullptr;
+};
+
+// Only the routine matching the opcode and the types of the sdiv is linked,
+// together with what it calls.
+TEST_F(EmulationImportTest, OnlyRequiredRoutinesAreLinked) {
+  runEmulationImport();
+  EXPECT_TRUE(isLinked("__cm_intrinsic_impl_sdiv_v4i64"));
+  EXPECT_TRUE(isLinked("div_helper"));
+
+  EXPECT_FALSE(M->getFunction("__cm_intrinsic_impl_udiv_v4i64"));
+  EXPECT_FALSE(M->getFunction("__cm_intrinsic_impl_sdiv_v8i64"));
+  EXPECT_FALSE(M->getFunction("__cm_intrinsic_impl_srem_v4i64"));
+  EXPECT_FALSE(M->getFunction("__cm_intrinsic_impl_si2fp_v4f32"));
+  EXPECT_FALSE(M->getFunction("rem_helper"));
+}
+
+TEST_F(EmulationImportTest, ImportAllLinksWholeLibrary) {
+  ImportAll->setValue(true);
+  runEmulationImport();
+  EXPECT_TRUE(isLinked("__cm_intrinsic_impl_sdiv_v4i64"));
+  EXPECT_TRUE(isLinked("__cm_intrinsic_impl_udiv_v4i64"));
+  EXPECT_TRUE(isLinked("__cm_intrinsic_impl_sdiv_v8i64"));
+  EXPECT_TRUE(isLinked("__cm_intrinsic_impl_srem_v4i64"));
+  EXPECT_TRUE(isLinked("__cm_intrinsic_impl_si2fp_v4f32"));
+  EXPECT_TRUE(isLinked("div_helper"));
+  EXPECT_TRUE(isLinked("rem_helper"));
+}
+
+} // namespace
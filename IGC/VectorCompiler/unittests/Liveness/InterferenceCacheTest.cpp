@@ -0,0 +1,63 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2024 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "GenXLiveness.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace genx;
+
+namespace {
+
+TEST(GenXLiveness, InterferenceCacheInvalidatedBySegmentChange) {
+  GenXLiveness Liveness;
+  LiveRange LR1, LR2;
+  LR1.push_back(0, 10);
+  LR2.push_back(10, 20);
+  EXPECT_FALSE(Liveness.interfere(&LR1, &LR2));
+
+  // Extending LR1 over the start of LR2 gives LR1 a new stamp.
+  uint64_t OldStamp = LR1.getStamp();
+  LR1.push_back(15, 18);
+  EXPECT_NE(LR1.getStamp(), OldStamp);
+  EXPECT_TRUE(Liveness.interfere(&LR1, &LR2));
+  EXPECT_TRUE(Liveness.interfere(&LR2, &LR1));
+}
+
+TEST(GenXLiveness, InterferenceCacheHitAfterUnrelatedChange) {
+  GenXLiveness Liveness;
+  LiveRange LR1, LR2, LR3;
+  LR1.push_back(0, 10);
+  LR2.push_back(10, 20);
+  LR3.push_back(5, 15);
+  EXPECT_FALSE(Liveness.interfere(&LR1, &LR2));
+
+  // Changing another live range keeps the stamps of LR1 and LR2.
+  uint64_t Stamp1 = LR1.getStamp(), Stamp2 = LR2.getStamp();
+  LR3.push_back(30, 40);
+  EXPECT_EQ(LR1.getStamp(), Stamp1);
+  EXPECT_EQ(LR2.getStamp(), Stamp2);
+
+  // Editing a segment in place through the iterator does not restamp LR1,
+  // so a result that still says "no interference" can only come from the
+  // cache.
+  LR1.begin()->setEnd(15);
+  EXPECT_FALSE(Liveness.interfere(&LR1, &LR2));
+  EXPECT_TRUE(Liveness.getSingleInterferenceSites(&LR1, &LR2, nullptr));
+}
+
+TEST(GenXLiveness, LiveRangeStampsAreUnique) {
+  LiveRange LR1, LR2;
+  EXPECT_NE(LR1.getStamp(), LR2.getStamp());
+  uint64_t OldStamp = LR2.getStamp();
+  LR1.push_back(0, 1);
+  EXPECT_NE(LR1.getStamp(), OldStamp);
+}
+
+} // namespace
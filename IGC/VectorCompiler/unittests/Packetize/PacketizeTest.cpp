@@ -0,0 +1,187 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2024 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "vc/GenXOpts/GenXOpts.h"
+
+#include "llvm/GenXIntrinsics/GenXIntrinsics.h"
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/SourceMgr.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// A divergent switch with two cases going to the same block, which has a
+// phi with an entry per switch edge. The result is passed to a function
+// that has a vector variant.
+constexpr const char *SwitchIR = R"IR(
+declare i32 @llvm.genx.lane.id()
+declare void @sink(i32)
+declare void @sink.simd8(<8 x i32>)
+
+define void @simt() #0 {
+entry:
+  %lane = call i32 @llvm.genx.lane.id()
+  switch i32 %lane, label %default [
+    i32 1, label %odd
+    i32 2, label %even
+    i32 3, label %odd
+  ]
+odd:
+  %o = phi i32 [ 10, %entry ], [ 10, %entry ]
+  br label %exit
+even:
+  br label %exit
+default:
+  br label %exit
+exit:
+  %v = phi i32 [ %o, %odd ], [ 20, %even ], [ %lane, %default ]
+  call void @sink(i32 %v) #1
+  ret void
+}
+
+attributes #0 = { "CMGenxSIMT"="8" }
+attributes #1 = { "vector-function-abi-variant"="_ZGV_LLVM_N8v_sink(sink.simd8)" }
+)IR";
+
+// A loop whose exit depends on the lane.
+constexpr const char *LoopIR = R"IR(
+declare i32 @llvm.genx.lane.id()
+declare void @sink(i32)
+declare void @sink.simd8(<8 x i32>)
+
+define void @simt() #0 {
+entry:
+  %lane = call i32 @llvm.genx.lane.id()
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %inc, %loop ]
+  %inc = add i32 %i, 1
+  %done = icmp ugt i32 %inc, %lane
+  br i1 %done, label %exit, label %loop
+exit:
+  call void @sink(i32 %inc) #1
+  ret void
+}
+
+attributes #0 = { "CMGenxSIMT"="8" }
+attributes #1 = { "vector-function-abi-variant"="_ZGV_LLVM_N8v_sink(sink.simd8)" }
+)IR";
+
+// The second parameter of the variant of @scale is uniform. It is used for
+// a uniform argument only, a per-lane one makes the call go lane by lane.
+constexpr const char *UniformParamIR = R"IR(
+declare i32 @llvm.genx.lane.id()
+declare i32 @scale(i32, i32) #2
+declare <8 x i32> @scale.simd8(<8 x i32>, i32)
+declare void @sink(i32)
+declare void @sink.simd8(<8 x i32>)
+
+define void @uniform() #0 {
+entry:
+  %lane = call i32 @llvm.genx.lane.id()
+  %r = call i32 @scale(i32 %lane, i32 3) #1
+  call void @sink(i32 %r) #3
+  ret void
+}
+
+define void @divergent() #0 {
+entry:
+  %lane = call i32 @llvm.genx.lane.id()
+  %r = call i32 @scale(i32 3, i32 %lane) #1
+  call void @sink(i32 %r) #3
+  ret void
+}
+
+attributes #0 = { "CMGenxSIMT"="8" }
+attributes #1 = { "vector-function-abi-variant"="_ZGV_LLVM_N8vu_scale(scale.simd8)" }
+attributes #2 = { nounwind readnone speculatable }
+attributes #3 = { "vector-function-abi-variant"="_ZGV_LLVM_N8v_sink(sink.simd8)" }
+)IR";
+
+std::unique_ptr<Module> packetize(const char *IR, LLVMContext &Ctx) {
+  SMDiagnostic Err;
+  std::unique_ptr<Module> M = parseAssemblyString(IR, Err, Ctx);
+  EXPECT_TRUE(M) << Err.getMessage().str();
+  if (!M)
+    return nullptr;
+
+  legacy::PassManager PM;
+  PM.add(createGenXPacketizePass());
+  PM.run(*M);
+  EXPECT_FALSE(verifyModule(*M, &errs()));
+  return M;
+}
+
+unsigned countCallsTo(Function &F, StringRef Name) {
+  unsigned NumCalls = 0;
+  for (Instruction &I : instructions(F))
+    if (auto *CI = dyn_cast<CallInst>(&I))
+      if (Function *Callee = CI->getCalledFunction())
+        NumCalls += Callee->getName() == Name;
+  return NumCalls;
+}
+
+unsigned countCallsTo(Function &F, GenXIntrinsic::ID IID) {
+  unsigned NumCalls = 0;
+  for (Instruction &I : instructions(F))
+    NumCalls += GenXIntrinsic::getGenXIntrinsicID(&I) == IID;
+  return NumCalls;
+}
+
+TEST(GenXPacketize, SwitchWithDuplicateDestinations) {
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M = packetize(SwitchIR, Ctx);
+  ASSERT_TRUE(M);
+  Function *F = M->getFunction("simt");
+  ASSERT_TRUE(F);
+  for (Instruction &I : instructions(*F))
+    EXPECT_FALSE(isa<SwitchInst>(I));
+  EXPECT_EQ(countCallsTo(*F, "sink"), 0u);
+  EXPECT_EQ(countCallsTo(*F, "sink.simd8"), 1u);
+}
+
+TEST(GenXPacketize, LoopWithDivergentExit) {
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M = packetize(LoopIR, Ctx);
+  ASSERT_TRUE(M);
+  Function *F = M->getFunction("simt");
+  ASSERT_TRUE(F);
+  // The lanes leaving the loop early wait at the join in the exit block.
+  EXPECT_GE(countCallsTo(*F, GenXIntrinsic::genx_simdcf_goto), 1u);
+  EXPECT_GE(countCallsTo(*F, GenXIntrinsic::genx_simdcf_join), 1u);
+  EXPECT_EQ(countCallsTo(*F, "sink.simd8"), 1u);
+}
+
+TEST(GenXPacketize, UniformParameterNeedsUniformArgument) {
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M = packetize(UniformParamIR, Ctx);
+  ASSERT_TRUE(M);
+
+  Function *Uniform = M->getFunction("uniform");
+  ASSERT_TRUE(Uniform);
+  EXPECT_EQ(countCallsTo(*Uniform, "scale.simd8"), 1u);
+  EXPECT_EQ(countCallsTo(*Uniform, "scale"), 0u);
+
+  Function *Divergent = M->getFunction("divergent");
+  ASSERT_TRUE(Divergent);
+  EXPECT_EQ(countCallsTo(*Divergent, "scale.simd8"), 0u);
+  EXPECT_EQ(countCallsTo(*Divergent, "scale"), 8u);
+}
+
+} // namespace
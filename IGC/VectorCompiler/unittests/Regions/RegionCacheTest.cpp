@@ -0,0 +1,118 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2024 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "GenXRegionUtils.h"
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+
+namespace {
+
+// Two indirect rdregions, one indexed by a constant add and the other by
+// genx.add.addr. Both index adds get baled into the region.
+constexpr const char *IndexAddIR = R"IR(
+declare <4 x i32> @llvm.genx.rdregioni.v4i32.v16i32.i16(<16 x i32>, i32, i32, i32, i16, i32)
+declare i16 @llvm.genx.add.addr.i16.i16(i16, i16)
+
+define <4 x i32> @f(<16 x i32> %v, i16 %a, i16 %b) {
+  %add = add i16 %a, 4
+  %rd.add = call <4 x i32> @llvm.genx.rdregioni.v4i32.v16i32.i16(<16 x i32> %v, i32 0, i32 4, i32 1, i16 %add, i32 undef)
+  %addr = call i16 @llvm.genx.add.addr.i16.i16(i16 %a, i16 8)
+  %rd.addr = call <4 x i32> @llvm.genx.rdregioni.v4i32.v16i32.i16(<16 x i32> %v, i32 0, i32 4, i32 1, i16 %addr, i32 undef)
+  %res = add <4 x i32> %rd.add, %rd.addr
+  ret <4 x i32> %res
+}
+)IR";
+
+Instruction *findNamed(Function &F, StringRef Name) {
+  for (auto &I : instructions(F))
+    if (I.getName() == Name)
+      return &I;
+  return nullptr;
+}
+
+class RegionCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    SMDiagnostic Err;
+    M = parseAssemblyString(IndexAddIR, Err, Ctx);
+    ASSERT_TRUE(M);
+    F = M->getFunction("f");
+    ASSERT_TRUE(F);
+  }
+
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M;
+  Function *F = nullptr;
+  genx::RegionWithOffsetCache Cache;
+};
+
+TEST_F(RegionCacheTest, ReusesUnchangedRegion) {
+  auto *Rd = findNamed(*F, "rd.add");
+  bool IsHit = true;
+  genx::Region R = Cache.get(Rd, false, &IsHit);
+  EXPECT_FALSE(IsHit);
+  EXPECT_EQ(R.Indirect, F->getArg(1));
+  EXPECT_EQ(R.Offset, 4);
+
+  EXPECT_TRUE(Cache.get(Rd, false, &IsHit) == R);
+  EXPECT_TRUE(IsHit);
+}
+
+// Changing the constant of the baled add changes Region::Offset.
+TEST_F(RegionCacheTest, RebuildsOnIndexAddOffsetChange) {
+  auto *Rd = findNamed(*F, "rd.add");
+  auto *Add = findNamed(*F, "add");
+  EXPECT_EQ(Cache.get(Rd).Offset, 4);
+
+  Add->setOperand(1, ConstantInt::get(Add->getType(), 12));
+  bool IsHit = true;
+  genx::Region R = Cache.get(Rd, false, &IsHit);
+  EXPECT_FALSE(IsHit);
+  EXPECT_EQ(R.Offset, 12);
+}
+
+// Changing the variable operand of genx.add.addr changes Region::Indirect
+// while the rdregion operands stay the same.
+TEST_F(RegionCacheTest, RebuildsOnAddAddrOperandChange) {
+  auto *Rd = findNamed(*F, "rd.addr");
+  auto *Addr = findNamed(*F, "addr");
+  genx::Region R = Cache.get(Rd);
+  EXPECT_EQ(R.Indirect, F->getArg(1));
+  EXPECT_EQ(R.Offset, 8);
+
+  Addr->setOperand(0, F->getArg(2));
+  bool IsHit = true;
+  R = Cache.get(Rd, false, &IsHit);
+  EXPECT_FALSE(IsHit);
+  EXPECT_EQ(R.Indirect, F->getArg(2));
+  EXPECT_EQ(R.Offset, 8);
+}
+
+// An index that stops being a balable add is no longer split out.
+TEST_F(RegionCacheTest, RebuildsWhenIndexAddIsNoLongerBalable) {
+  auto *Rd = findNamed(*F, "rd.add");
+  auto *Add = findNamed(*F, "add");
+  EXPECT_EQ(Cache.get(Rd).Indirect, F->getArg(1));
+
+  Add->setOperand(1, F->getArg(2));
+  genx::Region R = Cache.get(Rd);
+  EXPECT_EQ(R.Indirect, Add);
+  EXPECT_EQ(R.Offset, 0);
+}
+
+} // namespace
@@ -0,0 +1,170 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2024 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "FunctionGroup.h"
+#include "GenXLiveness.h"
+#include "GenXNumbering.h"
+#include "GenXPressureTracker.h"
+#include "GenXRematerialization.h"
+
+#include "vc/Utils/GenX/RegCategory.h"
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/SourceMgr.h"
+
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace genx;
+
+namespace {
+
+// A region read with a use before and a use after the high pressure region
+// made by %big, and a region read with a variable index.
+constexpr const char *RematIR = R"IR(
+declare <4 x float> @llvm.genx.rdregionf.v4f32.v16f32.i16(<16 x float>, i32, i32, i32, i16, i32)
+
+define void @f(<16 x float> %src, i16 %idx) {
+  %rd = call <4 x float> @llvm.genx.rdregionf.v4f32.v16f32.i16(<16 x float> %src, i32 0, i32 4, i32 1, i16 0, i32 undef)
+  %near = fadd <4 x float> %rd, %rd
+  %big = fadd <16 x float> %src, %src
+  %big2 = fmul <16 x float> %big, %big
+  %far = fadd <4 x float> %rd, %near
+  %rd.var = call <4 x float> @llvm.genx.rdregionf.v4f32.v16f32.i16(<16 x float> %src, i32 0, i32 4, i32 1, i16 %idx, i32 undef)
+  ret void
+}
+)IR";
+
+// High pressure threshold in bytes. With the live ranges below the pressure
+// is 64 + 16 + 64 = 144 bytes at numbers 3 and 4, and at most 80 elsewhere.
+constexpr unsigned Threshold = 128;
+
+class RematerializationTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    SMDiagnostic Err;
+    M = parseAssemblyString(RematIR, Err, Ctx);
+    ASSERT_TRUE(M);
+    F = M->getFunction("f");
+    ASSERT_TRUE(F);
+    FG.push_back(F);
+    Liveness.setDataLayout(&M->getDataLayout());
+    for (auto &Inst : instructions(*F))
+      Insts[std::string(Inst.getName())] = &Inst;
+    Numbering.setNumber(Insts["rd"], 1);
+    Numbering.setNumber(Insts["near"], 2);
+    Numbering.setNumber(Insts["big"], 3);
+    Numbering.setNumber(Insts["big2"], 5);
+    Numbering.setNumber(Insts["far"], 8);
+    Numbering.setNumber(Insts["rd.var"], 9);
+  }
+
+  LiveRange *addLiveRange(Value *V,
+                          ArrayRef<std::pair<unsigned, unsigned>> Segments) {
+    LiveRange *LR = Liveness.getOrCreateLiveRange(
+        SimpleValue(V), vc::RegCategory::General, 0);
+    for (auto &S : Segments)
+      LR->push_back(S.first, S.second);
+    return LR;
+  }
+
+  LLVMContext Ctx;
+  std::unique_ptr<Module> M;
+  Function *F = nullptr;
+  std::map<std::string, Instruction *> Insts;
+  FunctionGroup FG{nullptr};
+  GenXLiveness Liveness;
+  GenXNumbering Numbering;
+};
+
+TEST_F(RematerializationTest, RegionReadCandidates) {
+  addLiveRange(F->getArg(0), {{0, 10}});
+  addLiveRange(Insts["rd"], {{1, 8}});
+  addLiveRange(Insts["rd.var"], {{9, 10}});
+  PressureTracker RP(M->getDataLayout(), FG, &Liveness, false, Threshold);
+
+  Rematerializer Remat(Liveness, Numbering, RP);
+  EXPECT_TRUE(Remat.isRegionReadCandidate(*Insts["rd"]));
+  EXPECT_TRUE(Remat.isCandidate(*Insts["rd"]));
+  // The region moves with the variable index.
+  EXPECT_FALSE(Remat.isRegionReadCandidate(*Insts["rd.var"]));
+  EXPECT_FALSE(Remat.isCandidate(*Insts["rd.var"]));
+  // Not a region read, and no live range anyway.
+  EXPECT_FALSE(Remat.isCandidate(*Insts["near"]));
+
+  Rematerializer NoRegionReads(Liveness, Numbering, RP,
+                               /*WithRegionReads*/ false);
+  EXPECT_FALSE(NoRegionReads.isCandidate(*Insts["rd"]));
+}
+
+TEST_F(RematerializationTest, RematAcrossHighPressure) {
+  addLiveRange(F->getArg(0), {{0, 10}});
+  addLiveRange(Insts["rd"], {{1, 8}});
+  addLiveRange(Insts["big"], {{3, 5}});
+  PressureTracker RP(M->getDataLayout(), FG, &Liveness, false, Threshold);
+  EXPECT_EQ(RP.getPressure(2), 80u);
+  EXPECT_EQ(RP.getPressure(4), 144u);
+
+  Rematerializer Remat(Liveness, Numbering, RP);
+  EXPECT_EQ(Remat.remat(*Insts["rd"]), 1u);
+
+  // Only the use past the high pressure region gets a clone, right before
+  // it.
+  auto *Near = Insts["near"];
+  auto *Far = Insts["far"];
+  EXPECT_EQ(Near->getOperand(0), Insts["rd"]);
+  auto *Clone = dyn_cast<CallInst>(Far->getOperand(0));
+  ASSERT_TRUE(Clone);
+  EXPECT_NE(Clone, Insts["rd"]);
+  EXPECT_EQ(Clone->getCalledFunction(),
+            cast<CallInst>(Insts["rd"])->getCalledFunction());
+  EXPECT_EQ(Clone->getNextNode(), Far);
+
+  // %rd is now dead past its use at number 2.
+  EXPECT_EQ(RP.getPressure(1), 80u);
+  EXPECT_EQ(RP.getPressure(2), 64u);
+  EXPECT_EQ(RP.getPressure(4), 128u);
+  EXPECT_EQ(RP.getPressure(7), 64u);
+}
+
+// The pressure update walks the segments of the live range, so it does not
+// touch the pressure in its holes.
+TEST_F(RematerializationTest, PressureUpdateSkipsHoles) {
+  addLiveRange(F->getArg(0), {{0, 10}});
+  addLiveRange(Insts["rd"], {{1, 3}, {6, 8}});
+  addLiveRange(Insts["big"], {{3, 5}});
+  PressureTracker RP(M->getDataLayout(), FG, &Liveness, false, Threshold);
+  EXPECT_EQ(RP.getPressure(4), 128u);
+  EXPECT_EQ(RP.getPressure(6), 80u);
+
+  Rematerializer Remat(Liveness, Numbering, RP);
+  EXPECT_EQ(Remat.remat(*Insts["rd"]), 1u);
+  EXPECT_EQ(RP.getPressure(2), 64u);
+  EXPECT_EQ(RP.getPressure(4), 128u);
+  EXPECT_EQ(RP.getPressure(6), 64u);
+}
+
+// A region read is not cloned where its source is dead, as that would extend
+// the live range of the source.
+TEST_F(RematerializationTest, RegionReadDoesNotExtendSource) {
+  addLiveRange(F->getArg(0), {{0, 6}});
+  addLiveRange(Insts["rd"], {{1, 8}});
+  addLiveRange(Insts["big"], {{3, 5}});
+  PressureTracker RP(M->getDataLayout(), FG, &Liveness, false, Threshold);
+
+  Rematerializer Remat(Liveness, Numbering, RP);
+  EXPECT_EQ(Remat.remat(*Insts["rd"]), 0u);
+  EXPECT_EQ(Insts["far"]->getOperand(0), Insts["rd"]);
+  EXPECT_EQ(RP.getPressure(4), 144u);
+}
+
+} // namespace
@@ -0,0 +1,153 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2024 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "visaBuilder_interface.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Inline assembly as the kernel builder emits it once the constraints have
+// been substituted with the names of the kernel variables.
+constexpr const char *InlineAsm =
+    "add (M1, 16) acc(0,0)<1> acc(0,0)<1;1,0> 0x5:d";
+
+struct CompiledKernel {
+  std::vector<uint8_t> Binary;
+  std::string VISAAsm;
+};
+
+VISABuilder *createBuilder(vISABuilderMode Mode) {
+  VISABuilder *VB = nullptr;
+  EXPECT_EQ(CreateVISABuilder(VB, Mode, VISA_BUILDER_BOTH, Xe_DG2, 0, nullptr,
+                              nullptr),
+            0);
+  return VB;
+}
+
+// Starts a kernel that sets acc to Init. Its variables have explicit names,
+// so the vISA of both paths can be compared as is.
+VISAKernel *beginKernel(VISABuilder &VB, const char *Name, int Init) {
+  VISAKernel *Kernel = nullptr;
+  EXPECT_EQ(VB.AddKernel(Kernel, Name), 0);
+  if (!Kernel)
+    return nullptr;
+  VISA_GenVar *Acc = nullptr;
+  EXPECT_EQ(Kernel->CreateVISAGenVar(Acc, "acc", 16, ISA_TYPE_D, ALIGN_GRF),
+            0);
+  VISA_VectorOpnd *Dst = nullptr;
+  VISA_VectorOpnd *Src = nullptr;
+  EXPECT_EQ(Kernel->CreateVISADstOperand(Dst, Acc, 1, 0, 0), 0);
+  EXPECT_EQ(Kernel->CreateVISAImmediate(Src, &Init, ISA_TYPE_D), 0);
+  EXPECT_EQ(Kernel->AppendVISADataMovementInst(ISA_MOV, nullptr, false,
+                                               vISA_EMASK_M1, EXEC_SIZE_16,
+                                               Dst, Src),
+            0);
+  return Kernel;
+}
+
+void endKernel(VISAKernel &Kernel) {
+  EXPECT_EQ(Kernel.AppendVISACFRetInst(nullptr, vISA_EMASK_M1, EXEC_SIZE_1),
+            0);
+}
+
+// A vISA LTO module: a whole kernel given as vISA text.
+std::string getLTOModule() {
+  VISABuilder *VB = createBuilder(vISA_ASM_WRITER);
+  if (!VB)
+    return {};
+  if (VISAKernel *Kernel = beginKernel(*VB, "lto_kernel", 7))
+    endKernel(*Kernel);
+  std::string Text = VB->GetAsmTextStream().str();
+  DestroyVISABuilder(VB);
+  return Text;
+}
+
+std::map<std::string, CompiledKernel> collect(VISABuilder &VB) {
+  std::map<std::string, CompiledKernel> Result;
+  for (const char *Name : {"kernel", "lto_kernel"}) {
+    VISAKernel *Kernel = VB.GetVISAKernel(Name);
+    EXPECT_NE(Kernel, nullptr) << Name;
+    if (!Kernel)
+      continue;
+    CompiledKernel &CK = Result[Name];
+    void *Buffer = nullptr;
+    int Size = 0;
+    EXPECT_EQ(Kernel->GetGenxBinary(Buffer, Size), 0);
+    auto *Bytes = static_cast<uint8_t *>(Buffer);
+    CK.Binary.assign(Bytes, Bytes + Size);
+    freeBlock(Buffer);
+    CK.VISAAsm = Kernel->getVISAAsm();
+  }
+  return Result;
+}
+
+// The kernel builder's -vc-visa-text-round-trip path: the whole module is
+// written as vISA text, with the inline assembly in between, and parsed back
+// along with the LTO modules by a reader.
+std::map<std::string, CompiledKernel> compileWithTextRoundTrip() {
+  VISABuilder *Writer = createBuilder(vISA_ASM_WRITER);
+  VISABuilder *Reader = createBuilder(vISA_ASM_READER);
+  if (!Writer || !Reader)
+    return {};
+  if (VISAKernel *Kernel = beginKernel(*Writer, "kernel", 1)) {
+    Writer->GetAsmTextStream() << "\n// INLASM BEGIN\n"
+                               << InlineAsm << "\n// INLASM END\n"
+                               << std::endl;
+    endKernel(*Kernel);
+  }
+  EXPECT_EQ(Reader->ParseVISAText(Writer->GetAsmTextStream().str(), ""), 0);
+  EXPECT_EQ(Reader->ParseVISAText(getLTOModule(), ""), 0);
+  EXPECT_EQ(Reader->Compile(""), 0);
+  auto Result = collect(*Reader);
+  DestroyVISABuilder(Reader);
+  DestroyVISABuilder(Writer);
+  return Result;
+}
+
+// The default path: the inline assembly is parsed into the kernel being
+// built, and the LTO modules are linked into the same builder.
+std::map<std::string, CompiledKernel> compileDirectly() {
+  VISABuilder *VB = createBuilder(vISA_DEFAULT);
+  if (!VB)
+    return {};
+  VB->SetOption(vISA_KeepVarNames, true);
+  if (VISAKernel *Kernel = beginKernel(*VB, "kernel", 1)) {
+    EXPECT_EQ(VB->ParseVISAInlineAsm(Kernel, InlineAsm), 0)
+        << VB->GetCriticalMsg();
+    endKernel(*Kernel);
+  }
+  EXPECT_EQ(VB->ParseVISAText(getLTOModule(), ""), 0);
+  EXPECT_EQ(VB->Compile(""), 0);
+  auto Result = collect(*VB);
+  DestroyVISABuilder(VB);
+  return Result;
+}
+
+TEST(VISABuilder, InlineAsmDirectParseMatchesTextRoundTrip) {
+  auto Text = compileWithTextRoundTrip();
+  auto Direct = compileDirectly();
+
+  ASSERT_EQ(Text.size(), 2u);
+  ASSERT_EQ(Direct.size(), 2u);
+  for (auto &KV : Text) {
+    const std::string &Name = KV.first;
+    EXPECT_FALSE(KV.second.Binary.empty()) << Name;
+    EXPECT_EQ(KV.second.Binary, Direct[Name].Binary) << Name;
+    EXPECT_EQ(KV.second.VISAAsm, Direct[Name].VISAAsm) << Name;
+  }
+  // The snippet made it into the kernel.
+  EXPECT_NE(Direct["kernel"].VISAAsm.find("add (M1, 16)"), std::string::npos);
+}
+
+} // namespace
@@ -0,0 +1,107 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2024 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "visaBuilder_interface.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr unsigned NumKernels = 6;
+
+// Builds a kernel whose body is a chain of Length dependent adds, so that
+// kernels of the same builder differ in size and finish at different times.
+void buildKernel(VISABuilder &VB, unsigned Idx, unsigned Length) {
+  std::string Name = "kernel" + std::to_string(Idx);
+  VISAKernel *Kernel = nullptr;
+  ASSERT_EQ(VB.AddKernel(Kernel, Name.c_str()), 0);
+
+  VISA_GenVar *Acc = nullptr;
+  ASSERT_EQ(Kernel->CreateVISAGenVar(Acc, "acc", 16, ISA_TYPE_D, ALIGN_GRF),
+            0);
+
+  VISA_VectorOpnd *Dst = nullptr;
+  VISA_VectorOpnd *Src0 = nullptr;
+  VISA_VectorOpnd *Src1 = nullptr;
+  int Init = static_cast<int>(Idx);
+  ASSERT_EQ(Kernel->CreateVISADstOperand(Dst, Acc, 1, 0, 0), 0);
+  ASSERT_EQ(Kernel->CreateVISAImmediate(Src0, &Init, ISA_TYPE_D), 0);
+  ASSERT_EQ(Kernel->AppendVISADataMovementInst(ISA_MOV, nullptr, false,
+                                               vISA_EMASK_M1, EXEC_SIZE_16,
+                                               Dst, Src0),
+            0);
+
+  for (unsigned I = 0; I < Length; ++I) {
+    int Step = static_cast<int>(I + 1);
+    ASSERT_EQ(Kernel->CreateVISADstOperand(Dst, Acc, 1, 0, 0), 0);
+    ASSERT_EQ(Kernel->CreateVISASrcOperand(Src0, Acc, MODIFIER_NONE, 1, 1, 0,
+                                           0, 0),
+              0);
+    ASSERT_EQ(Kernel->CreateVISAImmediate(Src1, &Step, ISA_TYPE_D), 0);
+    ASSERT_EQ(Kernel->AppendVISAArithmeticInst(ISA_ADD, nullptr, false,
+                                               vISA_EMASK_M1, EXEC_SIZE_16,
+                                               Dst, Src0, Src1),
+              0);
+  }
+
+  ASSERT_EQ(Kernel->AppendVISACFRetInst(nullptr, vISA_EMASK_M1, EXEC_SIZE_1),
+            0);
+}
+
+// Compiles NumKernels kernels with the given number of finalizer threads and
+// returns their binaries in creation order.
+std::vector<std::vector<uint8_t>> compileKernels(const char *Threads) {
+  std::vector<const char *> Args = {"-compileThreads", Threads};
+  VISABuilder *VB = nullptr;
+  EXPECT_EQ(CreateVISABuilder(VB, vISA_DEFAULT, VISA_BUILDER_BOTH, Xe_DG2,
+                              static_cast<int>(Args.size()), Args.data(),
+                              nullptr),
+            0);
+  if (!VB)
+    return {};
+
+  std::vector<std::vector<uint8_t>> Binaries;
+  for (unsigned I = 0; I < NumKernels; ++I)
+    buildKernel(*VB, I, 4 + 8 * I);
+  EXPECT_EQ(VB->Compile(""), 0);
+
+  for (unsigned I = 0; I < NumKernels; ++I) {
+    std::string Name = "kernel" + std::to_string(I);
+    VISAKernel *Kernel = VB->GetVISAKernel(Name);
+    EXPECT_NE(Kernel, nullptr);
+    if (!Kernel)
+      continue;
+    void *Buffer = nullptr;
+    int Size = 0;
+    EXPECT_EQ(Kernel->GetGenxBinary(Buffer, Size), 0);
+    auto *Bytes = static_cast<uint8_t *>(Buffer);
+    Binaries.emplace_back(Bytes, Bytes + Size);
+    freeBlock(Buffer);
+  }
+
+  DestroyVISABuilder(VB);
+  return Binaries;
+}
+
+TEST(VISABuilder, ParallelCompileMatchesSerial) {
+  auto Serial = compileKernels("0");
+  auto Parallel = compileKernels("4");
+
+  ASSERT_EQ(Serial.size(), NumKernels);
+  ASSERT_EQ(Parallel.size(), NumKernels);
+  for (unsigned I = 0; I < NumKernels; ++I) {
+    EXPECT_FALSE(Serial[I].empty()) << "kernel" << I;
+    EXPECT_EQ(Serial[I], Parallel[I]) << "kernel" << I;
+  }
+}
+
+} // namespace
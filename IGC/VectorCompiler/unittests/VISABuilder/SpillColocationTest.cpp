@@ -0,0 +1,127 @@
+/*========================== begin_copyright_notice ============================
+
+Copyright (C) 2024 Intel Corporation
+
+SPDX-License-Identifier: MIT
+
+============================= end_copyright_notice ===========================*/
+
+#include "visaBuilder_interface.h"
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+namespace {
+
+// Twice as many 2-GRF values as there are GRFs, all of them live at once.
+constexpr unsigned NumValues = 128;
+
+// Builds a kernel that initializes NumValues vectors and then sums them up in
+// the order of definition, so the vectors spilled next to each other are
+// filled next to each other too.
+void buildKernel(VISAKernel *Kernel) {
+  std::vector<VISA_GenVar *> Values(NumValues);
+  for (unsigned I = 0; I < NumValues; ++I) {
+    std::string Name = "v" + std::to_string(I);
+    ASSERT_EQ(Kernel->CreateVISAGenVar(Values[I], Name.c_str(), 16,
+                                       ISA_TYPE_D, ALIGN_GRF),
+              0);
+  }
+  VISA_GenVar *Acc = nullptr;
+  ASSERT_EQ(Kernel->CreateVISAGenVar(Acc, "acc", 16, ISA_TYPE_D, ALIGN_GRF),
+            0);
+
+  VISA_VectorOpnd *Dst = nullptr;
+  VISA_VectorOpnd *Src0 = nullptr;
+  VISA_VectorOpnd *Src1 = nullptr;
+  for (unsigned I = 0; I < NumValues; ++I) {
+    int Init = static_cast<int>(I * 7 + 1);
+    ASSERT_EQ(Kernel->CreateVISADstOperand(Dst, Values[I], 1, 0, 0), 0);
+    ASSERT_EQ(Kernel->CreateVISAImmediate(Src0, &Init, ISA_TYPE_D), 0);
+    ASSERT_EQ(Kernel->AppendVISADataMovementInst(ISA_MOV, nullptr, false,
+                                                 vISA_EMASK_M1, EXEC_SIZE_16,
+                                                 Dst, Src0),
+              0);
+  }
+
+  ASSERT_EQ(Kernel->CreateVISADstOperand(Dst, Acc, 1, 0, 0), 0);
+  ASSERT_EQ(Kernel->CreateVISASrcOperand(Src0, Values[0], MODIFIER_NONE, 1, 1,
+                                         0, 0, 0),
+            0);
+  ASSERT_EQ(Kernel->AppendVISADataMovementInst(ISA_MOV, nullptr, false,
+                                               vISA_EMASK_M1, EXEC_SIZE_16,
+                                               Dst, Src0),
+            0);
+  for (unsigned I = 1; I < NumValues; ++I) {
+    ASSERT_EQ(Kernel->CreateVISADstOperand(Dst, Acc, 1, 0, 0), 0);
+    ASSERT_EQ(Kernel->CreateVISASrcOperand(Src0, Acc, MODIFIER_NONE, 1, 1, 0,
+                                           0, 0),
+              0);
+    ASSERT_EQ(Kernel->CreateVISASrcOperand(Src1, Values[I], MODIFIER_NONE, 1,
+                                           1, 0, 0, 0),
+              0);
+    ASSERT_EQ(Kernel->AppendVISAArithmeticInst(ISA_ADD, nullptr, false,
+                                               vISA_EMASK_M1, EXEC_SIZE_16,
+                                               Dst, Src0, Src1),
+              0);
+  }
+
+  ASSERT_EQ(Kernel->AppendVISACFRetInst(nullptr, vISA_EMASK_M1, EXEC_SIZE_1),
+            0);
+}
+
+struct SpillStats {
+  bool IsSpill = false;
+  int64_t NumSpillFills = 0;
+  uint32_t SpillMemUsed = 0;
+};
+
+SpillStats compileKernel(bool Colocation) {
+  std::vector<const char *> Args = {"-compilerStats"};
+  if (Colocation)
+    Args.push_back("-spillSlotColocation");
+  VISABuilder *VB = nullptr;
+  EXPECT_EQ(CreateVISABuilder(VB, vISA_DEFAULT, VISA_BUILDER_BOTH, Xe_DG2,
+                              static_cast<int>(Args.size()), Args.data(),
+                              nullptr),
+            0);
+  if (!VB)
+    return {};
+
+  SpillStats Stats;
+  VISAKernel *Kernel = nullptr;
+  EXPECT_EQ(VB->AddKernel(Kernel, "kernel"), 0);
+  if (Kernel) {
+    buildKernel(Kernel);
+    EXPECT_EQ(VB->Compile(""), 0);
+    vISA::FINALIZER_INFO *JitInfo = nullptr;
+    EXPECT_EQ(Kernel->GetJitInfo(JitInfo), 0);
+    if (JitInfo) {
+      Stats.IsSpill = JitInfo->isSpill;
+      Stats.NumSpillFills = JitInfo->numGRFSpill + JitInfo->numGRFFill;
+      Stats.SpillMemUsed = JitInfo->stats.spillMemUsed;
+    }
+  }
+
+  DestroyVISABuilder(VB);
+  return Stats;
+}
+
+// Colocated spill slots never take more scratch space, and the fills of
+// values defined and used in the same order are merged at least as well as
+// with first fit slots.
+TEST(VISABuilder, SpillSlotColocationKeepsSpillMessageCount) {
+  SpillStats FirstFit = compileKernel(false);
+  SpillStats Colocated = compileKernel(true);
+
+  ASSERT_TRUE(FirstFit.IsSpill);
+  ASSERT_TRUE(Colocated.IsSpill);
+  EXPECT_GT(FirstFit.NumSpillFills, 0);
+  EXPECT_GT(Colocated.NumSpillFills, 0);
+  EXPECT_LE(Colocated.NumSpillFills, FirstFit.NumSpillFills);
+  EXPECT_LE(Colocated.SpillMemUsed, FirstFit.SpillMemUsed);
+}
+
+} // namespace
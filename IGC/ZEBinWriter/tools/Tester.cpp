@@ -8,10 +8,14 @@ SPDX-License-Identifier: MIT
 
 #include "Tester.hpp"
 #include "ZEELFObjectBuilder.hpp"
-#include "ZEinfoYAML.hpp"
+#include "ZEInfoYAML.hpp"
+
+#include <llvm/Object/ELFObjectFile.h>
+#include <llvm/Support/MemoryBuffer.h>
 
 #include <iostream>
 #include <fstream>
+#include <map>
 
 using llvm::yaml::Output;
 using llvm::yaml::Input;
@@ -22,7 +26,6 @@ static void getTestZEInfo(zeInfoContainer& ks)
     zeInfoKernel k1;
 
     k1.name = "kernel_name_1";
-    k1.execution_env.actual_kernel_start_offset = 0;
     k1.execution_env.grf_count = 128;
     k1.execution_env.simd_size = 8;
     k1.execution_env.required_work_group_size.push_back(256);
@@ -86,7 +89,6 @@ static void getTestZEInfo(zeInfoContainer& ks)
 
     zeInfoKernel k2;
     k2.name = "kernel_name_2";
-    k2.execution_env.actual_kernel_start_offset = 0;
     k2.execution_env.grf_count = 100;
     k2.execution_env.simd_size = 16;
 
@@ -129,9 +131,10 @@ void Tester::testZEInfoOutput()
 
 void Tester::testELFOutput()
 {
-    TargetFlags flag;
-    flag.packed = 10;
-    ZEELFObjectBuilder builder(false, ET_ZEBIN_EXE, 0, flag);
+    TargetMetadata metadata;
+    metadata.packed = 10;
+    ZEELFObjectBuilder builder(false);
+    builder.setTargetMetadata(metadata);
 
     // add fake text
     uint8_t text_buff[100] = { 0x1, 0x2, 0x3, 0x4 };
@@ -156,8 +159,8 @@ void Tester::testELFOutput()
     builder.addSymbol("undef_sym", 0, 0, llvm::ELF::STB_GLOBAL, llvm::ELF::STT_OBJECT, -1);
 
     // add fake relocations
-    builder.addRelocation(4, "data1_sym_at_3", R_TYPE_ZEBIN::R_ZE_SYM_ADDR, text);
-    builder.addRelocation(8, "text_sym_at_1", R_TYPE_ZEBIN::R_ZE_SYM_ADDR_32, text);
+    builder.addRelRelocation(4, "data1_sym_at_3", R_TYPE_ZEBIN::R_ZE_SYM_ADDR, text);
+    builder.addRelRelocation(8, "text_sym_at_1", R_TYPE_ZEBIN::R_ZE_SYM_ADDR_32, text);
 
     // add fake ze_info
     zeInfoContainer ks;
@@ -169,3 +172,147 @@ void Tester::testELFOutput()
     builder.finalize(os);
     os.close();
 }
+
+static bool check(bool cond, const char* what)
+{
+    if (!cond)
+        std::cerr << "testELFRoundTrip failed: " << what << "\n";
+    return cond;
+}
+
+bool Tester::testELFRoundTrip()
+{
+    typedef llvm::object::ELF64LEObjectFile ELFObj;
+    bool ok = true;
+
+    ZEELFObjectBuilder builder(true);
+
+    uint8_t text_buff[16] = { 0x1, 0x2, 0x3, 0x4, 0x5 };
+    uint32_t text = builder.addSectionText("kernel", text_buff, 5, 0, 16);
+    // a debug section added before the data section of the same name, the
+    // data section is still the one found by name
+    uint8_t debug_buff[4] = { 0xd, 0xe, 0xb, 0x9 };
+    builder.addSectionDebug(".data.const", debug_buff, 4);
+    uint8_t data_buff[3] = { 0x7, 0x8, 0x9 };
+    uint32_t data = builder.addSectionData("const", data_buff, 3, 0, 8);
+    uint8_t asm_buff[4] = { 'v', 'i', 's', 'a' };
+    builder.addSectionVISAAsm("kernel", asm_buff, 4);
+    uint32_t bss = builder.addSectionBss("global", 64, 0, 16);
+
+    builder.addSymbol("kernel", 0, 5, llvm::ELF::STB_GLOBAL, llvm::ELF::STT_FUNC, text);
+    builder.addSymbol("const_sym", 1, 2, llvm::ELF::STB_GLOBAL, llvm::ELF::STT_OBJECT, data);
+    builder.addSymbol("global_sym", 0, 64, llvm::ELF::STB_GLOBAL, llvm::ELF::STT_OBJECT, bss);
+
+    ok &= check(builder.getSectionIDBySectionName(".text.kernel") == text,
+        "section lookup by name");
+    ok &= check(builder.getSectionIDBySectionName(".data.const") == data,
+        "section lookup by name");
+    ok &= check(builder.addRelRelocation(4, "const_sym", R_TYPE_ZEBIN::R_ZE_SYM_ADDR, text),
+        "rel relocation to a known symbol");
+    ok &= check(builder.addRelaRelocation(0, "global_sym", R_TYPE_ZEBIN::R_ZE_SYM_ADDR_32, 8, data),
+        "rela relocation to a known symbol");
+
+    zeInfoContainer ks;
+    getTestZEInfo(ks);
+    builder.addSectionZEInfo(ks);
+
+    std::string buff;
+    llvm::raw_string_ostream os(buff);
+    uint64_t size = builder.finalize(os);
+    os.flush();
+    ok &= check(size == buff.size(), "returned size matches written bytes");
+
+    llvm::Expected<ELFObj> objOrErr = ELFObj::create(
+        llvm::MemoryBufferRef(llvm::StringRef(buff.data(), buff.size()), "roundtrip"));
+    if (!objOrErr) {
+        llvm::consumeError(objOrErr.takeError());
+        return check(false, "output is a valid ELF");
+    }
+    const ELFObj& obj = *objOrErr;
+    const auto& ehdr = obj.getELFFile().getHeader();
+    ok &= check(ehdr.e_shoff % 8 == 0 && ehdr.e_shoff +
+        uint64_t(ehdr.e_shnum) * ehdr.e_shentsize <= buff.size(),
+        "section header table is within the object");
+
+    // sections are laid out in order, aligned and not overlapping
+    std::map<std::string, llvm::object::SectionRef> sections;
+    uint64_t prevEnd = sizeof(ehdr);
+    for (const llvm::object::SectionRef& sect : obj.sections()) {
+        llvm::Expected<llvm::StringRef> name = sect.getName();
+        if (!name) {
+            llvm::consumeError(name.takeError());
+            return check(false, "section names are readable");
+        }
+        const auto* shdr = obj.getSection(sect.getRawDataRefImpl());
+        if (shdr->sh_type == llvm::ELF::SHT_NULL)
+            continue;
+        // keep the first one of the sections with the same name, text and
+        // data sections are written before the others
+        sections.emplace(name->str(), sect);
+        ok &= check(shdr->sh_addralign <= 1 || shdr->sh_offset % shdr->sh_addralign == 0,
+            "section offset is aligned");
+        ok &= check(shdr->sh_offset >= prevEnd, "sections are not overlapping");
+        if (shdr->sh_type != llvm::ELF::SHT_NOBITS) {
+            prevEnd = shdr->sh_offset + shdr->sh_size;
+            ok &= check(prevEnd <= ehdr.e_shoff, "sections precede the header table");
+        }
+    }
+    for (const char* name : { ".text.kernel", ".data.const", ".bss.global",
+        ".visaasm.kernel", ".ze_info", ".symtab", ".strtab",
+        ".rel.text.kernel", ".rela.data.const" })
+        ok &= check(sections.count(name) != 0, name);
+    if (!ok)
+        return false;
+
+    llvm::Expected<llvm::StringRef> textContents = sections[".text.kernel"].getContents();
+    ok &= check(textContents && textContents->size() >= 5 &&
+        !memcmp(textContents->data(), text_buff, 5), ".text.kernel contents");
+    if (!textContents)
+        llvm::consumeError(textContents.takeError());
+    ok &= check(sections[".bss.global"].getSize() >= 64, ".bss.global size");
+    const auto* dataHdr = obj.getSection(sections[".data.const"].getRawDataRefImpl());
+    ok &= check(dataHdr->sh_type == llvm::ELF::SHT_PROGBITS &&
+        (dataHdr->sh_flags & llvm::ELF::SHF_ALLOC), ".data.const is the data section");
+
+    // symbols are defined in their sections
+    std::map<std::string, std::string> symSections;
+    for (const llvm::object::SymbolRef& sym : obj.symbols()) {
+        llvm::Expected<llvm::StringRef> name = sym.getName();
+        llvm::Expected<llvm::object::section_iterator> sect = sym.getSection();
+        if (!name || !sect) {
+            if (!name)
+                llvm::consumeError(name.takeError());
+            if (!sect)
+                llvm::consumeError(sect.takeError());
+            return check(false, "symbols are readable");
+        }
+        if (*sect == obj.section_end())
+            continue;
+        llvm::Expected<llvm::StringRef> sectName = (*sect)->getName();
+        if (sectName)
+            symSections[name->str()] = sectName->str();
+        else
+            llvm::consumeError(sectName.takeError());
+    }
+    ok &= check(symSections["kernel"] == ".text.kernel", "kernel symbol");
+    ok &= check(symSections["const_sym"] == ".data.const", "const_sym symbol");
+    ok &= check(symSections["global_sym"] == ".bss.global", "global_sym symbol");
+
+    // relocations refer to the right symbols
+    auto checkReloc = [&](const char* sectName, uint64_t offset, const char* symName) {
+        bool found = false;
+        for (const llvm::object::RelocationRef& reloc : sections[sectName].relocations()) {
+            llvm::Expected<llvm::StringRef> name = reloc.getSymbol()->getName();
+            if (!name) {
+                llvm::consumeError(name.takeError());
+                continue;
+            }
+            found |= reloc.getOffset() == offset && *name == symName;
+        }
+        return check(found, sectName);
+    };
+    ok &= checkReloc(".rel.text.kernel", 4, "const_sym");
+    ok &= checkReloc(".rela.data.const", 0, "global_sym");
+
+    return ok;
+}
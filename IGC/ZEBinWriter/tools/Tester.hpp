@@ -21,6 +21,9 @@ class Tester {
 public:
     static void testZEInfoOutput();
     static void testELFOutput();
+    // build an object, finalize it into memory and read it back, return
+    // false if the layout, symbols or relocations don't match what was added
+    static bool testELFRoundTrip();
 };
 
 } // namespace zebin
@@ -10,7 +10,7 @@ SPDX-License-Identifier: MIT
 
 #include "Tester.hpp"
 #include <ZEInfo.hpp>
-#include <ZEinfoYAML.hpp>
+#include <ZEInfoYAML.hpp>
 
 #include <llvm/Object/ObjectFile.h>
 #include <llvm/Object/ELFObjectFile.h>
@@ -31,14 +31,21 @@ using namespace zebin;
 static void dumpZEInfo(std::unique_ptr<llvm::object::ObjectFile> object) {
     bool dump = false;
     for (auto sect : object->sections()) {
-        llvm::StringRef name;
-        sect.getName(name);
+        llvm::Expected<llvm::StringRef> name = sect.getName();
+        if (!name) {
+            llvm::consumeError(name.takeError());
+            continue;
+        }
 
-        if (name.compare(llvm::StringRef(".ze_info")))
+        if (name->compare(llvm::StringRef(".ze_info")))
             continue;
 
-        llvm::StringRef content;
-        sect.getContents(content);
+        llvm::Expected<llvm::StringRef> contentOrErr = sect.getContents();
+        if (!contentOrErr) {
+            llvm::consumeError(contentOrErr.takeError());
+            continue;
+        }
+        llvm::StringRef content = *contentOrErr;
 
         std::ofstream outfile;
         outfile.open("ze_info.dump", std::ios::out | std::ios::binary);
@@ -62,6 +69,9 @@ static llvm::cl::opt<bool> DumpZEInfo ("info",
 
 static llvm::cl::opt<bool> RunTestZEInfo ("test-ze-info",
     llvm::cl::desc("Run static zeinfo generating tests, print the result to std output"));
+
+static llvm::cl::opt<bool> RunTestELF ("test-elf",
+    llvm::cl::desc("Build an ELF object in memory and check that it reads back"));
 /// ----------------------------------------------------------------------- ///
 
 int zeinfo_reader_main(int argc, const char** argv) {
@@ -74,6 +84,9 @@ int zeinfo_reader_main(int argc, const char** argv) {
         return 0;
     }
 
+    if (RunTestELF)
+        return Tester::testELFRoundTrip() ? 0 : 1;
+
     // read input elf file
     llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileOrErr =
         llvm::MemoryBuffer::getFile(InputFilename);
@@ -14,7 +14,7 @@ SPDX-License-Identifier: MIT
 #include "common/LLVMWarningsPush.hpp"
 #endif
 
-#include "llvm/MC/StringTableBuilder.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
@@ -29,12 +29,15 @@ SPDX-License-Identifier: MIT
 
 namespace zebin {
 
-/// ELFWriter - A helper class to write ELF contents into given raw_pwrite_stream,
+/// ELFWriter - A helper class to write ELF contents into given raw_ostream,
 ///             according to the given ZEELFObjectBuilder. This object should
 ///             only be used by ZEELFObjectBuilder
+///             The offset and size of all sections are computed before
+///             writing, so that the object can be emitted in a single
+///             sequential pass without seeking back to patch the ELF header
 class ELFWriter {
 public:
-    ELFWriter(llvm::raw_pwrite_stream& OS,
+    ELFWriter(llvm::raw_ostream& OS,
         ZEELFObjectBuilder& objBuilder);
 
     // write the ELF file into OS, return the number of written bytes
@@ -47,7 +50,7 @@ private:
     typedef ZEELFObjectBuilder::ZEInfoSection ZEInfoSection;
     typedef ZEELFObjectBuilder::RelocationListTy RelocationListTy;
     typedef std::map<ZEELFObjectBuilder::SectionID, uint32_t> SectionIndexMapTy;
-    typedef std::map<std::string, uint64_t> SymNameIndexMapTy;
+    typedef std::unordered_map<ZEELFObjectBuilder::SymbolID, uint64_t> SymNameIndexMapTy;
 
     struct SectionHdrEntry {
         uint32_t name    = 0;
@@ -67,11 +70,16 @@ private:
 
 private:
     // set m_SectionHdrEntries and adjust the section index, also create
-    // strings for sections' name in StringTableBuilder
+    // strings for sections' name in the string table
     void createSectionHdrEntries();
+    // assign the symbol table index of every symbol into m_SymNameIdxMap
+    void createSymbolIndices();
+    // compute the offset, size and other attributes of all SectionHdrEntry,
+    // and the offset of section header
+    void computeLayout();
     // write elf header
     void writeHeader();
-    // write sections and set the attributes in SectionHdrEntry
+    // write sections according to the layout of SectionHdrEntry
     void writeSections();
     // write a raw section
     uint64_t writeSectionData(const uint8_t* data, uint64_t size, uint32_t padding);
@@ -79,22 +87,19 @@ private:
     uint64_t writeSymTab();
     // write rel or rela relocation table section
     uint64_t writeRelocTab(const RelocationListTy& relocs, bool isRelFormat);
-    // write ze info section
-    uint64_t writeZEInfo();
-    // write .note.intelgt.compat section
-    std::pair<uint64_t, uint64_t> writeCompatibilityNote();
-    // write .note.intelgt.compat section
-    std::pair<uint64_t, uint64_t> writeMetricsNote(uint64_t sizeRsrv, uint64_t* offset);
+    // write .note.intelgt.compat section contents into given buffer
+    void renderCompatibilityNote(llvm::SmallVectorImpl<char>& buf);
     // write string table
     uint64_t writeStrTab();
     // write section header
     void writeSectionHeader();
-    // write the section header's offset into ELF header
-    void writeSectionHdrOffset(uint64_t offset);
     // write number of zero bytes
-    void writePadding(uint32_t size);
-    // write paddings until the required alignment requirement is met
-    void padToRequiredAlign(uint32_t align);
+    void writePadding(uint64_t size);
+    // write paddings until the given offset (relative to the start of this
+    // object) is reached
+    void padToOffset(uint64_t offset);
+    // the current offset relative to the start of this object
+    uint64_t curOffset() { return m_W.OS.tell() - m_Start; }
 
     // The name writeWord seems confusing. Both ELF32 and ELF64 words are
     // uint32_t.
@@ -114,6 +119,9 @@ private:
         const std::string& name, unsigned type, unsigned flags = 0, const Section* sect = nullptr);
     SectionHdrEntry& createNullSectionHdrEntry();
 
+    // the size of the space reserved at the beginning of the metrics note
+    static const uint64_t MetricsNoteReservedSize = 64;
+
     uint32_t getSymTabEntSize();
     uint32_t getRelocTabEntSize(bool isRelFormat);
 
@@ -131,16 +139,25 @@ private:
 
 private:
     llvm::support::endian::Writer m_W;
-    llvm::StringTableBuilder m_StrTabBuilder{llvm::StringTableBuilder::ELF};
     ZEELFObjectBuilder& m_ObjBuilder;
 
+    // the stream position where this object starts
+    uint64_t m_Start = 0;
+    // offset of the section header
+    uint64_t m_SectHdrOffset = 0;
+
+    // pre-rendered contents of the sections those sizes cannot be known
+    // without serializing them
+    std::string m_ZEInfo;
+    llvm::SmallString<128> m_CompatNote;
+
     // Map Section::m_id to ELF section index, used for creating symbol table
     SectionIndexMapTy m_SectionIndex;
     uint32_t m_SymTabIndex = 0;
     // string table index, it'll be the last section in this ELF file
     uint32_t m_StringTableIndex = 0;
 
-    // symbol name to symbol index mapping, for creating relocations
+    // interned symbol name to symbol index mapping, for creating relocations
     SymNameIndexMapTy m_SymNameIdxMap;
 
     // section information for constructing section header
@@ -153,6 +170,40 @@ private:
 using namespace zebin;
 using namespace llvm;
 
+uint32_t ZEELFObjectBuilder::StringTable::add(const std::string& str)
+{
+    if (str.empty())
+        return 0;
+    auto res = m_offsets.emplace(str, (uint32_t)m_data.size());
+    if (res.second) {
+        m_data.append(str);
+        m_data.push_back('\0');
+    }
+    return res.first->second;
+}
+
+bool ZEELFObjectBuilder::StringTable::lookup(
+    const std::string& str, uint32_t& offset) const
+{
+    if (str.empty()) {
+        offset = 0;
+        return true;
+    }
+    auto it = m_offsets.find(str);
+    if (it == m_offsets.end())
+        return false;
+    offset = it->second;
+    return true;
+}
+
+ZEELFObjectBuilder::SectionID
+ZEELFObjectBuilder::createSectionID(const std::string& sectName)
+{
+    IGC_ASSERT(m_sectionNames.size() == (size_t)m_sectionIdCount);
+    m_sectionNames.push_back(sectName);
+    return m_sectionIdCount++;
+}
+
 ZEELFObjectBuilder::Section&
 ZEELFObjectBuilder::addStandardSection(
     std::string sectName, const uint8_t* data, uint64_t size, unsigned type,
@@ -166,11 +217,20 @@ ZEELFObjectBuilder::addStandardSection(
     if (need_padding_for_align == align)
         need_padding_for_align = 0;
 
+    SectionID id = createSectionID(sectName);
+    // getSectionIDBySectionName searches text sections first, then data and
+    // bss sections, and then the others
+    unsigned rank = &sections == &m_textSections ? 0 :
+        &sections == &m_dataAndbssSections ? 1 : 2;
+    auto res = m_sectionIDs.emplace(sectName, std::make_pair(rank, id));
+    if (!res.second && rank < res.first->second.first)
+        res.first->second = std::make_pair(rank, id);
+    uint32_t nameOff = m_strTab.add(sectName);
+
     // total required padding is (padding + need_padding_for_align)
     sections.emplace_back(
-        ZEELFObjectBuilder::StandardSection(sectName, data, size, type,
-            flags, (need_padding_for_align + padding), m_sectionIdCount));
-    ++m_sectionIdCount;
+        ZEELFObjectBuilder::StandardSection(sectName, nameOff, data, size, type,
+            flags, (need_padding_for_align + padding), id));
     return sections.back();
 }
 
@@ -310,67 +370,99 @@ ZEELFObjectBuilder::addSectionZEInfo(zeInfoContainer& zeInfo)
 {
     // every object should have at most one ze_info section
     IGC_ASSERT(!m_zeInfoSection);
-    m_zeInfoSection.reset(new ZEInfoSection(zeInfo, m_sectionIdCount));
-    ++m_sectionIdCount;
+    m_zeInfoSection.reset(new ZEInfoSection(zeInfo, createSectionID(m_ZEInfoName)));
 }
 
-void ZEELFObjectBuilder::addSymbol(
+ZEELFObjectBuilder::SymbolID ZEELFObjectBuilder::addSymbol(
     std::string name, uint64_t addr, uint64_t size, uint8_t binding,
     uint8_t type, ZEELFObjectBuilder::SectionID sectionId)
 {
+    SymbolID symId = m_strTab.add(name);
+    m_symbolIDs.insert(symId);
     if (binding == llvm::ELF::STB_LOCAL)
         m_localSymbols.emplace_back(
-            ZEELFObjectBuilder::Symbol(name, addr, size, binding, type, sectionId));
+            ZEELFObjectBuilder::Symbol(symId, addr, size, binding, type, sectionId));
     else
         m_globalSymbols.emplace_back(
-            ZEELFObjectBuilder::Symbol(name, addr, size, binding, type, sectionId));
+            ZEELFObjectBuilder::Symbol(symId, addr, size, binding, type, sectionId));
+    return symId;
 }
 
 ZEELFObjectBuilder::RelocSection&
 ZEELFObjectBuilder::getOrCreateRelocSection(SectionID targetSectId, bool isRelFormat)
 {
-    // linear search to see if there's existed reloc section with given target id and rel format
-    // reversely iterate that the latest added might hit first
-    for (RelocSectionListTy::reverse_iterator it = m_relocSections.rbegin();
-         it != m_relocSections.rend(); ++it) {
-        if ((*it).m_TargetID == targetSectId && (*it).isRelFormat() == isRelFormat)
-            return *it;
-    }
+    auto it = m_relocSectionIdx.find(std::make_pair(targetSectId, isRelFormat));
+    if (it != m_relocSectionIdx.end())
+        return m_relocSections[it->second];
+
     // if not found, create one
     // adjust the section name to be .rel.applyTargetName or .rela.applyTargetName
     // If the targt name is empty, we use the defualt name .rel/.rela as the section name
     // though in our case this should not happen
     std::string sectName;
-    std::string targetName = getSectionNameBySectionID(targetSectId);
+    const std::string& targetName = getSectionNameBySectionID(targetSectId);
     if (!targetName.empty())
         sectName = (isRelFormat? m_RelName : m_RelaName) + targetName;
     else
         sectName = isRelFormat? m_RelName : m_RelaName;
 
-    m_relocSections.emplace_back(RelocSection(m_sectionIdCount, targetSectId, sectName, isRelFormat));
-    ++m_sectionIdCount;
+    m_relocSectionIdx.emplace(
+        std::make_pair(targetSectId, isRelFormat), m_relocSections.size());
+    m_relocSections.emplace_back(
+        RelocSection(createSectionID(sectName), targetSectId, sectName, isRelFormat));
     return m_relocSections.back();
 }
 
-void ZEELFObjectBuilder::addRelRelocation(
+bool ZEELFObjectBuilder::lookupSymbol(const std::string& symName, SymbolID& symId) const
+{
+    // only look up the name, a relocation must not add a string that no
+    // symbol refers to into the string table
+    return m_strTab.lookup(symName, symId) && m_symbolIDs.count(symId);
+}
+
+bool ZEELFObjectBuilder::addRelRelocation(
     uint64_t offset, std::string symName, R_TYPE_ZEBIN type, SectionID sectionId)
+{
+    SymbolID symId = 0;
+    if (!lookupSymbol(symName, symId)) {
+        IGC_ASSERT_MESSAGE(0, "addRelRelocation: unknown symbol");
+        return false;
+    }
+    addRelRelocation(offset, symId, type, sectionId);
+    return true;
+}
+
+void ZEELFObjectBuilder::addRelRelocation(
+    uint64_t offset, SymbolID symId, R_TYPE_ZEBIN type, SectionID sectionId)
 {
     RelocSection& reloc_sect = getOrCreateRelocSection(sectionId, true);
     // create the relocation
     reloc_sect.m_Relocations.emplace_back(
-        ZEELFObjectBuilder::Relocation(offset, symName, type));
+        ZEELFObjectBuilder::Relocation(offset, symId, type));
 }
 
-void ZEELFObjectBuilder::addRelaRelocation(
+bool ZEELFObjectBuilder::addRelaRelocation(
     uint64_t offset, std::string symName, R_TYPE_ZEBIN type, uint64_t addend, SectionID sectionId)
+{
+    SymbolID symId = 0;
+    if (!lookupSymbol(symName, symId)) {
+        IGC_ASSERT_MESSAGE(0, "addRelaRelocation: unknown symbol");
+        return false;
+    }
+    addRelaRelocation(offset, symId, type, addend, sectionId);
+    return true;
+}
+
+void ZEELFObjectBuilder::addRelaRelocation(
+    uint64_t offset, SymbolID symId, R_TYPE_ZEBIN type, uint64_t addend, SectionID sectionId)
 {
     RelocSection& reloc_sect = getOrCreateRelocSection(sectionId, false);
     // create the relocation
     reloc_sect.m_Relocations.emplace_back(
-        ZEELFObjectBuilder::Relocation(offset, symName, type, addend));
+        ZEELFObjectBuilder::Relocation(offset, symId, type, addend));
 }
 
-uint64_t ZEELFObjectBuilder::finalize(llvm::raw_pwrite_stream& os)
+uint64_t ZEELFObjectBuilder::finalize(llvm::raw_ostream& os)
 {
     ELFWriter w(os, *this);
     return w.write();
@@ -379,40 +471,20 @@ uint64_t ZEELFObjectBuilder::finalize(llvm::raw_pwrite_stream& os)
 ZEELFObjectBuilder::SectionID
 ZEELFObjectBuilder::getSectionIDBySectionName(const char* name)
 {
-    for (StandardSection& sect : m_textSections) {
-        if (strcmp(name, sect.m_sectName.c_str()) == 0)
-            return sect.id();
-    }
-    for (StandardSection& sect : m_dataAndbssSections) {
-        if (strcmp(name, sect.m_sectName.c_str()) == 0)
-            return sect.id();
-    }
-    for (StandardSection& sect : m_otherStdSections) {
-        if (strcmp(name, sect.m_sectName.c_str()) == 0)
-            return sect.id();
-    }
+    auto it = m_sectionIDs.find(name);
+    if (it != m_sectionIDs.end())
+        return it->second.second;
 
     IGC_ASSERT_MESSAGE(0, "getSectionIDBySectionName: section not found");
     return 0;
 }
 
-std::string ZEELFObjectBuilder::getSectionNameBySectionID(SectionID id)
+const std::string&
+ZEELFObjectBuilder::getSectionNameBySectionID(SectionID id) const
 {
-    // do linear search that we assume there won't be too many sections
-    for (StandardSection& sect : m_textSections) {
-        if (sect.id() == id)
-            return sect.m_sectName;
-    }
-    for (StandardSection& sect : m_dataAndbssSections) {
-        if (sect.id() == id)
-            return sect.m_sectName;
-    }
-    for (StandardSection& sect : m_otherStdSections) {
-        if (sect.id() == id)
-            return sect.m_sectName;
-    }
-    IGC_ASSERT_MESSAGE(0, "getSectionNameBySectionID: invalid SectionID");
-    return "";
+    IGC_ASSERT_MESSAGE(id >= 0 && (size_t)id < m_sectionNames.size(),
+        "getSectionNameBySectionID: invalid SectionID");
+    return m_sectionNames[id];
 }
 
 uint64_t ELFWriter::writeSectionData(const uint8_t* data, uint64_t size, uint32_t padding)
@@ -429,16 +501,16 @@ uint64_t ELFWriter::writeSectionData(const uint8_t* data, uint64_t size, uint32_
     return m_W.OS.tell() - start_off;
 }
 
-void ELFWriter::writePadding(uint32_t size)
+void ELFWriter::writePadding(uint64_t size)
 {
     m_W.OS.write_zeros(size);
 }
 
-void ELFWriter::padToRequiredAlign(uint32_t align)
+void ELFWriter::padToOffset(uint64_t offset)
 {
-    uint64_t cur = m_W.OS.tell();
-    uint64_t next = llvm::alignTo(cur, align);
-    writePadding(next - cur);
+    uint64_t cur = curOffset();
+    IGC_ASSERT_MESSAGE(cur <= offset, "section overlaps with the previous one");
+    writePadding(offset - cur);
 }
 
 uint32_t ELFWriter::getSymTabEntSize()
@@ -507,33 +579,48 @@ uint64_t ELFWriter::writeRelocTab(const RelocationListTy& relocs, bool isRelForm
 
     for (const ZEELFObjectBuilder::Relocation& reloc : relocs) {
         // the target symbol's name must have been added into symbol table
-        IGC_ASSERT(m_SymNameIdxMap.find(reloc.symName()) != m_SymNameIdxMap.end());
+        auto it = m_SymNameIdxMap.find(reloc.symName());
+        IGC_ASSERT(it != m_SymNameIdxMap.end());
 
         if (isRelFormat)
-            writeRelRelocation(
-                reloc.offset(), reloc.type(), m_SymNameIdxMap[reloc.symName()]);
+            writeRelRelocation(reloc.offset(), reloc.type(), it->second);
         else
             writeRelaRelocation(
-                reloc.offset(), reloc.type(), m_SymNameIdxMap[reloc.symName()], reloc.addend());
+                reloc.offset(), reloc.type(), it->second, reloc.addend());
     }
 
     return m_W.OS.tell() - start_off;
 }
 
+void ELFWriter::createSymbolIndices()
+{
+    // index 0 is the null symbol
+    uint64_t symidx = 1;
+
+    auto addOneSym = [&](const ZEELFObjectBuilder::Symbol& sym) {
+        // global symbol name must be unique
+        IGC_ASSERT(sym.binding() != llvm::ELF::STB_GLOBAL || m_SymNameIdxMap.find(sym.name()) == m_SymNameIdxMap.end());
+        // FIXME: This may not set the symidx correctly when there're multiple
+        // same-name local symbols.
+        m_SymNameIdxMap.insert(std::make_pair(sym.name(), symidx));
+        ++symidx;
+    };
+
+    // The local symbols are written first, and then global symbols
+    for (const ZEELFObjectBuilder::Symbol& sym : m_ObjBuilder.m_localSymbols)
+        addOneSym(sym);
+    for (const ZEELFObjectBuilder::Symbol& sym : m_ObjBuilder.m_globalSymbols)
+        addOneSym(sym);
+}
+
 uint64_t ELFWriter::writeSymTab()
 {
     uint64_t start_off = m_W.OS.tell();
 
-    uint64_t symidx = 0;
-
     // index 0 is the null symbol
     writeSymbol(0, 0, 0, 0, 0, 0, ELF::SHN_UNDEF);
-    ++symidx;
-
-    auto writeOneSym = [&](ZEELFObjectBuilder::Symbol& sym) {
-        // create symbol name entry in str table
-        uint32_t nameoff = m_StrTabBuilder.add(StringRef(sym.name()));
 
+    auto writeOneSym = [&](const ZEELFObjectBuilder::Symbol& sym) {
         uint16_t sect_idx = 0;
         if (sym.sectionId() >= 0) {
             // the given section's index must have been adjusted in
@@ -545,72 +632,61 @@ uint64_t ELFWriter::writeSymTab()
             sect_idx = ELF::SHN_UNDEF;
         }
 
-        writeSymbol(nameoff, sym.addr(), sym.size(), sym.binding(), sym.type(),
+        // the symbol name is interned to its offset in string table
+        writeSymbol(sym.name(), sym.addr(), sym.size(), sym.binding(), sym.type(),
             0, sect_idx);
-        // global symbol name must be unique
-        IGC_ASSERT(sym.binding() != llvm::ELF::STB_GLOBAL || m_SymNameIdxMap.find(sym.name()) == m_SymNameIdxMap.end());
-        // FIXME: This may not set the symidx correctly when there're multiple
-        // same-name local symbols.
-        m_SymNameIdxMap.insert(std::make_pair(sym.name(), symidx));
-        ++symidx;
     };
 
     // Write the local symbols first
-    for (ZEELFObjectBuilder::Symbol& sym : m_ObjBuilder.m_localSymbols) {
+    for (const ZEELFObjectBuilder::Symbol& sym : m_ObjBuilder.m_localSymbols) {
         writeOneSym(sym);
     }
 
     // And then global symbols
-    for (ZEELFObjectBuilder::Symbol& sym : m_ObjBuilder.m_globalSymbols) {
+    for (const ZEELFObjectBuilder::Symbol& sym : m_ObjBuilder.m_globalSymbols) {
         writeOneSym(sym);
     }
 
     return m_W.OS.tell() - start_off;
 }
 
-uint64_t ELFWriter::writeZEInfo()
+void ELFWriter::renderCompatibilityNote(llvm::SmallVectorImpl<char>& buf)
 {
-    uint64_t start_off = m_W.OS.tell();
-    // serialize ze_info contents
-    llvm::yaml::Output yout(m_W.OS);
-    IGC_ASSERT(m_ObjBuilder.m_zeInfoSection);
-    yout << m_ObjBuilder.m_zeInfoSection->getZeInfo();
-
-    return m_W.OS.tell() - start_off;
-}
-
-std::pair<uint64_t, uint64_t> ELFWriter::writeCompatibilityNote() {
     // The alignment of the Elf word, name and descriptor is 4.
     // Implementations differ from the specification here: in practice all
     // variants align both the name and descriptor to 4-bytes.
+    // The note is rendered into its own buffer which is 4-bytes aligned in
+    // the final object, so the alignment can be computed from the buffer size.
+    llvm::raw_svector_ostream os(buf);
+    llvm::support::endian::Writer w(os, llvm::support::little);
+
+    auto padToAlign4 = [&]() {
+        os.write_zeros(llvm::alignTo(buf.size(), 4) - buf.size());
+    };
 
     auto writeOneNote = [&](StringRef owner, auto desc, uint32_t type) {
         // It's easier to use uint32_t directly now because both Elf32_Word and
         // Elf64_Word are uint32_t.
         // TODO: Use template implementation to handle ELF32 and ELF64 cases.
-        m_W.write<uint32_t>(owner.size() + 1);
-        m_W.write<uint32_t>(sizeof(desc));
-        m_W.write<uint32_t>(type);
-        m_W.OS << owner << '\0';
-        padToRequiredAlign(4);
-        m_W.write(desc);
-        padToRequiredAlign(4);
+        w.write<uint32_t>(owner.size() + 1);
+        w.write<uint32_t>(sizeof(desc));
+        w.write<uint32_t>(type);
+        os << owner << '\0';
+        padToAlign4();
+        w.write(desc);
+        padToAlign4();
     };
 
     auto writeOneStrNote = [&](StringRef owner, StringRef desc, uint32_t type) {
-        m_W.write<uint32_t>(owner.size() + 1);
-        m_W.write<uint32_t>(desc.size() + 1);
-        m_W.write<uint32_t>(type);
-        m_W.OS << owner << '\0';
-        padToRequiredAlign(4);
-        m_W.OS << desc << '\0';
-        padToRequiredAlign(4);
+        w.write<uint32_t>(owner.size() + 1);
+        w.write<uint32_t>(desc.size() + 1);
+        w.write<uint32_t>(type);
+        os << owner << '\0';
+        padToAlign4();
+        os << desc << '\0';
+        padToAlign4();
     };
 
-    // Align the section offset to the required alignment first.
-    // TODO: Handle the section alignment in a more generic place..
-    padToRequiredAlign(4);
-    uint64_t start_off = m_W.OS.tell();
     // write NT_INTELGT_PRODUCT_FAMILY
     writeOneNote("IntelGT",
                  static_cast<uint32_t>(m_ObjBuilder.m_productFamily),
@@ -630,34 +706,16 @@ std::pair<uint64_t, uint64_t> ELFWriter::writeCompatibilityNote() {
     writeOneStrNote("IntelGT",
                     PreDefinedAttrGetter::getVersionNumber(),
                     NT_INTELGT_ZEBIN_VERSION);
-    return std::make_pair(start_off, m_W.OS.tell() - start_off);
-}
-
-std::pair<uint64_t, uint64_t> ELFWriter::writeMetricsNote(uint64_t sizeRsrv, uint64_t* offset) {
-    // Note that currently the alignment requirement of the metrics note used
-    // is same as the alignment of a standard ELF note.
-
-    // Align the section offset to the required alignment first.
-    // TODO: Handle the section alignment in a more generic place.
-    padToRequiredAlign(4);
-    uint64_t start_off = m_W.OS.tell();
-    *offset = start_off;
-    // Reserve space for metrics data
-    writePadding(sizeRsrv);
-
-    return std::make_pair(start_off, m_W.OS.tell() - start_off);
 }
 
 uint64_t ELFWriter::writeStrTab()
 {
     uint64_t start_off = m_W.OS.tell();
 
-    // at this point, all strings should be added. Finalized the string table
-    // and write it to OS
-    // must finalize it in order, that we take the offset of
-    // section and symbols' name when added
-    m_StrTabBuilder.finalizeInOrder();
-    m_StrTabBuilder.write(m_W.OS);
+    // all strings are added into the string table when the sections and
+    // symbols are created, it's ready to be written as is
+    const std::string& strtab = m_ObjBuilder.m_strTab.data();
+    m_W.OS.write(strtab.data(), strtab.size());
 
     return m_W.OS.tell() - start_off;
 }
@@ -682,7 +740,7 @@ void ELFWriter::writeSecHdrEntry(uint32_t name, uint32_t type, uint64_t flags,
 void ELFWriter::writeSectionHeader()
 {
     // all SectionHdrEntry fields should be fill-up in either
-    // createSectionHdrEntries or writeSections
+    // createSectionHdrEntries or computeLayout
     for (SectionHdrEntry& entry : m_SectionHdrEntries) {
         writeSecHdrEntry(
             entry.name, entry.type, entry.flags, 0, entry.offset, entry.size, entry.link,
@@ -690,11 +748,14 @@ void ELFWriter::writeSectionHeader()
     }
 }
 
-void ELFWriter::writeSections()
+void ELFWriter::computeLayout()
 {
+    uint64_t offset = is64Bit() ? sizeof(ELF::Elf64_Ehdr) : sizeof(ELF::Elf32_Ehdr);
+    const uint32_t sectAlign = is64Bit() ? 8 : 4;
+
     for (SectionHdrEntry& entry : m_SectionHdrEntries) {
-        padToRequiredAlign(is64Bit() ? 8 : 4);
-        entry.offset = m_W.OS.tell();
+        offset = llvm::alignTo(offset, sectAlign);
+        entry.offset = offset;
 
         switch(entry.type) {
         case SHT_ZEBIN_GTPIN_INFO: {
@@ -705,9 +766,12 @@ void ELFWriter::writeSections()
             auto res = symName.consume_front(m_ObjBuilder.m_GTPinInfoName);
             IGC_ASSERT(res);
             if (symName.consume_front(".")) {
-                auto it = m_SymNameIdxMap.find(symName.str());
-                IGC_ASSERT(it != m_SymNameIdxMap.end());
-                entry.info = it->second;
+                ZEELFObjectBuilder::SymbolID symId = 0;
+                bool found = m_ObjBuilder.m_strTab.lookup(symName.str(), symId);
+                auto it = m_SymNameIdxMap.find(symId);
+                IGC_ASSERT(found && it != m_SymNameIdxMap.end());
+                if (found && it != m_SymNameIdxMap.end())
+                    entry.info = it->second;
             }
             /* Fall-through */
         }
@@ -721,24 +785,27 @@ void ELFWriter::writeSections()
                 static_cast<const StandardSection*>(entry.section);
             IGC_ASSERT(nullptr != stdsect);
             IGC_ASSERT(stdsect->m_size + stdsect->m_padding);
-            entry.size = writeSectionData(
-                stdsect->m_data, stdsect->m_size, stdsect->m_padding);
+            entry.size = stdsect->m_size + stdsect->m_padding;
+            offset += entry.size;
             break;
         }
         case ELF::SHT_NOBITS: {
             const StandardSection* const stdsect =
                 static_cast<const StandardSection*>(entry.section);
             IGC_ASSERT(nullptr != stdsect);
+            // occupies no space in the file
             entry.size = stdsect->m_size;
             break;
         }
         case ELF::SHT_SYMTAB:
-            entry.size = writeSymTab();
             entry.entsize = getSymTabEntSize();
+            entry.size = (uint64_t)entry.entsize * (m_ObjBuilder.m_localSymbols.size() +
+                m_ObjBuilder.m_globalSymbols.size() + 1);
             entry.link = m_StringTableIndex;
             // one greater than the last local symbol index, including the
             // first null symbol
             entry.info = m_ObjBuilder.m_localSymbols.size() + 1;
+            offset += entry.size;
             break;
 
         case ELF::SHT_REL:
@@ -748,16 +815,25 @@ void ELFWriter::writeSections()
             const RelocSection* const relocSec =
                 static_cast<const RelocSection*>(entry.section);
             IGC_ASSERT(nullptr != relocSec);
-            entry.size = writeRelocTab(relocSec->m_Relocations, relocSec->isRelFormat());
             entry.entsize = getRelocTabEntSize(relocSec->isRelFormat());
+            entry.size = (uint64_t)entry.entsize * relocSec->m_Relocations.size();
+            offset += entry.size;
             break;
         }
-        case SHT_ZEBIN_ZEINFO:
-            entry.size = writeZEInfo();
+        case SHT_ZEBIN_ZEINFO: {
+            // serialize ze_info contents
+            IGC_ASSERT(m_ObjBuilder.m_zeInfoSection);
+            llvm::raw_string_ostream os(m_ZEInfo);
+            llvm::yaml::Output yout(os);
+            yout << m_ObjBuilder.m_zeInfoSection->getZeInfo();
+            os.flush();
+            entry.size = m_ZEInfo.size();
+            offset += entry.size;
             break;
-
+        }
         case ELF::SHT_STRTAB:
-            entry.size = writeStrTab();
+            entry.size = m_ObjBuilder.m_strTab.size();
+            offset += entry.size;
             break;
 
         case ELF::SHT_NULL:
@@ -768,25 +844,26 @@ void ELFWriter::writeSections()
             break;
 
         case ELF::SHT_NOTE: {
-            // Currently we don't seem to reorder strings in the .strtab, and
-            // the offset returned by LLVM StringTableBuilder::add() will still
-            // be valid, so the section name can be checked in this way.
-            //  Other possibilities are: creating a new section kind and set
-            // the appropriate section pointer, or emitting .strtab before
-            // the note section.
+            // Note sections are aligned to 4 which is always satisfied by
+            // the section alignment
             if (entry.sectName == m_ObjBuilder.m_CompatNoteName) {
-                std::tie(entry.offset, entry.size) = writeCompatibilityNote();
+                renderCompatibilityNote(m_CompatNote);
+                entry.size = m_CompatNote.size();
+                offset += entry.size;
             }
             if (entry.sectName == m_ObjBuilder.m_MetricsNoteName) {
-                uint64_t metricsDataBeginOffset = 0;
-                std::tie(entry.offset, entry.size) = writeMetricsNote(64, &metricsDataBeginOffset);
+                // Reserve space for metrics data
+                entry.size = MetricsNoteReservedSize;
+                offset += entry.size;
                 IGC_ASSERT(nullptr != entry.section);
                 IGC_ASSERT(entry.section->getKind() == Section::STANDARD);
                 const StandardSection* const stdsect =
                     static_cast<const StandardSection*>(entry.section);
                 IGC_ASSERT(nullptr != stdsect);
-                if (stdsect->m_size + stdsect->m_padding > 0)
-                    entry.size = writeSectionData(stdsect->m_data, stdsect->m_size, stdsect->m_padding);
+                if (stdsect->m_size + stdsect->m_padding > 0) {
+                    entry.size = stdsect->m_size + stdsect->m_padding;
+                    offset += entry.size;
+                }
             }
             break;
         }
@@ -796,24 +873,70 @@ void ELFWriter::writeSections()
             break;
         }
     }
+
+    // TODO: Use template implementation to handle ELF32 and ELF64 cases.
+    // Now use a hard-coded alignment value for ELF section header entries.
+    m_SectHdrOffset = llvm::alignTo(offset, sectAlign);
 }
 
-void ELFWriter::writeSectionHdrOffset(uint64_t offset)
+void ELFWriter::writeSections()
 {
-    auto &stream = static_cast<raw_pwrite_stream &>(m_W.OS);
+    for (SectionHdrEntry& entry : m_SectionHdrEntries) {
+        switch(entry.type) {
+        case SHT_ZEBIN_GTPIN_INFO:
+        case ELF::SHT_PROGBITS:
+        case SHT_ZEBIN_VISAASM:
+        case SHT_ZEBIN_SPIRV:
+        case SHT_ZEBIN_MISC: {
+            const StandardSection* const stdsect =
+                static_cast<const StandardSection*>(entry.section);
+            padToOffset(entry.offset);
+            writeSectionData(stdsect->m_data, stdsect->m_size, stdsect->m_padding);
+            break;
+        }
+        case ELF::SHT_SYMTAB:
+            padToOffset(entry.offset);
+            writeSymTab();
+            break;
 
-    if (is64Bit()) {
-        uint64_t Val =
-            support::endian::byte_swap<uint64_t>(offset, m_W.Endian);
-        stream.pwrite(reinterpret_cast<char *>(&Val), sizeof(Val),
-            offsetof(ELF::Elf64_Ehdr, e_shoff));
+        case ELF::SHT_REL:
+        case ELF::SHT_RELA: {
+            const RelocSection* const relocSec =
+                static_cast<const RelocSection*>(entry.section);
+            padToOffset(entry.offset);
+            writeRelocTab(relocSec->m_Relocations, relocSec->isRelFormat());
+            break;
+        }
+        case SHT_ZEBIN_ZEINFO:
+            padToOffset(entry.offset);
+            m_W.OS << m_ZEInfo;
+            // release the serialized contents once it's written
+            std::string().swap(m_ZEInfo);
+            break;
 
-    } else {
-        uint32_t Val =
-            support::endian::byte_swap<uint32_t>(
-                static_cast<uint32_t>(offset), m_W.Endian);
-        stream.pwrite(reinterpret_cast<char *>(&Val), sizeof(Val),
-            offsetof(ELF::Elf32_Ehdr, e_shoff));
+        case ELF::SHT_STRTAB:
+            padToOffset(entry.offset);
+            writeStrTab();
+            break;
+
+        case ELF::SHT_NOTE: {
+            padToOffset(entry.offset);
+            if (entry.sectName == m_ObjBuilder.m_CompatNoteName)
+                m_W.OS << m_CompatNote;
+            if (entry.sectName == m_ObjBuilder.m_MetricsNoteName) {
+                writePadding(MetricsNoteReservedSize);
+                const StandardSection* const stdsect =
+                    static_cast<const StandardSection*>(entry.section);
+                if (stdsect->m_size + stdsect->m_padding > 0)
+                    writeSectionData(stdsect->m_data, stdsect->m_size, stdsect->m_padding);
+            }
+            break;
+        }
+
+        default:
+            // SHT_NULL and SHT_NOBITS have no contents in the file
+            break;
+        }
     }
 }
 
@@ -856,8 +979,8 @@ void ELFWriter::writeHeader()
     // e_phoff, no program header
     writeWord(0);
 
-    // e_shoff, will write it later
-    writeWord(0);
+    // e_shoff, the layout has been computed before writing
+    writeWord(m_SectHdrOffset);
 
     // e_flags
     m_W.write<uint32_t>(0);
@@ -890,7 +1013,7 @@ uint16_t ELFWriter::numOfSections()
     return m_StringTableIndex + 1;
 }
 
-ELFWriter::ELFWriter(llvm::raw_pwrite_stream& OS,
+ELFWriter::ELFWriter(llvm::raw_ostream& OS,
                      ZEELFObjectBuilder& objBuilder)
     : m_W(OS, llvm::support::little), m_ObjBuilder(objBuilder)
 {
@@ -898,18 +1021,17 @@ ELFWriter::ELFWriter(llvm::raw_pwrite_stream& OS,
 
 uint64_t ELFWriter::write()
 {
-    uint64_t start = m_W.OS.tell();
+    m_Start = m_W.OS.tell();
     createSectionHdrEntries();
+    createSymbolIndices();
+    computeLayout();
+
+    // stream the object: header, sections in order, then the section header
     writeHeader();
     writeSections();
-
-    // TODO: Use template implementation to handle ELF32 and ELF64 cases.
-    // Now use a hard-coded alignment value for ELF section header entries.
-    padToRequiredAlign(is64Bit() ? 8 : 4);
-    uint64_t sectHdrOff = m_W.OS.tell();
+    padToOffset(m_SectHdrOffset);
     writeSectionHeader();
-    writeSectionHdrOffset(sectHdrOff);
-    return m_W.OS.tell() - start;
+    return curOffset();
 }
 
 ELFWriter::SectionHdrEntry& ELFWriter::createNullSectionHdrEntry()
@@ -928,8 +1050,7 @@ ELFWriter::SectionHdrEntry& ELFWriter::createSectionHdrEntry(
     entry.flags = flags;
     entry.section = sect;
     entry.sectName = name;
-    uint32_t nameoff = m_StrTabBuilder.add(StringRef(name));
-    entry.name = nameoff;
+    entry.name = m_ObjBuilder.m_strTab.add(name);
     return entry;
 }
 
@@ -33,10 +33,12 @@ SPDX-License-Identifier: MIT
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace llvm {
-    class raw_pwrite_stream;
+    class raw_ostream;
 }
 
 namespace zebin {
@@ -48,6 +50,11 @@ public:
     // The valid SectionID must be 0 or positive value
     typedef int32_t SectionID;
 
+    // SymbolID - the interned name of a symbol. Names are interned into the
+    // string table when they're added, and the returned ID is the offset of
+    // the name in .strtab. Relocations refer to their target symbol by it.
+    typedef uint32_t SymbolID;
+
 public:
     ZEELFObjectBuilder(bool is64Bit) : m_is64Bit(is64Bit)
     {
@@ -182,7 +189,9 @@ public:
     // - type    : symbol type. The value is defined in ELF standard ST_TYPE
     // - sectionId : the section id of which this symbol is defined in. Giving
     //               -1 if this is an UNDEFINED symbol
-    void addSymbol(std::string name, uint64_t addr, uint64_t size,
+    // - return the interned id of the symbol's name for referencing in
+    //   addRelRelocation and addRelaRelocation
+    SymbolID addSymbol(std::string name, uint64_t addr, uint64_t size,
         uint8_t binding, uint8_t type, SectionID sectionId);
 
     // add a relocation with rel format
@@ -190,33 +199,67 @@ public:
     // not exist
     // - offset    : the binary offset of the section where the relocation
     //               will apply to. The section is denoted by sectionId
-    // - symName   : the target symbol's name
+    // - symName   : the target symbol's name, the symbol must have been added
     // - type      : the relocation name
     // - sectionId : the section id where the relocation is apply to
-    void addRelRelocation(
+    // - return false if symName is not a known symbol, no relocation is added
+    bool addRelRelocation(
         uint64_t offset, std::string symName, R_TYPE_ZEBIN type, SectionID sectionId);
+    // same as above, but refer the target symbol by its interned id
+    void addRelRelocation(
+        uint64_t offset, SymbolID symId, R_TYPE_ZEBIN type, SectionID sectionId);
 
     // add a relocation with rela format
     // This function will create a corresponding .rela.{targetSectionName} section if
     // not exist
     // - offset    : the binary offset of the section where the relocation
     //               will apply to. The section is denoted by sectionId
-    // - symName   : the target symbol's name
+    // - symName   : the target symbol's name, the symbol must have been added
     // - type      : the relocation name
     // - addend    : the addend value
     // - sectionId : the section id where the relocation is apply to
-    void addRelaRelocation(
+    // - return false if symName is not a known symbol, no relocation is added
+    bool addRelaRelocation(
         uint64_t offset, std::string symName, R_TYPE_ZEBIN type, uint64_t addend, SectionID sectionId);
+    // same as above, but refer the target symbol by its interned id
+    void addRelaRelocation(
+        uint64_t offset, SymbolID symId, R_TYPE_ZEBIN type, uint64_t addend, SectionID sectionId);
 
     // finalize - Finalize the ELF Object, write ELF file into given os
+    // The layout of the whole object is computed before anything is written,
+    // and then each section is streamed to os in order directly from its
+    // source buffer. os is written sequentially only, it doesn't need to be
+    // seekable and no copy of the object is held in memory.
     // return number of written bytes
-    uint64_t finalize(llvm::raw_pwrite_stream& os);
+    uint64_t finalize(llvm::raw_ostream& os);
 
     // get an ID of a section
     // - name  : section name
     SectionID getSectionIDBySectionName(const char* name);
 
 private:
+    /// StringTable - the ELF string table shared by section and symbol names.
+    /// It's built incrementally while sections and symbols are added. The same
+    /// string is always interned to the same offset.
+    class StringTable {
+    public:
+        // index 0 is reserved for the empty string
+        StringTable() : m_data(1, '\0') {}
+
+        // add a string if not exist, return its offset in the table
+        uint32_t add(const std::string& str);
+        // get the offset of a previously added string, return false if
+        // the string is not in the table
+        bool lookup(const std::string& str, uint32_t& offset) const;
+
+        uint64_t size() const { return m_data.size(); }
+        const std::string& data() const { return m_data; }
+
+    private:
+        std::string m_data;
+        std::unordered_map<std::string, uint32_t> m_offsets;
+    };
+
     class Section {
     public:
         enum Kind {STANDARD, RELOC, ZEINFO};
@@ -236,10 +279,10 @@ private:
 
     class StandardSection : public Section {
     public:
-        StandardSection(std::string sectName, const uint8_t* data, uint64_t size,
-            unsigned type, unsigned flags, uint32_t padding, uint32_t id)
-            : Section(id), m_sectName(sectName), m_data(data), m_size(size), m_type(type),
-              m_flags(flags), m_padding(padding)
+        StandardSection(std::string sectName, uint32_t nameOff, const uint8_t* data,
+            uint64_t size, unsigned type, unsigned flags, uint32_t padding, uint32_t id)
+            : Section(id), m_sectName(sectName), m_nameOff(nameOff), m_data(data),
+              m_size(size), m_type(type), m_flags(flags), m_padding(padding)
         {}
 
         Kind getKind() const { return STANDARD; }
@@ -247,6 +290,8 @@ private:
         // m_sectName - the final name presented in ELF section header
         // This field is required as the place holder for StringTable construction
         std::string m_sectName;
+        // offset of m_sectName in the string table
+        uint32_t m_nameOff;
         const uint8_t* m_data;
         uint64_t m_size;
         // section type
@@ -272,13 +317,13 @@ private:
 
     class Symbol {
     public:
-        Symbol(std::string name, uint64_t addr, uint64_t size, uint8_t binding,
+        Symbol(SymbolID name, uint64_t addr, uint64_t size, uint8_t binding,
             uint8_t type, SectionID sectionId)
             : m_name(name), m_addr(addr), m_size(size), m_binding(binding),
             m_type(type), m_sectionId(sectionId)
         {}
 
-        std::string& name()            { return m_name;      }
+        SymbolID     name()      const { return m_name;      }
         uint64_t     addr()      const { return m_addr;      }
         uint64_t     size()      const { return m_size;      }
         uint8_t      binding()   const { return m_binding;   }
@@ -286,7 +331,7 @@ private:
         SectionID    sectionId() const { return m_sectionId; }
 
     private:
-        std::string m_name;
+        SymbolID m_name;
         uint64_t m_addr;
         uint64_t m_size;
         uint8_t m_binding;
@@ -299,18 +344,18 @@ private:
     /// It's rel or rela depends on it's in RelocSection or RelaRelocSection
     class Relocation {
     public:
-        Relocation(uint64_t offset, std::string symName, R_TYPE_ZEBIN type, uint64_t addend = 0)
+        Relocation(uint64_t offset, SymbolID symName, R_TYPE_ZEBIN type, uint64_t addend = 0)
             : m_offset(offset), m_symName(symName), m_type(type), m_addend(addend)
         {}
 
         uint64_t            offset()  const { return m_offset;  }
-        const std::string&  symName() const { return m_symName; }
+        SymbolID            symName() const { return m_symName; }
         R_TYPE_ZEBIN        type()    const { return m_type;    }
         uint64_t            addend()  const { return m_addend;  }
 
     private:
         uint64_t m_offset;
-        std::string m_symName;
+        SymbolID m_symName;
         R_TYPE_ZEBIN m_type;
         uint64_t m_addend;
     };
@@ -347,7 +392,14 @@ private:
     // isRelFormat - rel or rela relocation format
     RelocSection& getOrCreateRelocSection(SectionID targetSectId, bool isRelFormat);
 
-    std::string getSectionNameBySectionID(SectionID id);
+    // record the name of a newly created section, return its id
+    SectionID createSectionID(const std::string& sectName);
+
+    const std::string& getSectionNameBySectionID(SectionID id) const;
+
+    // find the interned id of an added symbol, return false if there's no
+    // symbol of the given name
+    bool lookupSymbol(const std::string& symName, SymbolID& symId) const;
 
 private:
     // place holder for section default name
@@ -384,6 +436,20 @@ private:
     // current section id
     SectionID m_sectionIdCount = 0;
 
+    // section names indexed by SectionID
+    std::vector<std::string> m_sectionNames;
+    // standard section name to its search rank and id. Sections with the same
+    // name are looked up in text, data and bss, and then other sections, and
+    // the first added one within the same kind
+    std::unordered_map<std::string, std::pair<unsigned, SectionID>> m_sectionIDs;
+    // interned names of the added symbols
+    std::unordered_set<SymbolID> m_symbolIDs;
+    // (target section id, isRelFormat) to the index in m_relocSections
+    std::map<std::pair<SectionID, bool>, size_t> m_relocSectionIdx;
+
+    // .strtab contents, section and symbol names are added into it on creation
+    StringTable m_strTab;
+
     // every ze object contains at most one ze_info section
     std::unique_ptr<ZEInfoSection> m_zeInfoSection;
     SymbolListTy m_localSymbols;
@@ -200,6 +200,18 @@ void ShaderStats::printSumShaderStats()
             fprintf(fileName_sqm, "total SIMD32 grf pressure = %d\n", m_CompileShaderStats[STATS_GRF_PRESSURE_SIMD32]);
             printf("total SIMD32 grf pressure = %d\n", m_CompileShaderStats[STATS_GRF_PRESSURE_SIMD32]);
         }
+        if (m_CompileShaderStats[STATS_PRIVATE_ARRAYS_IN_SCRATCH] != 0 ||
+            m_CompileShaderStats[STATS_PRIVATE_ARRAYS_IN_SLM] != 0)
+        {
+            fprintf(fileName_sqm, "total private arrays in GRF = %d, SLM = %d, scratch = %d\n",
+                m_CompileShaderStats[STATS_PRIVATE_ARRAYS_IN_GRF],
+                m_CompileShaderStats[STATS_PRIVATE_ARRAYS_IN_SLM],
+                m_CompileShaderStats[STATS_PRIVATE_ARRAYS_IN_SCRATCH]);
+            printf("total private arrays in GRF = %d, SLM = %d, scratch = %d\n",
+                m_CompileShaderStats[STATS_PRIVATE_ARRAYS_IN_GRF],
+                m_CompileShaderStats[STATS_PRIVATE_ARRAYS_IN_SLM],
+                m_CompileShaderStats[STATS_PRIVATE_ARRAYS_IN_SCRATCH]);
+        }
 
         fprintf(fileName_sqm, "total SIMD8  shaders = %d\n", m_TotalSimd8);
         fprintf(fileName_sqm, "total SIMD16 shaders = %d\n", m_TotalSimd16);
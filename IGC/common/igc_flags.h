@@ -163,6 +163,7 @@ DECLARE_IGC_REGKEY(bool, DisableEmptyBlockRemoval,      false, "Setting this to
 DECLARE_IGC_REGKEY(bool, DisableSIMD32Slicing,          false, "Setting this to 1/true adds a compiler switch to disable emitting SIMD32 VISA code in slices", false)
 DECLARE_IGC_REGKEY(bool, DisableMatchMad,               false, "Setting this to 1/true adds a compiler switch to disable mul+add = mad optimization", false)
 DECLARE_IGC_REGKEY(bool, WaAllowMatchMadOptimizationforVS, false, "Setting this to 1/true adds a compiler switch to enable mul+add = mad optimization for VS", false)
+DECLARE_IGC_REGKEY(bool, EnableCostDrivenPatternMatch,  false, "Setting this to 1/true selects among overlapping arithmetic patterns (mad, add3, lrp, modifiers...) by estimated cost instead of taking the first match", false)
 DECLARE_IGC_REGKEY(bool, DisableLoadSinking,            true,  "Setting this to 1/true adds a compiler switch to disable load sinking during retry", false)
 DECLARE_IGC_REGKEY(bool, EnableIntegerMad,              true,  "Setting this to 1/true adds a compiler switch to enable integer mul+add = mad optimization", false)
 DECLARE_IGC_REGKEY(bool, DisableMatchPredAdd,           false, "Setting this to 1/true adds a compiler switch to disable pred+add = predAdd optimization", false)
@@ -177,6 +178,7 @@ DECLARE_IGC_REGKEY(DWORD, SynchronizationObjectCoalescingConfig, 0, "Modify the
 DECLARE_IGC_REGKEY(DWORD,SetLoopUnrollThreshold,        0,     "Set the loop unroll threshold. Value 0 will use the default threshold.", false)
 DECLARE_IGC_REGKEY(DWORD,SetLoopUnrollThresholdForHighRegPressure,        0,     "Set the loop unroll threshold for shaders with high reg pressure. Value 0 will use the default threshold.", false)
 DECLARE_IGC_REGKEY(DWORD,SetRegisterPressureThresholdForLoopUnroll,       64,     "Set the register pressure threshold for limiting the loop unroll to smaller loops", false)
+DECLARE_IGC_REGKEY(bool, EnableRegPressureAwareUnroll,  false, "Limit loop unroll factor by the estimated GRF pressure of the loop", false)
 DECLARE_IGC_REGKEY(DWORD,SetBranchSwapThreshold,        400,   "Set the branch swaping threshold.", false)
 DECLARE_IGC_REGKEY(debugString, LLVMCommandLine,        0,     "applies LLVM command line", false)
 DECLARE_IGC_REGKEY(debugString, SelectiveHashOptions,   0,     "applies options to hash ragne via string", false)
@@ -347,6 +349,9 @@ DECLARE_IGC_REGKEY(bool, EnableCapsDump,                false, "Enable hardware
 DECLARE_IGC_REGKEY(bool, EnableLivenessDump,            false, "Enable dumping out liveness info on stderr.", true)
 DECLARE_IGC_REGKEY(DWORD, ForceRPE,                     0,     "Force RPE (RegisterEstimator) computation if > 0. If 2, force RPE per inst.", true)
 DECLARE_IGC_REGKEY(DWORD, RPEDumpLevel,                 0,     "> 0 : dump info of register pressure estimate on stderr. See igc_flags.hpp level defs.", false)
+DECLARE_IGC_REGKEY(bool, EnablePressureCodeMotion,      false, "Enable global code motion (sinking, hoisting, rematerialization) driven by the register pressure estimate", false)
+DECLARE_IGC_REGKEY(DWORD, PressureCodeMotionSimdSize,    32,    "SIMD size whose GRF budget pressure driven code motion aims at, unless a sub group size is required", false)
+DECLARE_IGC_REGKEY(DWORD, PressureCodeMotionMaxRounds,   4,     "Max number of rounds of pressure driven code motion, liveness is recomputed between rounds", false)
 DECLARE_IGC_REGKEY(bool, DumpOCLProgramInfo,            false, "dump OpenCL Patch Tokens, Kernel/Program Binary Header", true)
 DECLARE_IGC_REGKEY(bool, DumpPatchTokens,               false, "Enable dumping of patch tokens.", true)
 DECLARE_IGC_REGKEY(bool, DumpVariableAlias,             false, "Dump variable alias info, valid if EnableVariableAlias is on)", true)
@@ -375,6 +380,7 @@ DECLARE_IGC_REGKEY(bool, EnableWriteOldFPToStack,       true,  "Setting this to
 DECLARE_IGC_REGKEY(bool, ZeBinCompatibleDebugging,      true,  "Setting this to 1 (true) enables embed debug info in zeBinary", true)
 DECLARE_IGC_REGKEY(bool, DebugInfoEnforceAmd64EM,       false, "Enforces elf file with the debug infomation to have eMachine set to AMD64", false)
 DECLARE_IGC_REGKEY(bool, DebugInfoValidation,           false, "Enable optional (strict) checks to detect debug information inconsistencies", false)
+DECLARE_IGC_REGKEY(bool, ParallelDebugInfoEmission,     false, "Setting this to 1 (true) finalizes the debug information of independent kernels concurrently", true)
 DECLARE_IGC_REGKEY(bool, deadLoopForFloatException,           false, "enable a dead loop if float exception happened", false)
 DECLARE_IGC_REGKEY(debugString, ExtraOCLOptions,        0,     "Extra options for OpenCL", true)
 DECLARE_IGC_REGKEY(debugString, ExtraOCLInternalOptions, 0,    "Extra internal options for OpenCL", true)
@@ -411,6 +417,7 @@ DECLARE_IGC_REGKEY(bool, EnableTypeDemotion,            true,  "Enable Type Demo
 DECLARE_IGC_REGKEY(bool, EnablePreRARematFlag,          true,  "Enable PreRA Rematerialization of Flag", false)
 DECLARE_IGC_REGKEY(bool, EnableGASResolver,             true,  "Enable GAS Resolver", false)
 DECLARE_IGC_REGKEY(bool, EnableLowerGPCallArg,          true,  "Enable pass to lower generic pointers in function arguments", false)
+DECLARE_IGC_REGKEY(DWORD, SpecializedKernelCacheSizeKB, 65536, "Upper bound in KB on the memory held by the per-device cache of programs built with specialized kernel arguments. 0 disables the cache", false)
 DECLARE_IGC_REGKEY(bool, DisableRecompilation,          false, "Disable recompilation", true)
 DECLARE_IGC_REGKEY(bool, SampleMultiversioning,         false, "Create branches aroung samplers which can be redundant with some values", false)
 DECLARE_IGC_REGKEY(bool, EnableSMRescheduling,          false, "Change instruction order to enable extra Sample Multiversioning cases", false)
@@ -555,6 +562,7 @@ DECLARE_IGC_REGKEY(DWORD, FunctionCloningThreshold,     0,
     "If number of cloned functions exceeds the threshold, compile the function only once and use address relocation instead." \
     "Setting this to '0' allows IGC to choose the default value.", true)
 DECLARE_IGC_REGKEY(bool, ForceLowestSIMDForStackCalls,  true, "If enabled, compile to the lowest allowed SIMD mode when stack calls or indirect calls are present", true)
+DECLARE_IGC_REGKEY(bool, EnableArgUniformityPropagation, false, "If enabled, arguments of subroutines and stack calls that are uniform at all call sites are treated as uniform in the callee", true)
 DECLARE_IGC_REGKEY(DWORD, OCLInlineThreshold,           512,  "Setting OCL inline thershold", true)
 DECLARE_IGC_REGKEY(bool, DisableAddingAlwaysAttribute,  false, "Disable adding always attribute", true)
 DECLARE_IGC_REGKEY(bool, EnableForceGroupSize,          false, "Enable forcing thread Group Size ForceGroupSizeX and ForceGroupSizeY", false)
@@ -658,6 +666,12 @@ DECLARE_IGC_REGKEY(bool, ForceSubroutineForEmulation,   false,  "Force subroutin
 DECLARE_IGC_REGKEY(DWORD, InlinedEmulationThreshold,    125000, "Inlined instruction threshold for enabling subroutines", false)
 DECLARE_IGC_REGKEY(int, ByPassAllocaSizeHeuristic,   0,  "Force some Alloca to pass the pressure heuristic until the given size", false)
 DECLARE_IGC_REGKEY(DWORD, MemOptWindowSize,   150,  "Size of the window in unit of instructions in which load/stores are allowed to be coalesced. Keep it limited in order to avoid creating long liveranges. Default value is 150", false)
+DECLARE_IGC_REGKEY(bool, EnableMemOptCrossBlock, false, "Hoist loads / sink stores between control-equivalent blocks so that MemOpt can merge them. Bounded by MemOptWindowSize", false)
+DECLARE_IGC_REGKEY(bool, EnableDivergentAtomicAggregation, false, "Partition lanes of divergent-address integer atomics by address and issue one atomic per unique address", false)
+DECLARE_IGC_REGKEY(bool, EnableLSC2DBlockLoadSynthesis, false, "Turn per-lane loads forming a 2D tile across the subgroup into LSC 2D block reads", false)
+DECLARE_IGC_REGKEY(bool, EnableLSCLoopPrefetch, false, "Insert LSC prefetches ahead of affine global loads in innermost loops", false)
+DECLARE_IGC_REGKEY(DWORD, LSCLoopPrefetchLatency, 600, "Memory latency in cycles the loop prefetch distance is chosen to cover", false)
+DECLARE_IGC_REGKEY(DWORD, LSCLoopPrefetchMaxDistance, 8, "Maximum number of iterations a loop prefetch is issued ahead", false)
 DECLARE_IGC_REGKEY(bool, ForceNoFP64bRegioning, false, "force regioning rules for FP and 64b FPU instructions", false)
 DECLARE_IGC_REGKEY(bool, EmitDebugLoc, true, "Enable generation of .debug_loc section", false)
 DECLARE_IGC_REGKEY(bool, EmitOffsetInDbgLoc, false, "Emit offset of private memory in DW_AT_location when available", false)
@@ -692,6 +706,8 @@ DECLARE_IGC_REGKEY(DWORD, OverrideOCLMaxParamSize, 0,  "Override the value impos
 DECLARE_IGC_REGKEY(bool, EnableOptReportPrivateMemoryToSLM, false, "[POC] Generate opt report file for moving private memory allocations to SLM.", false)
 DECLARE_IGC_REGKEY(bool, ForceAllPrivateMemoryToSLM, false, "[POC] Force moving all private memory allocations to SLM.", false)
 DECLARE_IGC_REGKEY(debugString, ForcePrivateMemoryToSLMOnBuffers, 0, "[POC] Force moving private memory allocations to SLM, semicolon-separated list of buffers.", false)
+DECLARE_IGC_REGKEY(bool, EnablePrivateMemoryToSLMFallback, false, "Move private arrays that cannot be promoted to GRF to SLM instead of scratch when the occupancy allows it.", false)
+DECLARE_IGC_REGKEY(DWORD, PrivateMemoryToSLMMinOccupancy, 50, "Minimum percentage of the work-groups resident per subslice that SLM fallback of private arrays may keep.", false)
 DECLARE_IGC_REGKEY(bool, ForcePrivateMemoryToGlobalOnGeneric, true, "Force moving private memory allocations to global buffer when generic pointer is present", true)
 DECLARE_IGC_REGKEY(bool, DetectCastToGAS,                     true, "Check if the module contains local/private to GAS (Gerneric Address Space) cast, it also check internal flags", true)
 
@@ -727,6 +743,8 @@ DECLARE_IGC_GROUP("Raytracing Options")
     DECLARE_IGC_REGKEY(bool, DisablePromoteToScratch, false, "Use scratch space rather than SWStack when possible.", true)
     DECLARE_IGC_REGKEY(bool, DisableInvariantLoad, false, "Disabled !invariant_load metadata for raytracing shaders", true)
     DECLARE_IGC_REGKEY(bool, DisablePreSplitOpts, false, "Disable last minute optimizations befoer shader splitting", true)
+    DECLARE_IGC_REGKEY(DWORD, SuspendCrossingSparseThreshold, 1024, "Functions with more basic blocks than this use the sparse (per def block) suspend crossing analysis. 0 = always sparse", true)
+    DECLARE_IGC_REGKEY(bool, VerifySuspendCrossingInfo, false, "Compute both dense and sparse suspend crossing analysis and assert that they agree", true)
     DECLARE_IGC_REGKEY(bool, EnableKnownBTIBase, false, "For testing, assume that we know what baseBTI is in RTGlobals", true)
     DECLARE_IGC_REGKEY(DWORD, KnownBTIBaseValue, 0, "If EnableKnownBTIBase is set, use this value for baseBTI", true)
     DECLARE_IGC_REGKEY(bool, DisableStatefulRTStackAccess, false, "do stateless rather than stateful accesses to the HW portion of the async stack", true)
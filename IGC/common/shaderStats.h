@@ -29,4 +29,7 @@ DEFINE_SHADER_STAT(STATS_GRF_USED_SIMD32,                 "GRF used simd32")
 DEFINE_SHADER_STAT(STATS_GRF_PRESSURE_SIMD8,              "GRF pressure estimate simd8")
 DEFINE_SHADER_STAT(STATS_GRF_PRESSURE_SIMD16,             "GRF pressure estimate simd16")
 DEFINE_SHADER_STAT(STATS_GRF_PRESSURE_SIMD32,             "GRF pressure estimate simd32")
+DEFINE_SHADER_STAT(STATS_PRIVATE_ARRAYS_IN_GRF,           "private arrays in GRF")
+DEFINE_SHADER_STAT(STATS_PRIVATE_ARRAYS_IN_SLM,           "private arrays in SLM")
+DEFINE_SHADER_STAT(STATS_PRIVATE_ARRAYS_IN_SCRATCH,       "private arrays in scratch")
 DEFINE_SHADER_STAT( STATS_MAX_SHADER_STATS_ITEMS,         ""                 )
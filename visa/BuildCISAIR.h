@@ -10,7 +10,9 @@ SPDX-License-Identifier: MIT
 #define _BUILDCISAIR_H_
 
 #include <cstdint>
+#include <memory>
 #include <sstream>
+#include <vector>
 
 namespace vISA {
 class Mem_Manager;
@@ -86,6 +88,8 @@ public:
   VISA_BUILDER_API int ParseVISAText(const std::string &visaText,
                                      const std::string &visaTextFile) override;
   VISA_BUILDER_API int ParseVISAText(const std::string &visaFile) override;
+  VISA_BUILDER_API int ParseVISAInlineAsm(VISAKernel *kernel,
+                                          const std::string &asmText) override;
   VISA_BUILDER_API std::stringstream &GetAsmTextStream() override {
     return m_ssIsaAsm;
   }
@@ -117,6 +121,9 @@ public:
 
   int verifyVISAIR();
 
+  int parseVISATextBuffer(const std::string &visaText,
+                          const std::string &visaTextFile);
+
   static void cat(std::stringstream &ss) {}
   template <typename T, typename... Ts>
   static void cat(std::stringstream &ss, T t, Ts... ts) {
@@ -570,6 +577,9 @@ public:
   const vISA::PlatformInfo *getPlatformInfo() const { return m_platformInfo; }
   TARGET_PLATFORM getPlatform() const { return m_platformInfo->platform; }
   Options *getOptions() { return &m_options; }
+  // Options for a new kernel or function: the builder's own, or a private
+  // copy when kernels are compiled in parallel.
+  Options *getOptionsForKernel();
   VISA_BUILDER_OPTION getBuilderOption() const { return mBuildOption; }
   vISABuilderMode getBuilderMode() const { return m_builderMode; }
 
@@ -640,6 +650,8 @@ private:
 
   // list of kernels and functions added to this builder
   std::list<VISAKernelImpl *> m_kernelsAndFunctions;
+  // per-kernel copies of m_options, see getOptionsForKernel()
+  std::list<std::unique_ptr<Options>> m_kernelOptions;
   // for cases of several kernels/functions in one CisaBuilder
   // we need to keep a mapping of kernels to names
   // to make GetVISAKernel() work
@@ -647,6 +659,11 @@ private:
 
   std::map<std::string, vISA::G4_Kernel *> functionsNameMap;
   vISA::G4_Kernel *GetCallerKernel(vISA::G4_INST *);
+
+  unsigned getNumCompileThreads() const;
+  void syncKernelOptions(const Options *kernelOptions);
+  void setParseMode(bool isParseMode);
+  int compileKernelsInParallel(const std::vector<VISAKernelImpl *> &kernels);
   vISA::G4_Kernel *GetCalleeKernel(vISA::G4_INST *);
 
   // Set of functions that should be called directly (vs. indirect calls).
@@ -27,6 +27,7 @@ SPDX-License-Identifier: MIT
 #include "IsaVerification.h"
 #include "IGC/common/StringMacros.hpp"
 
+#include <atomic>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -35,6 +36,8 @@ SPDX-License-Identifier: MIT
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 using namespace vISA;
 extern "C" int64_t getTimerTicks(unsigned int idx);
@@ -364,6 +367,38 @@ void CISA_IR_Builder::SetDirectCallFunctionSet(
   m_directCallFunctions = directCallFunctions;
 }
 
+unsigned CISA_IR_Builder::getNumCompileThreads() const {
+  // Code patching compiles the shader body before the payload sections that
+  // are stitched to it.
+  if (m_options.getuInt32Option(vISA_CodePatch))
+    return 1;
+  return std::max(1u, m_options.getuInt32Option(vISA_CompileThreads));
+}
+
+Options *CISA_IR_Builder::getOptionsForKernel() {
+  // Compilation updates the options as it goes, so kernels compiled at the
+  // same time must not share them.
+  if (getNumCompileThreads() <= 1)
+    return &m_options;
+  m_kernelOptions.push_back(std::make_unique<Options>(m_options));
+  return m_kernelOptions.back().get();
+}
+
+// Copies back the options a kernel updates for the rest of the builder to
+// see, when the kernel has its own copy of them.
+void CISA_IR_Builder::syncKernelOptions(const Options *kernelOptions) {
+  if (kernelOptions == &m_options)
+    return;
+  m_options.setOption(vISA_TotalGRFNum,
+                      kernelOptions->getuInt32Option(vISA_TotalGRFNum));
+}
+
+void CISA_IR_Builder::setParseMode(bool isParseMode) {
+  m_options.setOptionInternally(vISA_isParseMode, isParseMode);
+  for (auto &options : m_kernelOptions)
+    options->setOptionInternally(vISA_isParseMode, isParseMode);
+}
+
 int CISA_IR_Builder::AddKernel(VISAKernel *&kernel, const char *kernelName) {
   if (kernel) {
     vASSERT(kernel == nullptr);
@@ -373,6 +408,7 @@ int CISA_IR_Builder::AddKernel(VISAKernel *&kernel, const char *kernelName) {
   unsigned int funcId = this->m_kernel_count++;
   VISAKernelImpl *kerneltemp = new (m_mem)
       VISAKernelImpl(VISA_BUILD_TYPE::KERNEL, this, kernelName, funcId);
+  syncKernelOptions(kerneltemp->getOptions());
   kernel = static_cast<VISAKernel *>(kerneltemp);
   m_kernel = kerneltemp;
 
@@ -404,6 +440,7 @@ int CISA_IR_Builder::AddFunction(VISAFunction *&function,
   unsigned int funcId = this->m_function_count++;
   VISAKernelImpl *kerneltemp = new (m_mem)
       VISAKernelImpl(VISA_BUILD_TYPE::FUNCTION, this, functionName, funcId);
+  syncKernelOptions(kerneltemp->getOptions());
   function = static_cast<VISAFunction *>(kerneltemp);
   m_kernel = kerneltemp;
   m_kernelsAndFunctions.push_back(kerneltemp);
@@ -1402,8 +1439,8 @@ extern YY_BUFFER_STATE CISA_scan_string(const char *yy_str);
 extern void CISA_delete_buffer(YY_BUFFER_STATE buf);
 static std::mutex mtx;
 
-int CISA_IR_Builder::ParseVISAText(const std::string &visaText,
-                                   const std::string &visaTextFile) {
+int CISA_IR_Builder::parseVISATextBuffer(const std::string &visaText,
+                                         const std::string &visaTextFile) {
   const std::lock_guard<std::mutex> lock(mtx);
 #if defined(__linux__) || defined(_WIN64) || defined(_WIN32)
   // Direct output of parser to null
@@ -1424,6 +1461,20 @@ int CISA_IR_Builder::ParseVISAText(const std::string &visaText,
     }
   }
 
+  // The text may also be parsed by a builder that is not an asm reader, in
+  // which case the declarations still have to follow the asm input rules.
+  // The builder's mode is restored on every way out of the parser.
+  struct ParseModeScope {
+    CISA_IR_Builder *builder;
+    bool prevParseMode;
+    explicit ParseModeScope(CISA_IR_Builder *b)
+        : builder(b),
+          prevParseMode(b->m_options.getOption(vISA_isParseMode)) {
+      builder->setParseMode(true);
+    }
+    ~ParseModeScope() { builder->setParseMode(prevParseMode); }
+  } parseModeScope(this);
+
   YY_BUFFER_STATE visaBuf = CISA_scan_string(visaText.c_str());
   if (CISAparse(this) != 0) {
 #ifndef DLL_MODE
@@ -1441,6 +1492,17 @@ int CISA_IR_Builder::ParseVISAText(const std::string &visaText,
     fclose(CISAout);
   }
 
+  return status;
+#else
+  vISA_ASSERT(false, "vISA asm parsing not supported on this platform");
+  return VISA_FAILURE;
+#endif
+}
+
+int CISA_IR_Builder::ParseVISAText(const std::string &visaText,
+                                   const std::string &visaTextFile) {
+  int status = parseVISATextBuffer(visaText, visaTextFile);
+
   // run vISA verifier to cath any additional errors.
   // the subsequent vISABuilder::Compile() call is assumed to always succeed
   // after verifier checks.
@@ -1449,10 +1511,33 @@ int CISA_IR_Builder::ParseVISAText(const std::string &visaText,
   }
 
   return status;
-#else
-  vISA_ASSERT(false, "vISA asm parsing not supported on this platform");
-  return VISA_FAILURE;
-#endif
+}
+
+// Parses inline asm instructions into a kernel under construction, without
+// going through the vISA text of the whole module.
+int CISA_IR_Builder::ParseVISAInlineAsm(VISAKernel *kernel,
+                                        const std::string &asmText) {
+  vISA_ASSERT(m_options.getOption(vISA_isParseMode) ||
+                  m_options.getOption(vISA_KeepVarNames),
+              "variable names are needed to parse inline asm");
+
+  // The grammar expects a complete listing, so the snippet is given the
+  // version header of the module being built.
+  std::stringstream ss;
+  ss << ".version " << (unsigned)getMajorVersion() << "."
+     << (unsigned)getMinorVersion() << "\n"
+     << asmText << "\n";
+
+  // The snippet is parsed in a scope of its own, as if it was enclosed in
+  // braces, so that its declarations do not leak into the kernel.
+  VISAKernelImpl *prevKernel = m_kernel;
+  m_kernel = static_cast<VISAKernelImpl *>(kernel);
+  m_kernel->pushIndexMapScopeLevel();
+  int status = parseVISATextBuffer(ss.str(), "");
+  m_kernel->popIndexMapScopeLevel();
+  m_kernel = prevKernel;
+
+  return status;
 }
 
 // Parses inline asm file from ShaderOverride
@@ -1486,6 +1571,45 @@ int CISA_IR_Builder::ParseVISAText(const std::string &visaFile) {
 #endif
 }
 
+// Compiles kernels and functions that do not depend on each other. Each of
+// them owns its IR builder, memory and options, so they only meet again when
+// the functions are stitched. Timers of the worker threads are not reported.
+int CISA_IR_Builder::compileKernelsInParallel(
+    const std::vector<VISAKernelImpl *> &kernels) {
+  const size_t numThreads =
+      std::min<size_t>(getNumCompileThreads(), kernels.size());
+  std::vector<int> results(kernels.size(), VISA_SUCCESS);
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+  auto compile = [&]() {
+    for (size_t i = next++; i < kernels.size() && !failed; i = next++) {
+      results[i] = kernels[i]->compileFastPath();
+      if (results[i] != VISA_SUCCESS)
+        failed = true;
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < numThreads; ++i)
+    workers.emplace_back(compile);
+  compile();
+  for (auto &worker : workers)
+    worker.join();
+
+  // Kernels compiled serially share the builder options, so the last one
+  // compiled leaves its updates in them.
+  for (auto kernel : kernels)
+    syncKernelOptions(kernel->getOptions());
+
+  // Report the failure of the first kernel in order, as a serial compilation
+  // would.
+  for (int status : results) {
+    if (status != VISA_SUCCESS)
+      return status;
+  }
+  return VISA_SUCCESS;
+}
+
 // default size of the kernel mem manager in bytes
 int CISA_IR_Builder::Compile(const char *nameInput, std::ostream *os,
                              bool emit_visa_only) {
@@ -1629,6 +1753,10 @@ int CISA_IR_Builder::Compile(const char *nameInput, std::ostream *os,
     uint32_t localScheduleEndKernelId =
         m_options.getuInt32Option(vISA_LocalScheduleingEndKernel);
     VISAKernelImpl *mainKernel = nullptr;
+    const bool compileInParallel = !isInPatchingMode &&
+                                   getNumCompileThreads() > 1 &&
+                                   m_kernelsAndFunctions.size() > 1;
+    std::vector<VISAKernelImpl *> kernelsToCompile;
     std::list<VISAKernelImpl *>::iterator iter = m_kernelsAndFunctions.begin();
     std::list<VISAKernelImpl *>::iterator end = m_kernelsAndFunctions.end();
     for (int i = 0; iter != end; iter++, i++) {
@@ -1685,6 +1813,10 @@ int CISA_IR_Builder::Compile(const char *nameInput, std::ostream *os,
           (kernel->getvIsaInstCount() == 0 && kernel->getIsPayload())) {
         continue;
       }
+      if (compileInParallel) {
+        kernelsToCompile.push_back(kernel);
+        continue;
+      }
       int status = kernel->compileFastPath();
       if (status != VISA_SUCCESS) {
         stopTimer(TimerID::TOTAL);
@@ -1708,6 +1840,15 @@ int CISA_IR_Builder::Compile(const char *nameInput, std::ostream *os,
         }
       }
     }
+    if (compileInParallel) {
+      int status = compileKernelsInParallel(kernelsToCompile);
+      if (status != VISA_SUCCESS) {
+        stopTimer(TimerID::TOTAL);
+        if (status == VISA_EARLY_EXIT)
+          status = VISA_SUCCESS;
+        return status;
+      }
+    }
     // Here we change the payload section as the main kernel in
     // m_kernelsAndFunctions During stitching, all functions will be cloned and
     // stitched to the main kernel. Demoting the shader body to a function type
@@ -22,6 +22,7 @@ SPDX-License-Identifier: MIT
 #include "iga/IGALibrary/api/iga.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
 #include <fstream>
@@ -364,7 +365,8 @@ G4_BB *FlowGraph::createNewBBWithLabel(const char *LabelSuffix) {
   return newBB;
 }
 
-static int globalCount = 1;
+// Shared by the kernels of a builder, which may be compiled in parallel.
+static std::atomic<int> globalCount{1};
 
 int64_t FlowGraph::insertDummyUUIDMov() {
   // Here when -addKernelId is passed
@@ -382,8 +384,7 @@ int64_t FlowGraph::insertDummyUUIDMov() {
       uint32_t seed = (uint32_t)std::chrono::high_resolution_clock::now()
                           .time_since_epoch()
                           .count();
-      std::mt19937 mt_rand(seed * globalCount);
-      globalCount++;
+      std::mt19937 mt_rand(seed * globalCount++);
 
       G4_DstRegRegion *nullDst = builder->createNullDst(Type_UD);
       int64_t uuID = (int64_t)mt_rand();
@@ -854,6 +854,11 @@ private:
   void insertSlot1HwordR0Set(G4_BB *bb, INST_LIST_ITER &instIt);
   void insertSlot1HwordR0Reset(G4_BB *bb, INST_LIST_ITER &instIt);
 
+  // LSC cache controls chosen for spill/fill intrinsics based on the reuse
+  // distance of their scratch slots. Empty unless -lscSpillCacheHints.
+  std::unordered_map<G4_INST *, LSC_CACHE_OPTS> spillFillCacheHints;
+  void computeSpillFillCacheHints();
+
   bool spillFillIntrinUsesLSC(G4_INST *spillFillIntrin);
   void expandFillLSC(G4_BB *bb, INST_LIST_ITER &instIt);
   void expandSpillLSC(G4_BB *bb, INST_LIST_ITER &instIt);
@@ -12,12 +12,14 @@ SPDX-License-Identifier: MIT
 #include "PlatformInfo.h"
 #include "Timer.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <limits>
 #include <sstream>
 #include <string_view>
@@ -721,3 +723,12 @@ Options::Options() {
   initializeArgToOption();
   initialize_m_vISAOptions();
 }
+
+Options::Options(const Options &Other)
+    : argToOption(Other.argToOption), m_vISAOptions(this),
+      target(Other.target), stepping(Other.stepping) {
+  std::copy(std::begin(Other.vISAOptionsToStr),
+            std::end(Other.vISAOptionsToStr), std::begin(vISAOptionsToStr));
+  m_vISAOptions.copyFrom(Other.m_vISAOptions);
+  argString << Other.argString.str();
+}
@@ -53,10 +53,16 @@ struct VISAOptionsEntry {
   EntryValue val;
   EntryType getType(void) const { return type; }
   virtual void dump(void) const { std::cerr << "BASE"; }
+  virtual VISAOptionsEntry *clone(void) const {
+    return new VISAOptionsEntry(*this);
+  }
   virtual ~VISAOptionsEntry() {}
 };
 
 struct VISAOptionsEntryBool : VISAOptionsEntry {
+  VISAOptionsEntry *clone(void) const override {
+    return new VISAOptionsEntryBool(*this);
+  }
   VISAOptionsEntryBool(bool Val) {
     val.boolean = Val;
     type = ET_BOOL;
@@ -68,6 +74,9 @@ struct VISAOptionsEntryBool : VISAOptionsEntry {
   bool getVal(void) const { return val.boolean; }
 };
 struct VISAOptionsEntryUint32 : VISAOptionsEntry {
+  VISAOptionsEntry *clone(void) const override {
+    return new VISAOptionsEntryUint32(*this);
+  }
   VISAOptionsEntryUint32(uint32_t Val) {
     val.int32 = Val;
     type = ET_INT32;
@@ -78,6 +87,9 @@ struct VISAOptionsEntryUint32 : VISAOptionsEntry {
   uint32_t getVal(void) const { return val.int32; }
 };
 struct VISAOptionsEntryUint64 : VISAOptionsEntry {
+  VISAOptionsEntry *clone(void) const override {
+    return new VISAOptionsEntryUint64(*this);
+  }
   VISAOptionsEntryUint64(uint64_t Val) {
     val.int64 = Val;
     type = ET_INT64;
@@ -88,6 +100,9 @@ struct VISAOptionsEntryUint64 : VISAOptionsEntry {
   uint64_t getVal(void) const { return val.int64; }
 };
 struct VISAOptionsEntryCstr : VISAOptionsEntry {
+  VISAOptionsEntry *clone(void) const override {
+    return new VISAOptionsEntryCstr(*this);
+  }
   VISAOptionsEntryCstr(const char *Val) {
     val.cstr = Val;
     type = ET_CSTR;
@@ -111,6 +126,10 @@ class Options {
 
 public:
   Options();
+  // Deep copy, used to give each kernel its own options when kernels are
+  // compiled in parallel.
+  Options(const Options &Other);
+  Options &operator=(const Options &) = delete;
 
   const char *get_vISAOptionsToStr(vISAOptions opt) {
     return vISAOptionsToStr[opt];
@@ -396,6 +415,17 @@ private:
     VISAOptionsDB() {}
     VISAOptionsDB(Options *opt) { options = opt; }
 
+    // Copy all the entries of OTHER, which must not share them afterwards.
+    void copyFrom(const VISAOptionsDB &other) {
+      for (auto &pair : other.optionsMap) {
+        VISAOptionsLine line = pair.second;
+        line.value = line.value ? line.value->clone() : nullptr;
+        line.defaultValue =
+            line.defaultValue ? line.defaultValue->clone() : nullptr;
+        optionsMap[pair.first] = line;
+      }
+    }
+
     ~VISAOptionsDB(void) {
       for (auto pair : optionsMap) {
         auto *val = pair.second.value;
@@ -440,6 +440,46 @@ void SpillManagerGRF::getOverlappingIntervals(
   }
 }
 
+// Check whether [disp, disp + size) is clear of all locations in locList.
+// Location ends are rounded up to GRF size as in first fit allocation.
+template <typename LocListTy, typename SizeFnTy>
+static bool isSpillSlotFree(const LocListTy &locList, unsigned disp,
+                            unsigned size, SizeFnTy getRoundedSize) {
+  for (G4_RegVar *curLoc : locList) {
+    unsigned curLocDisp = curLoc->getDisp();
+    unsigned curLocEnd = curLocDisp + getRoundedSize(curLoc);
+    if (disp < curLocEnd && curLocDisp < disp + size)
+      return false;
+  }
+  return true;
+}
+
+// Try to place regVar right after the previously allocated spill slot.
+// Ranges get their slots in order of first reference, so neighbouring slots
+// tend to be accessed together and their spills/fills can be coalesced by
+// spill cleanup. Note that CoalesceSpillFills merges at most
+// cMaxFillPayloadSize rows, wider coalescing is not attempted here. The slot
+// is only taken if it does not grow spill space.
+template <typename LocListTy>
+unsigned SpillManagerGRF::getColocatedSpillDisp(const LocListTy &locList,
+                                                unsigned minDisp,
+                                                unsigned size) const {
+  if (!builder_->getOption(vISA_SpillSlotColocation) ||
+      lastSpillDispEnd_ == UINT_MAX)
+    return UINT_MAX;
+
+  unsigned grfSize = builder_->numEltPerGRF<Type_UB>();
+  unsigned disp = ROUND(lastSpillDispEnd_, grfSize);
+  if (disp < minDisp || disp + size > spillDispHighWater_)
+    return UINT_MAX;
+
+  auto getRoundedSize = [&](G4_RegVar *var) {
+    return ROUND(getByteSize(var), grfSize);
+  };
+  return isSpillSlotFree(locList, disp, size, getRoundedSize) ? disp
+                                                              : UINT_MAX;
+}
+
 // Calculate the spill memory displacement for the regvar.
 unsigned SpillManagerGRF::calculateSpillDisp(G4_RegVar *regVar) const {
   vASSERT(regVar->getDisp() == UINT_MAX);
@@ -488,6 +528,11 @@ unsigned SpillManagerGRF::calculateSpillDisp(G4_RegVar *regVar) const {
       ROUND(nextSpillOffset_, builder_->numEltPerGRF<Type_UB>());
   unsigned regVarSize = getByteSize(regVar);
 
+  unsigned colocatedDisp =
+      getColocatedSpillDisp(locList, regVarLocDisp, regVarSize);
+  if (colocatedDisp != UINT_MAX)
+    return colocatedDisp;
+
   for (G4_RegVar *curLoc : locList) {
     unsigned curLocDisp = curLoc->getDisp();
     if (regVarLocDisp < curLocDisp && regVarLocDisp + regVarSize <= curLocDisp)
@@ -544,6 +589,11 @@ unsigned SpillManagerGRF::calculateSpillDispForLS(G4_RegVar *regVar) const {
       ROUND(nextSpillOffset_, builder_->numEltPerGRF<Type_UB>());
   unsigned regVarSize = getByteSize(regVar);
 
+  unsigned colocatedDisp =
+      getColocatedSpillDisp(locList, regVarLocDisp, regVarSize);
+  if (colocatedDisp != UINT_MAX)
+    return colocatedDisp;
+
   for (LocList::iterator curLoc = locList.begin(), end = locList.end();
        curLoc != end; ++curLoc) {
     unsigned curLocDisp = (*curLoc)->getDisp();
@@ -631,6 +681,8 @@ unsigned SpillManagerGRF::getDisp(G4_RegVar *regVar) {
       } else {
         regVar->setDisp(calculateSpillDisp(regVar));
       }
+      lastSpillDispEnd_ = regVar->getDisp() + getByteSize(regVar);
+      spillDispHighWater_ = std::max(spillDispHighWater_, lastSpillDispEnd_);
     } else {
       vASSERT(regVar->isRegVarTransient() == false);
       if (regVar->getId() >= varIdCount_) {
@@ -4758,6 +4810,9 @@ void GlobalRA::expandSpillLSC(G4_BB *bb, INST_LIST_ITER &instIt) {
       (LSC_L1_L3_CC)builder->getuint32Option(vISA_lscSpillStoreCCOverride);
   if (store_cc != LSC_CACHING_DEFAULT) {
     cacheOpts = convertLSCLoadStoreCacheControlEnum(store_cc, false);
+  } else if (auto hint = spillFillCacheHints.find(inst);
+             hint != spillFillCacheHints.end()) {
+    cacheOpts = hint->second;
   }
 
   LSC_ADDR addrInfo;
@@ -4857,6 +4912,9 @@ void GlobalRA::expandFillLSC(G4_BB *bb, INST_LIST_ITER &instIt) {
       (LSC_L1_L3_CC)builder->getuint32Option(vISA_lscSpillLoadCCOverride);
   if (ld_cc != LSC_CACHING_DEFAULT) {
     cacheOpts = convertLSCLoadStoreCacheControlEnum(ld_cc, true);
+  } else if (auto hint = spillFillCacheHints.find(inst);
+             hint != spillFillCacheHints.end()) {
+    cacheOpts = hint->second;
   }
 
   LSC_ADDR addrInfo;
@@ -5579,12 +5637,98 @@ void GlobalRA::expandFillIntrinsic(G4_BB *bb) {
 }
 
 
+// Pick LSC cache controls for spill/fill intrinsics from the distance, in
+// instructions of layout order, between accesses to the same scratch rows:
+// - a spill that is not filled within vISA_lscSpillReuseDistance bypasses L1;
+// - a fill that is the last read of its rows before they are overwritten (or
+//   ever) is streamed through L1 so it does not evict hotter lines.
+// Blocks inside loops keep the default since accesses may come through the
+// back edge. The hints only affect performance, so layout order is good
+// enough here.
+void GlobalRA::computeSpillFillCacheHints() {
+  spillFillCacheHints.clear();
+  const unsigned reuseDistance =
+      builder.getuint32Option(vISA_lscSpillReuseDistance);
+
+  struct Access {
+    G4_INST *inst;
+    unsigned pos;
+  };
+  // Last access of each scratch row. FP relative rows are kept apart from
+  // absolute ones.
+  std::unordered_map<uint32_t, Access> lastAccess;
+  // Distance from a spill to the first fill reading any of its rows.
+  std::unordered_map<G4_INST *, unsigned> spillReuse;
+  // Fills with at least one row read again before being overwritten.
+  std::unordered_set<G4_INST *> refilled;
+  std::vector<std::pair<G4_INST *, G4_BB *>> spillFills;
+
+  unsigned pos = 0;
+  for (auto bb : kernel.fg) {
+    for (auto inst : *bb) {
+      ++pos;
+      if (!inst->isSpillIntrinsic() && !inst->isFillIntrinsic())
+        continue;
+
+      bool isFill = inst->isFillIntrinsic();
+      uint32_t offset = 0, numRows = 0;
+      bool offBP = false;
+      if (isFill) {
+        offset = inst->asFillIntrinsic()->getOffset();
+        numRows = inst->asFillIntrinsic()->getNumRows();
+        offBP = inst->asFillIntrinsic()->isOffBP();
+      } else {
+        offset = inst->asSpillIntrinsic()->getOffset();
+        numRows = inst->asSpillIntrinsic()->getNumRows();
+        offBP = inst->asSpillIntrinsic()->isOffBP();
+      }
+
+      for (uint32_t row = offset; row != offset + numRows; ++row) {
+        uint32_t key = offBP ? (row | 0x80000000) : row;
+        auto it = lastAccess.find(key);
+        if (isFill && it != lastAccess.end()) {
+          G4_INST *prev = it->second.inst;
+          if (prev->isSpillIntrinsic()) {
+            auto res = spillReuse.emplace(prev, pos - it->second.pos);
+            res.first->second =
+                std::min(res.first->second, pos - it->second.pos);
+          } else {
+            refilled.insert(prev);
+          }
+        }
+        lastAccess[key] = {inst, pos};
+      }
+      spillFills.emplace_back(inst, bb);
+    }
+  }
+
+  for (auto [inst, bb] : spillFills) {
+    // A loop may re-read the same rows through its back edge.
+    if (bb->getNestLevel() != 0)
+      continue;
+    if (inst->isFillIntrinsic()) {
+      if (!refilled.count(inst))
+        spillFillCacheHints[inst] =
+            convertLSCLoadStoreCacheControlEnum(LSC_L1S_L3C_WB, true);
+      continue;
+    }
+    auto it = spillReuse.find(inst);
+    if (it == spillReuse.end() || it->second > reuseDistance)
+      spillFillCacheHints[inst] =
+          convertLSCLoadStoreCacheControlEnum(LSC_L1UC_L3C_WB, false);
+  }
+}
+
 void GlobalRA::expandSpillFillIntrinsics(unsigned int spillSizeInBytes) {
   auto globalScratchOffset =
       kernel.getInt32KernelAttr(Attributes::ATTR_SpillMemOffset);
   bool hasStackCall =
       kernel.fg.getHasStackCalls() || kernel.fg.getIsStackCallFunc();
 
+  if ((useLscForSpillFill || useLscForNonStackCallSpillFill) &&
+      builder.getOption(vISA_lscSpillCacheHints))
+    computeSpillFillCacheHints();
+
   for (auto bb : kernel.fg) {
     if (builder.hasScratchSurface() &&
         (hasStackCall || kernel.fg.builder->hasValidOldA0Dot2() ||
@@ -642,6 +642,10 @@ private:
   void getOverlappingIntervals(G4_Declare *dcl,
                                std::vector<G4_Declare *> &intervals) const;
 
+  template <typename LocListTy>
+  unsigned getColocatedSpillDisp(const LocListTy &locList, unsigned minDisp,
+                                 unsigned size) const;
+
   // Data
   GlobalRA &gra;
   IR_Builder *builder_;
@@ -662,6 +666,11 @@ private:
   unsigned bbId_ = UINT_MAX;
   unsigned spillAreaOffset_;
   bool doSpillSpaceCompression;
+  // End of the most recently allocated spill slot and the highest slot end
+  // allocated so far; used to colocate ranges that are first referenced
+  // close to each other.
+  unsigned lastSpillDispEnd_ = UINT_MAX;
+  unsigned spillDispHighWater_ = 0;
 
   bool failSafeSpill_;
   unsigned spillRegStart_;
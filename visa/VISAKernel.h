@@ -49,7 +49,7 @@ public:
   VISAKernelImpl(enum VISA_BUILD_TYPE type, CISA_IR_Builder *cisaBuilder,
                  const char *name, unsigned int funcId)
       : m_mem(4096), m_CISABuilder(cisaBuilder),
-        m_options(cisaBuilder->getOptions()), m_functionId(funcId) {
+        m_options(cisaBuilder->getOptionsForKernel()), m_functionId(funcId) {
     mBuildOption = m_CISABuilder->getBuilderOption();
     m_magic_number = COMMON_ISA_MAGIC_NUM;
     m_major_version = m_CISABuilder->getMajorVersion();
@@ -1195,6 +1195,8 @@ private:
   bool isReservedName(const std::string &nm) const;
   void ensureVariableNameUnique(const char *&varName);
   void generateVariableName(Common_ISA_Var_Class Ty, const char *&varName);
+  bool keepsVarNames() const;
+  void keepVarName(const char *varName, CISA_GEN_VAR *decl);
 
   void dumpDebugFormatFile(std::vector<vISA::DebugInfoFormat> &debugSymbols,
                            std::string filename);
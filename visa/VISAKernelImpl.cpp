@@ -735,7 +735,7 @@ int VISAKernelImpl::CISABuildPreDefinedDecls() {
         std::string varName(getPredefinedVarString(predefId));
         std::string alias = "V" + std::to_string(i);
         decl->genVar.name_index = addStringPool(varName);
-        if (m_options->getOption(vISA_isParseMode)) {
+        if (keepsVarNames()) {
           setNameIndexMap(alias, decl, true);
           setNameIndexMap(varName, decl, true);
         }
@@ -876,7 +876,8 @@ void VISAKernelImpl::ensureVariableNameUnique(const char *&varName) {
 
 void VISAKernelImpl::generateVariableName(Common_ISA_Var_Class Ty,
                                           const char *&varName) {
-  if (!m_options->getOption(vISA_GenerateISAASM) && !IsAsmWriterMode()) {
+  if (!m_options->getOption(vISA_GenerateISAASM) && !IsAsmWriterMode() &&
+      !m_options->getOption(vISA_KeepVarNames)) {
     // variable name is a don't care if we are not outputting vISA assembly
     return;
   }
@@ -931,6 +932,22 @@ void VISAKernelImpl::generateVariableName(Common_ISA_Var_Class Ty,
   ensureVariableNameUnique(varName);
 }
 
+bool VISAKernelImpl::keepsVarNames() const {
+  return m_options->getOption(vISA_isParseMode) ||
+         m_options->getOption(vISA_KeepVarNames);
+}
+
+// In parse mode the names are mapped as the declarations are parsed. With
+// vISA_KeepVarNames the variables created through the builder API are mapped
+// as well, so that vISA text parsed into the kernel later on (e.g. inline
+// assembly) can refer to them.
+void VISAKernelImpl::keepVarName(const char *varName, CISA_GEN_VAR *decl) {
+  if (m_options->getOption(vISA_isParseMode) ||
+      !m_options->getOption(vISA_KeepVarNames) || !varName || !*varName)
+    return;
+  setNameIndexMap(std::string(varName), decl);
+}
+
 std::string VISAKernelImpl::getVarName(VISA_GenVar *decl) const {
   return getVarName((CISA_GEN_VAR *)decl);
 }
@@ -979,6 +996,7 @@ int VISAKernelImpl::CreateVISAGenVar(VISA_GenVar *&decl, const char *varName,
   }
 
   m_GenVarToNameMap[decl] = varName;
+  keepVarName(varName, decl);
 
   info->bit_properties = (uint8_t)dataType;
   info->bit_properties += varAlign << 4;
@@ -1066,6 +1084,7 @@ int VISAKernelImpl::CreateVISAAddrVar(VISA_AddrVar *&decl, const char *varName,
   generateVariableName(decl->type, varName);
 
   m_GenVarToNameMap[decl] = varName;
+  keepVarName(varName, decl);
 
   decl->index = m_addr_info_count++;
   if (IS_GEN_BOTH_PATH) {
@@ -1117,6 +1136,7 @@ int VISAKernelImpl::CreateVISAPredVar(VISA_PredVar *&decl, const char *varName,
   generateVariableName(decl->type, varName);
 
   m_GenVarToNameMap[decl] = varName;
+  keepVarName(varName, decl);
 
   pred_info_t *pred = &decl->predVar;
 
@@ -1163,6 +1183,7 @@ int VISAKernelImpl::CreateStateVar(CISA_GEN_VAR *&decl,
   generateVariableName(decl->type, varName);
 
   m_GenVarToNameMap[decl] = varName;
+  keepVarName(varName, decl);
 
   state_info_t *state = &decl->stateVar;
   state->attribute_capacity = 0;
@@ -9,6 +9,8 @@ SPDX-License-Identifier: MIT
 #include "../Timer.h"
 #include "BuildIR.h"
 
+#include <atomic>
+
 using namespace vISA;
 
 static const unsigned MESSAGE_PRECISION_SUBTYPE_OFFSET = 30;
@@ -1228,7 +1230,8 @@ Need to split sample_d and sample_dc in to two simd8 sends since HW doesn't
 support it. Also need to split any sample instruciton that has more then 5
 parameters. Since there is a limit on msg length.
 */
-static unsigned TmpSmplDstID = 0;
+// Kernels may be compiled in parallel, see vISA_CompileThreads.
+static std::atomic<unsigned> TmpSmplDstID{0};
 
 // split simd32/16 sampler messages into simd16/8 messages due to HW limitation.
 int IR_Builder::splitSampleInst(
@@ -17,6 +17,9 @@ SPDX-License-Identifier: MIT
 
 #include "visa/include/RelocationInfo.h"
 
+#include <string>
+#include <unordered_set>
+
 class VISAKernel {
 public:
   /********** CREATE VARIABLE APIS START ******************/
@@ -1222,6 +1225,10 @@ public:
   ParseVISAText(const std::string &visaText,
                 const std::string &visaTextFile) = 0;
   VISA_BUILDER_API virtual int ParseVISAText(const std::string &visaFile) = 0;
+  // Parses vISA instructions directly into the given kernel. The variables
+  // of the kernel are referenced by name, which requires vISA_KeepVarNames.
+  VISA_BUILDER_API virtual int
+  ParseVISAInlineAsm(VISAKernel *kernel, const std::string &asmText) = 0;
   VISA_BUILDER_API virtual std::stringstream &GetAsmTextStream() = 0;
   VISA_BUILDER_API virtual VISAKernel *
   GetVISAKernel(const std::string &kernelName = "") const = 0;
@@ -202,6 +202,10 @@ DEF_VISA_OPTION(vISA_renderTargetWriteSendReloc, ET_BOOL,
         "Enables adding offsets of all Render Target Write send instructions to the relocation table.", false)
 DEF_VISA_OPTION(vISA_CodePatch, ET_INT32, "-codePatch", UNUSED, 0)
 DEF_VISA_OPTION(vISA_Linker, ET_INT32, "-linker", UNUSED, 0)
+// Number of threads compiling the kernels and functions of a builder. Each
+// kernel then gets its own copy of the options. 0 and 1 compile serially.
+DEF_VISA_OPTION(vISA_CompileThreads, ET_INT32, "-compileThreads",
+                "USAGE: -compileThreads <threadNum>\n", 0)
 DEF_VISA_OPTION(vISA_lscEnableImmOffsFor, ET_INT32, "-lscEnableImmOffsFor",
                 UNUSED, 0x3001E)
 DEF_VISA_OPTION(vISA_PreserveR0InR0, ET_BOOL, "-preserver0", UNUSED, false)
@@ -215,9 +219,20 @@ DEF_VISA_OPTION(vISA_lscSpillLoadCCOverride, ET_INT32,
 DEF_VISA_OPTION(vISA_lscSpillStoreCCOverride, ET_INT32,
                 "-lscSpillStoreCCOverride",
                 "lsc store cache control option for spill", 0)
+// derive spill/fill cache control from scratch reuse distance when no
+// override above is given.
+DEF_VISA_OPTION(vISA_lscSpillCacheHints, ET_BOOL, "-lscSpillCacheHints",
+                "use reuse distance to pick lsc spill/fill cache control",
+                false)
+DEF_VISA_OPTION(vISA_lscSpillReuseDistance, ET_INT32,
+                "-lscSpillReuseDistance",
+                "spills not filled within this many instructions bypass L1",
+                256)
 
 //=== RA options ===
 DEF_VISA_OPTION(vISA_RoundRobin, ET_BOOL, "-noroundrobin", UNUSED, true)
+DEF_VISA_OPTION(vISA_SpillSlotColocation, ET_BOOL, "-spillSlotColocation",
+                UNUSED, false)
 DEF_VISA_OPTION(vISA_PrintRegUsage, ET_BOOL, "-printregusage", UNUSED, false)
 DEF_VISA_OPTION(vISA_IPA, ET_BOOL, "-noipa", UNUSED, true)
 DEF_VISA_OPTION(vISA_LocalRA, ET_BOOL, "-nolocalra", UNUSED, true)
@@ -474,6 +489,8 @@ DEF_VISA_OPTION(vISA_NoVerifyvISA, ET_BOOL, "-noverifyCISA", UNUSED, false)
 DEF_VISA_OPTION(vISA_InitPayload, ET_BOOL, "-initializePayload", UNUSED, false)
 DEF_VISA_OPTION(vISA_AvoidUsingR0R1, ET_BOOL, "-avoidR0R1", UNUSED, false)
 DEF_VISA_OPTION(vISA_isParseMode, ET_BOOL, NULLSTR, UNUSED, false)
+//   keep variable names so that vISA text can be parsed into binary kernels
+DEF_VISA_OPTION(vISA_KeepVarNames, ET_BOOL, NULLSTR, UNUSED, false)
 //   rerun RA post scheduling for gtpin
 DEF_VISA_OPTION(vISA_ReRAPostSchedule, ET_BOOL, "-rerapostschedule", UNUSED,
                 false)